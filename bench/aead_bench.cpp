@@ -0,0 +1,172 @@
+// Compares the AEAD frame cipher with the stream ciphers the transport key used before, on the payload of one frame.
+//
+// Usage: aead_bench [--seconds 2] [--size 1400] [--methods aes-128-cfb,aes-256-cfb,aes-128-gcm,aes-256-gcm,chacha20-poly1305]
+//
+// A method AEAD::Support accepts is measured with AEAD::Seal and AEAD::Open (sequence, nonce and tag included) the way key.aead frames
+// the payload, every other method with Ciphertext::Encrypt and Ciphertext::Decrypt the way the transport key encrypts it. The header,
+// which both framings obfuscate the same way, is left out. Every result is printed as one key=value line with frames per second, MB/s
+// of payload and nanoseconds per frame for each direction. tunnel_bench measures the whole carrier with key.aead on or off.
+
+#include <ppp/stdafx.h>
+#include <ppp/cryptography/AEAD.h>
+#include <ppp/cryptography/Ciphertext.h>
+#include <ppp/threading/BufferswapAllocator.h>
+
+#include <chrono>
+
+using ppp::Byte;
+using ppp::cryptography::AEAD;
+using ppp::cryptography::Ciphertext;
+
+typedef std::chrono::steady_clock                                       Clock;
+
+static constexpr const char* BENCHMARK_KEY = "HWFweXu2g5RVMEpy";
+
+static double ElapsedSeconds(Clock::time_point started) noexcept {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started).count() / 1000000000.0;
+}
+
+static void PrintResult(const char* method, const char* framing, const char* direction, uint64_t frames, int size, double elapsed, uint64_t errors) noexcept {
+    printf("method=%s framing=%s direction=%s size=%d frames=%llu fps=%.0f mbps=%.1f ns_per_frame=%.1f errors=%llu\n",
+        method,
+        framing,
+        direction,
+        size,
+        (unsigned long long)frames,
+        (double)frames / elapsed,
+        (double)frames * size / elapsed / 1000000.0,
+        elapsed * 1000000000.0 / std::max<uint64_t>(1, frames),
+        (unsigned long long)errors);
+    fflush(stdout);
+}
+
+static constexpr int BENCHMARK_ROUND = 256;
+
+// The client seals and the server opens, so every frame carries the sequence the opening side expects next. Frames are sealed and
+// opened in rounds, a frame can only be opened after it has been sealed.
+static bool RunAEAD(const ppp::string& method, int size, int seconds) noexcept {
+    AEAD client(method, BENCHMARK_KEY, false);
+    AEAD server(method, BENCHMARK_KEY, true);
+    if (!client.IsVaild() || !server.IsVaild()) {
+        fprintf(stderr, "Unable to set up %s\n", method.data());
+        return false;
+    }
+
+    static const Byte header[3] = { 0x5a, 0x5a, 0x5a };
+    int sealed_size = size + AEAD::OVERHEAD_SIZE;
+    std::vector<Byte> payload(size, 'x');
+    std::vector<Byte> sealed((std::size_t)BENCHMARK_ROUND * sealed_size);
+    std::vector<Byte> opened(size);
+
+    uint64_t frames = 0;
+    uint64_t errors = 0;
+    double seal_seconds = 0;
+    double open_seconds = 0;
+    Clock::time_point deadline = Clock::now() + std::chrono::seconds(seconds);
+    do {
+        Clock::time_point started = Clock::now();
+        for (int i = 0; i < BENCHMARK_ROUND; i++) {
+            errors += client.Seal(header, sizeof(header), payload.data(), size, sealed.data() + (std::size_t)i * sealed_size) ? 0 : 1;
+        }
+        seal_seconds += ElapsedSeconds(started);
+
+        started = Clock::now();
+        for (int i = 0; i < BENCHMARK_ROUND; i++) {
+            errors += server.Open(header, sizeof(header), sealed.data() + (std::size_t)i * sealed_size, sealed_size, opened.data()) ? 0 : 1;
+        }
+        open_seconds += ElapsedSeconds(started);
+        frames += BENCHMARK_ROUND;
+    } while (Clock::now() < deadline);
+
+    errors += memcmp(opened.data(), payload.data(), size) != 0 ? 1 : 0;
+    PrintResult(method.data(), "aead", "seal", frames, size, seal_seconds, errors);
+    PrintResult(method.data(), "aead", "open", frames, size, open_seconds, errors);
+    return errors == 0;
+}
+
+static bool RunCiphertext(const ppp::string& method, int size, int seconds) noexcept {
+    Ciphertext encryptor(method, BENCHMARK_KEY);
+    Ciphertext decryptor(method, BENCHMARK_KEY);
+
+    std::shared_ptr<ppp::threading::BufferswapAllocator> allocator;
+    std::vector<Byte> payload(size, 'x');
+    std::vector<std::shared_ptr<Byte>> encrypted(BENCHMARK_ROUND);
+    std::vector<std::shared_ptr<Byte>> decrypted(BENCHMARK_ROUND);
+
+    uint64_t frames = 0;
+    uint64_t errors = 0;
+    double encrypt_seconds = 0;
+    double decrypt_seconds = 0;
+    Clock::time_point deadline = Clock::now() + std::chrono::seconds(seconds);
+    do {
+        Clock::time_point started = Clock::now();
+        for (int i = 0; i < BENCHMARK_ROUND; i++) {
+            int outlen = 0;
+            encrypted[i] = encryptor.Encrypt(allocator, payload.data(), size, outlen);
+            errors += NULL != encrypted[i] && outlen == size ? 0 : 1;
+        }
+        encrypt_seconds += ElapsedSeconds(started);
+
+        started = Clock::now();
+        for (int i = 0; i < BENCHMARK_ROUND; i++) {
+            int outlen = 0;
+            decrypted[i] = NULL != encrypted[i] ? decryptor.Decrypt(allocator, encrypted[i].get(), size, outlen) : NULL;
+            errors += NULL != decrypted[i] && outlen == size ? 0 : 1;
+        }
+        decrypt_seconds += ElapsedSeconds(started);
+        frames += BENCHMARK_ROUND;
+    } while (Clock::now() < deadline);
+
+    errors += NULL == decrypted[0] || memcmp(decrypted[0].get(), payload.data(), size) != 0 ? 1 : 0;
+    PrintResult(method.data(), "stream", "seal", frames, size, encrypt_seconds, errors);
+    PrintResult(method.data(), "stream", "open", frames, size, decrypt_seconds, errors);
+    return errors == 0;
+}
+
+int main(int argc, const char* argv[]) {
+    int seconds = 2;
+    int size = 1400;
+    ppp::string methods = "aes-128-cfb,aes-256-cfb,aes-128-gcm,aes-256-gcm,chacha20-poly1305";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--seconds") == 0) {
+            seconds = std::max<int>(1, atoi(argv[i + 1]));
+        }
+        else if (strcmp(argv[i], "--size") == 0) {
+            size = std::max<int>(1, atoi(argv[i + 1]));
+        }
+        else if (strcmp(argv[i], "--methods") == 0) {
+            methods = argv[i + 1];
+        }
+        else {
+            fprintf(stderr, "Usage: %s [--seconds 2] [--size 1400] [--methods aes-128-cfb,aes-256-gcm,...]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    bool ok = true;
+    for (std::size_t position = 0; position <= methods.size();) {
+        std::size_t comma = methods.find(',', position);
+        if (comma == ppp::string::npos) {
+            comma = methods.size();
+        }
+
+        ppp::string method = methods.substr(position, comma - position);
+        position = comma + 1;
+        if (method.empty()) {
+            continue;
+        }
+
+        if (AEAD::Support(method)) {
+            ok &= RunAEAD(method, size, seconds);
+        }
+        elif(Ciphertext::Support(method)) {
+            ok &= RunCiphertext(method, size, seconds);
+        }
+        else {
+            fprintf(stderr, "Unsupported method: %s\n", method.data());
+            ok = false;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+// Measures ip_standard_chksum against the byte-at-a-time loop it replaced over the buffer sizes the tunnel checksums most.
+//
+// Usage: checksum_bench [--seconds 1] [--sizes 20,64,576,1500,9000]
+//
+// Both run over the same buffer at an odd address, the way an IP header often lies behind a frame header. Every result is printed
+// as one key=value line with nanoseconds per call and GB/s, the vector line also carries its speedup over the scalar line of the
+// same size. Which vector width is measured depends on the flags of the build (SSE2 on every x86-64 build, AVX2 with -mavx2).
+
+#include <ppp/stdafx.h>
+#include <ppp/net/native/checksum.h>
+
+#include <chrono>
+
+using ppp::Byte;
+
+typedef std::chrono::steady_clock                                       Clock;
+
+static double ElapsedSeconds(Clock::time_point started) noexcept {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started).count() / 1000000000.0;
+}
+
+// The loop ip_standard_chksum used before it was vectorized.
+static unsigned short ScalarChecksum(const void* dataptr, int len) noexcept {
+    unsigned int acc = 0;
+    unsigned short src;
+    const unsigned char* octetptr = (const unsigned char*)dataptr;
+    while (len > 1) {
+        src = (unsigned short)((*octetptr) << 8);
+        octetptr++;
+        src |= (*octetptr);
+        octetptr++;
+        acc += src;
+        len -= 2;
+    }
+
+    if (len > 0) {
+        src = (unsigned short)((*octetptr) << 8);
+        acc += src;
+    }
+
+    acc = (unsigned int)((acc >> 16) + (acc & 0x0000ffffUL));
+    if ((acc & 0xffff0000UL) != 0) {
+        acc = (unsigned int)((acc >> 16) + (acc & 0x0000ffffUL));
+    }
+
+    return ntohs((unsigned short)acc);
+}
+
+// Returns the calls per second of the run, the sink keeps the compiler from dropping the sums.
+static double RunChecksum(int size, int seconds, bool vector, double baseline) noexcept {
+    std::vector<Byte> buffer(size + 1);
+    for (std::size_t i = 0; i < buffer.size(); i++) {
+        buffer[i] = (Byte)(i * 31 + 7);
+    }
+
+    Byte* p = buffer.data() + 1;
+    uint64_t calls = 0;
+    uint64_t sink = 0;
+    Clock::time_point started = Clock::now();
+    Clock::time_point deadline = started + std::chrono::seconds(seconds);
+    do {
+        for (int i = 0; i < 1024; i++) {
+            p[0] = (Byte)i;
+            sink += vector ? ppp::net::native::ip_standard_chksum(p, size) : ScalarChecksum(p, size);
+        }
+
+        calls += 1024;
+    } while (Clock::now() < deadline);
+
+    double elapsed = ElapsedSeconds(started);
+    double cps = (double)calls / elapsed;
+    printf("mode=%s size=%d calls=%llu ns_per_call=%.1f gbps=%.2f",
+        vector ? "vector" : "scalar",
+        size,
+        (unsigned long long)calls,
+        elapsed * 1000000000.0 / std::max<uint64_t>(1, calls),
+        cps * size / 1000000000.0);
+
+    if (baseline > 0) {
+        printf(" speedup=%.2f", cps / baseline);
+    }
+
+    printf(" sink=%llu\n", (unsigned long long)(sink & 0xff));
+    fflush(stdout);
+    return cps;
+}
+
+int main(int argc, const char* argv[]) {
+    int seconds = 1;
+    ppp::string sizes = "20,64,576,1500,9000";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--seconds") == 0) {
+            seconds = std::max<int>(1, atoi(argv[i + 1]));
+        }
+        elif(strcmp(argv[i], "--sizes") == 0) {
+            sizes = argv[i + 1];
+        }
+        else {
+            fprintf(stderr, "Usage: %s [--seconds 1] [--sizes 20,64,576,1500,9000]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    for (std::size_t position = 0; position < sizes.size();) {
+        std::size_t comma = sizes.find(',', position);
+        if (comma == ppp::string::npos) {
+            comma = sizes.size();
+        }
+
+        int size = std::max<int>(1, atoi(sizes.substr(position, comma - position).data()));
+        double scalar = RunChecksum(size, seconds, false, 0);
+        RunChecksum(size, seconds, true, scalar);
+        position = comma + 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,182 @@
+// Compares encrypting the frames of one drained write queue with a Ciphertext batch against encrypting them one call at a time.
+//
+// Usage: ciphertext_batch_bench [--seconds 2] [--size 1400] [--methods aes-128-cfb,aes-256-cfb] [--batches 1,4,16,64]
+//
+// Both ways produce the same ciphertext for every message, the batch only takes the lock and expands the key schedule once and then
+// rewinds the IV per message. Every result is printed as one key=value line with messages per second, MB/s and nanoseconds per
+// message, and the batch line also carries its speedup over the single calls for the same method and batch size.
+
+#include <ppp/stdafx.h>
+#include <ppp/cryptography/Ciphertext.h>
+#include <ppp/threading/BufferswapAllocator.h>
+
+#include <chrono>
+
+using ppp::Byte;
+using ppp::cryptography::Ciphertext;
+
+typedef std::chrono::steady_clock                                       Clock;
+typedef Ciphertext::BatchMessage                                        BatchMessage;
+
+static constexpr const char* BENCHMARK_KEY = "HWFweXu2g5RVMEpy";
+
+static double ElapsedSeconds(Clock::time_point started) noexcept {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started).count() / 1000000000.0;
+}
+
+static void PrintResult(const ppp::string& method, const char* mode, int batch, int size, uint64_t messages, double elapsed, uint64_t errors, double speedup) noexcept {
+    printf("method=%s mode=%s batch=%d size=%d messages=%llu mps=%.0f mbps=%.1f ns_per_message=%.1f errors=%llu",
+        method.data(),
+        mode,
+        batch,
+        size,
+        (unsigned long long)messages,
+        (double)messages / elapsed,
+        (double)messages * size / elapsed / 1000000.0,
+        elapsed * 1000000000.0 / std::max<uint64_t>(1, messages),
+        (unsigned long long)errors);
+
+    if (speedup > 0) {
+        printf(" speedup=%.2f", speedup);
+    }
+
+    printf("\n");
+    fflush(stdout);
+}
+
+// Returns the messages per second of the run, the batch and the single calls encrypt the same payloads.
+static double RunBatch(const ppp::string& method, int batch, int size, int seconds, bool batched, double baseline) noexcept {
+    Ciphertext ciphertext(method, BENCHMARK_KEY);
+    std::shared_ptr<ppp::threading::BufferswapAllocator> allocator;
+
+    std::vector<Byte> payloads((std::size_t)batch * size);
+    for (std::size_t i = 0; i < payloads.size(); i++) {
+        payloads[i] = (Byte)(i * 31 + 7);
+    }
+
+    std::vector<BatchMessage> messages(batch);
+    uint64_t count = 0;
+    uint64_t errors = 0;
+    Clock::time_point started = Clock::now();
+    Clock::time_point deadline = started + std::chrono::seconds(seconds);
+    do {
+        for (int i = 0; i < batch; i++) {
+            BatchMessage& message = messages[i];
+            message.data = payloads.data() + (std::size_t)i * size;
+            message.datalen = size;
+        }
+
+        if (batched) {
+            errors += ciphertext.Encrypt(allocator, messages.data(), batch) ? 0 : 1;
+        }
+        else {
+            for (int i = 0; i < batch; i++) {
+                BatchMessage& message = messages[i];
+                message.output = ciphertext.Encrypt(allocator, message.data, message.datalen, message.outlen);
+                errors += NULL != message.output ? 0 : 1;
+            }
+        }
+
+        count += batch;
+    } while (Clock::now() < deadline);
+
+    double elapsed = ElapsedSeconds(started);
+    double mps = (double)count / elapsed;
+    PrintResult(method, batched ? "batch" : "single", batch, size, count, elapsed, errors, baseline > 0 ? mps / baseline : 0);
+    return errors > 0 ? -1 : mps;
+}
+
+// Both ways have to agree byte for byte, otherwise the timings compare different work.
+static bool VerifyBatch(const ppp::string& method, int batch, int size) noexcept {
+    Ciphertext batched(method, BENCHMARK_KEY);
+    Ciphertext single(method, BENCHMARK_KEY);
+    std::shared_ptr<ppp::threading::BufferswapAllocator> allocator;
+
+    std::vector<Byte> payloads((std::size_t)batch * size, 0x3c);
+    std::vector<BatchMessage> messages(batch);
+    for (int i = 0; i < batch; i++) {
+        messages[i].data = payloads.data() + (std::size_t)i * size;
+        messages[i].datalen = size;
+    }
+
+    if (!batched.Encrypt(allocator, messages.data(), batch)) {
+        return false;
+    }
+
+    for (int i = 0; i < batch; i++) {
+        int outlen = 0;
+        std::shared_ptr<Byte> output = single.Encrypt(allocator, messages[i].data, messages[i].datalen, outlen);
+        if (NULL == output || outlen != messages[i].outlen || memcmp(output.get(), messages[i].output.get(), outlen) != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static std::vector<ppp::string> Split(const ppp::string& s) noexcept {
+    std::vector<ppp::string> items;
+    for (std::size_t position = 0; position <= s.size();) {
+        std::size_t comma = s.find(',', position);
+        if (comma == ppp::string::npos) {
+            comma = s.size();
+        }
+
+        if (comma > position) {
+            items.emplace_back(s.substr(position, comma - position));
+        }
+
+        position = comma + 1;
+    }
+
+    return items;
+}
+
+int main(int argc, const char* argv[]) {
+    int seconds = 2;
+    int size = 1400;
+    ppp::string methods = "aes-128-cfb,aes-256-cfb";
+    ppp::string batches = "1,4,16,64";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--seconds") == 0) {
+            seconds = std::max<int>(1, atoi(argv[i + 1]));
+        }
+        else if (strcmp(argv[i], "--size") == 0) {
+            size = std::max<int>(1, atoi(argv[i + 1]));
+        }
+        else if (strcmp(argv[i], "--methods") == 0) {
+            methods = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--batches") == 0) {
+            batches = argv[i + 1];
+        }
+        else {
+            fprintf(stderr, "Usage: %s [--seconds 2] [--size 1400] [--methods aes-128-cfb,aes-256-cfb] [--batches 1,4,16,64]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    bool ok = true;
+    for (const ppp::string& method : Split(methods)) {
+        if (!Ciphertext::Support(method)) {
+            fprintf(stderr, "Unsupported method: %s\n", method.data());
+            ok = false;
+            continue;
+        }
+
+        for (const ppp::string& item : Split(batches)) {
+            int batch = std::max<int>(1, atoi(item.data()));
+            if (!VerifyBatch(method, batch, size)) {
+                fprintf(stderr, "Batch and single encryption differ: method=%s batch=%d\n", method.data(), batch);
+                ok = false;
+                continue;
+            }
+
+            double single = RunBatch(method, batch, size, seconds, false, 0);
+            double batched = RunBatch(method, batch, size, seconds, true, single);
+            ok &= single > 0 && batched > 0;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,306 @@
+// Measures requests per second and added latency of the local HTTP proxy against an in-process origin server.
+//
+// Usage: http_proxy_bench [--proxy host:port] [--connections 16] [--seconds 5] [--size 1024]
+//
+// The origin listens on an ephemeral loopback port and answers every request with a body of --size bytes, keeping the connection
+// open unless the request asks for "Connection: close". The same workload runs once directly against the origin and once through
+// the proxy given with --proxy (a running ppp client with its http-proxy enabled), every result is printed as one key=value line.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include <boost/asio.hpp>
+
+using boost::asio::ip::tcp;
+
+typedef std::chrono::steady_clock                                       Clock;
+
+struct BenchmarkResult {
+    uint64_t                                                            requests    = 0;
+    uint64_t                                                            connections = 0;
+    uint64_t                                                            errors      = 0;
+    std::vector<uint32_t>                                               latencies; // microseconds
+};
+
+static int Strncasecmp(const char* s1, const char* s2, std::size_t n) noexcept {
+    for (std::size_t i = 0; i < n; i++) {
+        int c1 = tolower((unsigned char)s1[i]);
+        int c2 = tolower((unsigned char)s2[i]);
+        if (c1 != c2 || c1 == 0) {
+            return c1 - c2;
+        }
+    }
+    return 0;
+}
+
+// Returns the value of a header in a head that ends with "\r\n\r\n", or an empty string.
+static std::string FindHeader(const std::string& head, const char* key) noexcept {
+    std::size_t key_size = strlen(key);
+    for (std::size_t line = head.find("\r\n"); line != std::string::npos && line + 2 < head.size(); line = head.find("\r\n", line + 2)) {
+        const char* s = head.data() + line + 2;
+        if (head.size() - line - 2 > key_size && Strncasecmp(s, key, key_size) == 0 && s[key_size] == ':') {
+            std::size_t value = line + 2 + key_size + 1;
+            std::size_t value_end = head.find("\r\n", value);
+            while (value < value_end && head[value] == ' ') {
+                value++;
+            }
+            return head.substr(value, value_end - value);
+        }
+    }
+    return std::string();
+}
+
+// Reads one head into head and the bytes already received behind it into rest, returns false on EOF or error.
+static bool ReadHead(tcp::socket& socket, std::string& head, std::string& rest) noexcept {
+    head.swap(rest);
+    rest.clear();
+
+    char buffer[16384];
+    for (;;) {
+        std::size_t position = head.find("\r\n\r\n");
+        if (position != std::string::npos) {
+            rest.assign(head, position + 4, std::string::npos);
+            head.resize(position + 4);
+            return true;
+        }
+
+        if (head.size() > 65536) {
+            return false;
+        }
+
+        boost::system::error_code ec;
+        std::size_t bytes_transferred = socket.read_some(boost::asio::buffer(buffer), ec);
+        if (ec || bytes_transferred < 1) {
+            return false;
+        }
+
+        head.append(buffer, bytes_transferred);
+    }
+}
+
+static bool ReadBody(tcp::socket& socket, std::string& rest, std::size_t length) noexcept {
+    char buffer[16384];
+    while (rest.size() < length) {
+        boost::system::error_code ec;
+        std::size_t bytes_transferred = socket.read_some(boost::asio::buffer(buffer), ec);
+        if (ec || bytes_transferred < 1) {
+            return false;
+        }
+
+        rest.append(buffer, bytes_transferred);
+    }
+
+    rest.erase(0, length);
+    return true;
+}
+
+static void OriginConnection(tcp::socket socket, const std::string& body) noexcept {
+    std::string head;
+    std::string rest;
+    boost::system::error_code ec;
+    socket.set_option(tcp::no_delay(true), ec);
+
+    while (ReadHead(socket, head, rest)) {
+        std::string content_length = FindHeader(head, "Content-Length");
+        if (!content_length.empty() && !ReadBody(socket, rest, strtoul(content_length.data(), NULL, 10))) {
+            break;
+        }
+
+        bool close = Strncasecmp(FindHeader(head, "Connection").data(), "close", 6) == 0 || head.find(" HTTP/1.0\r\n") != std::string::npos;
+        std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\nContent-Length: " + std::to_string(body.size()) +
+            (close ? "\r\nConnection: close\r\n\r\n" : "\r\n\r\n") + body;
+
+        boost::asio::write(socket, boost::asio::buffer(response), ec);
+        if (ec || close) {
+            break;
+        }
+    }
+
+    socket.shutdown(tcp::socket::shutdown_send, ec);
+    socket.close(ec);
+}
+
+static bool ParseEndPoint(const char* s, tcp::endpoint& ep) noexcept {
+    const char* colon = strrchr(s, ':');
+    if (NULL == colon) {
+        return false;
+    }
+
+    boost::system::error_code ec;
+    std::string host(s, colon - s);
+    if (host.size() > 1 && host.front() == '[' && host.back() == ']') {
+        host = host.substr(1, host.size() - 2);
+    }
+
+    boost::asio::ip::address address = boost::asio::ip::make_address(host, ec);
+    int port = atoi(colon + 1);
+    if (ec || port < 1 || port > 65535) {
+        return false;
+    }
+
+    ep = tcp::endpoint(address, port);
+    return true;
+}
+
+// Each worker keeps one connection busy with back-to-back requests and reconnects whenever the response closes it.
+static void RunWorker(const tcp::endpoint& target, const std::string& request, Clock::time_point deadline, BenchmarkResult& result) noexcept {
+    boost::asio::io_context context;
+    std::string head;
+    std::string rest;
+
+    while (Clock::now() < deadline) {
+        tcp::socket socket(context);
+        boost::system::error_code ec;
+        socket.connect(target, ec);
+        if (ec) {
+            result.errors++;
+            continue;
+        }
+
+        result.connections++;
+        socket.set_option(tcp::no_delay(true), ec);
+        rest.clear();
+
+        while (Clock::now() < deadline) {
+            Clock::time_point started = Clock::now();
+            boost::asio::write(socket, boost::asio::buffer(request), ec);
+            if (ec || !ReadHead(socket, head, rest) || head.size() < 12 || head.compare(9, 3, "200") != 0) {
+                result.errors++;
+                break;
+            }
+
+            if (!ReadBody(socket, rest, strtoul(FindHeader(head, "Content-Length").data(), NULL, 10))) {
+                result.errors++;
+                break;
+            }
+
+            result.requests++;
+            result.latencies.emplace_back((uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - started).count());
+            if (Strncasecmp(FindHeader(head, "Connection").data(), "close", 6) == 0) {
+                break;
+            }
+        }
+
+        socket.close(ec);
+    }
+}
+
+static BenchmarkResult RunBenchmark(const tcp::endpoint& target, const std::string& request, int connections, int seconds) noexcept {
+    std::vector<BenchmarkResult> results(connections);
+    std::vector<std::thread> workers;
+    Clock::time_point deadline = Clock::now() + std::chrono::seconds(seconds);
+    for (int i = 0; i < connections; i++) {
+        workers.emplace_back(RunWorker, target, std::cref(request), deadline, std::ref(results[i]));
+    }
+
+    BenchmarkResult result;
+    for (int i = 0; i < connections; i++) {
+        workers[i].join();
+        result.requests += results[i].requests;
+        result.connections += results[i].connections;
+        result.errors += results[i].errors;
+        result.latencies.insert(result.latencies.end(), results[i].latencies.begin(), results[i].latencies.end());
+    }
+
+    std::sort(result.latencies.begin(), result.latencies.end());
+    return result;
+}
+
+static uint32_t Percentile(const BenchmarkResult& result, double p) noexcept {
+    if (result.latencies.empty()) {
+        return 0;
+    }
+
+    std::size_t index = (std::size_t)(p * (result.latencies.size() - 1));
+    return result.latencies[index];
+}
+
+static void PrintResult(const char* mode, const BenchmarkResult& result, int seconds, const BenchmarkResult* baseline) noexcept {
+    printf("mode=%s requests=%llu connections=%llu errors=%llu rps=%.0f p50_us=%u p90_us=%u p99_us=%u",
+        mode,
+        (unsigned long long)result.requests,
+        (unsigned long long)result.connections,
+        (unsigned long long)result.errors,
+        (double)result.requests / seconds,
+        Percentile(result, 0.50),
+        Percentile(result, 0.90),
+        Percentile(result, 0.99));
+
+    if (NULL != baseline) {
+        printf(" added_p50_us=%d added_p99_us=%d",
+            (int)Percentile(result, 0.50) - (int)Percentile(*baseline, 0.50),
+            (int)Percentile(result, 0.99) - (int)Percentile(*baseline, 0.99));
+    }
+
+    printf("\n");
+    fflush(stdout);
+}
+
+int main(int argc, const char* argv[]) {
+    const char* proxy = NULL;
+    int connections = 16;
+    int seconds = 5;
+    int size = 1024;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--proxy") == 0) {
+            proxy = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--connections") == 0) {
+            connections = std::max<int>(1, atoi(argv[i + 1]));
+        }
+        else if (strcmp(argv[i], "--seconds") == 0) {
+            seconds = std::max<int>(1, atoi(argv[i + 1]));
+        }
+        else if (strcmp(argv[i], "--size") == 0) {
+            size = std::max<int>(0, atoi(argv[i + 1]));
+        }
+        else {
+            fprintf(stderr, "Usage: %s [--proxy host:port] [--connections 16] [--seconds 5] [--size 1024]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    tcp::endpoint proxyEP;
+    if (NULL != proxy && !ParseEndPoint(proxy, proxyEP)) {
+        fprintf(stderr, "Invalid proxy endpoint: %s\n", proxy);
+        return 1;
+    }
+
+    boost::asio::io_context context;
+    tcp::acceptor acceptor(context, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    tcp::endpoint originEP = acceptor.local_endpoint();
+
+    std::string body(size, 'x');
+    std::thread([&acceptor, &context, &body]() noexcept {
+        for (;;) {
+            boost::system::error_code ec;
+            tcp::socket socket(context);
+            acceptor.accept(socket, ec);
+            if (ec) {
+                break;
+            }
+
+            std::thread(OriginConnection, std::move(socket), std::cref(body)).detach();
+        }
+    }).detach();
+
+    std::string authority = originEP.address().to_string() + ":" + std::to_string(originEP.port());
+    BenchmarkResult direct = RunBenchmark(originEP, "GET /bench HTTP/1.1\r\nHost: " + authority + "\r\n\r\n", connections, seconds);
+    PrintResult("direct", direct, seconds, NULL);
+
+    if (NULL != proxy) {
+        BenchmarkResult proxied = RunBenchmark(proxyEP,
+            "GET http://" + authority + "/bench HTTP/1.1\r\nHost: " + authority + "\r\nProxy-Connection: keep-alive\r\n\r\n", connections, seconds);
+        PrintResult("proxy", proxied, seconds, &direct);
+    }
+
+    return 0;
+}
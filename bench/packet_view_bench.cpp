@@ -0,0 +1,271 @@
+// Compares reading and rewriting datagrams in place with PacketView against the IPFrame and UdpFrame parse and serialize path.
+//
+// Usage: packet_view_bench [--seconds 2] [--size 512]
+//
+// udp_parse reads the ports and the payload of a UDP datagram, udp_rewrite replaces the source address and port the way a NAT
+// does, and icmp_ttl decrements the TTL of an ICMP echo before it is forwarded. view does the work on the packet buffer with the
+// incremental checksum updates of RFC 1624, frame parses the packet into an IPFrame (and UdpFrame) and, for the rewrites, builds
+// a new packet with ToArray. Every result is printed as one key=value line with packets per second and nanoseconds per packet,
+// the view line also carries its speedup over the frame line of the same workload.
+
+#include <ppp/stdafx.h>
+#include <ppp/net/IPEndPoint.h>
+#include <ppp/net/native/checksum.h>
+#include <ppp/net/packet/IPFrame.h>
+#include <ppp/net/packet/UdpFrame.h>
+#include <ppp/net/packet/PacketView.h>
+#include <ppp/threading/BufferswapAllocator.h>
+
+#include <chrono>
+
+using ppp::Byte;
+using ppp::net::IPEndPoint;
+using ppp::net::packet::BufferSegment;
+using ppp::net::packet::IPFrame;
+using ppp::net::packet::UdpFrame;
+using ppp::net::packet::PacketView;
+using ppp::net::native::ip_hdr;
+
+typedef std::chrono::steady_clock                                       Clock;
+typedef std::vector<Byte>                                               Datagram;
+
+static constexpr int                                                    BENCHMARK_DATAGRAMS = 256;
+static constexpr int                                                    ICMP_ECHO_SIZE      = 64;
+
+static double ElapsedSeconds(Clock::time_point started) noexcept {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started).count() / 1000000000.0;
+}
+
+static bool ToDatagram(const std::shared_ptr<BufferSegment>& packet, Datagram& datagram) noexcept {
+    if (NULL == packet || NULL == packet->Buffer || packet->Length < 1) {
+        return false;
+    }
+
+    Byte* p = packet->Buffer.get();
+    datagram.assign(p, p + packet->Length);
+    return true;
+}
+
+static bool NewUdpDatagrams(int size, std::vector<Datagram>& datagrams) noexcept {
+    std::shared_ptr<ppp::threading::BufferswapAllocator> allocator;
+    for (int i = 0; i < BENCHMARK_DATAGRAMS; i++) {
+        std::shared_ptr<Byte> payload = ppp::make_shared_alloc<Byte>(size);
+        if (NULL == payload) {
+            return false;
+        }
+
+        for (int j = 0; j < size; j++) {
+            payload.get()[j] = (Byte)(i + j * 7);
+        }
+
+        UdpFrame frame;
+        frame.Source = IPEndPoint(htonl(0x0a000001 + i), 53000 + i);
+        frame.Destination = IPEndPoint(htonl(0x08080808), 53);
+        frame.Payload = ppp::make_shared_object<BufferSegment>(payload, size);
+
+        std::shared_ptr<IPFrame> ip = frame.ToIp(allocator);
+        Datagram datagram;
+        if (NULL == ip || !ToDatagram(ip->ToArray(allocator), datagram)) {
+            return false;
+        }
+
+        datagrams.emplace_back(std::move(datagram));
+    }
+
+    return true;
+}
+
+static bool NewIcmpDatagrams(std::vector<Datagram>& datagrams) noexcept {
+    std::shared_ptr<ppp::threading::BufferswapAllocator> allocator;
+    for (int i = 0; i < BENCHMARK_DATAGRAMS; i++) {
+        std::shared_ptr<Byte> payload = ppp::make_shared_alloc<Byte>(ICMP_ECHO_SIZE);
+        if (NULL == payload) {
+            return false;
+        }
+
+        Byte* echo = payload.get();
+        memset(echo, (Byte)i, ICMP_ECHO_SIZE);
+        echo[0] = 8; /* echo request */
+        echo[1] = 0;
+        echo[2] = 0;
+        echo[3] = 0;
+
+        unsigned short chksum = ppp::net::native::inet_chksum(echo, ICMP_ECHO_SIZE);
+        memcpy(echo + 2, &chksum, sizeof(chksum));
+
+        IPFrame frame;
+        frame.ProtocolType = ip_hdr::IP_PROTO_ICMP;
+        frame.Source = htonl(0x0a000001 + i);
+        frame.Destination = htonl(0x08080808);
+        frame.Ttl = 64;
+        frame.Payload = ppp::make_shared_object<BufferSegment>(payload, ICMP_ECHO_SIZE);
+
+        Datagram datagram;
+        if (!ToDatagram(frame.ToArray(allocator), datagram)) {
+            return false;
+        }
+
+        datagrams.emplace_back(std::move(datagram));
+    }
+
+    return true;
+}
+
+// Does the work of the workload on one datagram, returns false when the datagram did not parse.
+static bool RunOne(const char* workload, bool view, Datagram& datagram, uint64_t& sink) noexcept {
+    static std::shared_ptr<ppp::threading::BufferswapAllocator> allocator;
+
+    Byte* p = datagram.data();
+    int length = (int)datagram.size();
+    if (strcmp(workload, "udp_parse") == 0) {
+        if (view) {
+            PacketView packet(p, length);
+            if (!packet.IsValid() || NULL == packet.GetUdpHeader()) {
+                return false;
+            }
+
+            sink += packet.GetSourcePort() + packet.GetUdpPayloadLength() + packet.GetUdpPayload()[0];
+        }
+        else {
+            std::shared_ptr<IPFrame> ip = IPFrame::Parse(allocator, p, length);
+            std::shared_ptr<UdpFrame> udp = UdpFrame::Parse(ip.get());
+            if (NULL == udp) {
+                return false;
+            }
+
+            sink += udp->Source.Port + udp->Payload->Length + udp->Payload->Buffer.get()[0];
+        }
+    }
+    elif(strcmp(workload, "udp_rewrite") == 0) {
+        uint32_t address = htonl(0xc0a80001 + (uint32_t)(sink & 0xff));
+        int port = 10000 + (int)(sink & 0x3fff);
+        if (view) {
+            PacketView packet(p, length);
+            if (!packet.IsValid() || NULL == packet.GetUdpHeader()) {
+                return false;
+            }
+
+            packet.SetSource(address);
+            packet.SetSourcePort(port);
+            sink += packet.GetIPHeader()->chksum;
+        }
+        else {
+            std::shared_ptr<IPFrame> ip = IPFrame::Parse(allocator, p, length);
+            std::shared_ptr<UdpFrame> udp = UdpFrame::Parse(ip.get());
+            if (NULL == udp) {
+                return false;
+            }
+
+            udp->Source = IPEndPoint(address, port);
+            ip = udp->ToIp(allocator);
+
+            std::shared_ptr<BufferSegment> packet = NULL != ip ? ip->ToArray(allocator) : NULL;
+            if (NULL == packet) {
+                return false;
+            }
+
+            sink += packet->Length;
+        }
+    }
+    else {
+        // Flip between two TTLs so the datagrams never expire however long the run takes.
+        if (view) {
+            PacketView packet(p, length);
+            if (!packet.IsValid()) {
+                return false;
+            }
+
+            int ttl = packet.GetTtl();
+            packet.SetTtl(ttl > 32 ? ttl - 1 : 64);
+            sink += packet.GetIPHeader()->chksum;
+        }
+        else {
+            std::shared_ptr<IPFrame> ip = IPFrame::Parse(allocator, p, length);
+            if (NULL == ip) {
+                return false;
+            }
+
+            ip->Ttl = ip->Ttl > 32 ? ip->Ttl - 1 : 64;
+
+            std::shared_ptr<BufferSegment> packet = ip->ToArray(allocator);
+            if (NULL == packet) {
+                return false;
+            }
+
+            sink += packet->Length;
+        }
+    }
+
+    return true;
+}
+
+// Returns the packets per second of the run, or -1 if a datagram did not parse.
+static double RunWorkload(const char* workload, bool view, std::vector<Datagram> datagrams, int seconds, double baseline) noexcept {
+    uint64_t count = 0;
+    uint64_t errors = 0;
+    uint64_t sink = 0;
+    Clock::time_point started = Clock::now();
+    Clock::time_point deadline = started + std::chrono::seconds(seconds);
+    do {
+        for (Datagram& datagram : datagrams) {
+            errors += RunOne(workload, view, datagram, sink) ? 0 : 1;
+        }
+
+        count += datagrams.size();
+    } while (Clock::now() < deadline);
+
+    double elapsed = ElapsedSeconds(started);
+    double pps = (double)count / elapsed;
+    printf("workload=%s mode=%s packets=%llu pps=%.0f ns_per_packet=%.1f errors=%llu",
+        workload,
+        view ? "view" : "frame",
+        (unsigned long long)count,
+        pps,
+        elapsed * 1000000000.0 / std::max<uint64_t>(1, count),
+        (unsigned long long)errors);
+
+    if (baseline > 0) {
+        printf(" speedup=%.2f", pps / baseline);
+    }
+
+    printf(" sink=%llu\n", (unsigned long long)(sink & 0xff));
+    fflush(stdout);
+    return errors > 0 ? -1 : pps;
+}
+
+int main(int argc, const char* argv[]) {
+    int seconds = 2;
+    int size = 512;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--seconds") == 0) {
+            seconds = std::max<int>(1, atoi(argv[i + 1]));
+        }
+        elif(strcmp(argv[i], "--size") == 0) {
+            size = std::max<int>(1, std::min<int>(1400, atoi(argv[i + 1])));
+        }
+        else {
+            fprintf(stderr, "Usage: %s [--seconds 2] [--size 512]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    ppp::global::cctor();
+
+    std::vector<Datagram> udp;
+    std::vector<Datagram> icmp;
+    if (!NewUdpDatagrams(size, udp) || !NewIcmpDatagrams(icmp)) {
+        fprintf(stderr, "Unable to build the datagrams.\n");
+        return 1;
+    }
+
+    bool ok = true;
+    const char* workloads[] = { "udp_parse", "udp_rewrite", "icmp_ttl" };
+    for (const char* workload : workloads) {
+        const std::vector<Datagram>& datagrams = strcmp(workload, "icmp_ttl") == 0 ? icmp : udp;
+        double frame = RunWorkload(workload, false, datagrams, seconds, 0);
+        double view = RunWorkload(workload, true, datagrams, seconds, frame);
+        ok &= frame > 0 && view > 0;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,420 @@
+// Runs a reliable udp carrier through an in-process relay that drops and delays datagrams, and optionally attacks it with forged headers.
+//
+// Usage: reliable_udp_bench [--config appsettings.json] [--seconds 5] [--size 1400] [--window 16] [--loss 0] [--delay 0] [--jitter 0] [--spoof 0|1]
+//
+// The client transmission talks to an IReliableUdpAcceptor over loopback, every datagram in both directions passes a relay that drops
+// it with probability --loss (0..1) and delays it by --delay ms plus up to --jitter ms, so late datagrams overtake earlier ones. The
+// client keeps --window frames of --size bytes in flight and the server echoes every frame, the client checks that the echoes come
+// back complete and in order. --spoof 1 sends forged FIN and ACK headers (una far ahead, window closed) for the conversation to the
+// acceptor from another address every 10 ms while the stream runs. The result is printed as one key=value line with the echoed frames,
+// goodput, the relay counters and whether the stream was still open at the end. The exit code is 1 when an echo was wrong or missing
+// order, or when the stream ended before the run did.
+
+#include <ppp/stdafx.h>
+#include <ppp/configurations/AppConfiguration.h>
+#include <ppp/coroutines/YieldContext.h>
+#include <ppp/auxiliary/StringAuxiliary.h>
+#include <ppp/net/Socket.h>
+#include <ppp/net/IPEndPoint.h>
+#include <ppp/threading/Executors.h>
+#include <ppp/threading/BufferswapAllocator.h>
+#include <ppp/transmissions/IReliableUdpAcceptor.h>
+#include <ppp/transmissions/IReliableUdpTransmission.h>
+
+#include <random>
+
+using ppp::Byte;
+using ppp::net::Socket;
+using ppp::threading::Executors;
+using ppp::transmissions::IReliableUdpAcceptor;
+using ppp::transmissions::IReliableUdpTransmission;
+using boost::asio::ip::udp;
+
+typedef std::chrono::steady_clock                                       Clock;
+typedef ppp::configurations::AppConfiguration                           AppConfiguration;
+typedef std::shared_ptr<AppConfiguration>                               AppConfigurationPtr;
+typedef std::shared_ptr<boost::asio::io_context>                        ContextPtr;
+typedef ppp::coroutines::YieldContext                                   YieldContext;
+typedef std::shared_ptr<udp::socket>                                    DatagramSocketPtr;
+
+#pragma pack(push, 1)
+// The wire header of the carrier, the forged datagrams are built from it.
+struct ReliableUdpHeader {
+    uint32_t                                                            conv;
+    uint8_t                                                             cmd;
+    uint8_t                                                             reserved;
+    uint16_t                                                            wnd;
+    uint32_t                                                            ts;
+    uint32_t                                                            sn;
+    uint32_t                                                            una;
+    uint16_t                                                            len;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(ReliableUdpHeader) == IReliableUdpTransmission::HEADER_SIZE, "The reliable udp header is 22 bytes.");
+
+struct BenchmarkContext {
+    AppConfigurationPtr                                                 configuration;
+    ContextPtr                                                          context;
+    int                                                                 seconds     = 5;
+    int                                                                 size        = 1400;
+    int                                                                 window      = 16;
+    double                                                              loss        = 0;
+    int                                                                 delay       = 0;
+    int                                                                 jitter      = 0;
+    bool                                                                spoof       = false;
+    std::mt19937                                                        random;
+
+    bool                                                                stop        = false;
+    bool                                                                closed      = false;
+    bool                                                                handshaked  = false;
+    uint64_t                                                            sent        = 0;
+    uint64_t                                                            echoed      = 0;
+    uint64_t                                                            errors      = 0;
+    uint64_t                                                            forwarded   = 0;
+    uint64_t                                                            dropped     = 0;
+    uint64_t                                                            forged      = 0;
+
+    std::shared_ptr<IReliableUdpAcceptor>                               acceptor;
+    std::shared_ptr<IReliableUdpTransmission>                           client;
+    std::vector<std::shared_ptr<IReliableUdpTransmission>>              servers;
+    DatagramSocketPtr                                                   front;      // the relay side the client sends to
+    DatagramSocketPtr                                                   back;       // the relay side the acceptor answers to
+    DatagramSocketPtr                                                   spoofer;
+    udp::endpoint                                                       clientEP;
+    udp::endpoint                                                       serverEP;
+};
+
+static DatagramSocketPtr OpenLoopbackSocket(const ContextPtr& context) noexcept {
+    DatagramSocketPtr socket = ppp::make_shared_object<udp::socket>(*context);
+    if (NULL == socket || !Socket::OpenSocket(*socket, boost::asio::ip::address_v4::loopback(), ppp::net::IPEndPoint::MinPort)) {
+        return NULL;
+    }
+
+    return socket;
+}
+
+// Every datagram is dropped or sent on after its own delay, the delays differ by the jitter, so the path reorders as well.
+static void RelayForward(BenchmarkContext& bench, const DatagramSocketPtr& socket, const udp::endpoint& destinationEP, const Byte* packet, int packet_length) noexcept {
+    std::uniform_real_distribution<double> chance(0, 1);
+    if (bench.loss > 0 && chance(bench.random) < bench.loss) {
+        bench.dropped++;
+        return;
+    }
+
+    bench.forwarded++;
+
+    int delay = bench.delay + (bench.jitter > 0 ? (int)(bench.random() % (uint32_t)(bench.jitter + 1)) : 0);
+    if (delay < 1) {
+        boost::system::error_code ec;
+        socket->send_to(boost::asio::buffer(packet, packet_length), destinationEP, 0, ec);
+        return;
+    }
+
+    std::shared_ptr<ppp::vector<Byte>> datagram = ppp::make_shared_object<ppp::vector<Byte>>(packet, packet + packet_length);
+    std::shared_ptr<boost::asio::steady_timer> timer = ppp::make_shared_object<boost::asio::steady_timer>(*bench.context);
+    timer->expires_after(std::chrono::milliseconds(delay));
+    timer->async_wait(
+        [socket, destinationEP, datagram, timer](const boost::system::error_code& ec) noexcept {
+            if (ec) {
+                return;
+            }
+
+            boost::system::error_code ignored;
+            socket->send_to(boost::asio::buffer(datagram->data(), datagram->size()), destinationEP, 0, ignored);
+        });
+}
+
+static void RelayReceive(BenchmarkContext& bench, const DatagramSocketPtr& socket, bool from_client) noexcept {
+    std::shared_ptr<Byte> buffer = ppp::threading::BufferswapAllocator::MakeByteArray(NULL, PPP_BUFFER_SIZE);
+    std::shared_ptr<udp::endpoint> sourceEP = ppp::make_shared_object<udp::endpoint>();
+    socket->async_receive_from(boost::asio::buffer(buffer.get(), PPP_BUFFER_SIZE), *sourceEP,
+        [&bench, socket, from_client, buffer, sourceEP](const boost::system::error_code& ec, std::size_t sz) noexcept {
+            if (ec == boost::system::errc::operation_canceled || !socket->is_open()) {
+                return;
+            }
+
+            if (ec == boost::system::errc::success && sz > 0) {
+                if (from_client) {
+                    bench.clientEP = *sourceEP;
+                    RelayForward(bench, bench.back, bench.serverEP, buffer.get(), (int)sz);
+                }
+                elif(bench.clientEP.port() != 0) {
+                    RelayForward(bench, bench.front, bench.clientEP, buffer.get(), (int)sz);
+                }
+            }
+
+            RelayReceive(bench, socket, from_client);
+        });
+}
+
+// Forged headers from an address that is not the client: a FIN, and an ACK that claims everything up to far ahead with a closed window.
+static void Spoof(BenchmarkContext& bench) noexcept {
+    if (bench.stop || NULL == bench.client) {
+        return;
+    }
+
+    uint32_t conversation = bench.client->GetConversation();
+    ReliableUdpHeader forged[2];
+    memset(forged, 0, sizeof(forged));
+
+    forged[0].conv = htonl(conversation);
+    forged[0].cmd = 3;
+    forged[1].conv = htonl(conversation);
+    forged[1].cmd = 2;
+    forged[1].sn = htonl(0x7fffffff);
+    forged[1].una = htonl(0x7fffffff);
+
+    boost::system::error_code ec;
+    for (ReliableUdpHeader& h : forged) {
+        bench.spoofer->send_to(boost::asio::buffer(&h, sizeof(h)), bench.serverEP, 0, ec);
+        bench.forged++;
+    }
+
+    std::shared_ptr<boost::asio::steady_timer> timer = ppp::make_shared_object<boost::asio::steady_timer>(*bench.context);
+    timer->expires_after(std::chrono::milliseconds(10));
+    timer->async_wait(
+        [&bench, timer](const boost::system::error_code& ec) noexcept {
+            if (!ec) {
+                Spoof(bench);
+            }
+        });
+}
+
+// The server end echoes every frame it reads until the stream closes.
+static bool ServerAccept(BenchmarkContext& bench, const std::shared_ptr<IReliableUdpTransmission>& transmission) noexcept {
+    bench.servers.emplace_back(transmission);
+    return YieldContext::Spawn(*bench.context,
+        [&bench, transmission](YieldContext& y) noexcept {
+            bool mux = false;
+            if (transmission->HandshakeClient(y, mux) == 0) {
+                bench.closed = true;
+                return;
+            }
+
+            for (;;) {
+                int packet_length = 0;
+                std::shared_ptr<Byte> packet = transmission->Read(y, packet_length);
+                if (NULL == packet || !transmission->Write(y, packet.get(), packet_length)) {
+                    break;
+                }
+            }
+
+            bench.closed |= !bench.stop;
+        });
+}
+
+// Every frame starts with its number, the next write is issued when the previous one completed, so the window stays full.
+static void ClientWrite(BenchmarkContext& bench) noexcept {
+    if (bench.stop || bench.closed) {
+        return;
+    }
+
+    std::shared_ptr<Byte> packet = ppp::threading::BufferswapAllocator::MakeByteArray(NULL, bench.size);
+    memset(packet.get(), (int)(bench.sent & 0xff), bench.size);
+    memcpy(packet.get(), &bench.sent, std::min<int>(bench.size, sizeof(bench.sent)));
+    bench.sent++;
+
+    bool ok = bench.client->Write(packet.get(), bench.size,
+        [&bench, packet](bool ok) noexcept {
+            if (ok) {
+                ClientWrite(bench);
+            }
+        });
+    if (!ok) {
+        bench.closed |= !bench.stop;
+    }
+}
+
+static void ClientRun(BenchmarkContext& bench) noexcept {
+    YieldContext::Spawn(*bench.context,
+        [&bench](YieldContext& y) noexcept {
+            DatagramSocketPtr socket = OpenLoopbackSocket(bench.context);
+            if (NULL == socket) {
+                bench.closed = true;
+                return;
+            }
+
+            boost::system::error_code ec;
+            udp::endpoint relayEP = bench.front->local_endpoint(ec);
+
+            std::shared_ptr<IReliableUdpTransmission> transmission = ppp::make_shared_object<IReliableUdpTransmission>(bench.context,
+                ppp::threading::Executors::StrandPtr(), socket, relayEP, IReliableUdpTransmission::NewConversation(), bench.configuration);
+            bench.client = transmission;
+            if (NULL == transmission || !transmission->Open() ||
+                !transmission->HandshakeServer(y, ppp::auxiliary::StringAuxiliary::GuidStringToInt128(ppp::GuidToString(ppp::GuidGenerate())), true)) {
+                bench.closed = true;
+                return;
+            }
+
+            bench.handshaked = true;
+            if (bench.spoof) {
+                Spoof(bench);
+            }
+
+            for (int i = 0; i < bench.window; i++) {
+                ClientWrite(bench);
+            }
+
+            uint64_t expected = 0;
+            for (;;) {
+                int packet_length = 0;
+                std::shared_ptr<Byte> packet = transmission->Read(y, packet_length);
+                if (NULL == packet) {
+                    break;
+                }
+
+                uint64_t sequence = 0;
+                memcpy(&sequence, packet.get(), std::min<int>(packet_length, sizeof(sequence)));
+                if (packet_length != bench.size || (bench.size >= (int)sizeof(sequence) && sequence != expected)) {
+                    bench.errors++;
+                }
+
+                expected++;
+                bench.echoed++;
+            }
+
+            bench.closed |= !bench.stop;
+        });
+}
+
+static void Finish(BenchmarkContext& bench, Clock::time_point started) noexcept {
+    bench.stop = true;
+
+    double elapsed = (double)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - started).count() / 1000000.0;
+    printf("loss=%.3f delay_ms=%d jitter_ms=%d spoof=%d size=%d window=%d seconds=%.3f sent=%llu echoed=%llu fps=%.0f goodput_mbps=%.2f forwarded=%llu dropped=%llu forged=%llu errors=%llu handshaked=%d alive=%d\n",
+        bench.loss,
+        bench.delay,
+        bench.jitter,
+        bench.spoof ? 1 : 0,
+        bench.size,
+        bench.window,
+        elapsed,
+        (unsigned long long)bench.sent,
+        (unsigned long long)bench.echoed,
+        (double)bench.echoed / elapsed,
+        (double)bench.echoed * bench.size * 8 / elapsed / 1000000.0,
+        (unsigned long long)bench.forwarded,
+        (unsigned long long)bench.dropped,
+        (unsigned long long)bench.forged,
+        (unsigned long long)bench.errors,
+        bench.handshaked ? 1 : 0,
+        bench.closed ? 0 : 1);
+    fflush(stdout);
+
+    if (NULL != bench.client) {
+        bench.client->Dispose();
+    }
+
+    for (std::shared_ptr<IReliableUdpTransmission>& transmission : bench.servers) {
+        transmission->Dispose();
+    }
+
+    bench.acceptor->Dispose();
+    for (DatagramSocketPtr* socket : { &bench.front, &bench.back, &bench.spoofer }) {
+        Socket::Closesocket(*socket);
+    }
+
+    // Pending operations of the transmissions complete as cancelled before the executor stops.
+    std::shared_ptr<boost::asio::steady_timer> timer = ppp::make_shared_object<boost::asio::steady_timer>(*bench.context);
+    timer->expires_after(std::chrono::milliseconds(200));
+    timer->async_wait(
+        [timer](const boost::system::error_code& ec) noexcept {
+            Executors::Exit();
+        });
+}
+
+static int Start(BenchmarkContext& bench) noexcept {
+    bench.context = Executors::GetDefault();
+    bench.front = OpenLoopbackSocket(bench.context);
+    bench.back = OpenLoopbackSocket(bench.context);
+    bench.spoofer = OpenLoopbackSocket(bench.context);
+    if (NULL == bench.front || NULL == bench.back || NULL == bench.spoofer) {
+        fprintf(stderr, "Unable to open the relay sockets.\n");
+        return 1;
+    }
+
+    // The acceptor wants a port of its own, a socket bound to port 0 tells which one is free.
+    int port = 0;
+    if (DatagramSocketPtr probe = OpenLoopbackSocket(bench.context); NULL != probe) {
+        boost::system::error_code ec;
+        port = probe->local_endpoint(ec).port();
+        Socket::Closesocket(probe);
+    }
+
+    bench.acceptor = ppp::make_shared_object<IReliableUdpAcceptor>(bench.context, bench.configuration);
+    if (NULL == bench.acceptor || !bench.acceptor->Open(boost::asio::ip::address_v4::loopback(), port) ||
+        !bench.acceptor->Run([&bench](const std::shared_ptr<IReliableUdpTransmission>& transmission) noexcept { return ServerAccept(bench, transmission); })) {
+        fprintf(stderr, "Unable to open the acceptor.\n");
+        return 1;
+    }
+
+    bench.serverEP = bench.acceptor->GetLocalEndPoint();
+    RelayReceive(bench, bench.front, true);
+    RelayReceive(bench, bench.back, false);
+    ClientRun(bench);
+
+    Clock::time_point started = Clock::now();
+    std::shared_ptr<boost::asio::steady_timer> timer = ppp::make_shared_object<boost::asio::steady_timer>(*bench.context);
+    timer->expires_after(std::chrono::seconds(bench.seconds));
+    timer->async_wait(
+        [&bench, started, timer](const boost::system::error_code& ec) noexcept {
+            Finish(bench, started);
+        });
+    return 0;
+}
+
+int main(int argc, const char* argv[]) {
+    const char* config = "appsettings.json";
+
+    BenchmarkContext bench;
+    bench.random.seed(20260101);
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--config") == 0) {
+            config = argv[i + 1];
+        }
+        elif(strcmp(argv[i], "--seconds") == 0) {
+            bench.seconds = std::max<int>(1, atoi(argv[i + 1]));
+        }
+        elif(strcmp(argv[i], "--size") == 0) {
+            bench.size = std::max<int>(1, std::min<int>(PPP_BUFFER_SIZE, atoi(argv[i + 1])));
+        }
+        elif(strcmp(argv[i], "--window") == 0) {
+            bench.window = std::max<int>(1, atoi(argv[i + 1]));
+        }
+        elif(strcmp(argv[i], "--loss") == 0) {
+            bench.loss = std::max<double>(0, std::min<double>(0.9, atof(argv[i + 1])));
+        }
+        elif(strcmp(argv[i], "--delay") == 0) {
+            bench.delay = std::max<int>(0, atoi(argv[i + 1]));
+        }
+        elif(strcmp(argv[i], "--jitter") == 0) {
+            bench.jitter = std::max<int>(0, atoi(argv[i + 1]));
+        }
+        elif(strcmp(argv[i], "--spoof") == 0) {
+            bench.spoof = atoi(argv[i + 1]) != 0;
+        }
+        else {
+            fprintf(stderr, "Usage: %s [--config appsettings.json] [--seconds 5] [--size 1400] [--window 16] [--loss 0] [--delay 0] [--jitter 0] [--spoof 0|1]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    ppp::global::cctor();
+
+    bench.configuration = ppp::make_shared_object<AppConfiguration>();
+    if (NULL == bench.configuration || !bench.configuration->Load(config)) {
+        fprintf(stderr, "Unable to load the configuration: %s\n", config);
+        return 1;
+    }
+
+    int status = Executors::Run(NULL,
+        [&bench](int argc, const char* argv[]) noexcept {
+            return Start(bench);
+        });
+    if (status != 0) {
+        return status;
+    }
+
+    return bench.handshaked && !bench.closed && bench.errors == 0 && bench.echoed > 0 ? 0 : 1;
+}
@@ -0,0 +1,200 @@
+// Measures the sniproxy first flight parsers on a realistic ClientHello and HTTP/1.1 request head.
+//
+// Usage: sniproxy_bench [--seconds 3] [--segments 2]
+//
+// The ClientHello carries the extensions a current browser sends (SNI, ALPN, key shares, signature algorithms and padding) and is
+// delivered in --segments reads the way do_tlsvd_handshake receives it, so record reassembly is part of every iteration. The HTTP
+// head is searched for its end in the same number of reads before the Host header is taken. Every result is printed as one
+// key=value line with parses per second, MB/s of first flight consumed and nanoseconds per parse.
+
+#include <ppp/net/proxies/sniproxy.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using ppp::Byte;
+using ppp::net::proxies::sniproxy;
+
+typedef std::chrono::steady_clock                                       Clock;
+
+static constexpr int FORWARD_MSS = 65536;
+
+static void AppendU8(std::vector<Byte>& out, int value) noexcept {
+    out.emplace_back((Byte)value);
+}
+
+static void AppendU16(std::vector<Byte>& out, int value) noexcept {
+    out.emplace_back((Byte)(value >> 8));
+    out.emplace_back((Byte)value);
+}
+
+static void AppendBytes(std::vector<Byte>& out, const void* data, std::size_t length) noexcept {
+    out.insert(out.end(), (const Byte*)data, (const Byte*)data + length);
+}
+
+static void AppendExtension(std::vector<Byte>& out, int type, const std::vector<Byte>& body) noexcept {
+    AppendU16(out, type);
+    AppendU16(out, (int)body.size());
+    AppendBytes(out, body.data(), body.size());
+}
+
+// One ClientHello of about 512 bytes in a single TLS record, the size padding rounds browser hellos to.
+static std::vector<Byte> MakeClientHello(const char* host) noexcept {
+    std::vector<Byte> extensions;
+    std::vector<Byte> body;
+
+    std::size_t host_length = strlen(host);
+    AppendU16(body, (int)host_length + 3);
+    AppendU8(body, 0);
+    AppendU16(body, (int)host_length);
+    AppendBytes(body, host, host_length);
+    AppendExtension(extensions, 0x0000, body);
+
+    static const char* protocols[] = { "h2", "http/1.1" };
+    body.clear();
+    AppendU16(body, 2 + 1 + 8 + 1);
+    for (const char* protocol : protocols) {
+        AppendU8(body, (int)strlen(protocol));
+        AppendBytes(body, protocol, strlen(protocol));
+    }
+    AppendExtension(extensions, 0x0010, body);
+
+    body.assign(2 + 36 + 2, 0x5a);
+    AppendExtension(extensions, 0x0033, body); // key_share
+    body.assign(2 + 16, 0x04);
+    AppendExtension(extensions, 0x000d, body); // signature_algorithms
+    body.assign(1 + 4, 0x03);
+    AppendExtension(extensions, 0x002b, body); // supported_versions
+
+    std::vector<Byte> hello;
+    AppendU16(hello, 0x0303);
+    hello.insert(hello.end(), 32, 0x11);
+    AppendU8(hello, 32);
+    hello.insert(hello.end(), 32, 0x22);
+    AppendU16(hello, 32);
+    for (int i = 0; i < 16; i++) {
+        AppendU16(hello, 0x1301 + i);
+    }
+    AppendU8(hello, 1);
+    AppendU8(hello, 0);
+
+    int padding = 512 - (int)(4 + hello.size() + 2 + extensions.size() + 4);
+    body.assign(std::max<int>(0, padding), 0);
+    AppendExtension(extensions, 0x0015, body);
+
+    AppendU16(hello, (int)extensions.size());
+    AppendBytes(hello, extensions.data(), extensions.size());
+
+    std::vector<Byte> record;
+    AppendU8(record, 0x16);
+    AppendU16(record, 0x0301);
+    AppendU16(record, (int)hello.size() + 4);
+    AppendU8(record, 0x01);
+    AppendU8(record, 0);
+    AppendU16(record, (int)hello.size());
+    AppendBytes(record, hello.data(), hello.size());
+    return record;
+}
+
+// Delivers packet in segments reads of equal size and returns the handshake message size, or a value below 1 on failure.
+static int ReassembleClientHello(const std::vector<Byte>& packet, int segments, Byte* handshake) noexcept {
+    int length = (int)packet.size();
+    int packet_offset = 0;
+    int handshake_length = 0;
+    for (int i = 1; i <= segments; i++) {
+        int received = i == segments ? length : length * i / segments;
+        int handshake_size = sniproxy::tls_reassemble_client_hello(packet.data(), received, packet_offset, handshake, FORWARD_MSS, handshake_length);
+        if (handshake_size != 0) {
+            return handshake_size;
+        }
+    }
+    return 0;
+}
+
+static void PrintResult(const char* parser, uint64_t parses, std::size_t size, double elapsed, uint64_t errors) noexcept {
+    printf("parser=%s size=%d parses=%llu pps=%.0f mbps=%.1f ns_per_parse=%.1f errors=%llu\n",
+        parser,
+        (int)size,
+        (unsigned long long)parses,
+        (double)parses / elapsed,
+        (double)parses * size / elapsed / 1000000.0,
+        elapsed * 1000000000.0 / std::max<uint64_t>(1, parses),
+        (unsigned long long)errors);
+    fflush(stdout);
+}
+
+int main(int argc, const char* argv[]) {
+    int seconds = 3;
+    int segments = 2;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--seconds") == 0) {
+            seconds = std::max<int>(1, atoi(argv[i + 1]));
+        }
+        else if (strcmp(argv[i], "--segments") == 0) {
+            segments = std::max<int>(1, atoi(argv[i + 1]));
+        }
+        else {
+            fprintf(stderr, "Usage: %s [--seconds 3] [--segments 2]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    static const char host[] = "www.example.com";
+    std::vector<Byte> client_hello = MakeClientHello(host);
+    std::string request = std::string("GET /index.html HTTP/1.1\r\nHost: ") + host +
+        ":8080\r\nUser-Agent: Mozilla/5.0 (X11; Linux x86_64)\r\nAccept: text/html,application/xhtml+xml\r\nAccept-Language: en-US,en;q=0.5\r\n"
+        "Accept-Encoding: gzip, deflate, br\r\nConnection: keep-alive\r\n\r\n";
+
+    static Byte handshake[FORWARD_MSS];
+    uint64_t parses = 0;
+    uint64_t errors = 0;
+    Clock::time_point started = Clock::now();
+    Clock::time_point deadline = started + std::chrono::seconds(seconds);
+    do {
+        for (int i = 0; i < 1024; i++) {
+            sniproxy::tls_client_hello hello;
+            int handshake_size = ReassembleClientHello(client_hello, segments, handshake);
+            if (handshake_size < 1 || !sniproxy::tls_fetch_client_hello(handshake, handshake_size, hello) || hello.alpn_length != 2 ||
+                hello.sni_length != (int)sizeof(host) - 1 || memcmp(hello.sni, host, hello.sni_length) != 0) {
+                errors++;
+            }
+        }
+        parses += 1024;
+    } while (Clock::now() < deadline);
+    PrintResult("tls", parses, client_hello.size(), (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started).count() / 1000000000.0, errors);
+
+    const char* headers = request.data();
+    int length = (int)request.size();
+    uint64_t failures = errors;
+    parses = 0;
+    errors = 0;
+    started = Clock::now();
+    deadline = started + std::chrono::seconds(seconds);
+    do {
+        for (int i = 0; i < 1024; i++) {
+            int headers_size = -1;
+            for (int k = 1, offset = 0; k <= segments && headers_size < 0; k++) {
+                int received = k == segments ? length : length * k / segments;
+                headers_size = sniproxy::http_fetch_headers_end(headers, received, offset);
+                offset = received;
+            }
+
+            int port;
+            int host_length;
+            const char* host_name;
+            if (headers_size < 1 || !sniproxy::http_fetch_host(headers, headers_size, host_name, host_length, port) || port != 8080 ||
+                host_length != (int)sizeof(host) - 1) {
+                errors++;
+            }
+        }
+        parses += 1024;
+    } while (Clock::now() < deadline);
+    PrintResult("http", parses, request.size(), (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started).count() / 1000000000.0, errors);
+    return (failures + errors) > 0 ? 1 : 0;
+}
@@ -0,0 +1,459 @@
+// Compares TCP throughput and UDP request rate through the local SOCKS5 proxy with the same traffic sent directly, which is the
+// TUN path whenever a ppp client routes the origin through its virtual adapter.
+//
+// Usage: socks_proxy_bench [--serve port] [--origin host:port] [--domain name] [--proxy host:port]
+//                          [--connections 8] [--seconds 5] [--size 1024]
+//
+// --serve runs only the echo origin (TCP and UDP on the same port) and is meant for a host behind the tunnel. Without --origin an
+// in-process echo origin listens on an ephemeral loopback port, then the direct run is a baseline with no tunnel at all. With
+// --proxy (a running ppp client with client.socks-proxy enabled) the workload runs again through CONNECT and UDP ASSOCIATE, the
+// destination is sent by name (ATYP 0x03) when --domain is given. The name is resolved by the VPN server, so it has to reach the
+// origin from there. --size is capped at 1400 bytes so datagrams are never fragmented, every result is printed as one key=value line.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#else
+#include <poll.h>
+#endif
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include <boost/asio.hpp>
+
+using boost::asio::ip::tcp;
+using boost::asio::ip::udp;
+
+typedef std::chrono::steady_clock                                       Clock;
+
+static constexpr int UDP_TIMEOUT_MILLISECONDS = 1000;
+
+struct BenchmarkResult {
+    uint64_t                                                            bytes    = 0;
+    uint64_t                                                            requests = 0;
+    uint64_t                                                            lost     = 0;
+    uint64_t                                                            errors   = 0;
+};
+
+struct BenchmarkTarget {
+    tcp::endpoint                                                       originEP;
+    std::string                                                         domain;
+    const tcp::endpoint*                                                proxyEP = NULL;
+};
+
+static bool ParseEndPoint(const char* s, tcp::endpoint& ep) noexcept {
+    const char* colon = strrchr(s, ':');
+    if (NULL == colon) {
+        return false;
+    }
+
+    boost::system::error_code ec;
+    std::string host(s, colon - s);
+    if (host.size() > 1 && host.front() == '[' && host.back() == ']') {
+        host = host.substr(1, host.size() - 2);
+    }
+
+    boost::asio::ip::address address = boost::asio::ip::make_address(host, ec);
+    int port = atoi(colon + 1);
+    if (ec || port < 1 || port > 65535) {
+        return false;
+    }
+
+    ep = tcp::endpoint(address, port);
+    return true;
+}
+
+static bool WaitReadable(udp::socket& socket, int milliseconds) noexcept {
+#if defined(_WIN32)
+    WSAPOLLFD fd = { socket.native_handle(), POLLRDNORM, 0 };
+    return WSAPoll(&fd, 1, milliseconds) > 0;
+#else
+    struct pollfd fd = { socket.native_handle(), POLLIN, 0 };
+    return poll(&fd, 1, milliseconds) > 0;
+#endif
+}
+
+// ATYP DST.ADDR DST.PORT of a SOCKS5 request or UDP header, the destination is the origin or its --domain name.
+static std::string SocksAddress(const BenchmarkTarget& target) noexcept {
+    std::string s;
+    boost::asio::ip::address address = target.originEP.address();
+    if (!target.domain.empty()) {
+        s += (char)0x03;
+        s += (char)target.domain.size();
+        s += target.domain;
+    }
+    else if (address.is_v4()) {
+        boost::asio::ip::address_v4::bytes_type bytes = address.to_v4().to_bytes();
+        s += (char)0x01;
+        s.append((char*)bytes.data(), bytes.size());
+    }
+    else {
+        boost::asio::ip::address_v6::bytes_type bytes = address.to_v6().to_bytes();
+        s += (char)0x04;
+        s.append((char*)bytes.data(), bytes.size());
+    }
+
+    int port = target.originEP.port();
+    s += (char)(port >> 8);
+    s += (char)port;
+    return s;
+}
+
+// Returns the offset behind ATYP DST.ADDR DST.PORT starting at offset, or -1 when the address does not fit.
+static int SocksAddressEnd(const unsigned char* p, int length, int offset) noexcept {
+    if (offset >= length) {
+        return -1;
+    }
+
+    int address_size = -1;
+    if (p[offset] == 0x01) {
+        address_size = 4;
+    }
+    else if (p[offset] == 0x04) {
+        address_size = 16;
+    }
+    else if (p[offset] == 0x03 && offset + 1 < length) {
+        address_size = 1 + p[offset + 1];
+    }
+
+    if (address_size < 0 || offset + 1 + address_size + 2 > length) {
+        return -1;
+    }
+
+    return offset + 1 + address_size + 2;
+}
+
+
+// Negotiates no authentication and sends one request, the bound endpoint of a succeeded reply is returned in bindEP.
+static bool SocksRequest(tcp::socket& socket, int command, const std::string& destination, tcp::endpoint& bindEP) noexcept {
+    boost::system::error_code ec;
+    unsigned char replies[4 + 1 + 255 + 2];
+    boost::asio::write(socket, boost::asio::buffer("\x05\x01\x00", 3), ec);
+    if (ec || boost::asio::read(socket, boost::asio::buffer(replies, 2), ec) != 2 || replies[0] != 0x05 || replies[1] != 0x00) {
+        return false;
+    }
+
+    std::string request = std::string("\x05", 1) + (char)command + std::string("\x00", 1) + destination;
+    boost::asio::write(socket, boost::asio::buffer(request), ec);
+    if (ec || boost::asio::read(socket, boost::asio::buffer(replies, 5), ec) != 5 || replies[1] != 0x00) {
+        return false;
+    }
+
+    int length = SocksAddressEnd(replies, sizeof(replies), 3);
+    if (length < 5 || boost::asio::read(socket, boost::asio::buffer(replies + 5, length - 5), ec) != (std::size_t)(length - 5)) {
+        return false;
+    }
+
+    int port = replies[length - 2] << 8 | replies[length - 1];
+    if (replies[3] == 0x01) {
+        boost::asio::ip::address_v4::bytes_type bytes;
+        memcpy(bytes.data(), replies + 4, bytes.size());
+        bindEP = tcp::endpoint(boost::asio::ip::address_v4(bytes), port);
+    }
+    else if (replies[3] == 0x04) {
+        boost::asio::ip::address_v6::bytes_type bytes;
+        memcpy(bytes.data(), replies + 4, bytes.size());
+        bindEP = tcp::endpoint(boost::asio::ip::address_v6(bytes), port);
+    }
+    else {
+        bindEP = tcp::endpoint(boost::asio::ip::address_v4::any(), port);
+    }
+
+    return true;
+}
+
+static void OriginConnection(tcp::socket socket) noexcept {
+    char buffer[65536];
+    boost::system::error_code ec;
+    socket.set_option(tcp::no_delay(true), ec);
+
+    for (;;) {
+        std::size_t bytes_transferred = socket.read_some(boost::asio::buffer(buffer), ec);
+        if (ec || bytes_transferred < 1) {
+            break;
+        }
+
+        boost::asio::write(socket, boost::asio::buffer(buffer, bytes_transferred), ec);
+        if (ec) {
+            break;
+        }
+    }
+
+    socket.close(ec);
+}
+
+// Echoes every TCP connection and every datagram on the same port until the process ends.
+static void RunOrigin(boost::asio::io_context& context, tcp::acceptor& acceptor, udp::socket& socket) noexcept {
+    std::thread([&socket]() noexcept {
+        char buffer[65536];
+        for (;;) {
+            udp::endpoint remoteEP;
+            boost::system::error_code ec;
+            std::size_t bytes_transferred = socket.receive_from(boost::asio::buffer(buffer), remoteEP, 0, ec);
+            if (ec == boost::asio::error::bad_descriptor) {
+                break;
+            }
+
+            if (!ec) {
+                socket.send_to(boost::asio::buffer(buffer, bytes_transferred), remoteEP, 0, ec);
+            }
+        }
+    }).detach();
+
+    std::thread([&acceptor, &context]() noexcept {
+        for (;;) {
+            boost::system::error_code ec;
+            tcp::socket connection(context);
+            acceptor.accept(connection, ec);
+            if (ec) {
+                break;
+            }
+
+            std::thread(OriginConnection, std::move(connection)).detach();
+        }
+    }).detach();
+}
+
+// Each worker keeps one connection echoing --size chunks back to back and reconnects whenever it fails.
+static void RunTcpWorker(const BenchmarkTarget& target, int size, Clock::time_point deadline, BenchmarkResult& result) noexcept {
+    boost::asio::io_context context;
+    std::vector<char> chunk(size, 'x');
+    std::vector<char> echo(size);
+
+    while (Clock::now() < deadline) {
+        tcp::socket socket(context);
+        tcp::endpoint bindEP;
+        boost::system::error_code ec;
+        socket.connect(NULL != target.proxyEP ? *target.proxyEP : target.originEP, ec);
+        if (ec || (NULL != target.proxyEP && !SocksRequest(socket, 0x01, SocksAddress(target), bindEP))) {
+            result.errors++;
+            socket.close(ec);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+
+        socket.set_option(tcp::no_delay(true), ec);
+        while (Clock::now() < deadline) {
+            boost::asio::write(socket, boost::asio::buffer(chunk), ec);
+            if (ec || boost::asio::read(socket, boost::asio::buffer(echo), ec) != echo.size()) {
+                result.errors++;
+                break;
+            }
+
+            result.requests++;
+            result.bytes += echo.size();
+        }
+
+        socket.close(ec);
+    }
+}
+
+// Each worker sends one --size datagram and waits for its echo, a datagram not answered in time is counted as lost.
+static void RunUdpWorker(const BenchmarkTarget& target, int size, Clock::time_point deadline, BenchmarkResult& result) noexcept {
+    boost::asio::io_context context;
+    tcp::socket control(context);
+    boost::system::error_code ec;
+
+    std::string header;
+    udp::endpoint destinationEP(target.originEP.address(), target.originEP.port());
+    if (NULL != target.proxyEP) {
+        // The association is requested with an unspecified address, the relay learns the client's port from its first datagram.
+        tcp::endpoint bindEP;
+        control.connect(*target.proxyEP, ec);
+        if (ec || !SocksRequest(control, 0x03, std::string("\x01\x00\x00\x00\x00\x00\x00", 7), bindEP)) {
+            result.errors++;
+            return;
+        }
+
+        boost::asio::ip::address address = bindEP.address().is_unspecified() ? target.proxyEP->address() : bindEP.address();
+        destinationEP = udp::endpoint(address, bindEP.port());
+        header = std::string("\x00\x00\x00", 3) + SocksAddress(target);
+    }
+
+    udp::socket socket(context);
+    socket.open(destinationEP.protocol(), ec);
+    if (ec) {
+        result.errors++;
+        return;
+    }
+
+    std::vector<unsigned char> datagram(header.begin(), header.end());
+    datagram.resize(header.size() + size, 'x');
+
+    std::vector<unsigned char> echo(65536);
+    while (Clock::now() < deadline) {
+        socket.send_to(boost::asio::buffer(datagram), destinationEP, 0, ec);
+        if (ec) {
+            result.errors++;
+            continue;
+        }
+
+        if (!WaitReadable(socket, UDP_TIMEOUT_MILLISECONDS)) {
+            result.lost++;
+            continue;
+        }
+
+        udp::endpoint remoteEP;
+        int bytes_transferred = (int)socket.receive_from(boost::asio::buffer(echo), remoteEP, 0, ec);
+        int offset = header.empty() ? 0 : SocksAddressEnd(echo.data(), bytes_transferred, 3);
+        if (ec || offset < 0 || bytes_transferred - offset != size) {
+            result.errors++;
+            continue;
+        }
+
+        result.requests++;
+        result.bytes += size;
+    }
+
+    control.close(ec);
+}
+
+template <typename TWorker>
+static BenchmarkResult RunBenchmark(TWorker worker, const BenchmarkTarget& target, int size, int connections, int seconds) noexcept {
+    std::vector<BenchmarkResult> results(connections);
+    std::vector<std::thread> workers;
+    Clock::time_point deadline = Clock::now() + std::chrono::seconds(seconds);
+    for (int i = 0; i < connections; i++) {
+        workers.emplace_back(worker, std::cref(target), size, deadline, std::ref(results[i]));
+    }
+
+    BenchmarkResult result;
+    for (int i = 0; i < connections; i++) {
+        workers[i].join();
+        result.bytes += results[i].bytes;
+        result.requests += results[i].requests;
+        result.lost += results[i].lost;
+        result.errors += results[i].errors;
+    }
+
+    return result;
+}
+
+static void PrintResult(const char* mode, const char* protocol, const BenchmarkResult& result, int seconds, const BenchmarkResult* baseline) noexcept {
+    printf("mode=%s protocol=%s requests=%llu lost=%llu errors=%llu rps=%.0f mbps=%.2f",
+        mode,
+        protocol,
+        (unsigned long long)result.requests,
+        (unsigned long long)result.lost,
+        (unsigned long long)result.errors,
+        (double)result.requests / seconds,
+        (double)result.bytes * 8 / seconds / 1000000.0);
+
+    if (NULL != baseline && baseline->bytes > 0) {
+        printf(" relative=%.3f", (double)result.bytes / baseline->bytes);
+    }
+
+    printf("\n");
+    fflush(stdout);
+}
+
+int main(int argc, const char* argv[]) {
+    const char* proxy = NULL;
+    const char* origin = NULL;
+    const char* domain = NULL;
+    int serve = 0;
+    int connections = 8;
+    int seconds = 5;
+    int size = 1024;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--proxy") == 0) {
+            proxy = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--origin") == 0) {
+            origin = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--domain") == 0) {
+            domain = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--serve") == 0) {
+            serve = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--connections") == 0) {
+            connections = std::max<int>(1, atoi(argv[i + 1]));
+        }
+        else if (strcmp(argv[i], "--seconds") == 0) {
+            seconds = std::max<int>(1, atoi(argv[i + 1]));
+        }
+        else if (strcmp(argv[i], "--size") == 0) {
+            size = std::min<int>(1400, std::max<int>(1, atoi(argv[i + 1])));
+        }
+        else {
+            fprintf(stderr, "Usage: %s [--serve port] [--origin host:port] [--domain name] [--proxy host:port] [--connections 8] [--seconds 5] [--size 1024]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    BenchmarkTarget target;
+    tcp::endpoint proxyEP;
+    if (NULL != proxy && !ParseEndPoint(proxy, proxyEP)) {
+        fprintf(stderr, "Invalid proxy endpoint: %s\n", proxy);
+        return 1;
+    }
+
+    if (NULL != origin && !ParseEndPoint(origin, target.originEP)) {
+        fprintf(stderr, "Invalid origin endpoint: %s\n", origin);
+        return 1;
+    }
+
+    if (NULL != domain) {
+        target.domain.assign(domain, std::min<std::size_t>(255, strlen(domain)));
+    }
+
+    boost::asio::io_context context;
+    tcp::acceptor acceptor(context);
+    udp::socket socket(context);
+    if (serve > 0 || NULL == origin) {
+        boost::system::error_code ec;
+        boost::asio::ip::address address = serve > 0 ? boost::asio::ip::address(boost::asio::ip::address_v4::any()) : boost::asio::ip::address(boost::asio::ip::address_v4::loopback());
+        acceptor.open(tcp::v4(), ec);
+        acceptor.set_option(tcp::acceptor::reuse_address(true), ec);
+        acceptor.bind(tcp::endpoint(address, std::max<int>(0, serve)), ec);
+        acceptor.listen(boost::asio::socket_base::max_listen_connections, ec);
+        if (!ec) {
+            socket.open(udp::v4(), ec);
+            socket.bind(udp::endpoint(address, acceptor.local_endpoint().port()), ec);
+        }
+
+        if (ec) {
+            fprintf(stderr, "Unable to open the echo origin: %s\n", ec.message().data());
+            return 1;
+        }
+
+        RunOrigin(context, acceptor, socket);
+        if (serve > 0) {
+            printf("serve=%s:%d\n", address.to_string().data(), (int)acceptor.local_endpoint().port());
+            fflush(stdout);
+            for (;;) {
+                std::this_thread::sleep_for(std::chrono::hours(1));
+            }
+        }
+
+        target.originEP = acceptor.local_endpoint();
+    }
+
+    BenchmarkResult direct_tcp = RunBenchmark(RunTcpWorker, target, size, connections, seconds);
+    PrintResult("direct", "tcp", direct_tcp, seconds, NULL);
+
+    BenchmarkResult direct_udp = RunBenchmark(RunUdpWorker, target, size, connections, seconds);
+    PrintResult("direct", "udp", direct_udp, seconds, NULL);
+
+    if (NULL != proxy) {
+        target.proxyEP = &proxyEP;
+
+        BenchmarkResult socks_tcp = RunBenchmark(RunTcpWorker, target, size, connections, seconds);
+        PrintResult("socks", "tcp", socks_tcp, seconds, &direct_tcp);
+
+        BenchmarkResult socks_udp = RunBenchmark(RunUdpWorker, target, size, connections, seconds);
+        PrintResult("socks", "udp", socks_udp, seconds, &direct_udp);
+    }
+
+    return 0;
+}
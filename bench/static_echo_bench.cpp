@@ -0,0 +1,179 @@
+// Measures how fast the static echo receive path unpacks datagrams when several sockets of one SO_REUSEPORT group run at once.
+//
+// Usage: static_echo_bench [--config appsettings.json] [--threads 4] [--seconds 2] [--size 1400]
+//
+// Every thread stands for one socket of the port group on its own executor and unpacks the same set of packed datagrams with
+// VirtualEthernetPacket::Unpack, the way VirtualEthernetSwitcher::StaticEchoPacketInput does. shared runs every thread on one
+// protocol and transport Ciphertext pair, as the switcher did before, per_socket gives each thread its own pair, as the switcher
+// does now. Every result is printed as one key=value line with the datagrams per second of all threads and of one thread. The
+// spread between the two modes only shows on a host with at least as many cores as threads.
+
+#include <ppp/stdafx.h>
+#include <ppp/configurations/AppConfiguration.h>
+#include <ppp/cryptography/Ciphertext.h>
+#include <ppp/app/protocol/VirtualEthernetPacket.h>
+#include <ppp/threading/BufferswapAllocator.h>
+
+#include <chrono>
+#include <thread>
+
+using ppp::Byte;
+using ppp::cryptography::Ciphertext;
+using ppp::app::protocol::VirtualEthernetPacket;
+
+typedef std::chrono::steady_clock                                       Clock;
+typedef ppp::configurations::AppConfiguration                           AppConfiguration;
+typedef std::shared_ptr<AppConfiguration>                               AppConfigurationPtr;
+typedef std::shared_ptr<Ciphertext>                                     CiphertextPtr;
+
+static constexpr int                                                    BENCHMARK_DATAGRAMS = 256;
+
+struct BenchmarkDatagram {
+    std::shared_ptr<Byte>                                               packet;
+    int                                                                 packet_length = 0;
+};
+
+static double ElapsedSeconds(Clock::time_point started) noexcept {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started).count() / 1000000000.0;
+}
+
+static bool NewCiphertexts(const AppConfigurationPtr& configuration, CiphertextPtr& protocol, CiphertextPtr& transport) noexcept {
+    protocol = ppp::make_shared_object<Ciphertext>(configuration->key.protocol, configuration->key.protocol_key);
+    transport = ppp::make_shared_object<Ciphertext>(configuration->key.transport, configuration->key.transport_key);
+    return NULL != protocol && NULL != transport;
+}
+
+static bool PackDatagrams(const AppConfigurationPtr& configuration, int size, std::vector<BenchmarkDatagram>& datagrams) noexcept {
+    CiphertextPtr protocol;
+    CiphertextPtr transport;
+    if (!NewCiphertexts(configuration, protocol, transport)) {
+        return false;
+    }
+
+    std::shared_ptr<ppp::threading::BufferswapAllocator> allocator;
+    std::vector<Byte> payload(size);
+    for (int i = 0; i < BENCHMARK_DATAGRAMS; i++) {
+        for (int j = 0; j < size; j++) {
+            payload[j] = (Byte)(i + j * 7);
+        }
+
+        BenchmarkDatagram datagram;
+        datagram.packet = VirtualEthernetPacket::Pack(configuration, allocator, protocol, transport, i + 1,
+            htonl(0x0a000001), 53000 + i, htonl(0x0a000002), 53, payload.data(), size, datagram.packet_length);
+        if (NULL == datagram.packet) {
+            return false;
+        }
+
+        datagrams.emplace_back(datagram);
+    }
+
+    return true;
+}
+
+static bool RunThreads(const AppConfigurationPtr& configuration, const std::vector<BenchmarkDatagram>& datagrams, int threads, int seconds, bool shared) noexcept {
+    CiphertextPtr shared_protocol;
+    CiphertextPtr shared_transport;
+    if (shared && !NewCiphertexts(configuration, shared_protocol, shared_transport)) {
+        return false;
+    }
+
+    std::atomic<uint64_t> unpacked = 0;
+    std::atomic<uint64_t> errors = 0;
+    std::atomic<bool> stop = false;
+
+    std::vector<std::thread> workers;
+    Clock::time_point started = Clock::now();
+    for (int i = 0; i < threads; i++) {
+        workers.emplace_back(
+            [&]() noexcept {
+                CiphertextPtr protocol = shared_protocol;
+                CiphertextPtr transport = shared_transport;
+                if (!shared && !NewCiphertexts(configuration, protocol, transport)) {
+                    errors++;
+                    return;
+                }
+
+                std::shared_ptr<ppp::threading::BufferswapAllocator> allocator;
+                uint64_t count = 0;
+                uint64_t failures = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    for (const BenchmarkDatagram& datagram : datagrams) {
+                        std::shared_ptr<VirtualEthernetPacket> message =
+                            VirtualEthernetPacket::Unpack(configuration, allocator, protocol, transport, datagram.packet.get(), datagram.packet_length);
+                        failures += NULL != message ? 0 : 1;
+                    }
+
+                    count += datagrams.size();
+                }
+
+                unpacked += count;
+                errors += failures;
+            });
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    stop = true;
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    double elapsed = ElapsedSeconds(started);
+    printf("mode=%s threads=%d datagrams=%llu pps=%.0f pps_per_thread=%.0f errors=%llu\n",
+        shared ? "shared" : "per_socket",
+        threads,
+        (unsigned long long)unpacked.load(),
+        (double)unpacked.load() / elapsed,
+        (double)unpacked.load() / elapsed / threads,
+        (unsigned long long)errors.load());
+    fflush(stdout);
+    return errors == 0;
+}
+
+int main(int argc, const char* argv[]) {
+    const char* config = "appsettings.json";
+    int threads = 4;
+    int seconds = 2;
+    int size = 1400;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--config") == 0) {
+            config = argv[i + 1];
+        }
+        elif(strcmp(argv[i], "--threads") == 0) {
+            threads = std::max<int>(1, atoi(argv[i + 1]));
+        }
+        elif(strcmp(argv[i], "--seconds") == 0) {
+            seconds = std::max<int>(1, atoi(argv[i + 1]));
+        }
+        elif(strcmp(argv[i], "--size") == 0) {
+            size = std::max<int>(1, std::min<int>(PPP_BUFFER_SIZE - 64, atoi(argv[i + 1])));
+        }
+        else {
+            fprintf(stderr, "Usage: %s [--config appsettings.json] [--threads 4] [--seconds 2] [--size 1400]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    ppp::global::cctor();
+
+    AppConfigurationPtr configuration = ppp::make_shared_object<AppConfiguration>();
+    if (NULL == configuration || !configuration->Load(config)) {
+        fprintf(stderr, "Unable to load the configuration: %s\n", config);
+        return 1;
+    }
+
+    if (!Ciphertext::Support(configuration->key.protocol) || !Ciphertext::Support(configuration->key.transport)) {
+        fprintf(stderr, "The configured protocol and transport ciphers are not supported.\n");
+        return 1;
+    }
+
+    std::vector<BenchmarkDatagram> datagrams;
+    if (!PackDatagrams(configuration, size, datagrams)) {
+        fprintf(stderr, "Unable to pack the datagrams.\n");
+        return 1;
+    }
+
+    bool ok = RunThreads(configuration, datagrams, threads, seconds, true);
+    ok &= RunThreads(configuration, datagrams, threads, seconds, false);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,407 @@
+// Measures the tunnel carriers between a client and a server transmission inside one process over loopback.
+//
+// Usage: tunnel_bench [--config appsettings.json] [--carrier tcp|ws|wss] [--workload bulk|rr] [--connections 4] [--seconds 5] [--size 1400]
+//
+// Both ends are the transmissions the client exchanger and the server switcher run on: the same carrier classes, handshake, frame
+// ciphers and key settings, all taken from the configuration file. The server side runs on one executor and the client side on another.
+// bulk keeps a window of frames of --size bytes in flight from every client to the server, rr sends one frame and waits for the server
+// to echo it before it sends the next. Every result is printed as one key=value line: handshake and round trip percentiles, throughput,
+// frames per second and the process cpu time spent per GB that crossed the tunnel.
+//
+// The bench covers the carrier and frame path only. These are left out on purpose:
+//   - VirtualEthernetSwitcher and VEthernetExchanger, each side is a bare transmission and no session or linklayer messages are run.
+//   - A fake in-memory ITap, no IP packets enter or leave through a virtual adapter, so the tcp/ip stack and nat are not measured.
+//   - Short flow, UDP pps and DNS burst workloads, they need the exchanger and the adapter above, only bulk and rr frames are sent.
+//   - Allocations per packet, the process allocator is not instrumented, cpu per GB is the only cost figure.
+// socks_proxy_bench and http_proxy_bench measure the local proxy front-ends, static_echo_bench and reliable_udp_bench the UDP paths.
+
+#include <ppp/stdafx.h>
+#include <ppp/configurations/AppConfiguration.h>
+#include <ppp/coroutines/YieldContext.h>
+#include <ppp/coroutines/asio/asio.h>
+#include <ppp/auxiliary/StringAuxiliary.h>
+#include <ppp/transmissions/ITransmission.h>
+#include <ppp/transmissions/ITcpipTransmission.h>
+#include <ppp/transmissions/IWebsocketTransmission.h>
+
+#include <sys/resource.h>
+
+using ppp::Byte;
+using ppp::Int128;
+using boost::asio::ip::tcp;
+
+typedef std::chrono::steady_clock                                       Clock;
+typedef ppp::configurations::AppConfiguration                           AppConfiguration;
+typedef std::shared_ptr<AppConfiguration>                               AppConfigurationPtr;
+typedef ppp::transmissions::ITransmission                               ITransmission;
+typedef std::shared_ptr<ITransmission>                                  ITransmissionPtr;
+typedef ppp::coroutines::YieldContext                                   YieldContext;
+typedef std::shared_ptr<boost::asio::io_context>                        ContextPtr;
+
+static constexpr int                                                    BULK_WINDOW = 16;
+
+struct BenchmarkContext {
+    AppConfigurationPtr                                                 configuration;
+    std::string                                                         carrier;
+    bool                                                                rr          = false;
+    int                                                                 size        = 1400;
+
+    std::atomic<bool>                                                   stop        = false;
+    std::atomic<int>                                                    handshakes  = 0;
+    std::atomic<int>                                                    failures    = 0;
+    std::atomic<uint64_t>                                               frames      = 0;
+    std::atomic<uint64_t>                                               bytes       = 0;
+};
+
+struct BenchmarkClient {
+    ITransmissionPtr                                                    transmission;
+    uint32_t                                                            handshake   = 0; // microseconds
+    std::vector<uint32_t>                                               latencies;       // microseconds
+};
+
+static uint32_t Microseconds(Clock::time_point started) noexcept {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - started).count();
+}
+
+static ITransmissionPtr NewTransmission(BenchmarkContext& bench, const ContextPtr& context, const std::shared_ptr<tcp::socket>& socket) noexcept {
+    ppp::threading::Executors::StrandPtr strand;
+    const AppConfigurationPtr& configuration = bench.configuration;
+    if (bench.carrier == "ws") {
+        auto transmission = ppp::make_shared_object<ppp::transmissions::IWebsocketTransmission>(context, strand, socket, configuration);
+        if (NULL != transmission) {
+            transmission->Host = configuration->websocket.host;
+            transmission->Path = configuration->websocket.path;
+        }
+        return transmission;
+    }
+    elif(bench.carrier == "wss") {
+        auto transmission = ppp::make_shared_object<ppp::transmissions::ISslWebsocketTransmission>(context, strand, socket, configuration);
+        if (NULL != transmission) {
+            transmission->Host = configuration->websocket.host;
+            transmission->Path = configuration->websocket.path;
+        }
+        return transmission;
+    }
+    else {
+        return ppp::make_shared_object<ppp::transmissions::ITcpipTransmission>(context, strand, socket, configuration);
+    }
+}
+
+// The server end reads frames until the transmission closes, rr echoes every frame back to the client.
+static void ServerAccept(BenchmarkContext& bench, const ContextPtr& context, tcp::acceptor& acceptor, std::vector<ITransmissionPtr>& servers) noexcept {
+    std::shared_ptr<tcp::socket> socket = ppp::make_shared_object<tcp::socket>(*context);
+    acceptor.async_accept(*socket,
+        [&bench, context, &acceptor, &servers, socket](const boost::system::error_code& ec) noexcept {
+            if (ec) {
+                return;
+            }
+
+            boost::system::error_code ignored;
+            socket->set_option(tcp::no_delay(true), ignored);
+
+            ITransmissionPtr transmission = NewTransmission(bench, context, socket);
+            if (NULL != transmission) {
+                servers.emplace_back(transmission);
+                YieldContext::Spawn(*context,
+                    [&bench, transmission](YieldContext& y) noexcept {
+                        bool mux = false;
+                        if (transmission->HandshakeClient(y, mux) == 0) {
+                            bench.failures++;
+                            return;
+                        }
+
+                        for (;;) {
+                            int packet_length = 0;
+                            std::shared_ptr<Byte> packet = transmission->Read(y, packet_length);
+                            if (NULL == packet) {
+                                break;
+                            }
+
+                            if (!bench.stop.load(std::memory_order_relaxed)) {
+                                bench.frames.fetch_add(1, std::memory_order_relaxed);
+                                bench.bytes.fetch_add(packet_length, std::memory_order_relaxed);
+                            }
+
+                            if (bench.rr && !transmission->Write(y, packet.get(), packet_length)) {
+                                break;
+                            }
+                        }
+                    });
+            }
+
+            ServerAccept(bench, context, acceptor, servers);
+        });
+}
+
+static void ClientHandshake(BenchmarkContext& bench, const ContextPtr& context, BenchmarkClient& client, const tcp::endpoint& serverEP) noexcept {
+    YieldContext::Spawn(*context,
+        [&bench, context, &client, serverEP](YieldContext& y) noexcept {
+            Clock::time_point started = Clock::now();
+            std::shared_ptr<tcp::socket> socket = ppp::make_shared_object<tcp::socket>(*context);
+
+            boost::system::error_code ec;
+            socket->open(serverEP.protocol(), ec);
+            if (ec || !ppp::coroutines::asio::async_connect(*socket, serverEP, y)) {
+                bench.failures++;
+                return;
+            }
+
+            socket->set_option(tcp::no_delay(true), ec);
+            client.transmission = NewTransmission(bench, context, socket);
+            if (NULL == client.transmission || !client.transmission->HandshakeServer(y, ppp::auxiliary::StringAuxiliary::GuidStringToInt128(ppp::GuidToString(ppp::GuidGenerate())), true)) {
+                bench.failures++;
+                return;
+            }
+
+            client.handshake = Microseconds(started);
+            bench.handshakes++;
+        });
+}
+
+// Every completed write of the window issues the next one, so the write queue of the transmission always has frames to pack.
+static void ClientBulk(BenchmarkContext& bench, const ITransmissionPtr& transmission, const std::shared_ptr<Byte>& packet) noexcept {
+    if (bench.stop.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    bool ok = transmission->Write(packet.get(), bench.size,
+        [&bench, transmission, packet](bool ok) noexcept {
+            if (ok) {
+                ClientBulk(bench, transmission, packet);
+            }
+        });
+    if (!ok) {
+        bench.failures++;
+    }
+}
+
+static void ClientRequestResponse(BenchmarkContext& bench, const ContextPtr& context, BenchmarkClient& client, const std::shared_ptr<Byte>& packet) noexcept {
+    ITransmissionPtr transmission = client.transmission;
+    YieldContext::Spawn(*context,
+        [&bench, &client, transmission, packet](YieldContext& y) noexcept {
+            while (!bench.stop.load(std::memory_order_relaxed)) {
+                Clock::time_point started = Clock::now();
+                if (!transmission->Write(y, packet.get(), bench.size)) {
+                    break;
+                }
+
+                int packet_length = 0;
+                if (NULL == transmission->Read(y, packet_length)) {
+                    break;
+                }
+
+                if (!bench.stop.load(std::memory_order_relaxed)) {
+                    client.latencies.emplace_back(Microseconds(started));
+                }
+            }
+        });
+}
+
+static double CpuSeconds() noexcept {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+
+    return (double)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + (double)(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000000.0;
+}
+
+static uint32_t Percentile(const std::vector<uint32_t>& samples, double p) noexcept {
+    if (samples.empty()) {
+        return 0;
+    }
+
+    std::size_t index = (std::size_t)(p * (samples.size() - 1));
+    return samples[index];
+}
+
+static std::thread RunContext(const ContextPtr& context) noexcept {
+    return std::thread(
+        [context]() noexcept {
+            auto work = boost::asio::make_work_guard(*context);
+            boost::system::error_code ec;
+            context->run(ec);
+        });
+}
+
+int main(int argc, const char* argv[]) {
+    const char* config = "./appsettings.json";
+    const char* workload = "bulk";
+    int connections = 4;
+    int seconds = 5;
+
+    BenchmarkContext bench;
+    bench.carrier = "tcp";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--config") == 0) {
+            config = argv[i + 1];
+        }
+        elif(strcmp(argv[i], "--carrier") == 0) {
+            bench.carrier = argv[i + 1];
+        }
+        elif(strcmp(argv[i], "--workload") == 0) {
+            workload = argv[i + 1];
+        }
+        elif(strcmp(argv[i], "--connections") == 0) {
+            connections = std::max<int>(1, atoi(argv[i + 1]));
+        }
+        elif(strcmp(argv[i], "--seconds") == 0) {
+            seconds = std::max<int>(1, atoi(argv[i + 1]));
+        }
+        elif(strcmp(argv[i], "--size") == 0) {
+            bench.size = std::max<int>(1, std::min<int>(PPP_BUFFER_SIZE, atoi(argv[i + 1])));
+        }
+        else {
+            fprintf(stderr, "Usage: %s [--config appsettings.json] [--carrier tcp|ws|wss] [--workload bulk|rr] [--connections 4] [--seconds 5] [--size 1400]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (bench.carrier != "tcp" && bench.carrier != "ws" && bench.carrier != "wss") {
+        fprintf(stderr, "Unknown carrier: %s\n", bench.carrier.data());
+        return 1;
+    }
+
+    if (strcmp(workload, "bulk") != 0 && strcmp(workload, "rr") != 0) {
+        fprintf(stderr, "Unknown workload: %s\n", workload);
+        return 1;
+    }
+
+    ppp::global::cctor();
+
+    bench.rr = strcmp(workload, "rr") == 0;
+    bench.configuration = ppp::make_shared_object<AppConfiguration>();
+    if (NULL == bench.configuration || !bench.configuration->Load(config)) {
+        fprintf(stderr, "Unable to load the configuration: %s\n", config);
+        return 1;
+    }
+
+    // Both ends share one configuration, the loopback certificate is not issued for the configured host.
+    bench.configuration->websocket.ssl.verify_peer = false;
+
+    ContextPtr server_context = ppp::make_shared_object<boost::asio::io_context>();
+    ContextPtr client_context = ppp::make_shared_object<boost::asio::io_context>();
+
+    tcp::acceptor acceptor(*server_context, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    tcp::endpoint serverEP = acceptor.local_endpoint();
+
+    std::vector<ITransmissionPtr> servers;
+    std::vector<BenchmarkClient> clients(connections);
+    boost::asio::post(*server_context, [&]() noexcept { ServerAccept(bench, server_context, acceptor, servers); });
+
+    std::thread server_thread = RunContext(server_context);
+    std::thread client_thread = RunContext(client_context);
+
+    boost::asio::post(*client_context,
+        [&]() noexcept {
+            for (BenchmarkClient& client : clients) {
+                ClientHandshake(bench, client_context, client, serverEP);
+            }
+        });
+
+    Clock::time_point deadline = Clock::now() + std::chrono::seconds(10);
+    while (bench.handshakes + bench.failures < connections && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    int handshakes = bench.handshakes;
+    if (handshakes < connections) {
+        fprintf(stderr, "Only %d of %d handshakes completed.\n", handshakes, connections);
+        bench.stop = true;
+    }
+    else {
+        std::shared_ptr<Byte> packet = ppp::threading::BufferswapAllocator::MakeByteArray(NULL, bench.size);
+        memset(packet.get(), 'x', bench.size);
+
+        double cpu = CpuSeconds();
+        Clock::time_point started = Clock::now();
+        boost::asio::post(*client_context,
+            [&]() noexcept {
+                for (BenchmarkClient& client : clients) {
+                    if (bench.rr) {
+                        ClientRequestResponse(bench, client_context, client, packet);
+                        continue;
+                    }
+
+                    for (int i = 0; i < BULK_WINDOW; i++) {
+                        ClientBulk(bench, client.transmission, packet);
+                    }
+                }
+            });
+
+        std::this_thread::sleep_for(std::chrono::seconds(seconds));
+        bench.stop = true;
+
+        double elapsed = (double)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - started).count() / 1000000.0;
+        cpu = CpuSeconds() - cpu;
+
+        // rr moves every frame twice, once to the server and once back.
+        uint64_t frames = bench.frames.load();
+        uint64_t bytes = bench.bytes.load() * (bench.rr ? 2 : 1);
+
+        std::vector<uint32_t> handshake_latencies;
+        for (BenchmarkClient& client : clients) {
+            handshake_latencies.emplace_back(client.handshake);
+        }
+
+        std::sort(handshake_latencies.begin(), handshake_latencies.end());
+
+        printf("carrier=%s workload=%s connections=%d size=%d protocol=%s transport=%s seconds=%.3f frames=%llu bytes=%llu fps=%.0f mbps=%.2f cpu_s_per_gb=%.3f handshake_p50_us=%u handshake_max_us=%u",
+            bench.carrier.data(),
+            workload,
+            connections,
+            bench.size,
+            bench.configuration->key.protocol.data(),
+            bench.configuration->key.transport.data(),
+            elapsed,
+            (unsigned long long)frames,
+            (unsigned long long)bytes,
+            (double)frames / elapsed,
+            (double)bytes * 8 / elapsed / 1000000.0,
+            bytes > 0 ? cpu / ((double)bytes / 1000000000.0) : 0,
+            Percentile(handshake_latencies, 0.50),
+            Percentile(handshake_latencies, 1.00));
+    }
+
+    // The transmissions are closed on their own executors before those stop, their pending operations complete as cancelled.
+    boost::asio::post(*client_context,
+        [&]() noexcept {
+            for (BenchmarkClient& client : clients) {
+                if (NULL != client.transmission) {
+                    client.transmission->Dispose();
+                }
+            }
+        });
+    boost::asio::post(*server_context,
+        [&]() noexcept {
+            boost::system::error_code ec;
+            acceptor.close(ec);
+            for (ITransmissionPtr& transmission : servers) {
+                transmission->Dispose();
+            }
+        });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    client_context->stop();
+    server_context->stop();
+    client_thread.join();
+    server_thread.join();
+
+    if (handshakes < connections) {
+        return 1;
+    }
+
+    if (bench.rr) {
+        std::vector<uint32_t> latencies;
+        for (BenchmarkClient& client : clients) {
+            latencies.insert(latencies.end(), client.latencies.begin(), client.latencies.end());
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+        printf(" rtt_p50_us=%u rtt_p90_us=%u rtt_p99_us=%u", Percentile(latencies, 0.50), Percentile(latencies, 0.90), Percentile(latencies, 0.99));
+    }
+
+    printf(" failures=%d\n", bench.failures.load());
+    fflush(stdout);
+    return 0;
+}
@@ -6,6 +6,7 @@
 #include <lwip/udp.h>
 #include <lwip/sys.h>
 #include <lwip/timeouts.h>
+#include <lwip/pbuf.h>
 #include <lwip/priv/tcp_priv.h>
 
 #ifdef _WIN32
@@ -54,14 +55,15 @@ namespace lwip {
     public:
         typedef enum {
             ENETSTACK_TCP_SENT_LWIP,
-            ENETSTACK_TCP_SENT_SOCK,
             ENETSTACK_TCP_SENT_MAX
         }                                               ENETSTACK_TCP_SENT_BUFS;
 
     public:
         ppp::list<send_context_ptr>                     sents[ENETSTACK_TCP_SENT_MAX];
+        ppp::list<struct pbuf*>                         recvs;
         std::shared_ptr<boost::asio::ip::tcp::socket>   socket;
         bool                                            open;
+        bool                                            writing;
         int                                             pnat;
 
     public:
@@ -70,7 +72,7 @@ namespace lwip {
         u16_t                                           local_port;
         ip_addr_t                                       remote_ip;
         u16_t                                           remote_port;
-        u8_t                                            buf[1400];
+        u8_t                                            buf[TCP_MSS << 2];
 
     public:
         netstack_tcp_socket() noexcept;
@@ -90,6 +92,7 @@ namespace lwip {
     uint32_t                                            netstack::MASK        = 0;
     int                                                 netstack::Localhost   = 0;
     std::shared_ptr<boost::asio::io_context>            netstack::Executor;
+    std::shared_ptr<ppp::threading::BufferswapAllocator> netstack::Allocator;
 
     static std::shared_ptr<boost::asio::deadline_timer> timeout_;
     static struct netif*                                netif_              = NULL;
@@ -105,7 +108,8 @@ namespace lwip {
 
     static bool                                         netstack_socket_connect(const std::shared_ptr<netstack_tcp_socket>& socket_, const boost::asio::ip::tcp::endpoint& remoteEP_) noexcept;
     static bool                                         netstack_tunnel_open(const std::shared_ptr<netstack_tcp_socket>& socket_, boost::asio::ip::tcp::endpoint& remoteEP_) noexcept;
-    static bool                                         netstack_tunnel_send(const std::shared_ptr<netstack_tcp_socket>& socket_, void* data, int len, bool unsafe_) noexcept;
+    static bool                                         netstack_tunnel_send(const std::shared_ptr<netstack_tcp_socket>& socket_, struct pbuf* p) noexcept;
+    static bool                                         netstack_tunnel_dowrite(const std::shared_ptr<netstack_tcp_socket>& socket_) noexcept;
     static err_t                                        netstack_tcp_closesocket(struct tcp_pcb* pcb) noexcept;
     static bool                                         netstack_tcp_closesocket(netstack_tcp_socket* socket_) noexcept;
     static inline bool                                  netstack_tcp_closesocket(const std::shared_ptr<netstack_tcp_socket>& socket_) noexcept { return netstack_tcp_closesocket(socket_.get()); }
@@ -306,6 +310,12 @@ namespace lwip {
             sents.clear();
         }
 
+        for (struct pbuf* p : socket_->recvs) {
+            pbuf_free(p);
+        }
+
+        socket_->recvs.clear();
+
         netstack_tcp_releasesocket(socket_->pnat);
         netstack_tcp_closesocket(pcb);
 
@@ -351,6 +361,7 @@ namespace lwip {
 
     netstack_tcp_socket::netstack_tcp_socket() noexcept
         : open(false)
+        , writing(false)
         , pnat(ppp::net::IPEndPoint::MinPort)
         , pcb(NULL)
         , local_ip(netstack_ip_addr_v4_any())
@@ -364,13 +375,47 @@ namespace lwip {
         netstack_tcp_closesocket(this);
     }
 
+    struct netstack_pbuf_custom final {
+        struct pbuf_custom                                      p;
+        std::shared_ptr<ppp::threading::BufferswapAllocator>    allocator;
+    };
+
+    static void netstack_pbuf_custom_free(struct pbuf* p) noexcept {
+        netstack_pbuf_custom* custom = (netstack_pbuf_custom*)p;
+        std::shared_ptr<ppp::threading::BufferswapAllocator> allocator = std::move(custom->allocator);
+
+        custom->~netstack_pbuf_custom();
+        allocator->Free(custom);
+    }
+
     struct pbuf* netstack_pbuf_alloc(uint16_t len) noexcept {
         if (!len) {
             return NULL;
         }
-        else {
-            return pbuf_alloc(PBUF_RAW, len, PBUF_RAM);
+
+        // Packets are carved out of the swap allocator's fixed pool when one is configured, 
+        // So queued segments are bounded by the pool instead of growing the process heap.
+        std::shared_ptr<ppp::threading::BufferswapAllocator> allocator = netstack::Allocator;
+        if (allocator) {
+            static constexpr int custom_size = LWIP_MEM_ALIGN_SIZE(sizeof(netstack_pbuf_custom));
+
+            void* memory = allocator->Alloc(custom_size + len);
+            if (memory) {
+                netstack_pbuf_custom* custom = new (memory) netstack_pbuf_custom();
+                custom->allocator = allocator;
+                custom->p.custom_free_function = netstack_pbuf_custom_free;
+
+                struct pbuf* p = pbuf_alloced_custom(PBUF_RAW, len, PBUF_REF, &custom->p, (u8_t*)memory + custom_size, len);
+                if (p) {
+                    return p;
+                }
+
+                custom->~netstack_pbuf_custom();
+                allocator->Free(memory);
+            }
         }
+
+        return pbuf_alloc(PBUF_RAW, len, PBUF_RAM);
     }
 
     void netstack_pbuf_free(struct pbuf* buf) noexcept {
@@ -383,20 +428,11 @@ namespace lwip {
         LWIP_UNUSED_ARG(arg);
 
         while (p) {
-            if (p->len > 0) {
+            if (p->tot_len > 0) {
                 std::shared_ptr<netstack_tcp_socket> socket = netstack_tcp_getsocket(pcb->callback_arg);
                 if (socket) {
-                    bool ok = true;
-                    for (struct pbuf* q = p; q; q = q->next) {
-                        bool sent = netstack_tunnel_send(socket, q->payload, q->len, true);
-                        if (!sent) {
-                            ok = false;
-                            break;
-                        }
-                    }
-
-                    if (ok) {
-                        netstack_pbuf_free(p);
+                    // The chain is handed over as is and released once the socket has written it.
+                    if (netstack_tunnel_send(socket, p)) {
                         return ERR_OK;
                     }
                 }
@@ -485,6 +521,7 @@ namespace lwip {
         socket_->pcb = pcb;
         socket_->pnat = ppp::net::IPEndPoint::MinPort;
         socket_->open = false;
+        socket_->writing = false;
         socket_->socket = socket;
         socket_->local_ip = pcb->remote_ip;
         socket_->local_port = pcb->remote_port;
@@ -511,8 +548,8 @@ namespace lwip {
         }
     }
 
-    static bool netstack_tunnel_send(const std::shared_ptr<netstack_tcp_socket>& socket_, void* data, int len, bool unsafe_) noexcept {
-        if (!socket_ || !data || len < 1) {
+    static bool netstack_tunnel_send(const std::shared_ptr<netstack_tcp_socket>& socket_, struct pbuf* p) noexcept {
+        if (!socket_ || !p) {
             return false;
         }
 
@@ -520,45 +557,52 @@ namespace lwip {
         if (!socket || !socket->is_open()) {
             return false;
         }
-        
-        if (!socket_->open) {
-            std::shared_ptr<char> chunk_ = std::shared_ptr<char>((char*)lwip_netstack_malloc(len), lwip_netstack_free);
-            if (!chunk_) {
-                return false;
-            }
 
-            netstack_tcp_socket::send_context_ptr context =
-                ppp::make_shared_object<netstack_tcp_socket::send_context>();
-            if (!context) {
-                return false;
-            }
-            else {
-                memcpy(chunk_.get(), data, len);
-            }
-
-            context->buf.p = std::move(chunk_);
-            context->buf.sz = len;
+        // Nothing is acknowledged to lwip before it has been written, so the queue never outgrows the receive window.
+        socket_->recvs.emplace_back(p);
+        if (!socket_->open || socket_->writing) {
+            return true;
+        }
 
-            socket_->sents[netstack_tcp_socket::ENETSTACK_TCP_SENT_SOCK].emplace_back(std::move(context));
+        if (netstack_tunnel_dowrite(socket_)) {
             return true;
         }
 
-        std::shared_ptr<char> chunk_;
-        if (unsafe_) {
-            chunk_ = std::shared_ptr<char>((char*)lwip_netstack_malloc(len), lwip_netstack_free);
-            if (!chunk_) {
-                return false;
-            }
+        socket_->recvs.pop_back();
+        return false;
+    }
+
+    static bool netstack_tunnel_dowrite(const std::shared_ptr<netstack_tcp_socket>& socket_) noexcept {
+        std::shared_ptr<boost::asio::ip::tcp::socket>& socket = socket_->socket;
+        if (!socket || !socket->is_open()) {
+            return false;
+        }
 
-            memcpy(chunk_.get(), data, len);
+        ppp::list<struct pbuf*> pbufs = std::move(socket_->recvs);
+        socket_->recvs.clear();
+        if (pbufs.empty()) {
+            return true;
         }
-        else {
-            chunk_ = *(std::shared_ptr<char>*)data;
+
+        ppp::vector<boost::asio::const_buffer> buffers;
+        for (struct pbuf* p : pbufs) {
+            for (struct pbuf* q = p; q; q = q->next) {
+                if (q->len > 0) {
+                    buffers.emplace_back(q->payload, q->len);
+                }
+            }
         }
 
+        // All queued segments go out in a single gather write.
         std::shared_ptr<netstack_tcp_socket> socket__ = socket_;
-        boost::asio::async_write(*socket, boost::asio::buffer(chunk_.get(), len), 
-            [socket__, chunk_](const boost::system::error_code& ec, size_t sz) noexcept {
+        socket_->writing = true;
+        boost::asio::async_write(*socket, buffers, 
+            [socket__, pbufs](const boost::system::error_code& ec, size_t sz) noexcept {
+                for (struct pbuf* p : pbufs) {
+                    pbuf_free(p);
+                }
+
+                socket__->writing = false;
                 if (ec == boost::system::errc::success) {
                     struct tcp_pcb* pcb = socket__->pcb;
                     if (NULL != pcb) {
@@ -576,10 +620,13 @@ namespace lwip {
                             tcp_recved(pcb, len);
                         }
                     }
+
+                    if (netstack_tunnel_dowrite(socket__)) {
+                        return;
+                    }
                 }
-                else {
-                    netstack_tcp_closesocket(socket__);
-                }
+
+                netstack_tcp_closesocket(socket__);
             });
         return true;
     }
@@ -594,8 +641,14 @@ namespace lwip {
             return false;
         }
 
+        // Reads are sized to what the pcb can take right now, which keeps tcp_write off the copy-and-queue path.
+        int max_read = sizeof(socket_->buf);
+        if (struct tcp_pcb* pcb = socket_->pcb; NULL != pcb) {
+            max_read = std::max<int>(TCP_MSS, std::min<int>(max_read, tcp_sndbuf(pcb)));
+        }
+
         std::shared_ptr<netstack_tcp_socket> socket__ = socket_;
-        socket->async_read_some(boost::asio::buffer(socket_->buf, sizeof(socket_->buf)), 
+        socket->async_read_some(boost::asio::buffer(socket_->buf, max_read), 
             [socket__](const boost::system::error_code& ec, size_t sz) noexcept {
                 int by = std::max<int>(-1, ec ? -1 : (int)sz);
                 if (by < 1) {
@@ -616,14 +669,11 @@ namespace lwip {
             return false;
         }
 
-        ppp::list<netstack_tcp_socket::send_context_ptr>& sents = socket_->sents[netstack_tcp_socket::ENETSTACK_TCP_SENT_SOCK];
-        while (!sents.empty()) {
-            netstack_tcp_socket::send_context_ptr context = sents.front();
-            sents.pop_front();
-
-            netstack_tunnel_send(socket_, std::addressof(context->buf.p), context->buf.sz, false);
+        if (socket_->writing) {
+            return true;
         }
-        return true;
+
+        return netstack_tunnel_dowrite(socket_);
     }
 
     static bool netstack_socket_connect(const std::shared_ptr<netstack_tcp_socket>& socket_, const boost::asio::ip::tcp::endpoint& remoteEP_) noexcept {
@@ -2,6 +2,7 @@
 
 #include <ppp/stdafx.h>
 #include <ppp/threading/Executors.h>
+#include <ppp/threading/BufferswapAllocator.h>
 
 struct pbuf;
 
@@ -26,6 +27,8 @@ namespace lwip {
 
     public:
         static std::shared_ptr<boost::asio::io_context>     Executor;
+        static std::shared_ptr<ppp::threading::BufferswapAllocator> 
+                                                            Allocator;
 
     public:
         static bool                                         input(const void* packet, int size) noexcept;
@@ -85,7 +85,15 @@
 #define TCP_MSS 1460
 #endif
 
-#define TCP_WND 32 * 1024
+// A 64K window does not fit the unscaled 16-bit window field, the scale factor of 1 lets it be advertised in full. 
+// Out-of-order data received from the tun is reported with SACK blocks, so a SACK capable peer only has to resend the holes, 
+// lwIP itself only sends SACK options and its own retransmissions ignore the SACK blocks it receives.
+#define LWIP_WND_SCALE 1
+#define TCP_RCV_SCALE 1
+#define LWIP_TCP_SACK_OUT 1
+#define LWIP_TCP_MAX_SACK_NUM 4
+
+#define TCP_WND 64 * 1024
 #define TCP_SND_BUF (TCP_WND)
 
 #define MEM_LIBC_MALLOC 1
@@ -0,0 +1,29 @@
+#include <ppp/stdafx.h>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+// Replays the inputs named on the command line through a fuzz target, for compilers without libFuzzer.
+int main(int argc, const char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        FILE* file = fopen(argv[i], "rb");
+        if (NULL == file) {
+            fprintf(stderr, "%s: cannot open\n", argv[i]);
+            return 1;
+        }
+
+        ppp::vector<uint8_t> input;
+        uint8_t buffer[4096];
+        for (size_t n; (n = fread(buffer, 1, sizeof(buffer), file)) > 0;) {
+            input.insert(input.end(), buffer, buffer + n);
+        }
+
+        fclose(file);
+
+        // Copy into an allocation of exactly the input size so that the sanitizers catch reads past its end.
+        uint8_t* data = (uint8_t*)malloc(std::max<size_t>(1, input.size()));
+        memcpy(data, input.data(), input.size());
+        LLVMFuzzerTestOneInput(data, input.size());
+        free(data);
+    }
+    return 0;
+}
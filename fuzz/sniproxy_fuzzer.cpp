@@ -0,0 +1,59 @@
+#include <ppp/net/proxies/sniproxy.h>
+
+using ppp::Byte;
+using ppp::net::proxies::sniproxy;
+
+static constexpr int FORWARD_MSS = 65536;
+
+static void CheckWithin(const void* p, int length, const void* begin, int size) noexcept {
+    if (NULL != p && ((const Byte*)p < (const Byte*)begin || (const Byte*)p + length > (const Byte*)begin + size)) {
+        abort();
+    }
+}
+
+// Drives the first flight parsers the way do_tlsvd_handshake and do_httpd_handshake do. The input is delivered in two reads split
+// at a position taken from its first byte, so record and header boundaries also land across reads.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size < 2 || size > FORWARD_MSS) {
+        return 0;
+    }
+
+    int length = (int)size - 1;
+    const Byte* packet = data + 1;
+    int split = data[0] * length / 255;
+
+    static Byte handshake[FORWARD_MSS];
+    int packet_offset = 0;
+    int handshake_length = 0;
+    for (int received = split;; received = length) {
+        int handshake_size = sniproxy::tls_reassemble_client_hello(packet, received, packet_offset, handshake, FORWARD_MSS, handshake_length);
+        if (handshake_size > 0) {
+            sniproxy::tls_client_hello hello;
+            if (sniproxy::tls_fetch_client_hello(handshake, handshake_size, hello)) {
+                CheckWithin(hello.sni, hello.sni_length, handshake, handshake_size);
+                CheckWithin(hello.alpn, hello.alpn_length, handshake, handshake_size);
+                sniproxy::be_host("www.example.com", hello.sni, hello.sni_length);
+            }
+            break;
+        }
+        elif(handshake_size < 0 || received == length) {
+            break;
+        }
+    }
+
+    const char* headers = (const char*)packet;
+    int headers_size = sniproxy::http_fetch_headers_end(headers, split, 0);
+    if (headers_size < 0) {
+        headers_size = sniproxy::http_fetch_headers_end(headers, length, split);
+    }
+
+    if (headers_size > 0) {
+        int port;
+        int host_length;
+        const char* host;
+        if (sniproxy::http_fetch_host(headers, headers_size, host, host_length, port)) {
+            CheckWithin(host, host_length, headers, headers_size);
+        }
+    }
+    return 0;
+}
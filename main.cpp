@@ -7,6 +7,7 @@
 #include <ppp/auxiliary/StringAuxiliary.h>
 #include <ppp/diagnostics/Stopwatch.h>
 #include <ppp/diagnostics/PreventReturn.h>
+#include <ppp/diagnostics/Metrics.h>
 #include <ppp/threading/Timer.h>
 #include <ppp/threading/Thread.h>
 #include <ppp/threading/Executors.h>
@@ -51,6 +52,7 @@ using ppp::app::server::VirtualEthernetSwitcher;
 using ppp::app::client::VEthernetNetworkSwitcher;
 using ppp::app::client::VEthernetExchanger;
 using ppp::app::client::http::VEthernetHttpProxySwitcher;
+using ppp::app::client::socks::VEthernetSocksProxySwitcher;
 using ppp::Int128;
 
 struct NetworkInterface final
@@ -391,6 +393,23 @@ bool PppApplication::PrintEnvironmentInformation() noexcept
             printfn("P/A Controller        : %s", client->GetPaperAirplaneController() ? "on" : "off");
 #endif
         }
+
+        // Print the information related to the socks proxy server tab.
+        if (std::shared_ptr<VEthernetSocksProxySwitcher> socks_proxy = client->GetSocksProxy(); NULL != socks_proxy)
+        {
+            boost::asio::ip::tcp::endpoint localEP = socks_proxy->GetLocalEndPoint();
+            boost::asio::ip::address localIP = localEP.address();
+            if (localIP.is_unspecified())
+            {
+                if (auto ni = client->GetUnderlyingNetowrkInterface(); NULL != ni)
+                {
+                    localIP = ni->IPAddress;
+                }
+            }
+
+            ppp::string address_string = IPEndPoint::ToEndPoint(boost::asio::ip::tcp::endpoint(localIP, localEP.port())).ToString();
+            printfn("Socks Proxy           : %s/socks", address_string.data());
+        }
     }
 
     // Print some display information of the current virtual ethernet server!
@@ -406,11 +425,12 @@ bool PppApplication::PrintEnvironmentInformation() noexcept
         }
 
         // Displays the port numbers of various server public service addresses that are currently monitored.
-        const char* categories[] = { "ppp+tcp", "ppp+udp", "ppp+ws", "ppp+wss", "cdn+1", "cdn+2" };
+        const char* categories[] = { "ppp+tcp", "ppp+udp", "ppp+rudp", "ppp+ws", "ppp+wss", "cdn+1", "cdn+2" };
         VirtualEthernetSwitcher::NetworkAcceptorCategories categoriess[] = 
         { 
             NAC::NetworkAcceptorCategories_Tcpip, 
             NAC::NetworkAcceptorCategories_Udpip, 
+            NAC::NetworkAcceptorCategories_ReliableUdp, 
             NAC::NetworkAcceptorCategories_WebSocket, 
             NAC::NetworkAcceptorCategories_WebSocketSSL,
             NAC::NetworkAcceptorCategories_CDN1,
@@ -434,6 +454,12 @@ bool PppApplication::PrintEnvironmentInformation() noexcept
         }
     }
 
+    // Displays the local http endpoint that exposes the process metrics when it is enabled.
+    if (boost::asio::ip::tcp::endpoint metricsEP = ppp::diagnostics::Metrics::GetLocalEndPoint(); metricsEP.port() != IPEndPoint::MinPort)
+    {
+        printfn("Metrics               : %s/metrics", IPEndPoint::ToEndPoint(metricsEP).ToString().data());
+    }
+
     // Displays the current host environment type, in effect marking whether it is a released product or a development debug release.
     printfn("Hosting Environment   : %s", hosting_environment.data());
 
@@ -730,6 +756,15 @@ bool PppApplication::PreparedLoopbackEnvironment(const std::shared_ptr<NetworkIn
             }
         }
     }
+
+    // The metrics endpoint only observes the switchers, failing to open it does not fail the vpn.
+    if (success && configuration->metrics.port != IPEndPoint::MinPort)
+    {
+        if (!ppp::diagnostics::Metrics::Open(context, configuration->metrics.bind, configuration->metrics.port))
+        {
+            fprintf(stdout, "%s\r\n", "Listen to metrics endpoint failure.");
+        }
+    }
     return success;
 }
 
@@ -1066,6 +1101,8 @@ void PppApplication::Dispose() noexcept
         server->Dispose();
     }
 
+    ppp::diagnostics::Metrics::Close();
+
     std::shared_ptr<VEthernetNetworkSwitcher> client = std::move(client_);
     if (NULL != client)
     {
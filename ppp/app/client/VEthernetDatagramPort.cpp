@@ -188,6 +188,42 @@ namespace ppp {
                 return ok;
             }
 
+            bool VEthernetDatagramPort::SendTo(const void* packet, int packet_length, const ppp::string& hostname, int port) noexcept {
+                if (NULL == packet || packet_length < 1 || hostname.empty()) {
+                    return false;
+                }
+
+                if (disposed_) {
+                    return false;
+                }
+
+                if (port <= IPEndPoint::MinPort || port > IPEndPoint::MaxPort) {
+                    return false;
+                }
+
+                // A destination given by name is always resolved by the VPN server, it never leaves through the local physical NIC.
+                std::shared_ptr<ITransmission> transmission = transmission_;
+                if (NULL == transmission) {
+                    Dispose();
+                    return false;
+                }
+
+                bool ok = exchanger_->DoSendTo(transmission, sourceEP_, hostname, port, (Byte*)packet, packet_length, nullof<YieldContext>());
+                if (!ok) {
+                    transmission->Dispose();
+                    Dispose();
+                    return false;
+                }
+
+                sendto_ = true;
+                if (port != PPP_DNS_SYS_PORT) {
+                    onlydns_ = false;
+                }
+
+                Update();
+                return true;
+            }
+
             std::shared_ptr<VEthernetDatagramPort> VEthernetDatagramPort::GetReference() noexcept {
                 return shared_from_this();
             }
@@ -209,6 +245,11 @@ namespace ppp {
             }
 
             void VEthernetDatagramPort::OnMessage(void* packet, int packet_length, const boost::asio::ip::udp::endpoint& destinationEP) noexcept {
+                if (MessageEvent) {
+                    MessageEvent(this, packet, packet_length, destinationEP);
+                    return;
+                }
+
                 std::shared_ptr<VEthernetExchanger> exchanger = exchanger_;
                 if (exchanger) {
                     switcher_->DatagramOutput(sourceEP_, destinationEP, packet, packet_length);
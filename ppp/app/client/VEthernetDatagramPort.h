@@ -30,6 +30,8 @@ namespace ppp {
                 typedef std::lock_guard<SynchronizedObject>             SynchronizedObjectScope;
                 typedef std::shared_ptr<VEthernetExchanger>             VEthernetExchangerPtr;
                 typedef std::shared_ptr<VEthernetNetworkSwitcher>       VEthernetNetworkSwitcherPtr;
+                typedef ppp::function<void(VEthernetDatagramPort*, void*, int, const boost::asio::ip::udp::endpoint&)>   
+                                                                        MessageEventHandler;
 
 #if defined(_ANDROID)
             public:
@@ -45,6 +47,10 @@ namespace ppp {
                 ProtectorNetworkPtr                                     ProtectorNetwork;
 #endif
 
+            public:
+                /* Receives the replies of this port instead of the virtual network adapter, it is only assigned before the port is published. */
+                MessageEventHandler                                     MessageEvent;
+
             public:
                 VEthernetDatagramPort(const VEthernetExchangerPtr& exchanger, const ITransmissionPtr& transmission, const boost::asio::ip::udp::endpoint& sourceEP) noexcept;
                 virtual ~VEthernetDatagramPort() noexcept;
@@ -60,6 +66,7 @@ namespace ppp {
                 bool                                                    IsPortAging(UInt64 now) noexcept { return disposed_ || now >= timeout_; }
                 virtual void                                            Dispose() noexcept;
                 virtual bool                                            SendTo(const void* packet, int packet_length, const boost::asio::ip::udp::endpoint& destinationEP) noexcept;
+                virtual bool                                            SendTo(const void* packet, int packet_length, const ppp::string& hostname, int port) noexcept;
 
 #if defined(_ANDROID)
             public:  
@@ -17,10 +17,12 @@
 #include <ppp/coroutines/YieldContext.h>
 #include <ppp/transmissions/ITransmission.h>
 #include <ppp/transmissions/ITcpipTransmission.h>
+#include <ppp/transmissions/IReliableUdpTransmission.h>
 #include <ppp/transmissions/IWebsocketTransmission.h>
 
 typedef ppp::app::protocol::VirtualEthernetInformation              VirtualEthernetInformation;
 typedef ppp::app::protocol::VirtualEthernetPacket                   VirtualEthernetPacket;
+typedef ppp::app::protocol::VirtualEthernetFec                      VirtualEthernetFec;
 typedef ppp::collections::Dictionary                                Dictionary;
 typedef ppp::auxiliary::StringAuxiliary                             StringAuxiliary;
 typedef ppp::net::AddressFamily                                     AddressFamily;
@@ -31,6 +33,7 @@ typedef ppp::threading::Timer                                       Timer;
 typedef ppp::threading::Executors                                   Executors;
 typedef ppp::transmissions::ITransmission                           ITransmission;
 typedef ppp::transmissions::ITcpipTransmission                      ITcpipTransmission;
+typedef ppp::transmissions::IReliableUdpTransmission                IReliableUdpTransmission;
 typedef ppp::transmissions::IWebsocketTransmission                  IWebsocketTransmission;
 typedef ppp::transmissions::ISslWebsocketTransmission               ISslWebsocketTransmission;
 
@@ -268,6 +271,10 @@ namespace ppp {
                     return NULL;
                 }
 
+                if (protocol_type == ProtocolType::ProtocolType_ReliableUdp) {
+                    return OpenReliableUdpTransmission(context, strand, remoteEP, y);
+                }
+
                 std::shared_ptr<boost::asio::ip::tcp::socket> socket = NewAsynchronousSocket(context, strand, remoteEP.protocol(), y);
                 if (!socket) {
                     return NULL;
@@ -295,6 +302,59 @@ namespace ppp {
                 return NewTransmission(context, strand, socket, protocol_type, hostname, path);
             }
 
+            VEthernetExchanger::ITransmissionPtr VEthernetExchanger::OpenReliableUdpTransmission(const ContextPtr& context, const StrandPtr& strand, const boost::asio::ip::tcp::endpoint& remoteEP, YieldContext& y) noexcept {
+                if (disposed_ || !context) {
+                    return NULL;
+                }
+
+                std::shared_ptr<ppp::configurations::AppConfiguration> configuration = GetConfiguration();
+                if (!configuration) {
+                    return NULL;
+                }
+
+                std::shared_ptr<boost::asio::ip::udp::socket> socket = strand ?
+                    make_shared_object<boost::asio::ip::udp::socket>(*strand) : make_shared_object<boost::asio::ip::udp::socket>(*context);
+                if (!socket) {
+                    return NULL;
+                }
+
+                boost::asio::ip::address remoteIP = remoteEP.address();
+                boost::asio::ip::address localIP = remoteIP.is_v4() ? 
+                    boost::asio::ip::address(boost::asio::ip::address_v4::any()) : boost::asio::ip::address(boost::asio::ip::address_v6::any());
+                if (!Socket::OpenSocket(*socket, localIP, IPEndPoint::MinPort)) {
+                    return NULL;
+                }
+
+#if defined(_LINUX)
+                // The datagrams of the carrier must leave through the physical adapter, exactly like the tcp carriers.
+                if (remoteIP.is_v4() && !remoteIP.is_loopback()) {
+                    auto protector_network = switcher_->GetProtectorNetwork(); 
+                    if (NULL != protector_network) {
+                        if (!protector_network->Protect(socket->native_handle(), y)) {
+                            Socket::Closesocket(socket);
+                            return NULL;
+                        }
+                    }
+                }
+#endif
+
+                boost::asio::ip::udp::endpoint serverEP(remoteIP, remoteEP.port());
+                std::shared_ptr<IReliableUdpTransmission> transmission = make_shared_object<IReliableUdpTransmission>(context, strand, socket, serverEP, IReliableUdpTransmission::NewConversation(), configuration);
+                if (NULL == transmission) {
+                    Socket::Closesocket(socket);
+                    return NULL;
+                }
+
+                transmission->QoS = switcher_->GetQoS();
+                transmission->Statistics = switcher_->GetStatistics();
+                if (!transmission->Open()) {
+                    transmission->Dispose();
+                    return NULL;
+                }
+
+                return transmission;
+            }
+
             bool VEthernetExchanger::Open() noexcept {
                 if (disposed_) {
                     return false;
@@ -576,11 +636,11 @@ namespace ppp {
                 return false; // Immediate return false and forcefully close the connection due to a suspected malicious attack on the client.
             }
 
-            bool VEthernetExchanger::OnStatic(const ITransmissionPtr& transmission, YieldContext& y) noexcept {
+            bool VEthernetExchanger::OnStatic(const ITransmissionPtr& transmission, int fec, YieldContext& y) noexcept {
                 return false; // Immediate return false and forcefully close the connection due to a suspected malicious attack on the client.
             }
 
-            bool VEthernetExchanger::OnStatic(const ITransmissionPtr& transmission, int session_id, int remote_port, YieldContext& y) noexcept {                
+            bool VEthernetExchanger::OnStatic(const ITransmissionPtr& transmission, int session_id, int remote_port, int fec, YieldContext& y) noexcept {                
                 if (remote_port < IPEndPoint::MinPort || remote_port > IPEndPoint::MaxPort) {
                     return false;
                 }
@@ -594,6 +654,10 @@ namespace ppp {
                     StaticEchoClean();
                 }
                 else {
+                    std::shared_ptr<ppp::configurations::AppConfiguration> configuration = GetConfiguration();
+                    int group_size = VirtualEthernetFec::Negotiate(configuration->udp.static_.fec, fec);
+
+                    static_echo_fec_ = group_size > 0 ? make_shared_object<VirtualEthernetFec>(group_size) : NULL;
                     static_echo_session_id_ = session_id;
                     static_echo_remote_port_ = remote_port;
                 }
@@ -653,7 +717,7 @@ namespace ppp {
                     return false;
                 }
 
-                VEthernetDatagramPortPtr datagram = AddNewDatagramPort(transmission, sourceEP);
+                VEthernetDatagramPortPtr datagram = AddNewDatagramPort(transmission, sourceEP, NULL);
                 if (NULL == datagram) {
                     return false;
                 }
@@ -661,6 +725,19 @@ namespace ppp {
                 return datagram->SendTo(packet, packet_size, destinationEP);
             }
 
+            VEthernetExchanger::VEthernetDatagramPortPtr VEthernetExchanger::OpenDatagramPort(const boost::asio::ip::udp::endpoint& sourceEP, const DatagramMessageEventHandler& message_event) noexcept {
+                if (disposed_) {
+                    return NULL;
+                }
+
+                ITransmissionPtr transmission = transmission_;
+                if (NULL == transmission) {
+                    return NULL;
+                }
+
+                return AddNewDatagramPort(transmission, sourceEP, message_event);
+            }
+
             bool VEthernetExchanger::Echo(int ack_id) noexcept {
                 if (disposed_) {
                     return false;
@@ -755,7 +832,7 @@ namespace ppp {
                 return transmission_;
             }
 
-            VEthernetExchanger::VEthernetDatagramPortPtr VEthernetExchanger::AddNewDatagramPort(const ITransmissionPtr& transmission, const boost::asio::ip::udp::endpoint& sourceEP) noexcept {
+            VEthernetExchanger::VEthernetDatagramPortPtr VEthernetExchanger::AddNewDatagramPort(const ITransmissionPtr& transmission, const boost::asio::ip::udp::endpoint& sourceEP, const DatagramMessageEventHandler& message_event) noexcept {
                 if (NULL == transmission) {
                     return NULL;
                 }
@@ -776,6 +853,8 @@ namespace ppp {
                     return NULL;
                 }
                 else {
+                    datagram->MessageEvent = message_event;
+
                     SynchronizedObjectScope scope(syncobj_);
                     auto r = datagrams_.emplace(sourceEP, datagram);
                     ok = r.second;
@@ -993,6 +1072,7 @@ namespace ppp {
                     Socket::Closesocket(socket);
                 }
 
+                static_echo_fec_.reset();
                 static_echo_input_       = false;
                 static_echo_timeout_     = UINT64_MAX;
                 static_echo_session_id_  = 0;
@@ -1152,7 +1232,8 @@ namespace ppp {
                     return false;
                 }
 
-                return DoStatic(transmission, y);
+                std::shared_ptr<ppp::configurations::AppConfiguration> configuration = GetConfiguration();
+                return DoStatic(transmission, configuration->udp.static_.fec, y);
             }
 
             bool VEthernetExchanger::StaticEchoNextTimeout() noexcept {
@@ -1290,8 +1371,11 @@ namespace ppp {
                 std::shared_ptr<ppp::transmissions::ITransmissionStatistics> statistics = switcher_->GetStatistics();
                 boost::asio::ip::udp::endpoint serverEP = StaticEchoGetRemoteEndPoint();
 
+                int parity_length = 0;
+                std::shared_ptr<Byte> parity = StaticEchoParityToRemoteExchanger(packet, packet_length, parity_length);
+
                 boost::asio::dispatch(socket->get_executor(),
-                    [statistics, socket, packet, packet_length, serverEP]() noexcept {
+                    [statistics, socket, packet, packet_length, parity, parity_length, serverEP]() noexcept {
                         boost::system::error_code ec;
                         socket->send_to(boost::asio::buffer(packet.get(), packet_length), serverEP, 
                             boost::asio::socket_base::message_end_of_record, ec);
@@ -1301,10 +1385,43 @@ namespace ppp {
                                 statistics->AddOutgoingTraffic(packet_length);
                             }
                         }
+
+                        // The parity closes its group, send it right behind the last datagram it covers.
+                        if (NULL != parity) {
+                            socket->send_to(boost::asio::buffer(parity.get(), parity_length), serverEP,
+                                boost::asio::socket_base::message_end_of_record, ec);
+
+                            if (ec == boost::system::errc::success) {
+                                if (NULL != statistics) {
+                                    statistics->AddOutgoingTraffic(parity_length);
+                                }
+                            }
+                        }
                     });
                 return true;
             }
 
+            std::shared_ptr<Byte> VEthernetExchanger::StaticEchoParityToRemoteExchanger(const std::shared_ptr<Byte>& packet, int packet_length, int& parity_length) noexcept {
+                parity_length = 0;
+
+                std::shared_ptr<VirtualEthernetFec> fec = static_echo_fec_;
+                if (NULL == fec) {
+                    return NULL;
+                }
+
+                std::shared_ptr<ppp::configurations::AppConfiguration> configuration = GetConfiguration();
+                std::shared_ptr<ppp::threading::BufferswapAllocator> allocator = configuration->GetBufferAllocator();
+
+                int messages_length = 0;
+                std::shared_ptr<Byte> messages = fec->Encode(allocator, packet.get(), packet_length, messages_length);
+                if (NULL == messages) {
+                    return NULL;
+                }
+
+                return VirtualEthernetPacket::PackParity(configuration, allocator,
+                    static_echo_protocol_, static_echo_transport_, static_echo_session_id_, messages.get(), messages_length, parity_length);
+            }
+
             std::shared_ptr<ppp::app::protocol::VirtualEthernetPacket> VEthernetExchanger::StaticEchoReadPacket(const void* packet, int packet_length) noexcept {
                 if (NULL == packet || packet_length < 1) {
                     return NULL;
@@ -1320,8 +1437,32 @@ namespace ppp {
                 }
 
                 std::shared_ptr<ppp::threading::BufferswapAllocator> allocator = configuration->GetBufferAllocator();
-                return VirtualEthernetPacket::Unpack(configuration, 
+                std::shared_ptr<VirtualEthernetPacket> message = VirtualEthernetPacket::Unpack(configuration, 
                     allocator, static_echo_protocol_, static_echo_transport_, packet, packet_length);
+                if (NULL == message) {
+                    return NULL;
+                }
+
+                std::shared_ptr<VirtualEthernetFec> fec = static_echo_fec_;
+                if (message->IsParity()) {
+                    if (NULL == fec) {
+                        return NULL;
+                    }
+
+                    int rebuilt_length = 0;
+                    std::shared_ptr<Byte> rebuilt = fec->Decode(allocator, message->Payload.get(), message->Length, rebuilt_length);
+                    if (NULL == rebuilt) {
+                        return NULL;
+                    }
+
+                    return VirtualEthernetPacket::Unpack(configuration, 
+                        allocator, static_echo_protocol_, static_echo_transport_, rebuilt.get(), rebuilt_length);
+                }
+                elif(NULL != fec && !fec->Input(allocator, packet, packet_length)) {
+                    return NULL;
+                }
+
+                return message;
             }
 
             bool VEthernetExchanger::StaticEchoPacketInput(const std::shared_ptr<ppp::app::protocol::VirtualEthernetPacket>& packet) noexcept {
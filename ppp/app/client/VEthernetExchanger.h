@@ -3,8 +3,11 @@
 #include <ppp/app/protocol/VirtualEthernetLinklayer.h>
 #include <ppp/app/protocol/VirtualEthernetMappingPort.h>
 #include <ppp/app/protocol/VirtualEthernetPacket.h>
+#include <ppp/app/protocol/VirtualEthernetFec.h>
+#include <ppp/app/client/VEthernetDatagramPort.h>
 #include <ppp/cryptography/Ciphertext.h>
 #include <ppp/Int128.h>
+#include <ppp/collections/FlowTable.h>
 #include <ppp/net/Ipep.h>
 #include <ppp/net/IPEndPoint.h>
 #include <ppp/net/native/ip.h>
@@ -18,7 +21,6 @@ namespace ppp {
     namespace app {
         namespace client {
             class VEthernetNetworkSwitcher;
-            class VEthernetDatagramPort;
 
             class VEthernetExchanger : public ppp::app::protocol::VirtualEthernetLinklayer {
                 friend class                                                            VEthernetDatagramPort;
@@ -33,12 +35,13 @@ namespace ppp {
                 typedef std::shared_ptr<Timer>                                          TimerPtr;
                 typedef ppp::unordered_map<void*, TimerPtr>                             TimerTable;
                 typedef std::shared_ptr<VEthernetDatagramPort>                          VEthernetDatagramPortPtr;
+                typedef VEthernetDatagramPort::MessageEventHandler                      DatagramMessageEventHandler;
                 typedef ppp::threading::Executors::StrandPtr                            StrandPtr;
                 typedef std::mutex                                                      SynchronizedObject;
                 typedef std::lock_guard<SynchronizedObject>                             SynchronizedObjectScope;
 
             private:
-                typedef ppp::unordered_map<boost::asio::ip::udp::endpoint,
+                typedef ppp::collections::FlowTable<boost::asio::ip::udp::endpoint,
                     VEthernetDatagramPortPtr>                                           VEthernetDatagramPortTable;
                 typedef ppp::app::protocol::VirtualEthernetMappingPort                  VirtualEthernetMappingPort;
                 typedef std::shared_ptr<VirtualEthernetMappingPort>                     VirtualEthernetMappingPortPtr;
@@ -93,6 +96,7 @@ namespace ppp {
                 virtual bool                                                            Echo(int ack_id) noexcept;
                 virtual bool                                                            Echo(const void* packet, int packet_size) noexcept;
                 virtual bool                                                            SendTo(const boost::asio::ip::udp::endpoint& sourceEP, const boost::asio::ip::udp::endpoint& destinationEP, const void* packet, int packet_size) noexcept;
+                virtual VEthernetDatagramPortPtr                                        OpenDatagramPort(const boost::asio::ip::udp::endpoint& sourceEP, const DatagramMessageEventHandler& message_event) noexcept;
                 virtual bool                                                            Update(UInt64 now) noexcept;
                 bool                                                                    StaticEchoAllocated() noexcept;
                 virtual bool                                                            GetRemoteEndPoint(YieldContext* y, ppp::string& hostname, ppp::string& address, ppp::string& path, int& port, ProtocolType& protocol_type, ppp::string& server, boost::asio::ip::tcp::endpoint& remoteEP) noexcept;
@@ -108,8 +112,8 @@ namespace ppp {
                 virtual bool                                                            OnEcho(const ITransmissionPtr& transmission, int ack_id, YieldContext& y) noexcept override;
                 virtual bool                                                            OnEcho(const ITransmissionPtr& transmission, Byte* packet, int packet_length, YieldContext& y) noexcept override;
                 virtual bool                                                            OnSendTo(const ITransmissionPtr& transmission, const boost::asio::ip::udp::endpoint& sourceEP, const boost::asio::ip::udp::endpoint& destinationEP, Byte* packet, int packet_length, YieldContext& y) noexcept override;
-                virtual bool                                                            OnStatic(const ITransmissionPtr& transmission, YieldContext& y) noexcept override;
-                virtual bool                                                            OnStatic(const ITransmissionPtr& transmission, int session_id, int remote_port, YieldContext& y) noexcept override;
+                virtual bool                                                            OnStatic(const ITransmissionPtr& transmission, int fec, YieldContext& y) noexcept override;
+                virtual bool                                                            OnStatic(const ITransmissionPtr& transmission, int session_id, int remote_port, int fec, YieldContext& y) noexcept override;
 
             protected:
                 virtual VEthernetDatagramPortPtr                                        NewDatagramPort(const ITransmissionPtr& transmission, const boost::asio::ip::udp::endpoint& sourceEP) noexcept;
@@ -125,6 +129,7 @@ namespace ppp {
                     const ppp::string&                                                  host,
                     const ppp::string&                                                  path) noexcept;
                 virtual ITransmissionPtr                                                OpenTransmission(const ContextPtr& context, const StrandPtr& strand, YieldContext& y) noexcept;
+                virtual ITransmissionPtr                                                OpenReliableUdpTransmission(const ContextPtr& context, const StrandPtr& strand, const boost::asio::ip::tcp::endpoint& remoteEP, YieldContext& y) noexcept;
 
             protected:
                 virtual std::shared_ptr<boost::asio::ip::tcp::socket>                   NewAsynchronousSocket(const ContextPtr& context, const StrandPtr& strand, const boost::asio::ip::tcp& protocol, ppp::coroutines::YieldContext& y) noexcept;
@@ -143,7 +148,7 @@ namespace ppp {
                 int                                                                     EchoLanToRemoteExchanger(const ITransmissionPtr& transmission, YieldContext& y) noexcept;
                 bool                                                                    SendEchoKeepAlivePacket(UInt64 now, bool immediately) noexcept;
                 bool                                                                    ReceiveFromDestination(const boost::asio::ip::udp::endpoint& sourceEP, const boost::asio::ip::udp::endpoint& destinationEP, Byte* packet, int packet_length) noexcept;
-                VEthernetDatagramPortPtr                                                AddNewDatagramPort(const ITransmissionPtr& transmission, const boost::asio::ip::udp::endpoint& sourceEP) noexcept;
+                VEthernetDatagramPortPtr                                                AddNewDatagramPort(const ITransmissionPtr& transmission, const boost::asio::ip::udp::endpoint& sourceEP, const DatagramMessageEventHandler& message_event) noexcept;
 
             private:
                 template <typename TTransmission>
@@ -202,6 +207,7 @@ namespace ppp {
                 bool                                                                    StaticEchoOpenAsynchronousSocket(StaticEchoDatagarmSocket& socket, YieldContext& y) noexcept;
                 bool                                                                    StaticEchoAllocatedToRemoteExchanger(YieldContext& y) noexcept;
                 bool                                                                    StaticEchoPacketToRemoteExchanger(const std::shared_ptr<Byte>& packet, int packet_length) noexcept;
+                std::shared_ptr<Byte>                                                   StaticEchoParityToRemoteExchanger(const std::shared_ptr<Byte>& packet, int packet_length, int& parity_length) noexcept;
                 bool                                                                    StaticEchoPacketToRemoteExchanger(const ppp::net::packet::IPFrame* packet) noexcept;
                 bool                                                                    StaticEchoPacketToRemoteExchanger(const std::shared_ptr<ppp::net::packet::UdpFrame>& frame) noexcept;
                 bool                                                                    StaticEchoPacketInput(const std::shared_ptr<ppp::app::protocol::VirtualEthernetPacket>& packet) noexcept;
@@ -239,6 +245,7 @@ namespace ppp {
 
                 CiphertextPtr                                                           static_echo_protocol_;
                 CiphertextPtr                                                           static_echo_transport_;
+                std::shared_ptr<ppp::app::protocol::VirtualEthernetFec>                 static_echo_fec_;
                 std::shared_ptr<StaticEchoDatagarmSocket>                               static_echo_sockets_[2];
                 boost::asio::ip::udp::endpoint                                          static_echo_source_ep_;
                 ppp::list<boost::asio::ip::udp::endpoint>                               static_echo_server_ep_balances_;
@@ -3,6 +3,7 @@
 #include <ppp/app/client/VEthernetExchanger.h>
 #include <ppp/app/client/http/VEthernetHttpProxySwitcher.h>
 #include <ppp/app/client/http/VEthernetHttpProxyConnection.h>
+#include <ppp/app/client/socks/VEthernetSocksProxySwitcher.h>
 #include <ppp/IDisposable.h>
 #include <ppp/coroutines/asio/asio.h>
 #include <ppp/coroutines/YieldContext.h>
@@ -14,6 +15,7 @@
 #include <ppp/net/packet/IPFrame.h>
 #include <ppp/net/packet/UdpFrame.h>
 #include <ppp/net/packet/IcmpFrame.h>
+#include <ppp/net/packet/PacketView.h>
 #include <ppp/net/native/ip.h>
 #include <ppp/net/native/udp.h>
 #include <ppp/net/native/icmp.h>
@@ -50,6 +52,7 @@ using ppp::net::packet::IPFlags;
 using ppp::net::packet::IPFrame;
 using ppp::net::packet::UdpFrame;
 using ppp::net::packet::IcmpFrame;
+using ppp::net::packet::PacketView;
 using ppp::net::packet::IcmpType;
 using ppp::net::packet::BufferSegment;
 using ppp::transmissions::ITransmission;
@@ -83,6 +86,11 @@ namespace ppp {
                 return make_shared_object<VEthernetNetworkTcpipStack>(self);
             }
 
+            std::shared_ptr<VEthernetNetworkSwitcher::IPFragment> VEthernetNetworkSwitcher::NewFragment() noexcept {
+                auto& fragment = configuration_->client.fragment;
+                return make_shared_object<IPFragment>(fragment.slots, fragment.memory, fragment.timeout * 1000);
+            }
+
             bool VEthernetNetworkSwitcher::OnTick(uint64_t now) noexcept {
                 if (!VEthernet::OnTick(now)) {
                     return false;
@@ -179,6 +187,81 @@ namespace ppp {
                 }
             }
 
+            bool VEthernetNetworkSwitcher::OnPacketInput(PacketView& packet) noexcept {
+                int proto = packet.GetProtocol();
+                if (proto == ip_hdr::IP_PROTO_UDP) {
+                    return OnUdpPacketInput(packet);
+                }
+                elif(proto == ip_hdr::IP_PROTO_ICMP) {
+                    return OnIcmpPacketInput(packet);
+                }
+                else {
+                    return false;
+                }
+            }
+
+            // Returning false hands the datagram to the frame based handler, so nothing may be sent or rewritten before deciding that.
+            bool VEthernetNetworkSwitcher::OnUdpPacketInput(PacketView& packet) noexcept {
+                if (NULL == packet.GetUdpHeader()) {
+                    return false;
+                }
+
+                std::shared_ptr<VEthernetExchanger> exchanger = exchanger_;
+                if (NULL == exchanger) {
+                    return false;
+                }
+
+                // DNS redirection and the static transmission mode work on frame objects.
+                int destinationPort = packet.GetDestinationPort();
+                if (destinationPort == PPP_DNS_SYS_PORT || static_mode_) {
+                    return false;
+                }
+
+                if (block_quic_ && destinationPort == 443) {
+                    return true;
+                }
+
+                boost::asio::ip::udp::endpoint sourceEP = IPEndPoint::WrapAddressV4<boost::asio::ip::udp>(packet.GetSource(), packet.GetSourcePort());
+                boost::asio::ip::udp::endpoint destinationEP = IPEndPoint::WrapAddressV4<boost::asio::ip::udp>(packet.GetDestination(), destinationPort);
+                exchanger->SendTo(sourceEP, destinationEP, packet.GetUdpPayload(), packet.GetUdpPayloadLength());
+                return true;
+            }
+
+            bool VEthernetNetworkSwitcher::OnIcmpPacketInput(PacketView& packet) noexcept {
+                if (NULL == packet.GetIcmpHeader()) {
+                    return false;
+                }
+
+                std::shared_ptr<VEthernetExchanger> exchanger = exchanger_;
+                if (NULL == exchanger) {
+                    return false;
+                }
+
+                std::shared_ptr<ITap> tap = GetTap();
+                if (NULL == tap) {
+                    return false;
+                }
+
+                // Echoes answered locally keep the parsed packet around, they stay on the frame based path.
+                int ttl = packet.GetTtl();
+                if (ttl <= 1 || IPAddressIsGatewayServer(packet.GetDestination(), tap->GatewayServer, tap->SubmaskAddress)) {
+                    return false;
+                }
+
+                auto& static_ = configuration_->udp.static_;
+                if ((static_mode_ && static_.icmp) && exchanger->StaticEchoAllocated()) {
+                    return false;
+                }
+
+                if (IsDisposed()) {
+                    return false;
+                }
+
+                packet.SetTtl(ttl - 1);
+                exchanger->Echo(packet.GetBuffer(), packet.GetLength());
+                return true;
+            }
+
             bool VEthernetNetworkSwitcher::OnUdpPacketInput(const std::shared_ptr<IPFrame>& packet) noexcept {
                 std::shared_ptr<UdpFrame> frame = UdpFrame::Parse(packet.get());
                 if (NULL == frame) {
@@ -522,6 +605,15 @@ namespace ppp {
                 }
             }
 
+            VEthernetNetworkSwitcher::VEthernetSocksProxySwitcherPtr VEthernetNetworkSwitcher::NewSocksProxy(const std::shared_ptr<VEthernetExchanger>& exchanger) noexcept {
+                if (NULL == exchanger) {
+                    return NULL;
+                }
+                else {
+                    return make_shared_object<VEthernetSocksProxySwitcher>(exchanger);
+                }
+            }
+
             std::shared_ptr<ppp::threading::BufferswapAllocator> VEthernetNetworkSwitcher::GetBufferAllocator() noexcept {
                 return configuration_->GetBufferAllocator();
             }
@@ -643,6 +735,10 @@ namespace ppp {
                 return http_proxy_;
             }
 
+            VEthernetNetworkSwitcher::VEthernetSocksProxySwitcherPtr VEthernetNetworkSwitcher::GetSocksProxy() noexcept {
+                return socks_proxy_;
+            }
+
             std::shared_ptr<VEthernetNetworkSwitcher::VirtualEthernetInformation> VEthernetNetworkSwitcher::GetInformation() noexcept {
                 std::shared_ptr<VEthernetExchanger> exchanger = exchanger_;
                 if (NULL == exchanger) {
@@ -1037,6 +1133,19 @@ namespace ppp {
                     http_proxy.reset();
                 }
 
+                // Enable the local SOCKS5 PROXY server middleware, it stays closed unless a socks-proxy port is configured.
+                VEthernetSocksProxySwitcherPtr socks_proxy = NewSocksProxy(exchanger);
+                if (NULL == socks_proxy) {
+                    return false;
+                }
+                elif(socks_proxy->Open()) {
+                    socks_proxy_ = std::move(socks_proxy);
+                }
+                else {
+                    socks_proxy->Dispose();
+                    socks_proxy.reset();
+                }
+
                 // Mounts the various service objects created and opened by the current constructor.
                 qos_ = std::move(qos);
                 exchanger_ = std::move(exchanger);
@@ -1764,6 +1873,12 @@ namespace ppp {
                     http_proxy->Dispose();
                 }
 
+                // Stop and release the socks-proxy service.
+                if (VEthernetSocksProxySwitcherPtr socks_proxy = std::move(socks_proxy_); NULL != socks_proxy) {
+                    socks_proxy_.reset();
+                    socks_proxy->Dispose();
+                }
+
                 // Close and release the open exchanger!
                 if (std::shared_ptr<VEthernetExchanger> exchanger = std::move(exchanger_); NULL != exchanger) {
                     exchanger_.reset();
@@ -1920,6 +2035,9 @@ namespace ppp {
                     elif(protocol_type == ProtocolType::ProtocolType_HttpSSL || protocol_type == ProtocolType::ProtocolType_WebSocketSSL) {
                         server_ru_ += "ppp+wss";
                     }
+                    elif(protocol_type == ProtocolType::ProtocolType_ReliableUdp) {
+                        server_ru_ += "ppp+rudp";
+                    }
                     else {
                         server_ru_ += "ppp+tcp";
                     }
@@ -14,6 +14,7 @@
 #include <ppp/app/protocol/VirtualEthernetInformation.h>
 #include <ppp/app/client/dns/Rule.h>
 #include <ppp/app/client/http/VEthernetHttpProxySwitcher.h>
+#include <ppp/app/client/socks/VEthernetSocksProxySwitcher.h>
 
 #if defined(_WIN32)
 #include <windows/ppp/win32/network/Router.h>
@@ -54,6 +55,8 @@ namespace ppp {
                 typedef ppp::app::protocol::VirtualEthernetInformation              VirtualEthernetInformation;
                 typedef ppp::app::client::http::VEthernetHttpProxySwitcher          VEthernetHttpProxySwitcher;
                 typedef std::shared_ptr<VEthernetHttpProxySwitcher>                 VEthernetHttpProxySwitcherPtr;
+                typedef ppp::app::client::socks::VEthernetSocksProxySwitcher        VEthernetSocksProxySwitcher;
+                typedef std::shared_ptr<VEthernetSocksProxySwitcher>                VEthernetSocksProxySwitcherPtr;
                 typedef ppp::function<void(VEthernetNetworkSwitcher*, UInt64)>      VEthernetTickEventHandler;
                 typedef ppp::transmissions::ITransmissionStatistics                 ITransmissionStatistics;
                 typedef std::shared_ptr<ITransmissionStatistics>                    ITransmissionStatisticsPtr;
@@ -115,6 +118,7 @@ namespace ppp {
                 std::shared_ptr<ppp::transmissions::ITransmissionStatistics>        GetStatistics() noexcept { return statistics_; }
                 std::shared_ptr<VirtualEthernetInformation>                         GetInformation() noexcept;
                 VEthernetHttpProxySwitcherPtr                                       GetHttpProxy() noexcept;
+                VEthernetSocksProxySwitcherPtr                                      GetSocksProxy() noexcept;
                 RouteInformationTablePtr                                            GetRib() noexcept;
                 ForwardInformationTablePtr                                          GetFib() noexcept;
                 bool                                                                IsBlockQUIC() noexcept;
@@ -142,6 +146,7 @@ namespace ppp {
             protected:  
                 virtual bool                                                        OnPacketInput(ppp::net::native::ip_hdr* packet, int packet_length, int header_length, int proto, bool vnet) noexcept override;
                 virtual bool                                                        OnPacketInput(const std::shared_ptr<IPFrame>& packet) noexcept override;
+                virtual bool                                                        OnPacketInput(ppp::net::packet::PacketView& packet) noexcept override;
                 virtual bool                                                        OnTick(uint64_t now) noexcept override;
                 virtual bool                                                        OnUpdate(uint64_t now) noexcept override;
                 virtual bool                                                        OnInformation(const std::shared_ptr<VirtualEthernetInformation>& information) noexcept;
@@ -149,7 +154,9 @@ namespace ppp {
             protected:  
                 virtual std::shared_ptr<VEthernetExchanger>                         NewExchanger() noexcept;
                 virtual std::shared_ptr<ppp::ethernet::VNetstack>                   NewNetstack() noexcept override;
+                virtual std::shared_ptr<IPFragment>                                 NewFragment() noexcept override;
                 virtual VEthernetHttpProxySwitcherPtr                               NewHttpProxy(const std::shared_ptr<VEthernetExchanger>& exchanger) noexcept;
+                virtual VEthernetSocksProxySwitcherPtr                              NewSocksProxy(const std::shared_ptr<VEthernetExchanger>& exchanger) noexcept;
                 virtual std::shared_ptr<ppp::transmissions::ITransmissionQoS>       NewQoS() noexcept;
                 virtual ITransmissionStatisticsPtr                                  NewStatistics() noexcept;
 #if defined(_WIN32) 
@@ -166,6 +173,8 @@ namespace ppp {
 #endif  
                 virtual bool                                                        OnUdpPacketInput(const std::shared_ptr<IPFrame>& packet) noexcept;
                 virtual bool                                                        OnIcmpPacketInput(const std::shared_ptr<IPFrame>& packet) noexcept;
+                virtual bool                                                        OnUdpPacketInput(ppp::net::packet::PacketView& packet) noexcept;
+                virtual bool                                                        OnIcmpPacketInput(ppp::net::packet::PacketView& packet) noexcept;
 
             private:    
 #if !defined(_ANDROID) && !defined(_IPHONE) 
@@ -233,6 +242,7 @@ namespace ppp {
                 bool                                                                block_quic_      = false;
                 bool                                                                static_mode_     = false;
                 VEthernetHttpProxySwitcherPtr                                       http_proxy_;
+                VEthernetSocksProxySwitcherPtr                                      socks_proxy_;
                 TimeoutEventHandlerTable                                            timeouts_;
                 DNSRuleTable                                                        dns_rules_;
                 RouteInformationTablePtr                                            rib_;
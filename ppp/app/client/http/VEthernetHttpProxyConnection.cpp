@@ -17,34 +17,18 @@ namespace ppp {
         namespace client {
             namespace http {
                 class VEthernetHttpProxyConnectionStaticVariable final {
-                public:
-                    typedef ppp::unordered_set<ppp::string>                         StringSet;
-                    typedef ppp::unordered_map<ppp::string, ppp::string>            StringMap;
-
                 public: 
                     std::size_t                                                     protocolMethodMaxBytes;
-                    StringSet                                                       protocolMethods;
-                    StringMap                                                       proxyHeaderToAgentHeader;
+                    const char*                                                     protocolMethods[9];
+                    const char*                                                     proxyHeaders[4];
 
                 public:
-                    VEthernetHttpProxyConnectionStaticVariable() noexcept {
-                        protocolMethods.emplace("CONNECT");
-                        protocolMethods.emplace("DELETE");
-                        protocolMethods.emplace("GET");
-                        protocolMethods.emplace("HEAD");
-                        protocolMethods.emplace("OPTIONS");
-                        protocolMethods.emplace("PATCH");
-                        protocolMethods.emplace("POST");
-                        protocolMethods.emplace("PUT");
-                        protocolMethods.emplace("TRACE");
-
-                        proxyHeaderToAgentHeader["PROXY-CONNECTION"] = "";
-                        proxyHeaderToAgentHeader["PROXY-AUTHORIZATION"] = "";
-                        proxyHeaderToAgentHeader["CONNECTION"] = "";
-
+                    VEthernetHttpProxyConnectionStaticVariable() noexcept 
+                        : protocolMethods{ "CONNECT", "DELETE", "GET", "HEAD", "OPTIONS", "PATCH", "POST", "PUT", "TRACE" }
+                        , proxyHeaders{ "PROXY-CONNECTION", "PROXY-AUTHORIZATION", "CONNECTION", "KEEP-ALIVE" } {
                         protocolMethodMaxBytes = 0;
-                        for (auto& protocolMethod : protocolMethods) {
-                            std::size_t protocolMethodSize = protocolMethod.size();
+                        for (const char* protocolMethod : protocolMethods) {
+                            std::size_t protocolMethodSize = strlen(protocolMethod);
                             if (protocolMethodSize > protocolMethodMaxBytes) {
                                 protocolMethodMaxBytes = protocolMethodSize;
                             }
@@ -52,14 +36,30 @@ namespace ppp {
                     }
 
                 public:
-                    bool                                                            IsSupportMethodKey(const ppp::string& s) noexcept {
-                        if (s.empty()) {
+                    static bool                                                     IsMatchKey(const char* const* keys, int keys_count, const char* s, int length) noexcept {
+                        if (NULL == s || length < 1) {
+                            return false;
+                        }
+
+                        for (int i = 0; i < keys_count; i++) {
+                            const char* key = keys[i];
+                            if (strlen(key) == (std::size_t)length && strncasecmp(key, s, length) == 0) {
+                                return true;
+                            }
+                        }
+                        return false;
+                    }
+
+                    bool                                                            IsSupportMethodKey(const char* s, int length) noexcept {
+                        if (length > (int)protocolMethodMaxBytes) {
                             return false;
                         }
 
-                        StringSet::iterator tail = protocolMethods.find(s);
-                        StringSet::iterator endl = protocolMethods.end();
-                        return tail != endl;
+                        return IsMatchKey(protocolMethods, arraysizeof(protocolMethods), s, length);
+                    }
+
+                    bool                                                            IsProxyHeaderKey(const char* s, int length) noexcept {
+                        return IsMatchKey(proxyHeaders, arraysizeof(proxyHeaders), s, length);
                     }
                 };
 
@@ -72,6 +72,7 @@ namespace ppp {
 
                 VEthernetHttpProxyConnection::VEthernetHttpProxyConnection(const VEthernetHttpProxySwitcherPtr& proxy, const VEthernetExchangerPtr& exchanger, const std::shared_ptr<boost::asio::io_context>& context, const ppp::threading::Executors::StrandPtr& strand, const std::shared_ptr<boost::asio::ip::tcp::socket>& socket) noexcept
                     : disposed_(false)
+                    , tunnel_(false)
                     , context_(context)
                     , strand_(strand)
                     , timeout_(0)
@@ -145,46 +146,48 @@ namespace ppp {
                     return proxy_;
                 }
 
-                bool VEthernetHttpProxyConnection::ProtocolReadHeaders(ppp::io::MemoryStream& ms, ppp::vector<ppp::string>& headers, ppp::string* out_) noexcept {
-                    std::shared_ptr<Byte> protocol = ms.GetBuffer();
-                    if (NULL == protocol) {
-                        return false;
-                    }
-
-                    int protocol_size = ms.GetPosition();
-                    if (protocol_size < 1) {
-                        return false;
-                    }
-
-                    if (NULL != out_) {
-                        *out_ = ppp::string((char*)protocol.get(), protocol_size);
-                        return Tokenize<ppp::string>(*out_, headers, "\r\n") > 0;
-                    }
-                    else {
-                        return Tokenize<ppp::string>(ppp::string((char*)protocol.get(), protocol_size), headers, "\r\n") > 0;
-                    }
-                }
+                int VEthernetHttpProxyConnection::ProtocolReadHeaders(int& headers_size, YieldContext& y) noexcept {
+                    char* buffer = (char*)buffer_.get();
+                    int buffer_size = PPP_BUFFER_SIZE - PROTOCOL_HEADERS_RESERVED;
+                    int length = buffer_length_;
+                    int offset = 0;
+                    headers_size = -1;
+
+                    // Bytes a pipelining client already sent are searched first, then the fixed buffer is filled until the header block terminator
+                    // shows up, anything read past it stays in the buffer for the body and the requests behind it.
+                    while (headers_size < 0) {
+                        if (length > offset) {
+                            int next[4];
+                            int start = std::max<int>(0, offset - 3);
+                            int index = FindIndexOf(next, buffer + start, length - start, (char*)("\r\n\r\n"), 4); // KMP
+                            if (index > -1) {
+                                headers_size = start + index + 4;
+                                break;
+                            }
+                            elif(length >= (int)gStaticVariable->protocolMethodMaxBytes + 1) {
+                                const char* method_end = (char*)memchr(buffer, ' ', gStaticVariable->protocolMethodMaxBytes + 1);
+                                if (NULL == method_end || !gStaticVariable->IsSupportMethodKey(buffer, (int)(method_end - buffer))) {
+                                    return -1;
+                                }
+                            }
 
-                std::shared_ptr<VEthernetHttpProxyConnection::ProtocolRoot> VEthernetHttpProxyConnection::GetProtocolRootFromSocket(ppp::io::MemoryStream& ms) noexcept {
-                    std::shared_ptr<ProtocolRoot> protocolRoot = make_shared_object<ProtocolRoot>();
-                    if (NULL == protocolRoot) {
-                        return NULL;
-                    }
+                            offset = length;
+                        }
 
-                    ppp::vector<ppp::string> headers;
-                    if (!this->ProtocolReadHeaders(ms, headers, &protocolRoot->RawRotocol)) {
-                        return NULL;
-                    }
+                        if (length >= buffer_size) {
+                            return -1;
+                        }
 
-                    if (!this->ProtocolReadFirstRoot(headers, protocolRoot)) {
-                        return NULL;
-                    }
+                        int bytes_transferred = ppp::coroutines::asio::async_read_some(*socket_, boost::asio::buffer(buffer + length, buffer_size - length), y);
+                        if (bytes_transferred < 1) {
+                            return -1;
+                        }
 
-                    if (!this->ProtocolReadAllHeaders(headers, protocolRoot->Headers)) {
-                        return NULL;
+                        length += bytes_transferred;
                     }
 
-                    return protocolRoot;
+                    buffer_length_ = length;
+                    return length;
                 }
 
                 bool VEthernetHttpProxyConnection::Run(YieldContext& y) noexcept {
@@ -208,139 +211,401 @@ namespace ppp {
                     }
                 }
 
-                static bool ProtocolReadHttpHeaders(ppp::io::MemoryStream& protocol_array, VEthernetHttpProxyConnection::YieldContext& y, boost::asio::ip::tcp::socket& socket) noexcept {
-                    boost::system::error_code ec_;
-                    std::size_t length_;
-                    std::shared_ptr<boost::asio::streambuf> response_ = make_shared_object<boost::asio::streambuf>();
-                    if (NULL == response_) {
+                bool VEthernetHttpProxyConnection::ProcessHandshaking(YieldContext& y) noexcept {
+                    if (disposed_) {
                         return false;
                     }
 
-                    boost::asio::async_read_until(socket, *response_, "\r\n\r\n",
-                        [&y, &ec_, &length_, response_](boost::system::error_code ec, std::size_t sz) noexcept {
-                            ec_ = ec;
-                            length_ = sz;
-                            y.R();
-                        });
-
-                    y.Suspend();
-                    if (ec_) {
+                    buffer_ = ppp::threading::BufferswapAllocator::MakeByteArray(allocator_, PPP_BUFFER_SIZE);
+                    if (NULL == buffer_) {
                         return false;
                     }
 
-                    if (!length_) {
-                        return false;
-                    }
+                    // Plain HTTP requests are served one after another until the client closes, or a CONNECT turns the connection into a tunnel.
+                    for (;;) {
+                        Update();
+
+                        int headers_size = -1;
+                        if (this->ProtocolReadHeaders(headers_size, y) < 1) {
+                            return false;
+                        }
+
+                        ProtocolRoot protocol_root;
+                        if (!protocol_root.Parse((char*)buffer_.get(), headers_size)) {
+                            return false;
+                        }
+
+                        if (protocol_root.TunnelMode) {
+                            std::shared_ptr<ppp::app::protocol::AddressEndPoint> destinationEP = this->GetAddressEndPointByProtocol(protocol_root);
+                            if (NULL == destinationEP) {
+                                return false;
+                            }
+
+                            this->ReleaseBridgeToPeer();
+                            tunnel_ = true;
+
+                            if (!this->ConnectBridgeToPeer(destinationEP, y)) {
+                                return false;
+                            }
 
-                    boost::asio::const_buffers_1 buff_ = response_->data();
-                    return protocol_array.Write(buff_.data(), 0, (int)length_);
+                            bool ok = this->ProcessHandshaked(protocol_root, (char*)buffer_.get(), headers_size, buffer_length_, y);
+                            buffer_.reset();
+                            response_buffer_.reset();
+                            peer_buffer_.reset();
+                            return ok;
+                        }
+
+                        if (!this->ProcessRequest(protocol_root, headers_size, y)) {
+                            return false;
+                        }
+                    }
                 }
 
-                bool VEthernetHttpProxyConnection::ProcessHandshaking(YieldContext& y) noexcept {
-                    ppp::io::MemoryStream protocol_array;
+                bool VEthernetHttpProxyConnection::ProcessHandshaked(const ProtocolRoot& protocolRoot, char* messages, int headers_size, int messages_size, YieldContext& y) noexcept {
+                    static constexpr char RESPONSE_TEXT[] = " 200 Connection established\r\n\r\n";
+
                     if (disposed_) {
                         return false;
                     }
 
-                    Update();
-                    if (!ProtocolReadHttpHeaders(protocol_array, y, *socket_)) {
+                    // HTTP/1.1 200 Connection established
+                    char response_headers[64];
+                    int response_headers_size = protocolRoot.Version.Length;
+                    if ((response_headers_size + sizeof(RESPONSE_TEXT)) > sizeof(response_headers)) {
                         return false;
                     }
 
-                    std::shared_ptr<Byte> protocol_array_ptr = protocol_array.GetBuffer();
-                    if (NULL == protocol_array_ptr) {
+                    memcpy(response_headers, messages + protocolRoot.Version.Offset, response_headers_size);
+                    memcpy(response_headers + response_headers_size, RESPONSE_TEXT, sizeof(RESPONSE_TEXT) - 1);
+                    response_headers_size += sizeof(RESPONSE_TEXT) - 1;
+
+                    if (!ppp::coroutines::asio::async_write(*socket_, boost::asio::buffer(response_headers, response_headers_size), y)) {
                         return false;
                     }
 
-                    int protocol_array_size = protocol_array.GetPosition();
-                    if (protocol_array_size < 1) {
-                        return false;
+                    // Bytes the client already sent behind the CONNECT request belong to the tunnel.
+                    int pushfd_array_size = messages_size - headers_size;
+                    if (pushfd_array_size > 0) {
+                        return this->SendBufferToPeer(y, messages + headers_size, pushfd_array_size);
                     }
-                    elif(protocol_array_size < (int64_t)gStaticVariable->protocolMethodMaxBytes) {
+
+                    return true;
+                }
+
+                bool VEthernetHttpProxyConnection::ProcessRequest(const ProtocolRoot& protocolRoot, int headers_size, YieldContext& y) noexcept {
+                    if (disposed_) {
                         return false;
                     }
-                    else {
-                        ppp::string protocol = ppp::string((char*)protocol_array_ptr.get(), gStaticVariable->protocolMethodMaxBytes);
-                        std::size_t index = protocol.find(' ');
-                        if (index != ppp::string::npos) {
-                            protocol = protocol.substr(0, index);
+
+                    // The upstream is kept across requests to the same host, a request to another host replaces it.
+                    bool reused = IsLinked() && host_ == protocolRoot.Host;
+                    if (!reused) {
+                        std::shared_ptr<ppp::app::protocol::AddressEndPoint> destinationEP = this->GetAddressEndPointByProtocol(protocolRoot);
+                        if (NULL == destinationEP) {
+                            return false;
                         }
 
-                        protocol = ToUpper<ppp::string>(protocol);
-                        if (!gStaticVariable->IsSupportMethodKey(protocol)) {
+                        this->ReleaseBridgeToPeer();
+                        if (!this->ConnectBridgeToPeer(destinationEP, y)) {
                             return false;
                         }
+
+                        host_ = protocolRoot.Host;
                     }
 
-                    int next[4];
-                    int index = FindIndexOf(next, (char*)protocol_array_ptr.get(), protocol_array_size, (char*)("\r\n\r\n"), 4); // KMP
-                    if (index < 0) {
+                    std::shared_ptr<ProtocolBody> body = make_shared_object<ProtocolBody>(protocolRoot);
+                    if (NULL == body) {
                         return false;
                     }
 
-                    std::shared_ptr<ProtocolRoot> protocol_root = this->GetProtocolRootFromSocket(protocol_array);
-                    if (!this->ConnectBridgeToPeer(protocol_root, y)) {
+                    char* messages = (char*)buffer_.get();
+                    int pushfd_array_size = buffer_length_ - headers_size;
+                    int body_size = body->Consume(messages + headers_size, pushfd_array_size);
+                    if (body_size < 0) {
                         return false;
                     }
 
-                    int headers_endoffset = index + 4;
-                    int pushfd_array_size = protocol_array_size - headers_endoffset;
-                    return this->ProcessHandshaked(protocol_root, protocol_array_ptr.get() + headers_endoffset, pushfd_array_size, y);
-                }
+                    // The body and any pipelined requests behind it are parked behind the reserved tail while the head is compacted in place,
+                    // then the body is moved back behind the head, the pipelined bytes stay where they are until the response is relayed.
+                    char* pushfd_array = messages + headers_size + PROTOCOL_HEADERS_RESERVED;
+                    if (pushfd_array_size > 0) {
+                        memmove(pushfd_array, messages + headers_size, pushfd_array_size);
+                    }
 
-                bool VEthernetHttpProxyConnection::ProcessHandshaked(const std::shared_ptr<ProtocolRoot>& protocolRoot, const void* messages, int messages_size, YieldContext& y) noexcept {
-                    if (disposed_) {
+                    int request_headers_size = protocolRoot.ToArray(messages);
+                    if (request_headers_size < 1) {
                         return false;
                     }
 
-                    if (protocolRoot->TunnelMode) { // HTTP/1.1 200 Connection established
-                        ppp::string response_headers = protocolRoot->Protocol + "/" + protocolRoot->Version + " 200 Connection established\r\n\r\n";
-                        if (!ppp::coroutines::asio::async_write(*socket_, boost::asio::buffer(response_headers.data(), response_headers.size()), y)) {
+                    if (body_size > 0) {
+                        memmove(messages + request_headers_size, pushfd_array, body_size);
+                    }
+
+                    int request_size = request_headers_size + body_size;
+                    int pipelined_offset = headers_size + PROTOCOL_HEADERS_RESERVED + body_size;
+                    buffer_length_ = pushfd_array_size - body_size;
+
+                    // A request that is complete in the buffer can be sent again when a reused upstream turns out to have been closed by the origin.
+                    bool replayable = body->IsCompleted();
+                    for (;;) {
+                        bool reusable = false;
+                        int status = FORWARD_RESPONSE_RESET;
+                        if (this->SendBufferToPeer(y, messages, request_size)) {
+                            // The rest of the body is read in its own coroutine, the response may already arrive while it is uploaded (100-continue).
+                            if (!body->IsCompleted()) {
+                                auto self = shared_from_this();
+                                uploading_ = true;
+
+                                bool spawned = ppp::coroutines::YieldContext::Spawn(allocator_.get(), *context_, strand_.get(),
+                                    [self, this, body](YieldContext& y) noexcept {
+                                        if (!ForwardBodyToPeer(*body, y)) {
+                                            Dispose();
+                                        }
+
+                                        uploading_ = false;
+                                        if (YieldContext* waiting = waiting_; NULL != waiting) {
+                                            waiting_ = NULL;
+                                            waiting->R();
+                                        }
+                                    });
+                                if (!spawned) {
+                                    uploading_ = false;
+                                    return false;
+                                }
+                            }
+
+                            status = this->ForwardResponseToSocket(protocolRoot, reusable, y);
+                        }
+
+                        if (status == FORWARD_RESPONSE_RESET) {
+                            if (!reused || !replayable) {
+                                return false;
+                            }
+
+                            std::shared_ptr<ppp::app::protocol::AddressEndPoint> destinationEP = this->GetAddressEndPointByProtocol(protocolRoot);
+                            if (NULL == destinationEP) {
+                                return false;
+                            }
+
+                            reused = false;
+                            this->ReleaseBridgeToPeer();
+                            if (!this->ConnectBridgeToPeer(destinationEP, y)) {
+                                return false;
+                            }
+
+                            host_ = protocolRoot.Host;
+                            continue;
+                        }
+
+                        if (status == FORWARD_RESPONSE_FAILED) {
                             return false;
                         }
+
+                        // The response can end while the last body bytes are still written upstream, but with a body the client has not finished
+                        // sending the position of the next request is unknown.
+                        if (uploading_) {
+                            if (!body->IsCompleted()) {
+                                return false;
+                            }
+
+                            waiting_ = &y;
+                            y.Suspend();
+                        }
+
+                        if (!reusable) {
+                            this->ReleaseBridgeToPeer();
+                        }
+
+                        if (status != FORWARD_RESPONSE_KEEP_ALIVE || disposed_ || !body->IsCompleted()) {
+                            return false;
+                        }
+
+                        if (replayable && buffer_length_ > 0) {
+                            memmove(messages, messages + pipelined_offset, buffer_length_);
+                        }
+
+                        this->Update();
+                        return true;
                     }
-                    else {
-                        ppp::io::MemoryStream ms;
-                        ms.BufferAllocator = this->GetBufferAllocator();
+                }
 
-                        ppp::string request_headers = protocolRoot->ToString();
-                        if (request_headers.empty()) {
+                bool VEthernetHttpProxyConnection::ForwardBodyToPeer(ProtocolBody& body, YieldContext& y) noexcept {
+                    // Nothing follows an unfinished body in the buffer, so it is refilled from the start and whatever is read past the body is left
+                    // at its front for the next request.
+                    char* buffer = (char*)buffer_.get();
+                    while (!body.IsCompleted()) {
+                        if (disposed_) {
                             return false;
                         }
-                        elif(!ms.Write(request_headers.data(), 0, (int)request_headers.size())) {
+
+                        int bytes_transferred = ppp::coroutines::asio::async_read_some(*socket_, boost::asio::buffer(buffer, PPP_BUFFER_SIZE - PROTOCOL_HEADERS_RESERVED), y);
+                        if (bytes_transferred < 1) {
                             return false;
                         }
-                        elif(messages_size > 0 && !ms.Write(messages, 0, messages_size)) {
+
+                        int body_size = body.Consume(buffer, bytes_transferred);
+                        if (body_size < 0) {
                             return false;
                         }
-                        elif(ms.GetPosition() > 0 && !this->SendBufferToPeer(y, ms)) {
+
+                        if (body_size > 0 && !this->SendBufferToPeer(y, buffer, body_size)) {
                             return false;
                         }
+
+                        buffer_length_ = bytes_transferred - body_size;
+                        if (buffer_length_ > 0) {
+                            memmove(buffer, buffer + body_size, buffer_length_);
+                        }
+
+                        this->Update();
                     }
                     return true;
                 }
 
-                bool VEthernetHttpProxyConnection::SendBufferToPeer(YieldContext& y, ppp::io::MemoryStream& stream) noexcept {
-                    if (!stream.CanRead()) {
-                        return false;
+                int VEthernetHttpProxyConnection::ForwardResponseToSocket(const ProtocolRoot& protocolRoot, bool& reusable, YieldContext& y) noexcept {
+                    reusable = false;
+                    if (NULL == response_buffer_) {
+                        response_buffer_ = ppp::threading::BufferswapAllocator::MakeByteArray(allocator_, PPP_BUFFER_SIZE);
+                        if (NULL == response_buffer_) {
+                            return FORWARD_RESPONSE_FAILED;
+                        }
                     }
 
+                    // Only a response head split across reads is gathered in the response buffer, body bytes go to the client from the packet they came in.
+                    std::shared_ptr<Byte> packet;
+                    char* headers = (char*)response_buffer_.get();
+                    const char* data = NULL;
+                    int length = 0;
+                    int headers_length = 0;
+                    bool any = false;
+
+                    for (;;) {
+                        int headers_size = -1;
+                        while (headers_size < 0) {
+                            if (length < 1) {
+                                packet = this->ReadBufferFromPeer(y, length);
+                                if (NULL == packet || length < 1) {
+                                    return any || headers_length > 0 ? FORWARD_RESPONSE_FAILED : FORWARD_RESPONSE_RESET;
+                                }
+
+                                data = (char*)packet.get();
+                            }
+
+                            int n = std::min<int>(length, PPP_BUFFER_SIZE - headers_length);
+                            if (n < 1) {
+                                return FORWARD_RESPONSE_FAILED;
+                            }
+
+                            int next[4];
+                            int offset = std::max<int>(0, headers_length - 3);
+                            memcpy(headers + headers_length, data, n);
+                            headers_length += n;
+
+                            int index = FindIndexOf(next, headers + offset, headers_length - offset, (char*)("\r\n\r\n"), 4); // KMP
+                            if (index > -1) {
+                                headers_size = offset + index + 4;
+                                n -= headers_length - headers_size;
+                            }
+
+                            data += n;
+                            length -= n;
+                        }
+
+                        ProtocolResponse response;
+                        if (!response.Parse(headers, headers_size, protocolRoot)) {
+                            return FORWARD_RESPONSE_FAILED;
+                        }
+
+                        if (!ppp::coroutines::asio::async_write(*socket_, boost::asio::buffer(headers, headers_size), y)) {
+                            return FORWARD_RESPONSE_FAILED;
+                        }
+
+                        any = true;
+                        headers_length = 0;
+                        this->Update();
+
+                        // 100 Continue and the other interim responses come ahead of the final one.
+                        if (response.StatusCode < 200) {
+                            continue;
+                        }
+
+                        ProtocolBody body(response.Chunked, response.ContentLength);
+                        bool delimited = response.IsDelimited();
+                        while (!delimited || !body.IsCompleted()) {
+                            if (length < 1) {
+                                packet = this->ReadBufferFromPeer(y, length);
+                                if (NULL == packet || length < 1) {
+                                    return delimited ? FORWARD_RESPONSE_FAILED : FORWARD_RESPONSE_CLOSE;
+                                }
+
+                                data = (char*)packet.get();
+                            }
+
+                            int body_size = delimited ? body.Consume(data, length) : length;
+                            if (body_size < 0) {
+                                return FORWARD_RESPONSE_FAILED;
+                            }
+
+                            if (body_size > 0 && !ppp::coroutines::asio::async_write(*socket_, boost::asio::buffer(data, body_size), y)) {
+                                return FORWARD_RESPONSE_FAILED;
+                            }
+
+                            data += body_size;
+                            length -= body_size;
+                            this->Update();
+                        }
+
+                        // Anything the upstream sent behind the response answers no request, so its connection is not used again.
+                        reusable = response.KeepAlive && length < 1;
+                        return protocolRoot.KeepAlive ? FORWARD_RESPONSE_KEEP_ALIVE : FORWARD_RESPONSE_CLOSE;
+                    }
+                }
+
+                std::shared_ptr<Byte> VEthernetHttpProxyConnection::ReadBufferFromPeer(YieldContext& y, int& length) noexcept {
+                    length = 0;
                     if (disposed_) {
-                        return false;
+                        return NULL;
                     }
 
-                    int messages_size = stream.GetLength();
-                    if (messages_size < 1) {
-                        return true;
+                    if (VirtualEthernetTcpipConnectionPtr connection = this->connection_; NULL != connection) {
+                        ITransmissionPtr transmission = connection->GetTransmission();
+                        if (NULL != transmission) {
+                            return transmission->Read(y, length);
+                        }
                     }
+                    elif(std::shared_ptr<RinetdConnection> connection = this->connection_rinetd_; NULL != connection) {
+                        std::shared_ptr<boost::asio::ip::tcp::socket> socket = connection->GetRemoteSocket();
+                        if (NULL == peer_buffer_) {
+                            peer_buffer_ = ppp::threading::BufferswapAllocator::MakeByteArray(allocator_, PPP_BUFFER_SIZE);
+                        }
 
-                    std::shared_ptr<Byte> messages = stream.GetBuffer();
-                    if (NULL == messages) {
-                        return false;
+                        std::shared_ptr<Byte> buffer = peer_buffer_;
+                        if (NULL != socket && NULL != buffer) {
+                            int bytes_transferred = ppp::coroutines::asio::async_read_some(*socket, boost::asio::buffer(buffer.get(), PPP_BUFFER_SIZE), y);
+                            if (bytes_transferred > 0) {
+                                length = bytes_transferred;
+                                return buffer;
+                            }
+                        }
                     }
 
-                    void* messages_ptr = messages.get();
-                    return SendBufferToPeer(y, messages_ptr, messages_size);
+                    return NULL;
+                }
+
+                void VEthernetHttpProxyConnection::ReleaseBridgeToPeer() noexcept {
+                    std::shared_ptr<VirtualEthernetTcpipConnection> connection = std::move(connection_);
+                    if (NULL != connection) {
+                        connection_.reset();
+                        connection->Dispose();
+                    }
+
+                    std::shared_ptr<RinetdConnection> connection_rinetd = std::move(connection_rinetd_);
+                    if (NULL != connection_rinetd) {
+                        connection_rinetd_.reset();
+                        connection_rinetd->Dispose();
+                    }
+
+                    host_.clear();
                 }
 
                 bool VEthernetHttpProxyConnection::SendBufferToPeer(YieldContext& y, const void* messages, int messages_size) noexcept {
@@ -370,14 +635,9 @@ namespace ppp {
                     return false;
                 }
 
-                bool VEthernetHttpProxyConnection::ConnectBridgeToPeer(const std::shared_ptr<ProtocolRoot>& protocolRoot, YieldContext& y) noexcept {
+                bool VEthernetHttpProxyConnection::ConnectBridgeToPeer(const std::shared_ptr<ppp::app::protocol::AddressEndPoint>& destinationEP, YieldContext& y) noexcept {
                     using VEthernetTcpipConnection = ppp::app::protocol::templates::VEthernetTcpipConnection<VEthernetHttpProxyConnection>;
 
-                    if (NULL == protocolRoot) {
-                        return false;
-                    }
-
-                    std::shared_ptr<ppp::app::protocol::AddressEndPoint> destinationEP = this->GetAddressEndPointByProtocol(protocolRoot);
                     if (NULL == destinationEP) {
                         return false;
                     }
@@ -387,12 +647,14 @@ namespace ppp {
                         return false;
                     }
 
-                    std::shared_ptr<boost::asio::ip::tcp::socket> socket = GetSocket();
-                    if (NULL == socket) {
+                    if (NULL == socket_) {
                         return false;
                     }
 
-                    auto self = shared_from_this();
+                    // A tunnel hands the client socket to the relay, a plain HTTP upstream is only written and read by this connection, 
+                    // so its relay gets neither the socket nor a reference back and can be replaced without closing the client.
+                    std::shared_ptr<boost::asio::ip::tcp::socket> socket = tunnel_ ? socket_ : NULL;
+                    std::shared_ptr<VEthernetHttpProxyConnection> self = tunnel_ ? shared_from_this() : NULL;
                     if (auto resolver = exchanger_->GetTResolver(); NULL != resolver) {
                         if (auto switcher = exchanger_->GetSwitcher(); NULL != switcher) {
                             if (auto tap = switcher->GetTap(); NULL != tap && tap->IsHostedNetwork()) {
@@ -451,17 +713,13 @@ namespace ppp {
                     return true;
                 }
 
-                std::shared_ptr<ppp::app::protocol::AddressEndPoint> VEthernetHttpProxyConnection::GetAddressEndPointByProtocol(const std::shared_ptr<ProtocolRoot>& protocolRoot) noexcept {
-                    if (NULL == protocolRoot) {
-                        return NULL;
-                    }
-
+                std::shared_ptr<ppp::app::protocol::AddressEndPoint> VEthernetHttpProxyConnection::GetAddressEndPointByProtocol(const ProtocolRoot& protocolRoot) noexcept {
                     std::shared_ptr<ppp::app::protocol::AddressEndPoint> destinationEP = make_shared_object<ppp::app::protocol::AddressEndPoint>();
                     if (NULL == destinationEP) {
                         return NULL;
                     }
                     
-                    ppp::string host = protocolRoot->Host;
+                    ppp::string host = protocolRoot.Host;
                     int port = 80; 
                     if (host.empty()) {
                         return NULL;
@@ -502,210 +760,496 @@ namespace ppp {
                     return destinationEP;
                 }
 
-                bool VEthernetHttpProxyConnection::ProtocolReadFirstRoot(const ppp::vector<ppp::string>& headers, const std::shared_ptr<ProtocolRoot>& protocolRoot) noexcept {
-                    static ppp::string CONNECT_TEXT = "CONNECT";
-                    static ppp::string HTTP_TEXT = "HTTP";
-                    static ppp::string HOST_TEXT = "HOST";
-                    static ppp::string HTTP_COLON_TEXT = "HTTP:";
-                    static ppp::string DOUBLE_SLASH_TEXT = "//";
+                static const char* ProtocolTrimHeaderString(const char* s, const char* s_end, int& length) noexcept {
+                    while (s < s_end && (*s == ' ' || *s == '\t')) {
+                        s++;
+                    }
 
-                    if (headers.empty() || NULL == protocolRoot) {
-                        return false;
+                    while (s < s_end && (s_end[-1] == ' ' || s_end[-1] == '\t')) {
+                        s_end--;
                     }
 
-                    const ppp::string& header_first = headers[0];
-                    if (header_first.empty()) {
-                        return false;
+                    length = (int)(s_end - s);
+                    return s;
+                }
+
+                // Calls handler with the trimmed key and value of every header line in [line, headers_end), stops at the first false it returns.
+                template <typename THeaderHandler>
+                static bool ProtocolForEachHeader(const char* line, const char* headers_end, THeaderHandler&& handler) noexcept {
+                    for (const char* line_end = line; line < headers_end; line = line_end + 2) {
+                        line_end = line;
+                        while (line_end < headers_end && *line_end != '\r') {
+                            line_end++;
+                        }
+
+                        const char* colon = (char*)memchr(line, ':', line_end - line);
+                        if (NULL == colon || colon == line) {
+                            continue;
+                        }
+
+                        int key_length;
+                        int value_length;
+                        const char* key = ProtocolTrimHeaderString(line, colon, key_length);
+                        const char* value = ProtocolTrimHeaderString(colon + 1, line_end, value_length);
+                        if (!handler(key, key_length, value, value_length)) {
+                            return false;
+                        }
                     }
+                    return true;
+                }
 
-                    ppp::vector<ppp::string> segments;
-                    if (Tokenize<ppp::string>(header_first, segments, " ") < 3) {
+                // Repeated Content-Length headers must agree, otherwise the message has no single end.
+                static bool ProtocolParseContentLength(const char* value, int value_length, Int64& content_length) noexcept {
+                    if (value_length < 1 || value_length > 15) {
                         return false;
                     }
 
-                    protocolRoot->Method = ToUpper(segments[0]);
-                    if (protocolRoot->Method == CONNECT_TEXT) {
-                        protocolRoot->TunnelMode = true;
+                    Int64 length = 0;
+                    for (int i = 0; i < value_length; i++) {
+                        if (value[i] < '0' || value[i] > '9') {
+                            return false;
+                        }
+
+                        length = length * 10 + (value[i] - '0');
                     }
-                    elif(!gStaticVariable->IsSupportMethodKey(protocolRoot->Method)) {
+
+                    if (content_length > -1 && content_length != length) {
                         return false;
                     }
 
-                    const ppp::string& protocolVersion = segments[2]; {
-                        size_t index = protocolVersion.find('/');
-                        if (index == ppp::string::npos) {
-                            return false;
-                        }
+                    content_length = length;
+                    return true;
+                }
 
-                        protocolRoot->Protocol = protocolVersion.substr(0, index);
-                        if (protocolRoot->Protocol != HTTP_TEXT) {
-                            return false;
+                static constexpr int PROTOCOL_CONNECTION_CLOSE      = 1;
+                static constexpr int PROTOCOL_CONNECTION_KEEP_ALIVE = 2;
+
+                // Returns the close and keep-alive options of a comma separated Connection header value.
+                static int ProtocolConnectionOptions(const char* value, int value_length) noexcept {
+                    int options = 0;
+                    const char* value_end = value + value_length;
+                    while (value < value_end) {
+                        const char* token_end = (char*)memchr(value, ',', value_end - value);
+                        if (NULL == token_end) {
+                            token_end = value_end;
                         }
 
-                        if (++index > protocolVersion.size()) {
-                            return false;
+                        int token_length;
+                        const char* token = ProtocolTrimHeaderString(value, token_end, token_length);
+                        if (token_length == 5 && strncasecmp(token, "CLOSE", 5) == 0) {
+                            options |= PROTOCOL_CONNECTION_CLOSE;
                         }
-
-                        protocolRoot->Version = protocolVersion.substr(index);
-                        if (protocolRoot->Version.empty()) {
-                            return false;
+                        elif(token_length == 10 && strncasecmp(token, "KEEP-ALIVE", 10) == 0) {
+                            options |= PROTOCOL_CONNECTION_KEEP_ALIVE;
                         }
+
+                        value = token_end + 1;
+                    }
+                    return options;
+                }
+
+                // HTTP/1.1 keeps the connection unless it is asked to close, HTTP/1.0 closes it unless it is asked to keep it.
+                static bool ProtocolKeepAlive(bool http10, int options) noexcept {
+                    if (options & PROTOCOL_CONNECTION_CLOSE) {
+                        return false;
                     }
 
-                    ppp::string& rawUri = constantof(segments[1]);
-                    if (rawUri.empty()) {
-                        return false;        
+                    return !http10 || (options & PROTOCOL_CONNECTION_KEEP_ALIVE) != 0;
+                }
+
+                bool VEthernetHttpProxyConnection::ProtocolRoot::Parse(const char* headers, int headers_size) noexcept {
+                    static constexpr char HTTP_TEXT[] = "HTTP/";
+                    static constexpr char HTTP_COLON_TEXT[] = "HTTP://";
+
+                    if (NULL == headers || headers_size < 4) {
+                        return false;
                     }
-                    elif(protocolRoot->TunnelMode) {
-                        protocolRoot->Host = rawUri;
+
+                    // GET http://www.example.com/ HTTP/1.1
+                    const char* headers_end = headers + headers_size;
+                    const char* line_end = headers;
+                    while (line_end < headers_end && *line_end != '\r') {
+                        line_end++;
                     }
-                    elif(rawUri[0] == '/') {
-                        protocolRoot->RawUri = header_first;
-                        for (std::size_t index = 1, length = headers.size(); index < length; index++) {
-                            ppp::string line = LTrim(RTrim(headers[index]));
-                            if (line.empty()) {
-                                continue;
-                            }
 
-                            std::size_t left_index = line.find(':');
-                            if (left_index == 0 || left_index == ppp::string::npos) {
-                                continue;
-                            }
+                    const char* method_end = (char*)memchr(headers, ' ', line_end - headers);
+                    if (NULL == method_end) {
+                        return false;
+                    }
 
-                            ppp::string left = LTrim(RTrim(line.substr(0, left_index)));
-                            if (left.empty()) {
-                                continue;
-                            }
+                    const char* uri = method_end + 1;
+                    const char* uri_end = (char*)memchr(uri, ' ', line_end - uri);
+                    if (NULL == uri_end || uri == uri_end) {
+                        return false;
+                    }
+
+                    const char* version = uri_end + 1;
+                    if ((line_end - version) <= (int)(sizeof(HTTP_TEXT) - 1) || memcmp(version, HTTP_TEXT, sizeof(HTTP_TEXT) - 1) != 0) {
+                        return false;
+                    }
+
+                    this->Method = { 0, (int)(method_end - headers) };
+                    this->Version = { (int)(version - headers), (int)(line_end - version) };
+                    this->Headers = { (int)(line_end + 2 - headers), (int)(headers_end - 2 - (line_end + 2)) };
+                    this->RawUri = { (int)(uri - headers), (int)(uri_end - uri) };
+                    this->TunnelMode = false;
+                    this->Chunked = false;
+                    this->KeepAlive = false;
+                    this->HeadMethod = this->Method.Length == 4 && strncasecmp(headers, "HEAD", 4) == 0;
+                    this->ContentLength = -1;
+                    this->Host.clear();
+
+                    if (!gStaticVariable->IsSupportMethodKey(headers, this->Method.Length)) {
+                        return false;
+                    }
+
+                    // The body framing decides where the request ends, so any header that makes it ambiguous fails the request.
+                    bool transfer_encoding = false;
+                    int connection_options = 0;
+                    bool headers_ok = ProtocolForEachHeader(headers + this->Headers.Offset, headers_end,
+                        [this, &transfer_encoding, &connection_options](const char* key, int key_length, const char* value, int value_length) noexcept {
+                            if (key_length == 4 && strncasecmp(key, "HOST", 4) == 0) {
+                                if (value_length < 1) {
+                                    return false;
+                                }
 
-                            left = ToUpper(left);
-                            if (left != HOST_TEXT) {
-                                continue;
+                                if (this->Host.empty()) {
+                                    this->Host.assign(value, value_length);
+                                }
+                                elif(this->Host.size() != (std::size_t)value_length || memcmp(this->Host.data(), value, value_length) != 0) {
+                                    return false;
+                                }
+                            }
+                            elif(key_length == 14 && strncasecmp(key, "CONTENT-LENGTH", 14) == 0) {
+                                return ProtocolParseContentLength(value, value_length, this->ContentLength);
                             }
+                            elif(key_length == 17 && strncasecmp(key, "TRANSFER-ENCODING", 17) == 0) {
+                                if (transfer_encoding) {
+                                    return false;
+                                }
 
-                            ppp::string reft = LTrim(RTrim(line.substr(left_index + 1)));
-                            if (reft.empty()) {
-                                return false;
+                                transfer_encoding = true;
+                                this->Chunked = value_length == 7 && strncasecmp(value, "CHUNKED", 7) == 0;
+                                return this->Chunked;
                             }
+                            elif((key_length == 10 && strncasecmp(key, "CONNECTION", 10) == 0) || (key_length == 16 && strncasecmp(key, "PROXY-CONNECTION", 16) == 0)) {
+                                connection_options |= ProtocolConnectionOptions(value, value_length);
+                            }
+                            return true;
+                        });
+                    if (!headers_ok) {
+                        return false;
+                    }
 
-                            protocolRoot->Host = reft;
-                            break;
-                        }
+                    if (this->Chunked && this->ContentLength > -1) {
+                        return false;
+                    }
 
-                        if (protocolRoot->Host.empty()) {
+                    this->KeepAlive = ProtocolKeepAlive(this->Version.Length == 8 && memcmp(version, "HTTP/1.0", 8) == 0, connection_options);
+
+                    if (this->Method.Length == 7 && strncasecmp(headers, "CONNECT", 7) == 0) {
+                        this->TunnelMode = true;
+                        this->Host.assign(uri, uri_end - uri);
+                    }
+                    elif(*uri == '/') {
+                        if (this->Host.empty()) {
                             return false;
                         }
                     }
                     else {
-                        size_t left_index = rawUri.find(DOUBLE_SLASH_TEXT);
-                        if (left_index == ppp::string::npos) {
+                        int left_length = sizeof(HTTP_COLON_TEXT) - 1;
+                        if ((uri_end - uri) <= left_length || strncasecmp(uri, HTTP_COLON_TEXT, left_length) != 0) {
                             return false;
                         }
-                        
-                        ppp::string left = ToUpper(rawUri.substr(0, left_index));
-                        if (left != HTTP_COLON_TEXT) {
+
+                        const char* host = uri + left_length;
+                        const char* path = (char*)memchr(host, '/', uri_end - host);
+                        if (NULL == path) {
+                            path = uri_end;
+                        }
+
+                        if (host == path) {
                             return false;
                         }
-                        else {
-                            left_index = left_index + 2;
-                            if (left_index > rawUri.size()) {
-                                return false;
-                            }
+
+                        // An empty RawUri is written out as "/".
+                        this->Host.assign(host, path - host);
+                        this->RawUri = { (int)(path - headers), (int)(uri_end - path) };
+                    }
+
+                    if (this->Host.rfind(':') == ppp::string::npos) {
+                        this->Host += ":80";
+                    }
+
+                    return true;
+                }
+
+                int VEthernetHttpProxyConnection::ProtocolRoot::ToArray(char* headers) const noexcept {
+                    if (NULL == headers) {
+                        return -1;
+                    }
+
+                    // Every segment is copied to an offset no greater than its source offset, so memmove can compact the head in place, 
+                    // only the trailing Connection header may run up to PROTOCOL_HEADERS_RESERVED bytes past the source head.
+                    static constexpr char CONNECTION_CLOSE_TEXT[] = "Connection: close\r\n";
+                    static constexpr char CONNECTION_KEEP_ALIVE_TEXT[] = "Connection: keep-alive\r\n";
+                    static_assert(sizeof(CONNECTION_KEEP_ALIVE_TEXT) - 1 == PROTOCOL_HEADERS_RESERVED, "PROTOCOL_HEADERS_RESERVED");
+
+                    int length = 0;
+                    auto write = [headers, &length](int offset, int size) noexcept {
+                        memmove(headers + length, headers + offset, size);
+                        length += size;
+                    };
+
+                    write(this->Method.Offset, this->Method.Length);
+                    headers[length++] = ' ';
+
+                    if (this->RawUri.Length > 0) {
+                        write(this->RawUri.Offset, this->RawUri.Length);
+                    }
+                    else {
+                        headers[length++] = '/';
+                    }
+
+                    headers[length++] = ' ';
+                    write(this->Version.Offset, this->Version.Length);
+                    headers[length++] = '\r';
+                    headers[length++] = '\n';
+
+                    const char* line = headers + this->Headers.Offset;
+                    const char* headers_end = line + this->Headers.Length;
+                    for (const char* line_end = line; line < headers_end; line = line_end + 2) {
+                        line_end = line;
+                        while (line_end < headers_end && *line_end != '\r') {
+                            line_end++;
                         }
 
-                        size_t path_index = rawUri.find('/', left_index);
-                        if (path_index == ppp::string::npos) {
-                            protocolRoot->RawUri = "/";
-                            protocolRoot->Host = rawUri.substr(left_index);
+                        const char* colon = (char*)memchr(line, ':', line_end - line);
+                        if (NULL == colon || colon == line) {
+                            continue;
                         }
-                        else {
-                            size_t sz = path_index - left_index;
-                            if (sz > 0) {
-                                protocolRoot->Host = rawUri.substr(left_index, sz);
-                            }
 
-                            protocolRoot->RawUri = rawUri.substr(path_index);
+                        int key_length;
+                        const char* key = ProtocolTrimHeaderString(line, colon, key_length);
+                        if (gStaticVariable->IsProxyHeaderKey(key, key_length)) {
+                            continue;
                         }
 
-                        if (protocolRoot->Host.empty() ||
-                            protocolRoot->RawUri.empty() ||
-                            protocolRoot->RawUri[0] != '/') {
+                        write((int)(line - headers), (int)(line_end + 2 - line));
+                    }
+
+                    if (this->KeepAlive) {
+                        memcpy(headers + length, CONNECTION_KEEP_ALIVE_TEXT, sizeof(CONNECTION_KEEP_ALIVE_TEXT) - 1);
+                        length += sizeof(CONNECTION_KEEP_ALIVE_TEXT) - 1;
+                    }
+                    else {
+                        memcpy(headers + length, CONNECTION_CLOSE_TEXT, sizeof(CONNECTION_CLOSE_TEXT) - 1);
+                        length += sizeof(CONNECTION_CLOSE_TEXT) - 1;
+                    }
+
+                    headers[length++] = '\r';
+                    headers[length++] = '\n';
+                    return length;
+                }
+
+                bool VEthernetHttpProxyConnection::ProtocolResponse::Parse(const char* headers, int headers_size, const ProtocolRoot& protocolRoot) noexcept {
+                    static constexpr char HTTP_TEXT[] = "HTTP/1.";
+
+                    // HTTP/1.1 200 OK
+                    if (NULL == headers || headers_size < 16 || memcmp(headers, HTTP_TEXT, sizeof(HTTP_TEXT) - 1) != 0 || headers[8] != ' ') {
+                        return false;
+                    }
+
+                    int status_code = 0;
+                    for (int i = 9; i < 12; i++) {
+                        if (headers[i] < '0' || headers[i] > '9') {
                             return false;
                         }
+
+                        status_code = status_code * 10 + (headers[i] - '0');
                     }
 
-                    const ppp::string& host = protocolRoot->Host;
-                    if (host.rfind(':') == ppp::string::npos) {
-                        protocolRoot->Host = host + ":80";
+                    const char* headers_end = headers + headers_size;
+                    const char* line = (char*)memchr(headers, '\n', headers_size);
+                    if (NULL == line) {
+                        return false;
                     }
 
+                    this->StatusCode = status_code;
+                    this->Chunked = false;
+                    this->ContentLength = -1;
+
+                    bool transfer_encoding = false;
+                    int connection_options = 0;
+                    bool headers_ok = ProtocolForEachHeader(line + 1, headers_end,
+                        [this, &transfer_encoding, &connection_options](const char* key, int key_length, const char* value, int value_length) noexcept {
+                            if (key_length == 14 && strncasecmp(key, "CONTENT-LENGTH", 14) == 0) {
+                                return ProtocolParseContentLength(value, value_length, this->ContentLength);
+                            }
+                            elif(key_length == 17 && strncasecmp(key, "TRANSFER-ENCODING", 17) == 0) {
+                                // The chunked coding has to be the last one applied, any other final coding runs until the connection closes.
+                                transfer_encoding = true;
+                                this->Chunked = value_length >= 7 && strncasecmp(value + value_length - 7, "CHUNKED", 7) == 0 && 
+                                    (value_length == 7 || value[value_length - 8] == ',' || value[value_length - 8] == ' ');
+                            }
+                            elif(key_length == 10 && strncasecmp(key, "CONNECTION", 10) == 0) {
+                                connection_options |= ProtocolConnectionOptions(value, value_length);
+                            }
+                            return true;
+                        });
+                    if (!headers_ok) {
+                        return false;
+                    }
+
+                    // An upgrade is never asked for, the Connection header of the request is not forwarded.
+                    if (status_code == 101) {
+                        return false;
+                    }
+
+                    // Transfer-Encoding overrides Content-Length (RFC 9112 6.3).
+                    if (transfer_encoding) {
+                        this->ContentLength = -1;
+                    }
+
+                    if (status_code < 200 || status_code == 204 || status_code == 304 || protocolRoot.HeadMethod) {
+                        this->Chunked = false;
+                        this->ContentLength = 0;
+                    }
+
+                    this->KeepAlive = IsDelimited() && ProtocolKeepAlive(headers[7] == '0', connection_options);
                     return true;
                 }
 
-                bool VEthernetHttpProxyConnection::ProtocolReadAllHeaders(const ppp::vector<ppp::string>& headers, ProtocolRoot::HeaderCollection& s) noexcept {
-                    for (size_t i = 1, l = headers.size(); i < l; ++i) {
-                        const ppp::string& str = headers[i];
-                        size_t j = str.find(':');
-                        if (j == ppp::string::npos) {
-                            continue;
-                        }
+                VEthernetHttpProxyConnection::ProtocolBody::ProtocolBody(bool chunked, Int64 content_length) noexcept
+                    : state_(STATE_COMPLETED)
+                    , line_size_(0)
+                    , remaining_(0) {
+                    if (chunked) {
+                        state_ = STATE_CHUNK_SIZE;
+                    }
+                    elif(content_length > 0) {
+                        state_ = STATE_LENGTH;
+                        remaining_ = content_length;
+                    }
+                }
+
+                int VEthernetHttpProxyConnection::ProtocolBody::Consume(const char* s, int length) noexcept {
+                    int offset = 0;
+                    while (offset < length && state_ != STATE_COMPLETED) {
+                        if (state_ == STATE_LENGTH || state_ == STATE_CHUNK_DATA) {
+                            int n = (int)std::min<Int64>(remaining_, length - offset);
+                            offset += n;
+                            remaining_ -= n;
+                            if (remaining_ == 0) {
+                                state_ = state_ == STATE_LENGTH ? STATE_COMPLETED : STATE_CHUNK_DATA_CR;
+                            }
 
-                        size_t n = j + 2;
-                        if (n >= str.size()) {
                             continue;
                         }
 
-                        ppp::string left = str.substr(0, j); {
-                            auto tail = gStaticVariable->proxyHeaderToAgentHeader.find(ToUpper(left));
-                            auto endl = gStaticVariable->proxyHeaderToAgentHeader.end();
-                            if (tail != endl) {
-                                left = tail->second;
+                        // chunk-size [ chunk-ext ] CRLF chunk-data CRLF ... 0 CRLF *( trailer-field CRLF ) CRLF
+                        char ch = s[offset++];
+                        switch (state_) {
+                        case STATE_CHUNK_SIZE: {
+                            int digit = -1;
+                            if (ch >= '0' && ch <= '9') {
+                                digit = ch - '0';
+                            }
+                            elif(ch >= 'a' && ch <= 'f') {
+                                digit = ch - 'a' + 10;
+                            }
+                            elif(ch >= 'A' && ch <= 'F') {
+                                digit = ch - 'A' + 10;
                             }
-                        }
 
-                        if (left.empty()) {
-                            continue;
+                            if (digit > -1) {
+                                if (++line_size_ > 15) {
+                                    return -1;
+                                }
+
+                                remaining_ = (remaining_ << 4) | digit;
+                            }
+                            elif(line_size_ < 1) {
+                                return -1;
+                            }
+                            elif(ch == '\r') {
+                                state_ = STATE_CHUNK_SIZE_LF;
+                            }
+                            elif(ch == ';' || ch == ' ' || ch == '\t') {
+                                state_ = STATE_CHUNK_EXTENSION;
+                            }
+                            else {
+                                return -1;
+                            }
+                            break;
                         }
-                        else {
-                            s[left] = str.substr(n);
+                        case STATE_CHUNK_EXTENSION:
+                            if (ch == '\r') {
+                                state_ = STATE_CHUNK_SIZE_LF;
+                            }
+                            elif(ch == '\n') {
+                                return -1;
+                            }
+                            break;
+                        case STATE_CHUNK_SIZE_LF:
+                            if (ch != '\n') {
+                                return -1;
+                            }
+
+                            line_size_ = 0;
+                            state_ = remaining_ > 0 ? STATE_CHUNK_DATA : STATE_TRAILER;
+                            break;
+                        case STATE_CHUNK_DATA_CR:
+                            if (ch != '\r') {
+                                return -1;
+                            }
+
+                            state_ = STATE_CHUNK_DATA_LF;
+                            break;
+                        case STATE_CHUNK_DATA_LF:
+                            if (ch != '\n') {
+                                return -1;
+                            }
+
+                            state_ = STATE_CHUNK_SIZE;
+                            break;
+                        default: // STATE_TRAILER, an empty line ends the message.
+                            if (ch == '\n') {
+                                if (line_size_ < 1) {
+                                    state_ = STATE_COMPLETED;
+                                }
+
+                                line_size_ = 0;
+                            }
+                            elif(ch != '\r') {
+                                line_size_++;
+                            }
+                            break;
                         }
                     }
-                    return true;
+                    return offset;
                 }
 
-                void VEthernetHttpProxyConnection::Update() noexcept {
-                    bool linked = false;
+                bool VEthernetHttpProxyConnection::IsLinked() noexcept {
                     if (VirtualEthernetTcpipConnectionPtr connection = connection_; NULL != connection) {
-                        linked = connection->IsLinked();
+                        return connection->IsLinked();
                     }
                     elif(std::shared_ptr<RinetdConnection> connection = connection_rinetd_; NULL != connection) {
-                        linked = connection->IsLinked();
-                    }
-
-                    if (linked) {
-                        timeout_ = Executors::GetTickCount() + (UInt64)configuration_->tcp.inactive.timeout * 1000;
+                        return connection->IsLinked();
                     }
                     else {
-                        timeout_ = Executors::GetTickCount() + (UInt64)configuration_->tcp.connect.timeout * 1000;;
+                        return false;
                     }
                 }
 
-                ppp::string VEthernetHttpProxyConnection::ProtocolRoot::ToString() noexcept {
-                    ppp::string protocol;
-                    if (this->TunnelMode) {
-                        protocol = this->Method + " " + this->Host + " " + this->Protocol + "/" + this->Version + "\r\n";
+                void VEthernetHttpProxyConnection::Update() noexcept {
+                    bool linked = IsLinked();
+                    if (linked) {
+                        timeout_ = Executors::GetTickCount() + (UInt64)configuration_->tcp.inactive.timeout * 1000;
                     }
                     else {
-                        protocol = this->Method + " " + this->RawUri + " " + this->Protocol + "/" + this->Version + "\r\n";
-                    }
-
-                    HeaderCollection::iterator headerTail = this->Headers.begin();
-                    HeaderCollection::iterator headerEndl = this->Headers.end();
-                    for (; headerTail != headerEndl; ++headerTail) {
-                        protocol += headerTail->first + ": " + headerTail->second + "\r\n";
+                        timeout_ = Executors::GetTickCount() + (UInt64)configuration_->tcp.connect.timeout * 1000;;
                     }
-
-                    protocol += "\r\n";
-                    return protocol;
                 }
             }
         }
@@ -23,24 +23,78 @@ namespace ppp {
                 public:
                     class ProtocolRoot final {
                     public:
-                        typedef ppp::unordered_map<ppp::string, ppp::string>            HeaderCollection;
+                        struct Segment {
+                            int                                                         Offset = 0;
+                            int                                                         Length = 0;
+                        };
 
                     public:
-                        ppp::string                                                     RawRotocol;
-                        ppp::string                                                     Protocol;
-                        ppp::string                                                     Method;
-                        ppp::string                                                     RawUri;
+                        Segment                                                         Method;
+                        Segment                                                         RawUri;
+                        Segment                                                         Version;
+                        Segment                                                         Headers;
                         bool                                                            TunnelMode = false;
+                        bool                                                            Chunked    = false;
+                        bool                                                            KeepAlive  = false;
+                        bool                                                            HeadMethod = false;
+                        Int64                                                           ContentLength = -1;
                         ppp::string                                                     Host;
-                        ppp::string                                                     Version;
-                        HeaderCollection                                                Headers;
 
                     public:
-                        ProtocolRoot() noexcept : TunnelMode(false) {}
+                        ProtocolRoot() noexcept : TunnelMode(false), Chunked(false), KeepAlive(false), HeadMethod(false), ContentLength(-1) {}
 
                     public:
-                        ppp::string                                                     ToString() noexcept;
+                        /* Parses the request line and header block in place, headers_size must end just after the terminating "\r\n\r\n". */
+                        bool                                                            Parse(const char* headers, int headers_size) noexcept;
+                        /* Rewrites the request head in place into origin-form without proxy hop-by-hop headers and with a Connection header 
+                         * that follows KeepAlive, returns the new head size, which may exceed the source head by at most PROTOCOL_HEADERS_RESERVED bytes. */
+                        int                                                             ToArray(char* headers) const noexcept;
                     };
+
+                    /* The framing of a response head, a response with neither a length nor the chunked coding ends when the upstream closes. */
+                    class ProtocolResponse final {
+                    public:
+                        int                                                             StatusCode    = 0;
+                        bool                                                            Chunked       = false;
+                        bool                                                            KeepAlive     = false;
+                        Int64                                                           ContentLength = -1;
+
+                    public:
+                        /* Parses the status line and header block in place, 1xx, 204 and 304 responses and answers to HEAD carry no body. */
+                        bool                                                            Parse(const char* headers, int headers_size, const ProtocolRoot& protocolRoot) noexcept;
+                        bool                                                            IsDelimited() const noexcept { return Chunked || ContentLength > -1; }
+                    };
+
+                    /* Tracks where a message body ends, so that nothing sent behind it is forwarded with it. */
+                    class ProtocolBody final {
+                    public:
+                        ProtocolBody(const ProtocolRoot& protocolRoot) noexcept : ProtocolBody(protocolRoot.Chunked, protocolRoot.ContentLength) {}
+                        ProtocolBody(bool chunked, Int64 content_length) noexcept;
+
+                    public:
+                        /* Returns how many of the length bytes at s still belong to the body, or -1 if the chunked coding is malformed. */
+                        int                                                             Consume(const char* s, int length) noexcept;
+                        bool                                                            IsCompleted() const noexcept { return state_ == STATE_COMPLETED; }
+
+                    private:
+                        enum {
+                            STATE_COMPLETED,
+                            STATE_LENGTH,
+                            STATE_CHUNK_SIZE,
+                            STATE_CHUNK_EXTENSION,
+                            STATE_CHUNK_SIZE_LF,
+                            STATE_CHUNK_DATA,
+                            STATE_CHUNK_DATA_CR,
+                            STATE_CHUNK_DATA_LF,
+                            STATE_TRAILER,
+                        };
+                        int                                                             state_     = STATE_COMPLETED;
+                        int                                                             line_size_ = 0;
+                        Int64                                                           remaining_ = 0;
+                    };
+
+                    static constexpr int                                                PROTOCOL_HEADERS_RESERVED = 24; // Connection: keep-alive\r\n
+
                     typedef ppp::net::rinetd::RinetdConnection                          RinetdConnection;
                     typedef ppp::configurations::AppConfiguration                       AppConfiguration;
                     typedef std::shared_ptr<AppConfiguration>                           AppConfigurationPtr;
@@ -77,24 +131,42 @@ namespace ppp {
                     virtual void                                                        Update() noexcept;
                     virtual void                                                        Dispose() noexcept;
                     bool                                                                IsPortAging(uint64_t now) noexcept { return disposed_ || now >= timeout_; }
+                    bool                                                                IsDisposed() noexcept { return disposed_; }
 
-                private:
-                    void                                                                Finalize() noexcept;
-                    bool                                                                ProtocolReadFirstRoot(const ppp::vector<ppp::string>& headers, const std::shared_ptr<ProtocolRoot>& protocolRoot) noexcept;
-                    bool                                                                ProtocolReadAllHeaders(const ppp::vector<ppp::string>& headers, ProtocolRoot::HeaderCollection& s) noexcept;
-                    std::shared_ptr<ProtocolRoot>                                       GetProtocolRootFromSocket(ppp::io::MemoryStream& ms) noexcept;
-                    bool                                                                ProtocolReadHeaders(ppp::io::MemoryStream& ms, ppp::vector<ppp::string>& headers, ppp::string* out_) noexcept;
-                    std::shared_ptr<ppp::app::protocol::AddressEndPoint>                GetAddressEndPointByProtocol(const std::shared_ptr<ProtocolRoot>& protocolRoot) noexcept;
-                    bool                                                                ProcessHandshaked(const std::shared_ptr<ProtocolRoot>& protocolRoot, const void* messages, int messages_size, YieldContext& y) noexcept;
-                    bool                                                                ProcessHandshaking(YieldContext& y) noexcept;
-                    bool                                                                ConnectBridgeToPeer(const std::shared_ptr<ProtocolRoot>& protocolRoot, YieldContext& y) noexcept;
+                protected:
+                    virtual bool                                                        IsLinked() noexcept;
+                    virtual bool                                                        ProcessHandshaking(YieldContext& y) noexcept;
+                    bool                                                                ConnectBridgeToPeer(const std::shared_ptr<ppp::app::protocol::AddressEndPoint>& destinationEP, YieldContext& y) noexcept;
+                    bool                                                                SendBufferToPeer(YieldContext& y, const void* messages, int messages_size) noexcept;
 
                 private:
-                    bool                                                                SendBufferToPeer(YieldContext& y, ppp::io::MemoryStream& stream) noexcept;
-                    bool                                                                SendBufferToPeer(YieldContext& y, const void* messages, int messages_size) noexcept;
+                    enum {
+                        FORWARD_RESPONSE_FAILED = -1,
+                        FORWARD_RESPONSE_CLOSE,
+                        FORWARD_RESPONSE_KEEP_ALIVE,
+                        FORWARD_RESPONSE_RESET,         // The upstream closed before it sent a byte of the response.
+                    };
+
+                    void                                                                Finalize() noexcept;
+                    int                                                                 ProtocolReadHeaders(int& headers_size, YieldContext& y) noexcept;
+                    std::shared_ptr<ppp::app::protocol::AddressEndPoint>                GetAddressEndPointByProtocol(const ProtocolRoot& protocolRoot) noexcept;
+                    bool                                                                ProcessHandshaked(const ProtocolRoot& protocolRoot, char* messages, int headers_size, int messages_size, YieldContext& y) noexcept;
+                    bool                                                                ProcessRequest(const ProtocolRoot& protocolRoot, int headers_size, YieldContext& y) noexcept;
+                    bool                                                                ForwardBodyToPeer(ProtocolBody& body, YieldContext& y) noexcept;
+                    int                                                                 ForwardResponseToSocket(const ProtocolRoot& protocolRoot, bool& reusable, YieldContext& y) noexcept;
+                    std::shared_ptr<Byte>                                               ReadBufferFromPeer(YieldContext& y, int& length) noexcept;
+                    void                                                                ReleaseBridgeToPeer() noexcept;
 
                 private:
-                    bool                                                                disposed_ = false;
+                    bool                                                                disposed_  = false;
+                    bool                                                                tunnel_    = false;
+                    bool                                                                uploading_ = false;
+                    YieldContext*                                                       waiting_   = NULL;
+                    int                                                                 buffer_length_ = 0;
+                    std::shared_ptr<Byte>                                               buffer_;
+                    std::shared_ptr<Byte>                                               response_buffer_;
+                    std::shared_ptr<Byte>                                               peer_buffer_;
+                    ppp::string                                                         host_;
                     std::shared_ptr<boost::asio::io_context>                            context_;
                     ppp::threading::Executors::StrandPtr                                strand_;
                     UInt64                                                              timeout_  = 0;
@@ -76,13 +76,13 @@ namespace ppp {
                         return false;
                     }
                     else {
-                        int bind_port = configuration_->client.http_proxy.port;
+                        int bind_port = GetBindPort();
                         if (bind_port <= ppp::net::IPEndPoint::MinPort || bind_port > ppp::net::IPEndPoint::MaxPort) {
                             return false;
                         }
 
                         boost::asio::ip::address bind_ips[] = {
-                                ppp::net::Ipep::ToAddress(configuration_->client.http_proxy.bind, true),
+                                ppp::net::Ipep::ToAddress(GetBindAddress(), true),
                                 boost::asio::ip::address_v6::any(),
                                 boost::asio::ip::address_v4::any()
                             };
@@ -288,6 +288,14 @@ namespace ppp {
                     return make_shared_object<VEthernetHttpProxyConnection>(self, exchanger_, context, strand, socket);
                 }
 
+                int VEthernetHttpProxySwitcher::GetBindPort() noexcept {
+                    return configuration_->client.http_proxy.port;
+                }
+
+                ppp::string VEthernetHttpProxySwitcher::GetBindAddress() noexcept {
+                    return configuration_->client.http_proxy.bind;
+                }
+
                 boost::asio::ip::tcp::endpoint VEthernetHttpProxySwitcher::GetLocalEndPoint() noexcept {
                     std::shared_ptr<ppp::net::SocketAcceptor> acceptor = acceptor_;
                     if (NULL != acceptor) {
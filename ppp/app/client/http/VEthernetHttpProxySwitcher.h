@@ -38,6 +38,8 @@ namespace ppp {
 
                 protected:
                     virtual void                                                        Update(UInt64 now) noexcept;
+                    virtual int                                                         GetBindPort() noexcept;
+                    virtual ppp::string                                                 GetBindAddress() noexcept;
                     virtual std::shared_ptr<VEthernetHttpProxyConnection>               NewConnection(const std::shared_ptr<boost::asio::io_context>& context, const ppp::threading::Executors::StrandPtr& strand, const std::shared_ptr<boost::asio::ip::tcp::socket>& socket) noexcept;
 
                 private:
@@ -0,0 +1,512 @@
+#include <ppp/app/client/VEthernetExchanger.h>
+#include <ppp/app/client/VEthernetDatagramPort.h>
+#include <ppp/app/client/http/VEthernetHttpProxySwitcher.h>
+#include <ppp/app/client/socks/VEthernetSocksProxyConnection.h>
+
+#include <ppp/IDisposable.h>
+#include <ppp/net/Ipep.h>
+#include <ppp/net/Socket.h>
+#include <ppp/net/IPEndPoint.h>
+#include <ppp/coroutines/asio/asio.h>
+#include <ppp/coroutines/YieldContext.h>
+
+namespace ppp {
+    namespace app {
+        namespace client {
+            namespace socks {
+                static constexpr Byte SOCKS_VERSION                             = 0x05;
+                static constexpr Byte SOCKS_METHOD_NO_AUTHENTICATION            = 0x00;
+                static constexpr Byte SOCKS_METHOD_NO_ACCEPTABLE                = 0xFF;
+                static constexpr Byte SOCKS_COMMAND_CONNECT                     = 0x01;
+                static constexpr Byte SOCKS_COMMAND_UDP_ASSOCIATE               = 0x03;
+                static constexpr Byte SOCKS_ADDRESS_IPV4                        = 0x01;
+                static constexpr Byte SOCKS_ADDRESS_DOMAIN                      = 0x03;
+                static constexpr Byte SOCKS_ADDRESS_IPV6                        = 0x04;
+                static constexpr Byte SOCKS_REPLY_SUCCEEDED                     = 0x00;
+                static constexpr Byte SOCKS_REPLY_GENERAL_FAILURE               = 0x01;
+                static constexpr Byte SOCKS_REPLY_COMMAND_NOT_SUPPORTED         = 0x07;
+                static constexpr Byte SOCKS_REPLY_ADDRESS_NOT_SUPPORTED         = 0x08;
+
+                // RSV(2) FRAG(1) ATYP(1) ADDR(16) PORT(2), the widest UDP reply header, replies always carry the address they came from.
+                static constexpr int SOCKS_UDP_HEADER_MAX_SIZE                  = 22;
+
+                VEthernetSocksProxyConnection::VEthernetSocksProxyConnection(const VEthernetHttpProxySwitcherPtr& proxy, const VEthernetExchangerPtr& exchanger, const std::shared_ptr<boost::asio::io_context>& context, const ppp::threading::Executors::StrandPtr& strand, const std::shared_ptr<boost::asio::ip::tcp::socket>& socket) noexcept
+                    : VEthernetHttpProxyConnection(proxy, exchanger, context, strand, socket)
+                    , associated_(false) {
+
+                }
+
+                VEthernetSocksProxyConnection::~VEthernetSocksProxyConnection() noexcept {
+                    Finalize();
+                }
+
+                void VEthernetSocksProxyConnection::Finalize() noexcept {
+                    std::shared_ptr<boost::asio::ip::udp::socket> associate_socket = std::move(associate_socket_);
+                    if (NULL != associate_socket) {
+                        associate_socket_.reset();
+                        ppp::net::Socket::Closesocket(associate_socket);
+                    }
+
+                    VEthernetDatagramPortPtr associate_port = std::move(associate_port_);
+                    if (NULL != associate_port) {
+                        associate_port_.reset();
+                        associate_port->Dispose();
+                    }
+                }
+
+                void VEthernetSocksProxyConnection::Dispose() noexcept {
+                    auto self = std::static_pointer_cast<VEthernetSocksProxyConnection>(shared_from_this());
+                    ppp::threading::Executors::Post(GetContext(), GetStrand(),
+                        [self, this]() noexcept {
+                            Finalize();
+                        });
+
+                    VEthernetHttpProxyConnection::Dispose();
+                }
+
+                bool VEthernetSocksProxyConnection::IsLinked() noexcept {
+                    return associated_ || VEthernetHttpProxyConnection::IsLinked();
+                }
+
+                bool VEthernetSocksProxyConnection::ProcessHandshaking(YieldContext& y) noexcept {
+                    if (IsDisposed()) {
+                        return false;
+                    }
+
+                    Update();
+                    if (!ProcessNegotiate(y)) {
+                        return false;
+                    }
+
+                    Byte command = 0;
+                    std::shared_ptr<ppp::app::protocol::AddressEndPoint> destinationEP = ProcessRequest(command, y);
+                    if (NULL == destinationEP) {
+                        return false;
+                    }
+
+                    boost::asio::ip::address any = boost::asio::ip::address_v4::any();
+                    if (command == SOCKS_COMMAND_CONNECT) {
+                        if (!ConnectBridgeToPeer(destinationEP, y)) {
+                            ReplyToClient(SOCKS_REPLY_GENERAL_FAILURE, any, 0, y);
+                            return false;
+                        }
+
+                        return ReplyToClient(SOCKS_REPLY_SUCCEEDED, any, 0, y);
+                    }
+                    elif(command == SOCKS_COMMAND_UDP_ASSOCIATE) {
+                        return ProcessAssociate(y);
+                    }
+                    else {
+                        ReplyToClient(SOCKS_REPLY_COMMAND_NOT_SUPPORTED, any, 0, y);
+                        return false;
+                    }
+                }
+
+                bool VEthernetSocksProxyConnection::ProcessNegotiate(YieldContext& y) noexcept {
+                    std::shared_ptr<boost::asio::ip::tcp::socket> socket = GetSocket();
+                    if (NULL == socket) {
+                        return false;
+                    }
+
+                    // VER NMETHODS METHODS[NMETHODS], only the no authentication method is offered.
+                    Byte messages[UINT8_MAX + 1];
+                    if (!ppp::coroutines::asio::async_read(*socket, boost::asio::buffer(messages, 2), y)) {
+                        return false;
+                    }
+
+                    int methods_count = messages[1];
+                    if (messages[0] != SOCKS_VERSION || methods_count < 1) {
+                        return false;
+                    }
+
+                    if (!ppp::coroutines::asio::async_read(*socket, boost::asio::buffer(messages, methods_count), y)) {
+                        return false;
+                    }
+
+                    Byte method = SOCKS_METHOD_NO_ACCEPTABLE;
+                    if (NULL != memchr(messages, SOCKS_METHOD_NO_AUTHENTICATION, methods_count)) {
+                        method = SOCKS_METHOD_NO_AUTHENTICATION;
+                    }
+
+                    Byte replies[2] = { SOCKS_VERSION, method };
+                    if (!ppp::coroutines::asio::async_write(*socket, boost::asio::buffer(replies, sizeof(replies)), y)) {
+                        return false;
+                    }
+
+                    return method == SOCKS_METHOD_NO_AUTHENTICATION;
+                }
+
+                std::shared_ptr<ppp::app::protocol::AddressEndPoint> VEthernetSocksProxyConnection::ProcessRequest(Byte& command, YieldContext& y) noexcept {
+                    std::shared_ptr<boost::asio::ip::tcp::socket> socket = GetSocket();
+                    if (NULL == socket) {
+                        return NULL;
+                    }
+
+                    // VER CMD RSV ATYP DST.ADDR DST.PORT
+                    Byte messages[UINT8_MAX + 2];
+                    if (!ppp::coroutines::asio::async_read(*socket, boost::asio::buffer(messages, 4), y)) {
+                        return NULL;
+                    }
+
+                    if (messages[0] != SOCKS_VERSION) {
+                        return NULL;
+                    }
+
+                    std::shared_ptr<ppp::app::protocol::AddressEndPoint> destinationEP = make_shared_object<ppp::app::protocol::AddressEndPoint>();
+                    if (NULL == destinationEP) {
+                        return NULL;
+                    }
+
+                    command = messages[1];
+
+                    Byte address_type = messages[3];
+                    if (address_type == SOCKS_ADDRESS_IPV4 || address_type == SOCKS_ADDRESS_IPV6) {
+                        int address_size = address_type == SOCKS_ADDRESS_IPV4 ? 4 : 16;
+                        if (!ppp::coroutines::asio::async_read(*socket, boost::asio::buffer(messages, address_size + 2), y)) {
+                            return NULL;
+                        }
+
+                        boost::asio::ip::address address;
+                        if (address_type == SOCKS_ADDRESS_IPV4) {
+                            boost::asio::ip::address_v4::bytes_type address_bytes;
+                            memcpy(address_bytes.data(), messages, address_size);
+
+                            address = boost::asio::ip::address_v4(address_bytes);
+                            destinationEP->Type = ppp::app::protocol::AddressType::IPv4;
+                        }
+                        else {
+                            boost::asio::ip::address_v6::bytes_type address_bytes;
+                            memcpy(address_bytes.data(), messages, address_size);
+
+                            address = boost::asio::ip::address_v6(address_bytes);
+                            destinationEP->Type = ppp::app::protocol::AddressType::IPv6;
+                        }
+
+                        destinationEP->Host = ppp::net::Ipep::ToAddressString<ppp::string>(address);
+                        destinationEP->Port = messages[address_size] << 8 | messages[address_size + 1];
+                    }
+                    elif(address_type == SOCKS_ADDRESS_DOMAIN) {
+                        if (!ppp::coroutines::asio::async_read(*socket, boost::asio::buffer(messages, 1), y)) {
+                            return NULL;
+                        }
+
+                        int domain_size = messages[0];
+                        if (domain_size < 1) {
+                            return NULL;
+                        }
+
+                        if (!ppp::coroutines::asio::async_read(*socket, boost::asio::buffer(messages, domain_size + 2), y)) {
+                            return NULL;
+                        }
+
+                        destinationEP->Type = ppp::app::protocol::AddressType::Domain;
+                        destinationEP->Host = ppp::string((char*)messages, domain_size);
+                        destinationEP->Port = messages[domain_size] << 8 | messages[domain_size + 1];
+                    }
+                    else {
+                        ReplyToClient(SOCKS_REPLY_ADDRESS_NOT_SUPPORTED, boost::asio::ip::address_v4::any(), 0, y);
+                        return NULL;
+                    }
+
+                    // A UDP ASSOCIATE request may carry a zero port, it only announces where the client will send from.
+                    if (command != SOCKS_COMMAND_UDP_ASSOCIATE) {
+                        if (destinationEP->Port <= ppp::net::IPEndPoint::MinPort || destinationEP->Port > ppp::net::IPEndPoint::MaxPort) {
+                            return NULL;
+                        }
+                    }
+
+                    return destinationEP;
+                }
+
+                bool VEthernetSocksProxyConnection::ReplyToClient(Byte reply, const boost::asio::ip::address& address, int port, YieldContext& y) noexcept {
+                    std::shared_ptr<boost::asio::ip::tcp::socket> socket = GetSocket();
+                    if (NULL == socket) {
+                        return false;
+                    }
+
+                    // VER REP RSV ATYP BND.ADDR BND.PORT
+                    Byte messages[4 + 16 + 2] = { SOCKS_VERSION, reply, 0x00 };
+                    int messages_size = 4;
+                    if (address.is_v4()) {
+                        boost::asio::ip::address_v4::bytes_type address_bytes = address.to_v4().to_bytes();
+                        messages[3] = SOCKS_ADDRESS_IPV4;
+
+                        memcpy(messages + messages_size, address_bytes.data(), address_bytes.size());
+                        messages_size += (int)address_bytes.size();
+                    }
+                    else {
+                        boost::asio::ip::address_v6::bytes_type address_bytes = address.to_v6().to_bytes();
+                        messages[3] = SOCKS_ADDRESS_IPV6;
+
+                        memcpy(messages + messages_size, address_bytes.data(), address_bytes.size());
+                        messages_size += (int)address_bytes.size();
+                    }
+
+                    messages[messages_size++] = (Byte)(port >> 8);
+                    messages[messages_size++] = (Byte)(port);
+                    return ppp::coroutines::asio::async_write(*socket, boost::asio::buffer(messages, messages_size), y);
+                }
+
+                bool VEthernetSocksProxyConnection::ProcessAssociate(YieldContext& y) noexcept {
+                    std::shared_ptr<boost::asio::ip::tcp::socket> socket = GetSocket();
+                    if (NULL == socket) {
+                        return false;
+                    }
+
+                    boost::system::error_code ec;
+                    boost::asio::ip::tcp::endpoint localEP = socket->local_endpoint(ec);
+                    if (ec) {
+                        return false;
+                    }
+
+                    boost::asio::ip::tcp::endpoint remoteEP = socket->remote_endpoint(ec);
+                    if (ec) {
+                        return false;
+                    }
+
+                    boost::asio::ip::address any = boost::asio::ip::address_v4::any();
+                    std::shared_ptr<boost::asio::io_context> context = GetContext();
+                    ppp::threading::Executors::StrandPtr strand = GetStrand();
+
+                    // The relay socket listens on the address the client reached this proxy on, replies are only accepted from the client's host.
+                    std::shared_ptr<boost::asio::ip::udp::socket> associate_socket = strand ?
+                        make_shared_object<boost::asio::ip::udp::socket>(*strand) : make_shared_object<boost::asio::ip::udp::socket>(*context);
+                    if (NULL == associate_socket) {
+                        ReplyToClient(SOCKS_REPLY_GENERAL_FAILURE, any, 0, y);
+                        return false;
+                    }
+
+                    if (!ppp::net::Socket::OpenSocket(*associate_socket, localEP.address(), ppp::net::IPEndPoint::MinPort)) {
+                        ppp::net::Socket::Closesocket(associate_socket);
+                        ReplyToClient(SOCKS_REPLY_GENERAL_FAILURE, any, 0, y);
+                        return false;
+                    }
+
+                    boost::asio::ip::udp::endpoint bindEP = associate_socket->local_endpoint(ec);
+                    if (ec) {
+                        ppp::net::Socket::Closesocket(associate_socket);
+                        ReplyToClient(SOCKS_REPLY_GENERAL_FAILURE, any, 0, y);
+                        return false;
+                    }
+
+                    associate_buffer_ = ppp::threading::BufferswapAllocator::MakeByteArray(GetBufferAllocator(), PPP_BUFFER_SIZE);
+                    if (NULL == associate_buffer_) {
+                        ppp::net::Socket::Closesocket(associate_socket);
+                        ReplyToClient(SOCKS_REPLY_GENERAL_FAILURE, any, 0, y);
+                        return false;
+                    }
+
+                    associate_socket_ = associate_socket;
+                    associate_client_ip_ = ppp::net::Ipep::V6ToV4(remoteEP).address();
+
+                    if (!ReplyToClient(SOCKS_REPLY_SUCCEEDED, bindEP.address(), bindEP.port(), y)) {
+                        return false;
+                    }
+
+                    if (!AssociateLoopback()) {
+                        return false;
+                    }
+
+                    associated_ = true;
+                    Update();
+
+                    // The association lives as long as the control connection, RFC 1928 section 7.
+                    Byte messages[64];
+                    for (;;) {
+                        int bytes_transferred = ppp::coroutines::asio::async_read_some(*socket, boost::asio::buffer(messages, sizeof(messages)), y);
+                        if (bytes_transferred < 1) {
+                            break;
+                        }
+                    }
+
+                    return false;
+                }
+
+                bool VEthernetSocksProxyConnection::AssociateLoopback() noexcept {
+                    std::shared_ptr<boost::asio::ip::udp::socket> associate_socket = associate_socket_;
+                    if (NULL == associate_socket || IsDisposed()) {
+                        return false;
+                    }
+
+                    bool opened = associate_socket->is_open();
+                    if (!opened) {
+                        return false;
+                    }
+
+                    auto self = std::static_pointer_cast<VEthernetSocksProxyConnection>(shared_from_this());
+                    associate_socket->async_receive_from(boost::asio::buffer(associate_buffer_.get(), PPP_BUFFER_SIZE), associate_remote_ep_,
+                        [self, this](const boost::system::error_code& ec, std::size_t sz) noexcept {
+                            if (ec == boost::system::errc::operation_canceled) {
+                                return;
+                            }
+
+                            if (ec == boost::system::errc::success && sz > 0) {
+                                boost::asio::ip::udp::endpoint remoteEP = ppp::net::Ipep::V6ToV4(associate_remote_ep_);
+                                if (remoteEP.address() == associate_client_ip_) {
+                                    // The first datagram from the client's host pins the port the relay answers to.
+                                    if (associate_source_ep_.port() == ppp::net::IPEndPoint::MinPort) {
+                                        associate_source_ep_ = remoteEP;
+                                    }
+
+                                    if (associate_source_ep_ == remoteEP) {
+                                        AssociateSendTo(associate_buffer_.get(), (int)sz);
+                                    }
+                                }
+                            }
+
+                            AssociateLoopback();
+                        });
+                    return true;
+                }
+
+                bool VEthernetSocksProxyConnection::AssociateSendTo(Byte* packet, int packet_length) noexcept {
+                    // RSV(2) FRAG(1) ATYP(1) DST.ADDR DST.PORT DATA, fragments are not relayed.
+                    if (packet_length < 4 || packet[2] != 0) {
+                        return false;
+                    }
+
+                    int address_size = 0;
+                    int address_offset = 4;
+                    boost::asio::ip::address address;
+                    ppp::string hostname;
+                    if (packet[3] == SOCKS_ADDRESS_IPV4) {
+                        address_size = 4;
+                        if (packet_length < 4 + address_size + 2) {
+                            return false;
+                        }
+
+                        boost::asio::ip::address_v4::bytes_type address_bytes;
+                        memcpy(address_bytes.data(), packet + 4, address_size);
+                        address = boost::asio::ip::address_v4(address_bytes);
+                    }
+                    elif(packet[3] == SOCKS_ADDRESS_IPV6) {
+                        address_size = 16;
+                        if (packet_length < 4 + address_size + 2) {
+                            return false;
+                        }
+
+                        boost::asio::ip::address_v6::bytes_type address_bytes;
+                        memcpy(address_bytes.data(), packet + 4, address_size);
+                        address = boost::asio::ip::address_v6(address_bytes);
+                    }
+                    elif(packet[3] == SOCKS_ADDRESS_DOMAIN) {
+                        // The name is relayed as it is, like a CONNECT to a domain, and resolved by the server.
+                        if (packet_length < 5) {
+                            return false;
+                        }
+
+                        address_size = packet[4];
+                        address_offset = 5;
+                        if (address_size < 1 || packet_length < address_offset + address_size + 2) {
+                            return false;
+                        }
+
+                        hostname = ppp::string((char*)packet + address_offset, address_size);
+                    }
+                    else {
+                        return false;
+                    }
+
+                    Byte* port = packet + address_offset + address_size;
+                    boost::asio::ip::udp::endpoint destinationEP(address, port[0] << 8 | port[1]);
+
+                    int header_size = address_offset + address_size + 2;
+                    Byte* messages = packet + header_size;
+                    int messages_size = packet_length - header_size;
+                    if (messages_size < 1) {
+                        return false;
+                    }
+
+                    VEthernetExchangerPtr exchanger = GetExchanger();
+                    if (NULL == exchanger) {
+                        return false;
+                    }
+
+                    Update();
+                    for (int i = 0; i < 2; i++) {
+                        VEthernetDatagramPortPtr associate_port = associate_port_;
+                        if (NULL != associate_port) {
+                            bool ok = hostname.empty() ?
+                                associate_port->SendTo(messages, messages_size, destinationEP) :
+                                associate_port->SendTo(messages, messages_size, hostname, destinationEP.port());
+                            if (ok) {
+                                return true;
+                            }
+                        }
+
+                        // The datagram port ages out on its own inactivity timer, it is reopened on the next outgoing datagram.
+                        std::weak_ptr<VEthernetHttpProxyConnection> connection_weak = shared_from_this();
+                        associate_port_ = exchanger->OpenDatagramPort(associate_source_ep_,
+                            [connection_weak](VEthernetDatagramPort* port, void* packet, int packet_length, const boost::asio::ip::udp::endpoint& remoteEP) noexcept {
+                                std::shared_ptr<VEthernetHttpProxyConnection> connection = connection_weak.lock();
+                                if (NULL != connection) {
+                                    auto self = std::static_pointer_cast<VEthernetSocksProxyConnection>(connection);
+                                    self->AssociateReceiveFrom(packet, packet_length, remoteEP);
+                                }
+                            });
+                        if (NULL == associate_port_) {
+                            break;
+                        }
+                    }
+
+                    return false;
+                }
+
+                bool VEthernetSocksProxyConnection::AssociateReceiveFrom(const void* packet, int packet_length, const boost::asio::ip::udp::endpoint& remoteEP) noexcept {
+                    if (NULL == packet || packet_length < 1 || IsDisposed()) {
+                        return false;
+                    }
+
+                    std::shared_ptr<Byte> messages = ppp::threading::BufferswapAllocator::MakeByteArray(GetBufferAllocator(), SOCKS_UDP_HEADER_MAX_SIZE + packet_length);
+                    if (NULL == messages) {
+                        return false;
+                    }
+
+                    // The reply arrives on the exchanger's context, it is framed here and handed over to the connection's context to be sent.
+                    Byte* p = messages.get();
+                    p[0] = 0x00;
+                    p[1] = 0x00;
+                    p[2] = 0x00;
+
+                    int messages_size = 4;
+                    boost::asio::ip::address address = ppp::net::Ipep::V6ToV4(remoteEP).address();
+                    if (address.is_v4()) {
+                        boost::asio::ip::address_v4::bytes_type address_bytes = address.to_v4().to_bytes();
+                        p[3] = SOCKS_ADDRESS_IPV4;
+
+                        memcpy(p + messages_size, address_bytes.data(), address_bytes.size());
+                        messages_size += (int)address_bytes.size();
+                    }
+                    else {
+                        boost::asio::ip::address_v6::bytes_type address_bytes = address.to_v6().to_bytes();
+                        p[3] = SOCKS_ADDRESS_IPV6;
+
+                        memcpy(p + messages_size, address_bytes.data(), address_bytes.size());
+                        messages_size += (int)address_bytes.size();
+                    }
+
+                    int port = remoteEP.port();
+                    p[messages_size++] = (Byte)(port >> 8);
+                    p[messages_size++] = (Byte)(port);
+
+                    memcpy(p + messages_size, packet, packet_length);
+                    messages_size += packet_length;
+
+                    auto self = std::static_pointer_cast<VEthernetSocksProxyConnection>(shared_from_this());
+                    ppp::threading::Executors::Post(GetContext(), GetStrand(),
+                        [self, this, messages, messages_size]() noexcept {
+                            std::shared_ptr<boost::asio::ip::udp::socket> associate_socket = associate_socket_;
+                            if (NULL == associate_socket || !associate_socket->is_open()) {
+                                return;
+                            }
+
+                            Update();
+                            associate_socket->async_send_to(boost::asio::buffer(messages.get(), messages_size), associate_source_ep_,
+                                [self, messages](const boost::system::error_code& ec, std::size_t sz) noexcept {});
+                        });
+                    return true;
+                }
+            }
+        }
+    }
+}
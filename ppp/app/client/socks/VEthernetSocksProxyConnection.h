@@ -0,0 +1,55 @@
+#pragma once
+
+#include <ppp/app/client/http/VEthernetHttpProxyConnection.h>
+
+namespace ppp {
+    namespace app {
+        namespace client {
+            class VEthernetDatagramPort;
+
+            namespace socks {
+                /* RFC 1928 SOCKS5 front-end, CONNECT is bridged onto the link-layer streams and UDP ASSOCIATE onto the exchanger's datagram ports. */
+                class VEthernetSocksProxyConnection : public ppp::app::client::http::VEthernetHttpProxyConnection {
+                public:
+                    typedef std::shared_ptr<VEthernetDatagramPort>                      VEthernetDatagramPortPtr;
+
+                public:
+                    VEthernetSocksProxyConnection(const VEthernetHttpProxySwitcherPtr&  proxy,
+                        const VEthernetExchangerPtr&                                    exchanger,
+                        const std::shared_ptr<boost::asio::io_context>&                 context,
+                        const ppp::threading::Executors::StrandPtr&                     strand,
+                        const std::shared_ptr<boost::asio::ip::tcp::socket>&            socket) noexcept;
+                    virtual ~VEthernetSocksProxyConnection() noexcept;
+
+                public:
+                    virtual void                                                        Dispose() noexcept override;
+
+                protected:
+                    virtual bool                                                        IsLinked() noexcept override;
+                    virtual bool                                                        ProcessHandshaking(YieldContext& y) noexcept override;
+
+                private:
+                    void                                                                Finalize() noexcept;
+                    bool                                                                ProcessNegotiate(YieldContext& y) noexcept;
+                    std::shared_ptr<ppp::app::protocol::AddressEndPoint>                ProcessRequest(Byte& command, YieldContext& y) noexcept;
+                    bool                                                                ProcessAssociate(YieldContext& y) noexcept;
+                    bool                                                                ReplyToClient(Byte reply, const boost::asio::ip::address& address, int port, YieldContext& y) noexcept;
+
+                private:
+                    bool                                                                AssociateLoopback() noexcept;
+                    bool                                                                AssociateSendTo(Byte* packet, int packet_length) noexcept;
+                    bool                                                                AssociateReceiveFrom(const void* packet, int packet_length, const boost::asio::ip::udp::endpoint& remoteEP) noexcept;
+
+                private:
+                    bool                                                                associated_ = false;
+                    std::shared_ptr<boost::asio::ip::udp::socket>                       associate_socket_;
+                    std::shared_ptr<Byte>                                               associate_buffer_;
+                    boost::asio::ip::address                                            associate_client_ip_;
+                    boost::asio::ip::udp::endpoint                                      associate_source_ep_;
+                    boost::asio::ip::udp::endpoint                                      associate_remote_ep_;
+                    VEthernetDatagramPortPtr                                            associate_port_;
+                };
+            }
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#include <ppp/app/client/socks/VEthernetSocksProxySwitcher.h>
+#include <ppp/app/client/socks/VEthernetSocksProxyConnection.h>
+#include <ppp/app/client/VEthernetExchanger.h>
+
+namespace ppp {
+    namespace app {
+        namespace client {
+            namespace socks {
+                VEthernetSocksProxySwitcher::VEthernetSocksProxySwitcher(const std::shared_ptr<VEthernetExchanger>& exchanger) noexcept
+                    : VEthernetHttpProxySwitcher(exchanger) {
+
+                }
+
+                VEthernetSocksProxySwitcher::~VEthernetSocksProxySwitcher() noexcept {
+
+                }
+
+                int VEthernetSocksProxySwitcher::GetBindPort() noexcept {
+                    std::shared_ptr<ppp::configurations::AppConfiguration> configuration = GetConfiguration();
+                    return configuration->client.socks_proxy.port;
+                }
+
+                ppp::string VEthernetSocksProxySwitcher::GetBindAddress() noexcept {
+                    std::shared_ptr<ppp::configurations::AppConfiguration> configuration = GetConfiguration();
+                    return configuration->client.socks_proxy.bind;
+                }
+
+                std::shared_ptr<ppp::app::client::http::VEthernetHttpProxyConnection> VEthernetSocksProxySwitcher::NewConnection(const std::shared_ptr<boost::asio::io_context>& context, const ppp::threading::Executors::StrandPtr& strand, const std::shared_ptr<boost::asio::ip::tcp::socket>& socket) noexcept {
+                    auto self = std::static_pointer_cast<VEthernetHttpProxySwitcher>(shared_from_this());
+                    return make_shared_object<VEthernetSocksProxyConnection>(self, GetExchanger(), context, strand, socket);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <ppp/app/client/http/VEthernetHttpProxySwitcher.h>
+
+namespace ppp {
+    namespace app {
+        namespace client {
+            namespace socks {
+                class VEthernetSocksProxySwitcher : public ppp::app::client::http::VEthernetHttpProxySwitcher {
+                public:
+                    VEthernetSocksProxySwitcher(const std::shared_ptr<VEthernetExchanger>& exchanger) noexcept;
+                    virtual ~VEthernetSocksProxySwitcher() noexcept;
+
+                protected:
+                    virtual int                                                         GetBindPort() noexcept override;
+                    virtual ppp::string                                                 GetBindAddress() noexcept override;
+                    virtual std::shared_ptr<ppp::app::client::http::VEthernetHttpProxyConnection>
+                                                                                        NewConnection(const std::shared_ptr<boost::asio::io_context>& context, const ppp::threading::Executors::StrandPtr& strand, const std::shared_ptr<boost::asio::ip::tcp::socket>& socket) noexcept override;
+                };
+            }
+        }
+    }
+}
@@ -0,0 +1,216 @@
+#include <ppp/app/protocol/VirtualEthernetFec.h>
+
+namespace ppp {
+    namespace app {
+        namespace protocol {
+#pragma pack(push, 1)
+            typedef struct {
+                uint8_t                                                                     count;
+                uint8_t                                                                     loss;
+                uint16_t                                                                    length;
+            } VIRTUAL_ETHERNET_FEC_HEADER;
+#pragma pack(pop)
+
+            // Both sides keep a few groups worth of datagrams, parity normally trails its group by a single datagram.
+            static constexpr int VIRTUAL_ETHERNET_FEC_WINDOW = 4;
+
+            static void VirtualEthernetFec_Xor(Byte* destination, const Byte* source, int length) noexcept {
+                for (int i = 0; i < length; i++) {
+                    destination[i] ^= source[i];
+                }
+            }
+
+            VirtualEthernetFec::VirtualEthernetFec(int group_size) noexcept
+                : group_size_(std::max<int>(MIN_GROUP_SIZE, std::min<int>(group_size, MAX_GROUP_SIZE))) {
+                encode_parity_.resize(MAX_PACKET_SIZE);
+            }
+
+            int VirtualEthernetFec::Negotiate(int local, int remote) noexcept {
+                if (local < MIN_GROUP_SIZE || remote < MIN_GROUP_SIZE) {
+                    return 0;
+                }
+
+                return std::min<int>(MAX_GROUP_SIZE, std::min<int>(local, remote));
+            }
+
+            uint32_t VirtualEthernetFec::Hash(const void* packet, int packet_length) noexcept {
+                // Sealed datagrams start with a random mask and cipher text, the head alone tells them apart.
+                uint32_t h = (uint32_t)ppp::GetHashCode((char*)packet, std::min<int>(packet_length, 64));
+                return h ^ ((uint32_t)packet_length * 0x9e3779b1u);
+            }
+
+            int VirtualEthernetFec::NextGroupSize() noexcept {
+                // The peer reports the loss it sees in 1/256 units, size groups to lose about half a datagram each.
+                int loss = send_loss_;
+                if (loss < 1) {
+                    return group_size_;
+                }
+
+                return std::max<int>(MIN_GROUP_SIZE, std::min<int>(group_size_, 128 / loss));
+            }
+
+            std::shared_ptr<Byte> VirtualEthernetFec::Encode(const std::shared_ptr<BufferswapAllocator>& allocator, const void* packet, int packet_length, int& parity_length) noexcept {
+                parity_length = 0;
+                if (NULL == packet || packet_length < 1 || packet_length > MAX_PACKET_SIZE) {
+                    return NULL;
+                }
+
+                uint32_t hash = Hash(packet, packet_length);
+                SynchronizedObjectScope scope(encode_syncobj_);
+
+                if (encode_count_ == 0) {
+                    encode_size_   = NextGroupSize();
+                    encode_length_ = 0;
+                    encode_max_    = 0;
+                }
+
+                VirtualEthernetFec_Xor(encode_parity_.data(), (Byte*)packet, packet_length);
+                encode_hashes_[encode_count_++] = hash;
+                encode_length_ ^= packet_length;
+                encode_max_ = std::max<int>(encode_max_, packet_length);
+
+                if (encode_count_ < encode_size_) {
+                    return NULL;
+                }
+
+                int hashes_size = encode_count_ * sizeof(uint32_t);
+                int message_length = sizeof(VIRTUAL_ETHERNET_FEC_HEADER) + hashes_size + encode_max_;
+
+                std::shared_ptr<Byte> messages = BufferswapAllocator::MakeByteArray(allocator, message_length);
+                if (NULL != messages) {
+                    VIRTUAL_ETHERNET_FEC_HEADER* h = (VIRTUAL_ETHERNET_FEC_HEADER*)messages.get();
+                    h->count  = (uint8_t)encode_count_;
+                    h->loss   = (uint8_t)std::min<int>(receive_loss_, UINT8_MAX);
+                    h->length = htons((uint16_t)encode_length_);
+
+                    Byte* p = (Byte*)(h + 1);
+                    for (int i = 0; i < encode_count_; i++) {
+                        uint32_t n = htonl(encode_hashes_[i]);
+                        memcpy(p, &n, sizeof(n));
+                        p += sizeof(n);
+                    }
+
+                    memcpy(p, encode_parity_.data(), encode_max_);
+                    parity_length = message_length;
+                }
+
+                memset(encode_parity_.data(), 0, encode_max_);
+                encode_count_ = 0;
+                return messages;
+            }
+
+            bool VirtualEthernetFec::Input(const std::shared_ptr<BufferswapAllocator>& allocator, const void* packet, int packet_length) noexcept {
+                if (NULL == packet || packet_length < 1 || packet_length > MAX_PACKET_SIZE) {
+                    return true;
+                }
+
+                uint32_t hash = Hash(packet, packet_length);
+                SynchronizedObjectScope scope(decode_syncobj_);
+
+                auto tail = decode_datagrams_.find(hash);
+                if (tail != decode_datagrams_.end()) {
+                    return !tail->second.rebuilt;
+                }
+
+                std::shared_ptr<Byte> buffer = BufferswapAllocator::MakeByteArray(allocator, packet_length);
+                if (NULL == buffer) {
+                    return true;
+                }
+
+                memcpy(buffer.get(), packet, packet_length);
+
+                Datagram& datagram = decode_datagrams_[hash];
+                datagram.packet = buffer;
+                datagram.length = packet_length;
+                decode_order_.emplace_back(hash);
+
+                std::size_t capacity = (std::size_t)group_size_ * VIRTUAL_ETHERNET_FEC_WINDOW;
+                while (decode_order_.size() > capacity) {
+                    decode_datagrams_.erase(decode_order_.front());
+                    decode_order_.pop_front();
+                }
+
+                return true;
+            }
+
+            std::shared_ptr<Byte> VirtualEthernetFec::Decode(const std::shared_ptr<BufferswapAllocator>& allocator, const void* parity, int parity_length, int& packet_length) noexcept {
+                packet_length = 0;
+                if (NULL == parity || parity_length <= sizeof(VIRTUAL_ETHERNET_FEC_HEADER)) {
+                    return NULL;
+                }
+
+                VIRTUAL_ETHERNET_FEC_HEADER* h = (VIRTUAL_ETHERNET_FEC_HEADER*)parity;
+                int count = h->count;
+                if (count < 1 || count > MAX_GROUP_SIZE) {
+                    return NULL;
+                }
+
+                Byte* hashes = (Byte*)(h + 1);
+                Byte* body = hashes + count * sizeof(uint32_t);
+
+                int body_length = parity_length - (int)(body - (Byte*)parity);
+                if (body_length < 1) {
+                    return NULL;
+                }
+
+                send_loss_ = h->loss;
+
+                SynchronizedObjectScope scope(decode_syncobj_);
+                Datagram* present[MAX_GROUP_SIZE];
+                int present_count = 0;
+                int length = ntohs(h->length);
+
+                uint32_t missing = 0;
+                for (int i = 0; i < count; i++) {
+                    uint32_t hash;
+                    memcpy(&hash, hashes + i * sizeof(uint32_t), sizeof(hash));
+                    hash = ntohl(hash);
+
+                    auto tail = decode_datagrams_.find(hash);
+                    if (tail == decode_datagrams_.end()) {
+                        missing = hash;
+                    }
+                    else {
+                        Datagram& datagram = tail->second;
+                        length ^= datagram.length;
+                        present[present_count++] = &datagram;
+                    }
+                }
+
+                int lost = count - present_count;
+                receive_loss_ = (receive_loss_ * 7 + (lost << 8) / count) >> 3;
+
+                if (lost != 1 || length < 1 || length > body_length) {
+                    return NULL;
+                }
+
+                std::shared_ptr<Byte> packet = BufferswapAllocator::MakeByteArray(allocator, length);
+                if (NULL == packet) {
+                    return NULL;
+                }
+
+                Byte* p = packet.get();
+                memcpy(p, body, length);
+
+                for (int i = 0; i < present_count; i++) {
+                    Datagram* datagram = present[i];
+                    VirtualEthernetFec_Xor(p, datagram->packet.get(), std::min<int>(length, datagram->length));
+                }
+
+                if (Hash(p, length) != missing) {
+                    return NULL;
+                }
+
+                // Remember the rebuilt datagram so the original, if it was only late, is not delivered twice.
+                Datagram& datagram = decode_datagrams_[missing];
+                datagram.packet  = packet;
+                datagram.length  = length;
+                datagram.rebuilt = true;
+                decode_order_.emplace_back(missing);
+
+                packet_length = length;
+                return packet;
+            }
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <ppp/stdafx.h>
+#include <ppp/threading/BufferswapAllocator.h>
+
+namespace ppp {
+    namespace app {
+        namespace protocol {
+            /* XOR parity over groups of sealed static datagrams, one parity message rebuilds one lost datagram of its group. */
+            class VirtualEthernetFec final {
+            public:
+                typedef std::mutex                                                          SynchronizedObject;
+                typedef std::lock_guard<SynchronizedObject>                                 SynchronizedObjectScope;
+                typedef ppp::threading::BufferswapAllocator                                 BufferswapAllocator;
+
+            public:
+                static constexpr int                                                        MIN_GROUP_SIZE      = 2;
+                static constexpr int                                                        MAX_GROUP_SIZE      = 32;
+                static constexpr int                                                        MAX_PACKET_SIZE     = PPP_BUFFER_SIZE - 1024;
+
+            public:
+                VirtualEthernetFec(int group_size) noexcept;
+
+            public:
+                /* Adds an outgoing datagram to the open group, returns the parity message once the group is full. */
+                std::shared_ptr<Byte>                                                       Encode(const std::shared_ptr<BufferswapAllocator>& allocator, const void* packet, int packet_length, int& parity_length) noexcept;
+                /* Keeps an incoming datagram for recovery, returns false when it was already rebuilt from parity. */
+                bool                                                                        Input(const std::shared_ptr<BufferswapAllocator>& allocator, const void* packet, int packet_length) noexcept;
+                /* Rebuilds the only missing datagram of a parity group, NULL when none or more than one is missing. */
+                std::shared_ptr<Byte>                                                       Decode(const std::shared_ptr<BufferswapAllocator>& allocator, const void* parity, int parity_length, int& packet_length) noexcept;
+                int                                                                         GetGroupSize() noexcept { return group_size_; }
+                int                                                                         GetLoss() noexcept { return receive_loss_; }
+                static int                                                                  Negotiate(int local, int remote) noexcept;
+
+            private:
+                static uint32_t                                                             Hash(const void* packet, int packet_length) noexcept;
+                int                                                                         NextGroupSize() noexcept;
+
+            private:
+                struct Datagram {
+                    std::shared_ptr<Byte>                                                   packet;
+                    int                                                                     length  = 0;
+                    bool                                                                    rebuilt = false;
+                };
+                typedef ppp::unordered_map<uint32_t, Datagram>                              DatagramTable;
+
+            private:
+                const int                                                                   group_size_   = 0;
+                std::atomic<int>                                                            receive_loss_ = 0;
+                std::atomic<int>                                                            send_loss_    = 0;
+
+                SynchronizedObject                                                          encode_syncobj_;
+                int                                                                         encode_count_  = 0;
+                int                                                                         encode_size_   = 0;
+                int                                                                         encode_length_ = 0;
+                int                                                                         encode_max_    = 0;
+                uint32_t                                                                    encode_hashes_[MAX_GROUP_SIZE];
+                ppp::vector<Byte>                                                           encode_parity_;
+
+                SynchronizedObject                                                          decode_syncobj_;
+                DatagramTable                                                               decode_datagrams_;
+                ppp::list<uint32_t>                                                         decode_order_;
+            };
+        }
+    }
+}
@@ -548,14 +548,17 @@ namespace ppp {
                     }
                 }
                 elif(packet_action == PacketAction_STATIC) {
-                    return OnStatic(transmission, y);
+                    // The trailing FEC group size is optional, peers that predate it send the bare action.
+                    int fec = packet_length > 0 ? *p : 0;
+                    return OnStatic(transmission, fec, y);
                 }
                 elif(packet_action == PacketAction_STATICACK) {
                     int session_id = global::PACKET_Dword(p, packet_length);
                     if (packet_length > 0) {
                         int remote_port = global::PACKET_Word(p, packet_length);
                         if (packet_length > -1) {
-                            return OnStatic(transmission, session_id, remote_port, y);
+                            int fec = packet_length > 0 ? *p : 0;
+                            return OnStatic(transmission, session_id, remote_port, fec, y);
                         }
                     }
                 }
@@ -631,6 +634,26 @@ namespace ppp {
                 return false;
             }
 
+            bool VirtualEthernetLinklayer::DoSendTo(const ITransmissionPtr& transmission, const boost::asio::ip::udp::endpoint& sourceEP, const ppp::string& hostname, int port, Byte* packet, int packet_length, YieldContext& y) noexcept {
+                if (NULL == packet || packet_length < 1) {
+                    return false;
+                }
+
+                // The destination travels by name, the same way DoConnect sends it, and is resolved by the receiving side.
+                MemoryStream ms;
+                if (ms.WriteByte((Byte)PacketAction_SENDTO)) {
+                    if (global::PACKET_IPEndPoint(ms, hostname, port)) {
+                        if (global::PACKET_IPEndPoint(ms, sourceEP)) {
+                            if (ms.Write(packet, 0, packet_length)) {
+                                std::shared_ptr<Byte> buffer = ms.GetBuffer();
+                                return transmission->Write(y, buffer.get(), ms.GetPosition());
+                            }
+                        }
+                    }
+                }
+                return false;
+            }
+
             bool VirtualEthernetLinklayer::DoEcho(const ITransmissionPtr& transmission, int ack_id, YieldContext& y) noexcept {
                 return global::PACKET_Push(PacketAction_ECHOACK, transmission, ack_id, NULL, 0, y);
             }
@@ -639,9 +662,13 @@ namespace ppp {
                 return global::PACKET_Push(PacketAction_ECHO, transmission, packet, packet_length, y);
             }
 
-            bool VirtualEthernetLinklayer::DoStatic(const ITransmissionPtr& transmission, YieldContext& y) noexcept {
+            bool VirtualEthernetLinklayer::DoStatic(const ITransmissionPtr& transmission, int fec, YieldContext& y) noexcept {
                 MemoryStream ms;
                 if (ms.WriteByte(PacketAction_STATIC)) {
+                    if (fec > 0 && !ms.WriteByte((Byte)std::min<int>(fec, UINT8_MAX))) {
+                        return false;
+                    }
+
                     std::shared_ptr<Byte> buffer = ms.GetBuffer();
                     return transmission->Write(y, buffer.get(), ms.GetPosition());
                 }
@@ -649,11 +676,15 @@ namespace ppp {
                 return false;
             }
 
-            bool VirtualEthernetLinklayer::DoStatic(const ITransmissionPtr& transmission, int session_id, int remote_port, YieldContext& y) noexcept {
+            bool VirtualEthernetLinklayer::DoStatic(const ITransmissionPtr& transmission, int session_id, int remote_port, int fec, YieldContext& y) noexcept {
                 MemoryStream ms;
                 if (ms.WriteByte(PacketAction_STATICACK)) {
                     if (global::PACKET_Dword(ms, session_id)) {
                         if (global::PACKET_Word(ms, remote_port)) {
+                            if (fec > 0 && !ms.WriteByte((Byte)std::min<int>(fec, UINT8_MAX))) {
+                                return false;
+                            }
+
                             std::shared_ptr<Byte> buffer = ms.GetBuffer();
                             return transmission->Write(y, buffer.get(), ms.GetPosition());
                         }
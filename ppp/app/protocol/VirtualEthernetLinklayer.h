@@ -104,8 +104,9 @@ namespace ppp {
                 virtual bool                                                DoEcho(const ITransmissionPtr& transmission, int ack_id, YieldContext& y) noexcept;
                 virtual bool                                                DoEcho(const ITransmissionPtr& transmission, Byte* packet, int packet_length, YieldContext& y) noexcept;
                 virtual bool                                                DoSendTo(const ITransmissionPtr& transmission, const boost::asio::ip::udp::endpoint& sourceEP, const boost::asio::ip::udp::endpoint& destinationEP, Byte* packet, int packet_length, YieldContext& y) noexcept;
-                virtual bool                                                DoStatic(const ITransmissionPtr& transmission, YieldContext& y) noexcept;
-                virtual bool                                                DoStatic(const ITransmissionPtr& transmission, int session_id, int remote_port, YieldContext& y) noexcept;
+                virtual bool                                                DoSendTo(const ITransmissionPtr& transmission, const boost::asio::ip::udp::endpoint& sourceEP, const ppp::string& hostname, int port, Byte* packet, int packet_length, YieldContext& y) noexcept;
+                virtual bool                                                DoStatic(const ITransmissionPtr& transmission, int fec, YieldContext& y) noexcept;
+                virtual bool                                                DoStatic(const ITransmissionPtr& transmission, int session_id, int remote_port, int fec, YieldContext& y) noexcept;
 
             public:
                 virtual bool                                                DoFrpEntry(const ITransmissionPtr& transmission, bool tcp, bool in, int remote_port, YieldContext& y) noexcept;
@@ -134,8 +135,8 @@ namespace ppp {
                 virtual bool                                                OnEcho(const ITransmissionPtr& transmission, int ack_id, YieldContext& y) noexcept { return true; }
                 virtual bool                                                OnEcho(const ITransmissionPtr& transmission, Byte* packet, int packet_length, YieldContext& y) noexcept { return true; }
                 virtual bool                                                OnSendTo(const ITransmissionPtr& transmission, const boost::asio::ip::udp::endpoint& sourceEP, const boost::asio::ip::udp::endpoint& destinationEP, Byte* packet, int packet_length, YieldContext& y) noexcept { return true; }
-                virtual bool                                                OnStatic(const ITransmissionPtr& transmission, YieldContext& y) noexcept { return true; }
-                virtual bool                                                OnStatic(const ITransmissionPtr& transmission, int session_id, int remote_port, YieldContext& y) noexcept { return true; }
+                virtual bool                                                OnStatic(const ITransmissionPtr& transmission, int fec, YieldContext& y) noexcept { return true; }
+                virtual bool                                                OnStatic(const ITransmissionPtr& transmission, int session_id, int remote_port, int fec, YieldContext& y) noexcept { return true; }
 
             protected:
                 virtual bool                                                OnPreparedConnect(const ITransmissionPtr& transmission, int connection_id, const ppp::string& destinationHost, const boost::asio::ip::tcp::endpoint& destinationEP, YieldContext& y) noexcept { return true; }
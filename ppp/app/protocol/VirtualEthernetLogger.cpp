@@ -3,17 +3,32 @@
 #include <ppp/io/File.h>
 #include <ppp/net/Ipep.h>
 #include <ppp/net/Socket.h>
+#include <ppp/net/IPEndPoint.h>
 #include <ppp/threading/Executors.h>
+#include <ppp/diagnostics/Metrics.h>
 #include <ppp/auxiliary/StringAuxiliary.h>
 #include <ppp/transmissions/ITransmission.h>
 #include <ppp/transmissions/IWebsocketTransmission.h>
 
+#if !defined(_WIN32)
+#include <sys/uio.h>
+#endif
+
 namespace ppp {
     namespace app {
         namespace protocol {
+            static std::atomic<uint64_t> VirtualEthernetLogger_Generation = 0;
+
+            /* The ring of the current thread for the logger it was last used with, loggers are told apart by a generation rather than their address. */
+            struct VirtualEthernetLoggerRingCache {
+                uint64_t                                                        id = 0;
+                std::shared_ptr<void>                                           ring;
+            };
+            static thread_local VirtualEthernetLoggerRingCache VirtualEthernetLogger_RingCache;
+
             VirtualEthernetLogger::VirtualEthernetLogger(const std::shared_ptr<boost::asio::io_context>& context, const ppp::string& log_path) noexcept
-                : log_file_(NULL)
-                , log_context_(context) {
+                : log_context_(context)
+                , id_(++VirtualEthernetLogger_Generation) {
                 if (NULL != context && log_path.size() > 0) {
                     ppp::string file_path = ppp::io::File::GetFullPath(ppp::io::File::RewritePath(log_path.data()).data());
                     ppp::string file_dirs = ppp::io::File::GetParentPath(file_path.data());
@@ -21,35 +36,16 @@ namespace ppp {
                         if (ppp::io::File::CreateDirectories(file_dirs.data())) {
                             ppp::string file_name = ppp::io::File::GetFileName(file_path.data());
                             if (file_name.size() > 0) {
-#if defined(_WIN32)
-                                log_file_ = fopen(file_path.data(), "ab+");
-#else
-                                int fd = open(file_path.data(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
-                                if (fd != -1) {
-#if defined(_MACOS)
-                                    // https://developer.apple.com/library/archive/documentation/System/Conceptual/ManPages_iPhoneOS/man2/lseek.2.html
-                                    bool seek64 = lseek(fd, 0, SEEK_END) != -1;
-#else
-                                    // https://android.googlesource.com/platform/bionic/+/b23f193/libc/unistd/lseek64.c
-                                    bool seek64 = lseek64(fd, 0, SEEK_END) != -1;
-                                    if (!seek64) {
-                                        seek64 = lseek(fd, 0, SEEK_END) != -1;
-                                        if (!seek64) {
-                                            close(fd);
-                                        }
-                                    }
-#endif
-                                    if (seek64) {
-                                        auto log_file = make_shared_object<boost::asio::posix::stream_descriptor>(*context, fd);;
-                                        if (NULL == log_file) {
-                                            close(fd);
-                                        }
-                                        else {
-                                            log_file_ = std::move(log_file);
-                                        }
+                                log_path_ = file_path;
+                                if (OpenFile()) {
+                                    std::shared_ptr<ppp::threading::Thread> writer = make_shared_object<ppp::threading::Thread>(
+                                        [this](ppp::threading::Thread* my) noexcept {
+                                            Loopback();
+                                        });
+                                    if (NULL != writer && writer->Start()) {
+                                        writer_ = writer;
                                     }
                                 }
-#endif
                             }
                         }
                     }
@@ -70,14 +66,9 @@ namespace ppp {
 
             bool VirtualEthernetLogger::Valid() noexcept {
 #if defined(_WIN32)
-                return NULL != log_file_.load();
+                return NULL != log_file_;
 #else
-                std::shared_ptr<boost::asio::posix::stream_descriptor> log = log_file_;
-                if (NULL == log) {
-                    return false;
-                }
-
-                return log->is_open();
+                return log_file_ != -1;
 #endif
             }
 
@@ -95,18 +86,211 @@ namespace ppp {
             }
 
             void VirtualEthernetLogger::Finalize() noexcept {
+                {
+                    std::lock_guard<std::mutex> scope(syncobj_);
+                    stop_ = true;
+                }
+
+                // The writer drains every ring and pending write once more before it leaves.
+                signal_.notify_all();
+                std::shared_ptr<ppp::threading::Thread> writer = writer_;
+                if (NULL != writer && writer->Id != GetCurrentThreadId()) {
+                    writer->Join();
+                }
+
+                CloseFile();
+            }
+
+            bool VirtualEthernetLogger::OpenFile() noexcept {
 #if defined(_WIN32)
-                FILE* log = log_file_.exchange(NULL);
+                FILE* log = fopen(log_path_.data(), "ab+");
+                if (NULL == log) {
+                    return false;
+                }
+
+                fseek(log, 0, SEEK_END);
+                log_size_ = ftell(log);
+                log_file_ = log;
+#else
+                int fd = open(log_path_.data(), O_WRONLY | O_CREAT | O_APPEND, S_IRUSR | S_IWUSR);
+                if (fd == -1) {
+                    return false;
+                }
+
+                struct stat st;
+                log_size_ = fstat(fd, &st) == 0 ? st.st_size : 0;
+                log_file_ = fd;
+#endif
+                log_day_ = DateTime::Now().Ticks() / 864000000000LL;
+                return true;
+            }
+
+            void VirtualEthernetLogger::CloseFile() noexcept {
+#if defined(_WIN32)
+                FILE* log = log_file_;
                 if (NULL != log) {
+                    log_file_ = NULL;
                     fflush(log);
                     fclose(log);
                 }
 #else
-                std::shared_ptr<boost::asio::posix::stream_descriptor> log = std::move(log_file_);
-                if (NULL != log) {
-                    log_file_.reset();
-                    ppp::net::Socket::Closestream(log);
+                int fd = log_file_;
+                if (fd != -1) {
+                    log_file_ = -1;
+                    close(fd);
+                }
+#endif
+            }
+
+            void VirtualEthernetLogger::Rotate() noexcept {
+                CloseFile();
+
+                ppp::string rotate_path = log_path_ + "." + DateTime::Now().ToString("yyyyMMddHHmmss");
+                rename(log_path_.data(), rotate_path.data());
+
+                OpenFile();
+            }
+
+            void VirtualEthernetLogger::Loopback() noexcept {
+                SetThreadName("logger");
+                for (;;) {
+                    bool stop = false;
+                    {
+                        std::unique_lock<std::mutex> scope(syncobj_);
+                        signal_.wait_for(scope, std::chrono::milliseconds(FLUSH_INTERVAL), [this]() noexcept { return stop_; });
+                        stop = stop_;
+                    }
+
+                    Flush();
+                    if (stop) {
+                        break;
+                    }
+                }
+            }
+
+            bool VirtualEthernetLogger::Flush() noexcept {
+                ppp::vector<RingPtr> rings;
+                ppp::list<Raw> raws;
+                uint64_t raws_drops = 0;
+                {
+                    std::lock_guard<std::mutex> scope(syncobj_);
+                    rings = rings_;
+                    raws = std::move(raws_);
+                    raws_.clear();
+                    raws_drops = raws_drops_;
+                    raws_drops_ = 0;
+                }
+
+                // Records are formatted here rather than on the thread that raised them, the ring slots are released as soon as they are copied out.
+                ppp::string batch;
+                for (RingPtr& ring : rings) {
+                    uint64_t head = ring->head.load(std::memory_order_relaxed);
+                    uint64_t tail = ring->tail.load(std::memory_order_acquire);
+                    for (; head != tail; head++) {
+                        Format(ring->records[head % RING_SIZE], batch);
+                    }
+
+                    ring->head.store(tail, std::memory_order_release);
+
+                    uint64_t drops = ring->drops.load(std::memory_order_relaxed);
+                    if (drops != ring->dropped) {
+                        batch += "[" + DateTime::Now().ToString("yyyy-MM-dd HH:mm:ss") + "] ";
+                        batch += "LOGGER DROPPED:" + stl::to_string<ppp::string>(drops - ring->dropped) + "\r\n";
+                        ring->dropped = drops;
+                    }
+                }
+
+                if (raws_drops > 0) {
+                    batch += "[" + DateTime::Now().ToString("yyyy-MM-dd HH:mm:ss") + "] ";
+                    batch += "LOGGER DROPPED:" + stl::to_string<ppp::string>(raws_drops) + "\r\n";
+                }
+
+                static constexpr int MAX_BUFFERS = 64;
+
+                const void* buffers[MAX_BUFFERS];
+                int lengths[MAX_BUFFERS];
+                int count = 0;
+                bool ok = true;
+
+                if (batch.size() > 0) {
+                    buffers[count] = batch.data();
+                    lengths[count++] = static_cast<int>(batch.size());
+                }
+
+                for (Raw& raw : raws) {
+                    if (count == MAX_BUFFERS) {
+                        ok &= Append(buffers, lengths, count);
+                        count = 0;
+                    }
+
+                    buffers[count] = raw.buffer.get();
+                    lengths[count++] = raw.length;
+                }
+
+                if (count > 0) {
+                    ok &= Append(buffers, lengths, count);
+                }
+
+                for (Raw& raw : raws) {
+                    if (raw.cb) {
+                        raw.cb(ok);
+                    }
+                }
+
+                if (log_size_ >= ROTATE_SIZE || DateTime::Now().Ticks() / 864000000000LL != log_day_) {
+                    Rotate();
+                }
+
+                return ok;
+            }
+
+            bool VirtualEthernetLogger::Append(const void* buffers[], const int lengths[], int count) noexcept {
+#if defined(_WIN32)
+                FILE* log = log_file_;
+                if (NULL == log) {
+                    return false;
+                }
+
+                for (int i = 0; i < count; i++) {
+                    log_size_ += fwrite(buffers[i], 1, lengths[i], log);
                 }
+
+                fflush(log);
+                return true;
+#else
+                int fd = log_file_;
+                if (fd == -1) {
+                    return false;
+                }
+
+                struct iovec iov[64];
+                for (int i = 0; i < count; i++) {
+                    iov[i].iov_base = const_cast<void*>(buffers[i]);
+                    iov[i].iov_len = lengths[i];
+                }
+
+                for (int i = 0; i < count;) {
+                    ssize_t written = writev(fd, iov + i, count - i);
+                    if (written < 0) {
+                        if (errno == EINTR) {
+                            continue;
+                        }
+
+                        return false;
+                    }
+
+                    log_size_ += written;
+                    for (; i < count && written > 0; ) {
+                        if ((size_t)written < iov[i].iov_len) {
+                            iov[i].iov_base = (Byte*)iov[i].iov_base + written;
+                            iov[i].iov_len -= written;
+                            break;
+                        }
+
+                        written -= iov[i++].iov_len;
+                    }
+                }
+                return true;
 #endif
             }
 
@@ -130,51 +314,63 @@ namespace ppp {
                     return false;
                 }
 
-#if defined(_WIN32)
-                std::shared_ptr<VirtualEthernetLogger> self = shared_from_this();
-                log_context_->post(
-                    [self, this, s, length, cb]() noexcept {
-                        bool ok = false;
-                        FILE* log = log_file_.load();
-                        if (NULL != log) {
-                            fwrite(s.get(), 1, length, log);
-                            fflush(log);
-                        }
+                std::lock_guard<std::mutex> scope(syncobj_);
+                if (stop_ || NULL == writer_) {
+                    return false;
+                }
 
-                        if (cb) {
-                            cb(ok);
-                        }
-                    });
-#else
-                std::shared_ptr<boost::asio::posix::stream_descriptor> log = log_file_;
-                if (NULL == log || !log->is_open()) {
+                // Lines wait here for one flush interval at most, a writer that falls behind drops the newest ones instead of growing the list.
+                if (raws_.size() >= RAW_LIMIT) {
+                    raws_drops_++;
+                    drops_.fetch_add(1, std::memory_order_relaxed);
                     return false;
                 }
 
-                std::shared_ptr<VirtualEthernetLogger> self = shared_from_this();
-                boost::asio::async_write(*log, boost::asio::buffer(s.get(), length),
-                    [s, cb](boost::system::error_code ec, std::size_t sz) noexcept {
-                        if (cb) {
-                            bool ok = ec == boost::system::errc::success;
-                            cb(ok);
-                        }
-                    });
-#endif
+                raws_.emplace_back(Raw{ s, length, cb });
                 return true;
             }
 
-            static ppp::string LOGGER_NOW() noexcept {
-                ppp::string s = "[";
-                s += ppp::threading::Executors::Now().ToString("yyyy-MM-dd HH:mm:ss");
-                s += "]";
-                return s;
+            VirtualEthernetLogger::Ring* VirtualEthernetLogger::GetRing() noexcept {
+                VirtualEthernetLoggerRingCache& cache = VirtualEthernetLogger_RingCache;
+                if (cache.id == id_) {
+                    return static_cast<Ring*>(cache.ring.get());
+                }
+
+                std::thread::id owner = std::this_thread::get_id();
+                RingPtr ring;
+                {
+                    std::lock_guard<std::mutex> scope(syncobj_);
+                    if (stop_ || NULL == writer_) {
+                        return NULL;
+                    }
+
+                    for (RingPtr& i : rings_) {
+                        if (i->owner == owner) {
+                            ring = i;
+                            break;
+                        }
+                    }
+
+                    if (NULL == ring) {
+                        ring = make_shared_object<Ring>();
+                        if (NULL == ring) {
+                            return NULL;
+                        }
+
+                        ring->owner = owner;
+                        rings_.emplace_back(ring);
+                    }
+                }
+
+                cache.id = id_;
+                cache.ring = ring;
+                return ring.get();
             }
 
-            static ppp::string LOGGER_GUID(Int128 guid) noexcept {
-                ppp::string s = "{";
-                s += ToUpper(ppp::auxiliary::StringAuxiliary::Int128ToGuidString(guid));
-                s += "}";
-                return s;
+            static void LOGGER_COPY(char* dst, int size, const ppp::string& s) noexcept {
+                int length = std::min<int>(size - 1, static_cast<int>(s.size()));
+                memcpy(dst, s.data(), length);
+                dst[length] = '\x0';
             }
 
             static ppp::string GetXForwardedFor(const std::shared_ptr<ppp::transmissions::ITransmission>& transmission, ppp::string* protocol) noexcept {
@@ -205,17 +401,97 @@ namespace ppp {
                 return ppp::string();
             }
 
-            static ppp::string GetRemoteEndPoint(const std::shared_ptr<ppp::transmissions::ITransmission>& transmission) noexcept {
-                ppp::string log = ppp::net::IPEndPoint::ToEndPoint(transmission->GetRemoteEndPoint()).ToString();
+            VirtualEthernetLogger::Record* VirtualEthernetLogger::Acquire(Ring*& ring, RecordKind kind, Int128 guid, const std::shared_ptr<ppp::transmissions::ITransmission>& transmission) noexcept {
+                ring = GetRing();
+                if (NULL == ring) {
+                    return NULL;
+                }
+
+                // A full ring drops the event, the data path never waits for the writer.
+                uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+                if (tail - ring->head.load(std::memory_order_acquire) >= RING_SIZE) {
+                    ring->drops.fetch_add(1, std::memory_order_relaxed);
+                    drops_.fetch_add(1, std::memory_order_relaxed);
+                    ppp::diagnostics::Metrics::Increment(ppp::diagnostics::Metrics::MetricsCounter_LoggerDrops);
+                    return NULL;
+                }
+
+                Record* record = &ring->records[tail % RING_SIZE];
+                record->kind = kind;
+                record->tcp = false;
+                record->time = ppp::threading::Executors::Now();
+                record->guid = guid;
+                record->firstEP = boost::asio::ip::tcp::endpoint();
+                record->secondEP = boost::asio::ip::tcp::endpoint();
+                record->domain[0] = '\x0';
+
                 ppp::string protocol;
-                ppp::string XForwardedFor = GetXForwardedFor(transmission, &protocol);
-                if (XForwardedFor.empty()) {
-                    log += "/" + protocol;
+                ppp::string forwarded;
+                if (NULL != transmission) {
+                    record->sourceEP = transmission->GetRemoteEndPoint();
+                    forwarded = GetXForwardedFor(transmission, &protocol);
                 }
                 else {
-                    log += "/" + protocol + " X-Forwarded-For:" + XForwardedFor;
+                    record->sourceEP = boost::asio::ip::tcp::endpoint();
+                    protocol = "tcp";
+                }
+
+                LOGGER_COPY(record->protocol, sizeof(record->protocol), protocol);
+                LOGGER_COPY(record->forwarded, sizeof(record->forwarded), forwarded);
+                return record;
+            }
+
+            void VirtualEthernetLogger::Commit(Ring* ring) noexcept {
+                uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+                ring->tail.store(tail + 1, std::memory_order_release);
+            }
+
+            static ppp::string LOGGER_ENDPOINT(const boost::asio::ip::tcp::endpoint& ep) noexcept {
+                return ppp::net::IPEndPoint::ToEndPoint(ep).ToString();
+            }
+
+            void VirtualEthernetLogger::Format(Record& record, ppp::string& out) noexcept {
+                out += "[" + record.time.ToString("yyyy-MM-dd HH:mm:ss") + "] ";
+                out += "{" + ToUpper(ppp::auxiliary::StringAuxiliary::Int128ToGuidString(record.guid)) + "} ";
+
+                ppp::string source = LOGGER_ENDPOINT(record.sourceEP) + "/" + record.protocol;
+                if (record.forwarded[0] != '\x0') {
+                    source += " X-Forwarded-For:";
+                    source += record.forwarded;
+                }
+
+                switch (record.kind) {
+                case RecordKind_Vpn:
+                    out += "VPN SOURCE:" + source;
+                    break;
+                case RecordKind_Dns:
+                    out += "DNS SOURCE:" + source + " DOMAIN:" + record.domain;
+                    break;
+                case RecordKind_Arp:
+                    out += "ARP SOURCE:" + source + " IP:" + ppp::net::Ipep::ToAddressString<ppp::string>(record.firstEP.address()) + " ";
+                    out += " GATEWAY:" + ppp::net::Ipep::ToAddressString<ppp::string>(record.secondEP.address());
+                    break;
+                case RecordKind_Port:
+                    out += "PORT SOURCE:" + source + " IN:" + LOGGER_ENDPOINT(record.firstEP) + " NAT:" + LOGGER_ENDPOINT(record.secondEP);
+                    break;
+                case RecordKind_Connect:
+                    out += "CONNECT SOURCE:" + source + " NAT:" + LOGGER_ENDPOINT(record.firstEP) + " DESTINATION:" + LOGGER_ENDPOINT(record.secondEP);
+                    if (record.domain[0] != '\x0') {
+                        out += " DOMAIN:" + ppp::string(record.domain) + ":";
+                        out += stl::to_string<ppp::string>(record.secondEP.port());
+                    }
+                    break;
+                case RecordKind_MPEntry:
+                    out += "MAPPING PORT ENTRY SOURCE:" + source + " PUBLIC:" + LOGGER_ENDPOINT(record.firstEP) + "/" + (record.tcp ? "tcp" : "udp");
+                    break;
+                case RecordKind_MPConnect:
+                    out += "MAPPING PORT CONNECT SOURCE:" + source + " PUBLIC:" + LOGGER_ENDPOINT(record.firstEP) + " REMOTE:" + LOGGER_ENDPOINT(record.secondEP);
+                    break;
+                default:
+                    break;
                 }
-                return log;;
+
+                out += "\r\n";
             }
 
             bool VirtualEthernetLogger::Arp(Int128 guid, const std::shared_ptr<ppp::transmissions::ITransmission>& transmission, uint32_t ip, uint32_t mask) noexcept {
@@ -223,15 +499,16 @@ namespace ppp {
             }
 
             bool VirtualEthernetLogger::Arp(Int128 guid, const std::shared_ptr<ppp::transmissions::ITransmission>& transmission, const boost::asio::ip::address& ip, const boost::asio::ip::address& mask) noexcept {
-                ppp::string log = LOGGER_NOW() + " ";
-                log += LOGGER_GUID(guid) + " ";
-                log += "ARP SOURCE:";
-                log += GetRemoteEndPoint(transmission) + " IP:";
-                log += ip.to_string() + " ";
-                log += " GATEWAY:";
-                log += mask.to_string() + "\r\n";
-
-                return this->Write(log.data(), log.size(), NULL);
+                Ring* ring = NULL;
+                Record* record = Acquire(ring, RecordKind_Arp, guid, transmission);
+                if (NULL == record) {
+                    return false;
+                }
+
+                record->firstEP = boost::asio::ip::tcp::endpoint(ip, 0);
+                record->secondEP = boost::asio::ip::tcp::endpoint(mask, 0);
+                Commit(ring);
+                return true;
             }
 
             bool VirtualEthernetLogger::Connect(Int128 guid, const std::shared_ptr<ppp::transmissions::ITransmission>& transmission, const boost::asio::ip::tcp::endpoint& natEP, const boost::asio::ip::tcp::endpoint& dstEP, const ppp::string& hostDomain) noexcept {
@@ -239,19 +516,17 @@ namespace ppp {
                     return false;
                 }
 
-                ppp::string log = LOGGER_NOW() + " ";
-                log += LOGGER_GUID(guid) + " ";
-                log += "CONNECT SOURCE:";
-                log += GetRemoteEndPoint(transmission) + " NAT:";
-                log += ppp::net::IPEndPoint::ToEndPoint(natEP).ToString() + " DESTINATION:";
-                log += ppp::net::IPEndPoint::ToEndPoint(dstEP).ToString();
-                if (hostDomain.size() > 0) {
-                    log += " DOMAIN:" + hostDomain + ":";
-                    log += stl::to_string<ppp::string>(dstEP.port());
+                Ring* ring = NULL;
+                Record* record = Acquire(ring, RecordKind_Connect, guid, transmission);
+                if (NULL == record) {
+                    return false;
                 }
 
-                log += "\r\n";
-                return this->Write(log.data(), log.size(), NULL);
+                record->firstEP = natEP;
+                record->secondEP = dstEP;
+                LOGGER_COPY(record->domain, sizeof(record->domain), hostDomain);
+                Commit(ring);
+                return true;
             }
 
             bool VirtualEthernetLogger::Vpn(Int128 guid, const std::shared_ptr<ppp::transmissions::ITransmission>& transmission) noexcept {
@@ -259,55 +534,66 @@ namespace ppp {
                     return false;
                 }
 
-                ppp::string log = LOGGER_NOW() + " ";
-                log += LOGGER_GUID(guid) + " ";
-                log += "VPN SOURCE:";
-                log += GetRemoteEndPoint(transmission) + "\r\n";
+                Ring* ring = NULL;
+                Record* record = Acquire(ring, RecordKind_Vpn, guid, transmission);
+                if (NULL == record) {
+                    return false;
+                }
 
-                return this->Write(log.data(), log.size(), NULL);
+                Commit(ring);
+                return true;
             }
 
             bool VirtualEthernetLogger::Dns(Int128 guid, const std::shared_ptr<ppp::transmissions::ITransmission>& transmission, const ppp::string& hostDomain) noexcept {
-                ppp::string log = LOGGER_NOW() + " ";
-                log += LOGGER_GUID(guid) + " ";
-                log += "DNS SOURCE:";
-                log += GetRemoteEndPoint(transmission) + " DOMAIN:";
-                log += hostDomain + "\r\n";
+                Ring* ring = NULL;
+                Record* record = Acquire(ring, RecordKind_Dns, guid, transmission);
+                if (NULL == record) {
+                    return false;
+                }
 
-                return this->Write(log.data(), log.size(), NULL);
+                LOGGER_COPY(record->domain, sizeof(record->domain), hostDomain);
+                Commit(ring);
+                return true;
             }
 
             bool VirtualEthernetLogger::Port(Int128 guid, const std::shared_ptr<ppp::transmissions::ITransmission>& transmission, const boost::asio::ip::udp::endpoint& inEP, const boost::asio::ip::udp::endpoint& natEP) noexcept {
-                ppp::string log = LOGGER_NOW() + " ";
-                log += LOGGER_GUID(guid) + " ";
-                log += "PORT SOURCE:";
-                log += GetRemoteEndPoint(transmission) + " IN:";
-                log += ppp::net::IPEndPoint::ToEndPoint(inEP).ToString() + " NAT:";
-                log += ppp::net::IPEndPoint::ToEndPoint(natEP).ToString() + "\r\n";
-
-                return this->Write(log.data(), log.size(), NULL);
+                Ring* ring = NULL;
+                Record* record = Acquire(ring, RecordKind_Port, guid, transmission);
+                if (NULL == record) {
+                    return false;
+                }
+
+                record->firstEP = boost::asio::ip::tcp::endpoint(inEP.address(), inEP.port());
+                record->secondEP = boost::asio::ip::tcp::endpoint(natEP.address(), natEP.port());
+                Commit(ring);
+                return true;
             }
 
             bool VirtualEthernetLogger::MPConnect(Int128 guid, const std::shared_ptr<ppp::transmissions::ITransmission>& transmission, const boost::asio::ip::tcp::endpoint& publicEP, const boost::asio::ip::tcp::endpoint& remoteEP) noexcept {
-                ppp::string log = LOGGER_NOW() + " ";
-                log += LOGGER_GUID(guid) + " ";
-                log += "MAPPING PORT CONNECT SOURCE:";
-                log += GetRemoteEndPoint(transmission) + " PUBLIC:";
-                log += ppp::net::IPEndPoint::ToEndPoint(publicEP).ToString() + " REMOTE:";
-                log += ppp::net::IPEndPoint::ToEndPoint(remoteEP).ToString() + "\r\n";
-
-                return this->Write(log.data(), log.size(), NULL);
+                Ring* ring = NULL;
+                Record* record = Acquire(ring, RecordKind_MPConnect, guid, transmission);
+                if (NULL == record) {
+                    return false;
+                }
+
+                record->firstEP = publicEP;
+                record->secondEP = remoteEP;
+                Commit(ring);
+                return true;
             }
 
             bool VirtualEthernetLogger::MPEntry(Int128 guid, const std::shared_ptr<ppp::transmissions::ITransmission>& transmission, const boost::asio::ip::tcp::endpoint& publicEP, bool protocol_tcp_or_udp) noexcept {
-                ppp::string log = LOGGER_NOW() + " ";
-                log += LOGGER_GUID(guid) + " ";
-                log += "MAPPING PORT ENTRY SOURCE:";
-                log += GetRemoteEndPoint(transmission) + " PUBLIC:";
-                log += ppp::net::IPEndPoint::ToEndPoint(publicEP).ToString() + (ppp::string("/") + (protocol_tcp_or_udp ? "tcp" : "udp") + "\r\n");
+                Ring* ring = NULL;
+                Record* record = Acquire(ring, RecordKind_MPEntry, guid, transmission);
+                if (NULL == record) {
+                    return false;
+                }
 
-                return this->Write(log.data(), log.size(), NULL);
+                record->firstEP = publicEP;
+                record->tcp = protocol_tcp_or_udp;
+                Commit(ring);
+                return true;
             }
         }
     }
-}
\ No newline at end of file
+}
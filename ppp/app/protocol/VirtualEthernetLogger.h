@@ -2,13 +2,22 @@
 
 #include <ppp/stdafx.h>
 #include <ppp/Int128.h>
+#include <ppp/DateTime.h>
 #include <ppp/transmissions/ITransmission.h>
+#include <ppp/threading/Thread.h>
 #include <ppp/threading/BufferswapAllocator.h>
 
 namespace ppp {
     namespace app {
         namespace protocol {
+            /* Events are copied as fixed records into a ring owned by the calling thread, a writer thread formats and appends them to the file in batches. */
             class VirtualEthernetLogger : public std::enable_shared_from_this<VirtualEthernetLogger> {
+            public:
+                static constexpr int                                            RING_SIZE           = 1024;
+                static constexpr int                                            RAW_LIMIT           = 4096;
+                static constexpr int                                            FLUSH_INTERVAL      = 100;
+                static constexpr int64_t                                        ROTATE_SIZE         = 64LL * 1024 * 1024;
+
             public:
                 VirtualEthernetLogger(const std::shared_ptr<boost::asio::io_context>& context, const ppp::string& log_path) noexcept;
                 virtual ~VirtualEthernetLogger() noexcept;
@@ -21,6 +30,7 @@ namespace ppp {
                 ppp::string                                                     GetPath() noexcept;
                 std::shared_ptr<VirtualEthernetLogger>                          GetReference() noexcept;
                 bool                                                            Valid() noexcept;
+                uint64_t                                                        GetDrops() noexcept { return drops_.load(std::memory_order_relaxed); }
                 virtual void                                                    Dispose() noexcept;
 
             public:
@@ -34,23 +44,86 @@ namespace ppp {
             public:
                 bool                                                            MPEntry(Int128 guid, const std::shared_ptr<ppp::transmissions::ITransmission>& transmission, const boost::asio::ip::tcp::endpoint& publicEP, bool protocol_tcp_or_udp) noexcept;
                 bool                                                            MPConnect(Int128 guid, const std::shared_ptr<ppp::transmissions::ITransmission>& transmission, const boost::asio::ip::tcp::endpoint& publicEP, const boost::asio::ip::tcp::endpoint& remoteEP) noexcept;
-                
+
             public:
                 bool                                                            Write(const void* s, int length, const ppp::function<void(bool)>& cb) noexcept;
                 virtual bool                                                    Write(const std::shared_ptr<Byte>& s, int length, const ppp::function<void(bool)>& cb) noexcept;
 
+            private:
+                typedef enum {
+                    RecordKind_Vpn,
+                    RecordKind_Dns,
+                    RecordKind_Arp,
+                    RecordKind_Port,
+                    RecordKind_Connect,
+                    RecordKind_MPEntry,
+                    RecordKind_MPConnect,
+                }                                                               RecordKind;
+
+                struct Record {
+                    RecordKind                                                  kind    = RecordKind_Vpn;
+                    bool                                                        tcp     = false;
+                    DateTime                                                    time;
+                    Int128                                                      guid;
+                    boost::asio::ip::tcp::endpoint                              sourceEP;
+                    boost::asio::ip::tcp::endpoint                              firstEP;
+                    boost::asio::ip::tcp::endpoint                              secondEP;
+                    char                                                        protocol[8];
+                    char                                                        forwarded[64];
+                    char                                                        domain[256];
+                };
+
+                /* Single producer (the owning thread) and single consumer (the writer thread), the consumer only moves head once per flush. */
+                struct Ring {
+                    std::thread::id                                             owner;
+                    std::atomic<uint64_t>                                       head    = 0;
+                    std::atomic<uint64_t>                                       tail    = 0;
+                    std::atomic<uint64_t>                                       drops   = 0;
+                    uint64_t                                                    dropped = 0;
+                    Record                                                      records[RING_SIZE];
+                };
+                typedef std::shared_ptr<Ring>                                   RingPtr;
+
+                struct Raw {
+                    std::shared_ptr<Byte>                                       buffer;
+                    int                                                         length = 0;
+                    ppp::function<void(bool)>                                   cb;
+                };
+
             private:
                 void                                                            Finalize() noexcept;
+                bool                                                            OpenFile() noexcept;
+                void                                                            CloseFile() noexcept;
+                void                                                            Rotate() noexcept;
+                void                                                            Loopback() noexcept;
+                bool                                                            Flush() noexcept;
+                bool                                                            Append(const void* buffers[], const int lengths[], int count) noexcept;
+                Ring*                                                           GetRing() noexcept;
+                Record*                                                         Acquire(Ring*& ring, RecordKind kind, Int128 guid, const std::shared_ptr<ppp::transmissions::ITransmission>& transmission) noexcept;
+                static void                                                     Commit(Ring* ring) noexcept;
+                static void                                                     Format(Record& record, ppp::string& out) noexcept;
 
             private:
 #if defined(_WIN32)
-                std::atomic<FILE*>                                              log_file_ = NULL;
+                FILE*                                                           log_file_ = NULL;
 #else
-                std::shared_ptr<boost::asio::posix::stream_descriptor>          log_file_;
+                int                                                             log_file_ = -1;
 #endif
+                int64_t                                                         log_size_ = 0;
+                int64_t                                                         log_day_  = 0;
                 ppp::string                                                     log_path_;
                 std::shared_ptr<boost::asio::io_context>                        log_context_;
+
+                const uint64_t                                                  id_;
+                std::atomic<uint64_t>                                           drops_    = 0;
+                std::mutex                                                      syncobj_;
+                std::condition_variable                                         signal_;
+                bool                                                            stop_     = false;
+                ppp::vector<RingPtr>                                            rings_;
+                ppp::list<Raw>                                                  raws_;
+                uint64_t                                                        raws_drops_ = 0;
+                std::shared_ptr<ppp::threading::Thread>                         writer_;
             };
         }
     }
-}
\ No newline at end of file
+}
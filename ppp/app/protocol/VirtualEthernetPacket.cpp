@@ -512,6 +512,24 @@ namespace ppp
                     posedo->source_port, posedo->destination_ip, posedo->destination_port, posedo + 1, packet_buffers->Length - sizeof(PACKET_IP_PACKET_POSEDO), out);
             }
 
+            std::shared_ptr<ppp::Byte> VirtualEthernetPacket::PackParity(
+                const std::shared_ptr<ppp::configurations::AppConfiguration>&   configuration,
+                const std::shared_ptr<ppp::threading::BufferswapAllocator>&     allocator,
+                const std::shared_ptr<ppp::cryptography::Ciphertext>&           protocol,
+                const std::shared_ptr<ppp::cryptography::Ciphertext>&           transport,
+                int                                                             session_id,
+                const void*                                                     parity,
+                int                                                             parity_length,
+                int&                                                            out) noexcept
+            {
+                if (session_id < 1)
+                {
+                    return NULL;
+                }
+
+                return PackBy(configuration, allocator, protocol, transport, ~session_id, 0, 0, 0, 0, parity, parity_length, out);
+            }
+
             bool VirtualEthernetPacket::OpenDatagramSocket(boost::asio::ip::udp::socket& socket, const boost::asio::ip::address& address, int port, const boost::asio::ip::udp::endpoint& sourceEP) noexcept 
             {
                 bool ok = false;
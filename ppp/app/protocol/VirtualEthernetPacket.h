@@ -29,6 +29,7 @@ namespace ppp
                 std::shared_ptr<ppp::net::packet::IcmpFrame>                        GetIcmpPacket(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, std::shared_ptr<ppp::net::packet::IPFrame>& packet) noexcept;
                 std::shared_ptr<ppp::net::packet::IPFrame>                          GetIPPacket(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator) noexcept;
                 std::shared_ptr<ppp::net::packet::UdpFrame>                         GetUdpPacket() noexcept;
+                bool                                                                IsParity() noexcept { return Protocol == ppp::net::native::ip_hdr::IP_PROTO_IP && SourceIP == 0 && SourcePort == 0 && DestinationIP == 0 && DestinationPort == 0; }
 
             public:
                 static int                                                          NewId() noexcept;
@@ -40,6 +41,16 @@ namespace ppp
                     int                                                             session_id,
                     const ppp::net::packet::IPFrame*                                packet,
                     int&                                                            out) noexcept;
+                /* FEC parity rides in an IP frame with an all-zero posedo, no real IPv4 header starts with a zero byte. */
+                static std::shared_ptr<ppp::Byte>                                   PackParity(
+                    const std::shared_ptr<ppp::configurations::AppConfiguration>&   configuration,
+                    const std::shared_ptr<ppp::threading::BufferswapAllocator>&     allocator,
+                    const std::shared_ptr<ppp::cryptography::Ciphertext>&           protocol,
+                    const std::shared_ptr<ppp::cryptography::Ciphertext>&           transport,
+                    int                                                             session_id,
+                    const void*                                                     parity,
+                    int                                                             parity_length,
+                    int&                                                            out) noexcept;
                 static std::shared_ptr<ppp::Byte>                                   Pack(
                     const std::shared_ptr<ppp::configurations::AppConfiguration>&   configuration,
                     const std::shared_ptr<ppp::threading::BufferswapAllocator>&     allocator,
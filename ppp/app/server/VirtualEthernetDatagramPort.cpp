@@ -7,12 +7,14 @@
 #include <ppp/net/IPEndPoint.h>
 #include <ppp/coroutines/asio/asio.h>
 #include <ppp/coroutines/YieldContext.h>
+#include <ppp/diagnostics/Metrics.h>
 
 typedef ppp::coroutines::YieldContext                   YieldContext;
 typedef ppp::net::IPEndPoint                            IPEndPoint;
 typedef ppp::net::Socket                                Socket;
 typedef ppp::net::Ipep                                  Ipep;
 typedef ppp::app::protocol::VirtualEthernetPacket       VirtualEthernetPacket;
+typedef ppp::diagnostics::Metrics                       Metrics;
 
 namespace ppp {
     namespace app {
@@ -77,6 +79,10 @@ namespace ppp {
                 disposed_ = true;
                 sendto_ = false;
                 finalize_ = true;
+                if (socket_.is_open()) {
+                    Metrics::Gauge(Metrics::MetricsGauge_DatagramPorts, -1);
+                }
+
                 Socket::Closesocket(socket_);
 
                 exchanger_->ReleaseDatagramPort(sourceEP_);
@@ -102,6 +108,10 @@ namespace ppp {
                 boost::asio::ip::address address = switcher->GetInterfaceIP();
 
                 bool success = VirtualEthernetPacket::OpenDatagramSocket(socket_, address, IPEndPoint::MinPort, sourceEP_) && Loopback();
+                if (socket_.is_open()) {
+                    Metrics::Gauge(Metrics::MetricsGauge_DatagramPorts, +1);
+                }
+
                 if (success) {
                     boost::system::error_code ec;
                     localEP_ = socket_.local_endpoint(ec);
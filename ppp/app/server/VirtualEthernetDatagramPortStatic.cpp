@@ -170,7 +170,7 @@ namespace ppp {
 
                 boost::system::error_code ec;
                 socket.send_to(boost::asio::buffer(packet.get(), packet_length), 
-                    exchanger_->static_echo_source_ep_, boost::asio::socket_base::message_end_of_record, ec);
+                    exchanger_->StaticEchoSourceEndPoint(), boost::asio::socket_base::message_end_of_record, ec);
                 
                 if (ec) {
                     return false;
@@ -181,6 +181,7 @@ namespace ppp {
                     statistics->AddOutgoingTraffic(packet_length);
                 }
 
+                exchanger_->StaticEchoParityToClient(packet.get(), packet_length);
                 Update();
                 return true;
             }
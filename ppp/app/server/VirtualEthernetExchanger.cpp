@@ -17,8 +17,12 @@
 #include <ppp/net/native/checksum.h>
 #include <ppp/net/packet/IPFrame.h>
 #include <ppp/net/packet/IcmpFrame.h>
+#include <ppp/net/packet/PacketView.h>
+#include <ppp/diagnostics/Metrics.h>
 
 typedef ppp::app::protocol::VirtualEthernetInformation              VirtualEthernetInformation;
+typedef ppp::app::protocol::VirtualEthernetPacket                   VirtualEthernetPacket;
+typedef ppp::app::protocol::VirtualEthernetFec                      VirtualEthernetFec;
 typedef ppp::collections::Dictionary                                Dictionary;
 typedef ppp::net::AddressFamily                                     AddressFamily;
 typedef ppp::net::Socket                                            Socket;
@@ -168,12 +172,12 @@ namespace ppp {
                 return false; // Immediate return false and forcefully close the connection due to a suspected malicious attack on the server.
             }
 
-            bool VirtualEthernetExchanger::OnStatic(const ITransmissionPtr& transmission, YieldContext& y) noexcept {
-                StaticEcho(transmission, y);
+            bool VirtualEthernetExchanger::OnStatic(const ITransmissionPtr& transmission, int fec, YieldContext& y) noexcept {
+                StaticEcho(transmission, fec, y);
                 return true;
             }
 
-            bool VirtualEthernetExchanger::OnStatic(const ITransmissionPtr& transmission, int session_id, int remote_port, YieldContext& y) noexcept {
+            bool VirtualEthernetExchanger::OnStatic(const ITransmissionPtr& transmission, int session_id, int remote_port, int fec, YieldContext& y) noexcept {
                 return false; // Immediate return false and forcefully close the connection due to a suspected malicious attack on the server.
             }
 
@@ -195,7 +199,7 @@ namespace ppp {
                 return true;
             }
 
-            bool VirtualEthernetExchanger::StaticEcho(const ITransmissionPtr& transmission, YieldContext& y) noexcept {
+            bool VirtualEthernetExchanger::StaticEcho(const ITransmissionPtr& transmission, int fec, YieldContext& y) noexcept {
                 if (disposed_) {
                     return false;
                 }
@@ -205,14 +209,77 @@ namespace ppp {
 
                 Int128 guid = GetId();
                 if (switcher_->StaticEchoAllocated(guid, allocated_id, remote_port)) {
+                    AppConfigurationPtr configuration = GetConfiguration();
+                    int group_size = VirtualEthernetFec::Negotiate(configuration->udp.static_.fec, fec);
+
+                    static_echo_fec_ = group_size > 0 ? make_shared_object<VirtualEthernetFec>(group_size) : NULL;
                     static_echo_session_id_.exchange(allocated_id);
-                    return DoStatic(transmission, allocated_id, remote_port, y);
+                    return DoStatic(transmission, allocated_id, remote_port, group_size, y);
                 }
                 else {
-                    return DoStatic(transmission, 0, IPEndPoint::MinPort, y);
+                    return DoStatic(transmission, 0, IPEndPoint::MinPort, 0, y);
                 }
             }
 
+            boost::asio::ip::udp::endpoint VirtualEthernetExchanger::StaticEchoSourceEndPoint() noexcept {
+                SynchronizedObjectScope scope(static_echo_syncobj_);
+                return static_echo_source_ep_;
+            }
+
+            // The port group sockets of the switcher run on other executors, so the source endpoint is only exchanged under the lock.
+            void VirtualEthernetExchanger::StaticEchoSourceEndPoint(const boost::asio::ip::udp::endpoint& sourceEP) noexcept {
+                SynchronizedObjectScope scope(static_echo_syncobj_);
+                static_echo_source_ep_ = sourceEP;
+            }
+
+            bool VirtualEthernetExchanger::StaticEchoParityToClient(const void* packet, int packet_length) noexcept {
+                std::shared_ptr<VirtualEthernetFec> fec = static_echo_fec_;
+                if (NULL == fec) {
+                    return false;
+                }
+
+                int session_id = static_echo_session_id_;
+                if (session_id < 1) {
+                    return false;
+                }
+
+                AppConfigurationPtr configuration = GetConfiguration();
+                std::shared_ptr<ppp::threading::BufferswapAllocator> allocator = configuration->GetBufferAllocator();
+
+                int messages_length = 0;
+                std::shared_ptr<Byte> messages = fec->Encode(allocator, packet, packet_length, messages_length);
+                if (NULL == messages) {
+                    return false;
+                }
+
+                int parity_length = 0;
+                std::shared_ptr<Byte> parity = VirtualEthernetPacket::PackParity(configuration, allocator,
+                    switcher_->static_echo_protocol_, switcher_->static_echo_transport_, session_id, messages.get(), messages_length, parity_length);
+                if (NULL == parity) {
+                    return false;
+                }
+
+                boost::asio::ip::udp::socket& socket = switcher_->static_echo_socket_;
+                if (!socket.is_open()) {
+                    return false;
+                }
+
+                boost::system::error_code ec;
+                socket.send_to(boost::asio::buffer(parity.get(), parity_length), 
+                    StaticEchoSourceEndPoint(), boost::asio::socket_base::message_end_of_record, ec);
+
+                if (ec) {
+                    return false;
+                }
+
+                auto statistics = GetStatistics(); 
+                if (NULL != statistics) {
+                    statistics->AddOutgoingTraffic(parity_length);
+                }
+
+                return true;
+            }
+
             bool VirtualEthernetExchanger::Arp(const ITransmissionPtr& transmission, uint32_t ip, uint32_t mask) noexcept {
                 using VES = VirtualEthernetSwitcher;
 
@@ -279,6 +346,8 @@ namespace ppp {
                 
                 VirtualEthernetLoggerPtr logger = switcher_->GetLogger();
                 if (destinationPort == PPP_DNS_SYS_PORT) {
+                    ppp::diagnostics::Metrics::Increment(ppp::diagnostics::Metrics::MetricsCounter_DnsQueries);
+
                     ppp::string hostDomain = ppp::net::native::dns::ExtractHost(packet, packet_length);
                     if (hostDomain.size() > 0) {
                         if (NULL != logger) {
@@ -641,18 +710,20 @@ namespace ppp {
                     return false;
                 }
 
-                std::shared_ptr<ppp::threading::BufferswapAllocator> allocator = echo->BufferAllocator;
-                std::shared_ptr<IPFrame> ip = IPFrame::Parse(allocator, packet, packet_length);
-                if (NULL == ip) {
+                // Filter on a view of the packet so that dropped echoes cost no allocations.
+                ppp::net::packet::PacketView view(packet, packet_length);
+                if (!view.IsValid() || view.GetProtocol() != ip_hdr::IP_PROTO_ICMP) {
                     return false;
                 }
 
-                if (ip->ProtocolType != ip_hdr::IP_PROTO_ICMP) {
+                boost::asio::ip::address destinationIP = Ipep::ToAddress(view.GetDestination());
+                if (firewall_->IsDropNetworkSegment(destinationIP)) {
                     return false;
                 }
 
-                boost::asio::ip::address destinationIP = Ipep::ToAddress(ip->Destination);
-                if (firewall_->IsDropNetworkSegment(destinationIP)) {
+                std::shared_ptr<ppp::threading::BufferswapAllocator> allocator = echo->BufferAllocator;
+                std::shared_ptr<IPFrame> ip = IPFrame::Parse(allocator, packet, packet_length);
+                if (NULL == ip) {
                     return false;
                 }
 
@@ -4,6 +4,7 @@
 #include <ppp/app/protocol/VirtualEthernetLogger.h>
 #include <ppp/app/protocol/VirtualEthernetMappingPort.h>
 #include <ppp/app/protocol/VirtualEthernetPacket.h>
+#include <ppp/app/protocol/VirtualEthernetFec.h>
 #include <ppp/net/Ipep.h>
 #include <ppp/net/IPEndPoint.h>
 #include <ppp/net/Firewall.h>
@@ -86,8 +87,8 @@ namespace ppp {
                 virtual bool                                                                OnEcho(const ITransmissionPtr& transmission, int ack_id, YieldContext& y) noexcept override;
                 virtual bool                                                                OnEcho(const ITransmissionPtr& transmission, Byte* packet, int packet_length, YieldContext& y) noexcept override;
                 virtual bool                                                                OnSendTo(const ITransmissionPtr& transmission, const boost::asio::ip::udp::endpoint& sourceEP, const boost::asio::ip::udp::endpoint& destinationEP, Byte* packet, int packet_length, YieldContext& y) noexcept override;
-                virtual bool                                                                OnStatic(const ITransmissionPtr& transmission, YieldContext& y) noexcept override;
-                virtual bool                                                                OnStatic(const ITransmissionPtr& transmission, int session_id, int remote_port, YieldContext& y) noexcept override;
+                virtual bool                                                                OnStatic(const ITransmissionPtr& transmission, int fec, YieldContext& y) noexcept override;
+                virtual bool                                                                OnStatic(const ITransmissionPtr& transmission, int session_id, int remote_port, int fec, YieldContext& y) noexcept override;
     
             protected:  
                 virtual FirewallPtr                                                         GetFirewall() noexcept override;
@@ -127,7 +128,10 @@ namespace ppp {
                 bool                                                                        SendPacketToDestination(const ITransmissionPtr& transmission, const boost::asio::ip::udp::endpoint& sourceEP, const boost::asio::ip::udp::endpoint& destinationEP, Byte* packet, int packet_length, YieldContext& y) noexcept;
     
             private:    
-                bool                                                                        StaticEcho(const ITransmissionPtr& transmission, YieldContext& y) noexcept;
+                bool                                                                        StaticEcho(const ITransmissionPtr& transmission, int fec, YieldContext& y) noexcept;
+                bool                                                                        StaticEchoParityToClient(const void* packet, int packet_length) noexcept;
+                boost::asio::ip::udp::endpoint                                              StaticEchoSourceEndPoint() noexcept;
+                void                                                                        StaticEchoSourceEndPoint(const boost::asio::ip::udp::endpoint& sourceEP) noexcept;
                 bool                                                                        StaticEchoReleasePort(uint32_t source_ip, int source_port) noexcept;
                 bool                                                                        StaticEchoSendToDestination(const std::shared_ptr<ppp::app::protocol::VirtualEthernetPacket>& packet) noexcept;
                 bool                                                                        StaticEchoEchoToDestination(const std::shared_ptr<ppp::app::protocol::VirtualEthernetPacket>& packet, const boost::asio::ip::udp::endpoint& sourceEP) noexcept;
@@ -163,6 +167,7 @@ namespace ppp {
                 std::shared_ptr<VirtualInternetControlMessageProtocolStatic>                static_echo_;
                 boost::asio::ip::udp::endpoint                                              static_echo_source_ep_;
                 std::atomic<int>                                                            static_echo_session_id_ = 0;
+                std::shared_ptr<ppp::app::protocol::VirtualEthernetFec>                     static_echo_fec_;
                 VirtualEthernetDatagramPortStaticTable                                      static_echo_datagram_ports_;
             };
         }
@@ -33,8 +33,97 @@ namespace ppp {
 
                 PACKET_TIMEOUT_ECHO             = 5000,
                 PACKET_TIMEOUT_TRAFFIC          = PACKET_TIMEOUT_ECHO << 2,
+                PACKET_TIMEOUT_AUTHORIZATION    = 300000,
+                PACKET_TIMEOUT_REVOCATION       = PACKET_TIMEOUT_AUTHENTICATION << 2,
+
+                PACKET_FORMAT_BINARY            = 0xB1,
+                PACKET_BINARY_MAX_TASKS         = 4096,
             };
 
+            /* Binary messages share the hex length prefix of the json ones and are told apart by their first byte:
+             * [0xB1][varint cmd][varint id][varint node][body], guids are the 16 bytes of the uuid and signed values are zigzag varints.
+             *
+             * authentication: node -> backend  guid
+             *                 backend -> node  guid [information], no information rejects the session
+             * traffic:        node -> backend  varint count, count x (guid, zigzag rx, zigzag tx)
+             *                 backend -> node  varint count, count x (guid, information)
+             * information:    zigzag bandwidth_qos, varint incoming_traffic, varint outgoing_traffic, varint expired_time
+             */
+            static void PACKET_WriteVarint(ppp::string& s, uint64_t value) noexcept {
+                while (value >= 0x80) {
+                    s.push_back((char)(value | 0x80));
+                    value >>= 7;
+                }
+
+                s.push_back((char)value);
+            }
+
+            static bool PACKET_ReadVarint(const Byte*& p, const Byte* endl, uint64_t& value) noexcept {
+                value = 0;
+                for (int shift = 0; shift < 64 && p < endl; shift += 7) {
+                    Byte b = *p++;
+                    value |= (uint64_t)(b & 0x7f) << shift;
+                    if ((b & 0x80) == 0) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            static void PACKET_WriteZigZag(ppp::string& s, int64_t value) noexcept {
+                PACKET_WriteVarint(s, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+            }
+
+            static bool PACKET_ReadZigZag(const Byte*& p, const Byte* endl, int64_t& value) noexcept {
+                uint64_t n = 0;
+                if (!PACKET_ReadVarint(p, endl, n)) {
+                    return false;
+                }
+
+                value = (int64_t)(n >> 1) ^ -(int64_t)(n & 1);
+                return true;
+            }
+
+            static void PACKET_WriteGuid(ppp::string& s, const ppp::Int128& guid) noexcept {
+                Int128 network_guid = ppp::net::Ipep::HostToNetworkOrder(guid);
+                s.append((char*)&network_guid, sizeof(network_guid));
+            }
+
+            static bool PACKET_ReadGuid(const Byte*& p, const Byte* endl, ppp::Int128& guid) noexcept {
+                if (endl - p < (int)sizeof(Int128)) {
+                    return false;
+                }
+
+                Int128 network_guid;
+                memcpy(&network_guid, p, sizeof(network_guid));
+                p += sizeof(network_guid);
+
+                guid = ppp::net::Ipep::NetworkToHostOrder(network_guid);
+                return true;
+            }
+
+            static std::shared_ptr<VirtualEthernetManagedServer::VirtualEthernetInformation> PACKET_ReadInformation(const Byte*& p, const Byte* endl) noexcept {
+                int64_t bandwidth_qos = 0;
+                uint64_t incoming_traffic = 0;
+                uint64_t outgoing_traffic = 0;
+                uint64_t expired_time = 0;
+                if (!PACKET_ReadZigZag(p, endl, bandwidth_qos) ||
+                    !PACKET_ReadVarint(p, endl, incoming_traffic) ||
+                    !PACKET_ReadVarint(p, endl, outgoing_traffic) ||
+                    !PACKET_ReadVarint(p, endl, expired_time)) {
+                    return NULL;
+                }
+
+                auto i = make_shared_object<VirtualEthernetManagedServer::VirtualEthernetInformation>();
+                if (NULL != i) {
+                    i->BandwidthQoS = bandwidth_qos;
+                    i->IncomingTraffic = incoming_traffic;
+                    i->OutgoingTraffic = outgoing_traffic;
+                    i->ExpiredTime = (UInt32)expired_time;
+                }
+                return i;
+            }
+
             VirtualEthernetManagedServer::VirtualEthernetManagedServer(const std::shared_ptr<VirtualEthernetSwitcher>& switcher) noexcept
                 : disposed_(false)
                 , reconnecting_(false)
@@ -76,60 +165,157 @@ namespace ppp {
                     return false;
                 }
 
+                // A session the backend admitted recently is let in at once and revalidated by the request below, 
+                // Concurrent requests for one session share a single round trip to the backend.
+                VirtualEthernetInformationPtr cached = FindAuthorization(session_id);
+                bool request = false;
+
                 UInt64 next = Executors::GetTickCount() + PACKET_TIMEOUT_AUTHENTICATION; {
                     SynchronizedObjectScope scope(syncobj_);
-                    if (authentications_.find(session_id) != authentications_.end()) {
-                        return false;
+                    auto tail = authentications_.find(session_id);
+                    if (tail == authentications_.end()) {
+                        tail = authentications_.emplace(session_id, AuthenticationWaitable{ next }).first;
+                        request = true;
+                    }
+
+                    if (NULL == cached) {
+                        tail->second.acs.emplace_back(ac);
                     }
+                }
+
+                if (NULL != cached) {
+                    context_->post(
+                        [ac, cached]() noexcept {
+                            VirtualEthernetInformationPtr i = cached;
+                            ac(true, i);
+                        });
+                }
 
-                    authentications_.emplace(session_id, AuthenticationWaitable{ next, ac });
+                if (!request) {
+                    return true;
                 }
 
                 int id = NewId();
-                bool ok = SendToManagedServer(session_id, PACKET_CMD_AUTHENTICATION, id);
+                bool ok = false;
+                if (binary_.load()) {
+                    ppp::string body;
+                    PACKET_WriteGuid(body, session_id);
+                    ok = SendBinaryToManagedServer(PACKET_CMD_AUTHENTICATION, id, body);
+                }
+                else {
+                    ok = SendToManagedServer(session_id, PACKET_CMD_AUTHENTICATION, id);
+                }
+
                 if (ok) {
                     return true;
                 }
 
                 DeleteAuthenticationToManagedServer(session_id);
-                return false;
+                return NULL != cached;
             }
 
-            VirtualEthernetManagedServer::AuthenticationToManagedServerAsyncCallback VirtualEthernetManagedServer::DeleteAuthenticationToManagedServer(const ppp::Int128& session_id) noexcept {
-                AuthenticationToManagedServerAsyncCallback f; {
+            VirtualEthernetManagedServer::AuthenticationCallbackList VirtualEthernetManagedServer::DeleteAuthenticationToManagedServer(const ppp::Int128& session_id) noexcept {
+                AuthenticationCallbackList acs; {
                     SynchronizedObjectScope scope(syncobj_);
                     auto tail = authentications_.find(session_id);
                     auto endl = authentications_.end();
                     if (tail != endl) {
-                        auto& aw = tail->second;
-                        f = std::move(aw.ac);
-                        aw.ac.reset();
+                        acs = std::move(tail->second.acs);
                         authentications_.erase(tail);
                     }
                 }
-                return f;
+                return acs;
             }
 
-            void VirtualEthernetManagedServer::TickAllAuthenticationToManagedServer(UInt64 now) noexcept {
-                typedef struct {
-                    ppp::Int128 k;
-                    AuthenticationToManagedServerAsyncCallback f;
-                } ReleaseInfo;
+            VirtualEthernetManagedServer::VirtualEthernetInformationPtr VirtualEthernetManagedServer::FindAuthorization(const ppp::Int128& session_id) noexcept {
+                VirtualEthernetInformation information; {
+                    SynchronizedObjectScope scope(syncobj_);
+                    auto tail = authorizations_.find(session_id);
+                    auto endl = authorizations_.end();
+                    if (tail == endl) {
+                        return NULL;
+                    }
+
+                    Authorization& authorization = tail->second;
+                    if (Executors::GetTickCount() >= authorization.timeout) {
+                        authorizations_.erase(tail);
+                        return NULL;
+                    }
+
+                    information = authorization.information;
+                }
+
+                if (!information.Valid()) {
+                    return NULL;
+                }
+
+                return make_shared_object<VirtualEthernetInformation>(information);
+            }
+
+            bool VirtualEthernetManagedServer::UpdateAuthorization(const ppp::Int128& session_id, const VirtualEthernetInformationPtr& i) noexcept {
+                SynchronizedObjectScope scope(syncobj_);
+                if (NULL == i || !i->Valid()) {
+                    return authorizations_.erase(session_id) > 0;
+                }
+
+                Authorization& authorization = authorizations_[session_id];
+                authorization.timeout = Executors::GetTickCount() + PACKET_TIMEOUT_AUTHORIZATION;
+                authorization.information = *i;
+                revocations_.erase(session_id);
+                return true;
+            }
+
+            bool VirtualEthernetManagedServer::IsRevoked(const ppp::Int128& session_id) noexcept {
+                SynchronizedObjectScope scope(syncobj_);
+                auto tail = revocations_.find(session_id);
+                auto endl = revocations_.end();
+                if (tail == endl) {
+                    return false;
+                }
+
+                if (Executors::GetTickCount() >= tail->second) {
+                    revocations_.erase(tail);
+                    return false;
+                }
+
+                return true;
+            }
 
-                ppp::vector<ReleaseInfo> releases; {
+            void VirtualEthernetManagedServer::TickAllAuthenticationToManagedServer(UInt64 now) noexcept {
+                AuthenticationCallbackList releases; {
                     SynchronizedObjectScope scope(syncobj_);
-                    for (auto&& kv : authentications_) {
-                        auto& aw = kv.second;
+                    for (auto tail = authentications_.begin(); tail != authentications_.end();) {
+                        auto& aw = tail->second;
                         if (now >= aw.timeout) {
-                            releases.emplace_back(ReleaseInfo{ kv.first, std::move(aw.ac) });
-                            aw.ac.reset();
+                            releases.splice(releases.end(), aw.acs);
+                            tail = authentications_.erase(tail);
+                        }
+                        else {
+                            tail++;
+                        }
+                    }
+
+                    for (auto tail = authorizations_.begin(); tail != authorizations_.end();) {
+                        if (now >= tail->second.timeout) {
+                            tail = authorizations_.erase(tail);
+                        }
+                        else {
+                            tail++;
+                        }
+                    }
+
+                    for (auto tail = revocations_.begin(); tail != revocations_.end();) {
+                        if (now >= tail->second) {
+                            tail = revocations_.erase(tail);
+                        }
+                        else {
+                            tail++;
                         }
                     }
                 }
 
                 VirtualEthernetInformationPtr nullVEI;
-                for (ReleaseInfo& ri : releases) {
-                    AuthenticationToManagedServerAsyncCallback& f = ri.f;
+                for (AuthenticationToManagedServerAsyncCallback& f : releases) {
                     if (f) {
                         f(false, nullVEI);
                     }
@@ -211,13 +397,19 @@ namespace ppp {
                 }
                 elif(now >= echotest_next_) {
                     int id = NewId();
-                    SendToManagedServer(0, PACKET_CMD_ECHO, id);
+                    if (binary_.load()) {
+                        SendBinaryToManagedServer(PACKET_CMD_ECHO, id, ppp::string());
+                    }
+                    else {
+                        SendToManagedServer(0, PACKET_CMD_ECHO, id);
+                    }
+
                     echotest_next_ = now + RandomNext(1000, PACKET_TIMEOUT_ECHO);
                 }
             }
 
-            template <typename TWebSocket, typename TWebSocketPtr, typename TData>
-            static bool PACKET_SendToManagedServer(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, TWebSocketPtr websocket, const ppp::Int128& session_id, int cmd, int id, int node, const TData& data) noexcept {
+            template <typename TWebSocketPtr>
+            static bool PACKET_WriteToManagedServer(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, TWebSocketPtr websocket, const void* payload, int payload_length) noexcept {
                 if (NULL == websocket) {
                     return false;
                 }
@@ -227,27 +419,19 @@ namespace ppp {
                     return false;
                 }
 
-                Json::Value messages;
-                messages["Id"] = id;
-                messages["Node"] = node;
-                messages["Guid"] = StringAuxiliary::Int128ToGuidString(session_id);
-                messages["Cmd"] = cmd;
-                messages["Data"] = data;
-
-                ppp::string json_string = JsonAuxiliary::ToString(messages);
-                int length_dec = snprintf(length_hex, sizeof(length_hex), "%08x", (unsigned int)json_string.size());
+                int length_dec = snprintf(length_hex, sizeof(length_hex), "%08x", (unsigned int)payload_length);
                 if (length_dec < 1) {
                     return false;
                 }
 
-                int packet_length = json_string.size() + length_dec;
+                int packet_length = payload_length + length_dec;
                 std::shared_ptr<Byte> packet = ppp::threading::BufferswapAllocator::MakeByteArray(allocator, packet_length);
                 if (NULL == packet) {
                     return false;
                 }
                 
                 memcpy(packet.get(), length_hex, length_dec);
-                memcpy(packet.get() + length_dec, json_string.data(), json_string.size());
+                memcpy(packet.get() + length_dec, payload, payload_length);
                 return websocket->Write(packet.get(), 0, packet_length, 
                     [websocket, packet](bool ok) noexcept -> void {
                         if (!ok) {
@@ -256,6 +440,24 @@ namespace ppp {
                     });
             }
 
+            template <typename TWebSocket, typename TWebSocketPtr, typename TData>
+            static bool PACKET_SendToManagedServer(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, TWebSocketPtr websocket, const ppp::Int128& session_id, int cmd, int id, int node, const TData& data, bool binary = false) noexcept {
+                Json::Value messages;
+                messages["Id"] = id;
+                messages["Node"] = node;
+                messages["Guid"] = StringAuxiliary::Int128ToGuidString(session_id);
+                messages["Cmd"] = cmd;
+                messages["Data"] = data;
+
+                // Offers the binary framing on connect, a backend that does not echo it back keeps talking json.
+                if (binary) {
+                    messages["Binary"] = true;
+                }
+
+                ppp::string json_string = JsonAuxiliary::ToString(messages);
+                return PACKET_WriteToManagedServer(allocator, websocket, json_string.data(), static_cast<int>(json_string.size()));
+            }
+
             template <typename TWebSocketPtr>
             static std::shared_ptr<Byte> PACKET_ReadBinaryPacket(std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, TWebSocketPtr& websocket, int& packet_length, ppp::coroutines::YieldContext& y) noexcept {
                 char length_hex[8];
@@ -309,6 +511,19 @@ namespace ppp {
                 return PACKET_SendToManagedServer<WebSocket>(allocator, server_, session_id, cmd, id, node, data);
             }
 
+            bool VirtualEthernetManagedServer::SendBinaryToManagedServer(int cmd, int id, const ppp::string& body) noexcept {
+                ppp::string payload;
+                payload.reserve(body.size() + 16);
+                payload.push_back((char)PACKET_FORMAT_BINARY);
+                PACKET_WriteVarint(payload, (uint32_t)cmd);
+                PACKET_WriteVarint(payload, (uint32_t)id);
+                PACKET_WriteVarint(payload, (uint32_t)switcher_->GetNode());
+                payload += body;
+
+                auto allocator = configuration_->GetBufferAllocator();
+                return PACKET_WriteToManagedServer(allocator, server_, payload.data(), static_cast<int>(payload.size()));
+            }
+
             bool VirtualEthernetManagedServer::TryVerifyUriAsync(const ppp::string& url, const TryVerifyUriAsyncCallback& ac) noexcept {
                 if (disposed_) {
                     return false;
@@ -433,8 +648,22 @@ namespace ppp {
             void VirtualEthernetManagedServer::Run(IWebScoketPtr& websocket, YieldContext& y) noexcept {
                 int node = switcher_->GetNode();
                 while (!disposed_) {
-                    Json::Value json;
-                    if (!PACKET_ReadJsonPacket(allocator_, websocket, json, y)) {
+                    int packet_length = 0;
+                    std::shared_ptr<Byte> packet = PACKET_ReadBinaryPacket(allocator_, websocket, packet_length, y);
+                    if (NULL == packet || packet_length < 1) {
+                        break;
+                    }
+
+                    if (*packet == PACKET_FORMAT_BINARY) {
+                        if (!AckBinaryToManagedServer(packet.get(), packet_length, y)) {
+                            break;
+                        }
+
+                        continue;
+                    }
+
+                    Json::Value json = JsonAuxiliary::FromString((char*)packet.get(), packet_length);
+                    if (!json.isObject()) {
                         break;
                     }
 
@@ -490,20 +719,77 @@ namespace ppp {
                     }
 
                     Int128 session_id = StringAuxiliary::GuidStringToInt128(guid);
+                    UpdateAuthorization(session_id, info);
                     any |= switcher_->OnInformation(session_id, info, y);
                 }
                 return any;
             }
 
-            bool VirtualEthernetManagedServer::AckAuthenticationToManagedServer(Json::Value& json, YieldContext& y) noexcept {
-                ppp::string guid = JsonAuxiliary::AsString(json["Guid"]);
-                if (guid.empty()) {
+            bool VirtualEthernetManagedServer::AckBinaryToManagedServer(const Byte* packet, int packet_length, YieldContext& y) noexcept {
+                const Byte* p = packet + 1;
+                const Byte* endl = packet + packet_length;
+
+                uint64_t cmd_var = 0;
+                uint64_t id_var = 0;
+                uint64_t node_var = 0;
+                if (!PACKET_ReadVarint(p, endl, cmd_var) || !PACKET_ReadVarint(p, endl, id_var) || !PACKET_ReadVarint(p, endl, node_var)) {
                     return false;
                 }
 
-                Int128 session_id = StringAuxiliary::GuidStringToInt128(guid);
-                AuthenticationToManagedServerAsyncCallback f = DeleteAuthenticationToManagedServer(session_id);
-                if (!f) {
+                if (node_var != (uint32_t)switcher_->GetNode()) {
+                    return false;
+                }
+
+                if (cmd_var == PACKET_CMD_ECHO) {
+                    return true;
+                }
+                elif(cmd_var == PACKET_CMD_AUTHENTICATION) {
+                    Int128 session_id;
+                    if (!PACKET_ReadGuid(p, endl, session_id)) {
+                        return false;
+                    }
+
+                    VirtualEthernetInformationPtr i;
+                    if (p < endl) {
+                        i = PACKET_ReadInformation(p, endl);
+                        if (NULL == i) {
+                            return false;
+                        }
+                    }
+
+                    AckAuthenticationToManagedServer(session_id, i, y);
+                    return true;
+                }
+                elif(cmd_var == PACKET_CMD_TRAFFIC) {
+                    uint64_t count = 0;
+                    if (!PACKET_ReadVarint(p, endl, count)) {
+                        return false;
+                    }
+
+                    for (uint64_t index = 0; index < count; index++) {
+                        Int128 session_id;
+                        if (!PACKET_ReadGuid(p, endl, session_id)) {
+                            return false;
+                        }
+
+                        VirtualEthernetInformationPtr i = PACKET_ReadInformation(p, endl);
+                        if (NULL == i) {
+                            return false;
+                        }
+
+                        UpdateAuthorization(session_id, i);
+                        switcher_->OnInformation(session_id, i, y);
+                    }
+                    return true;
+                }
+                else {
+                    return false;
+                }
+            }
+
+            bool VirtualEthernetManagedServer::AckAuthenticationToManagedServer(Json::Value& json, YieldContext& y) noexcept {
+                ppp::string guid = JsonAuxiliary::AsString(json["Guid"]);
+                if (guid.empty()) {
                     return false;
                 }
 
@@ -519,14 +805,38 @@ namespace ppp {
                     }
                 }
 
-                if (!i) {
-                    VirtualEthernetInformationPtr nullVEI;
-                    f(false, nullVEI);
-                    return true;
+                Int128 session_id = StringAuxiliary::GuidStringToInt128(guid);
+                return AckAuthenticationToManagedServer(session_id, i, y);
+            }
+
+            bool VirtualEthernetManagedServer::AckAuthenticationToManagedServer(const ppp::Int128& session_id, VirtualEthernetInformationPtr& i, YieldContext& y) noexcept {
+                bool admitted = NULL != FindAuthorization(session_id);
+                bool valid = NULL != i && i->Valid();
+                UpdateAuthorization(session_id, i);
+
+                // The backend revoked a session that was let in from the cache, UpdateAuthorization evicted it already. The exchanger may not
+                // be registered yet, so the revocation is also kept for a while and the switcher refuses a registration that comes later.
+                if (admitted && !valid) {
+                    UInt64 timeout = Executors::GetTickCount() + PACKET_TIMEOUT_REVOCATION; {
+                        SynchronizedObjectScope scope(syncobj_);
+                        revocations_[session_id] = timeout;
+                    }
+
+                    switcher_->OnInformation(session_id, i, y);
                 }
 
-                f(i->Valid(), i);
-                return true;
+                AuthenticationCallbackList acs = DeleteAuthenticationToManagedServer(session_id);
+                for (AuthenticationToManagedServerAsyncCallback& f : acs) {
+                    if (!i) {
+                        VirtualEthernetInformationPtr nullVEI;
+                        f(false, nullVEI);
+                    }
+                    else {
+                        f(valid, i);
+                    }
+                }
+
+                return admitted || !acs.empty();
             }
 
             void VirtualEthernetManagedServer::UploadTrafficToManagedServer(const ppp::Int128& session_id, int64_t rx, int64_t tx) noexcept {
@@ -548,15 +858,43 @@ namespace ppp {
                     return false;
                 }
 
-                Json::Value json;
-                Json::Value& json_array = json["Tasks"];
-
                 UploadTrafficTaskTable traffics; {
                     SynchronizedObjectScope scope(syncobj_);
                     traffics = std::move(traffics_);
                     traffics_.clear();
                 }
 
+                traffics_next_ = now + PACKET_TIMEOUT_TRAFFIC;
+                if (binary_.load()) {
+                    // Sessions are packed many to a frame, a frame is bounded so a large node does not stall the link with one message.
+                    ppp::string body;
+                    ppp::string tasks;
+                    int count = 0;
+                    for (auto&& [guid, task] : traffics) {
+                        PACKET_WriteGuid(tasks, guid);
+                        PACKET_WriteZigZag(tasks, task.tx); // server:tx = client:rx
+                        PACKET_WriteZigZag(tasks, task.rx); // server:rx = client:tx
+                        if (++count == PACKET_BINARY_MAX_TASKS) {
+                            PACKET_WriteVarint(body, count);
+                            body += tasks;
+                            SendBinaryToManagedServer(PACKET_CMD_TRAFFIC, NewId(), body);
+
+                            body.clear();
+                            tasks.clear();
+                            count = 0;
+                        }
+                    }
+
+                    if (count > 0) {
+                        PACKET_WriteVarint(body, count);
+                        body += tasks;
+                        SendBinaryToManagedServer(PACKET_CMD_TRAFFIC, NewId(), body);
+                    }
+                    return true;
+                }
+
+                Json::Value json;
+                Json::Value& json_array = json["Tasks"];
                 for (auto&& [guid, task] : traffics) {
                     Json::Value json_value;
                     json_value["Guid"] = StringAuxiliary::Int128ToGuidString(guid);
@@ -565,7 +903,6 @@ namespace ppp {
                     json_array.append(json_value);
                 }
 
-                traffics_next_ = now + PACKET_TIMEOUT_TRAFFIC;
                 if (json_array.isArray()) {
                     int id = NewId();
                     SendToManagedServer(0, PACKET_CMD_TRAFFIC, id, JsonAuxiliary::ToString(json));
@@ -584,7 +921,7 @@ namespace ppp {
                 int node = switcher_->GetNode();
 
                 auto allocator = configuration_->GetBufferAllocator();
-                bool ok = PACKET_SendToManagedServer<WebSocket>(allocator, websocket, 0, PACKET_CMD_CONNECT, id, node, configuration_->server.backend_key);
+                bool ok = PACKET_SendToManagedServer<WebSocket>(allocator, websocket, 0, PACKET_CMD_CONNECT, id, node, configuration_->server.backend_key, true);
 
                 class websocket_auto_destroy final {
                 public:
@@ -642,7 +979,12 @@ namespace ppp {
                 }
 
                 ppp::string data = JsonAuxiliary::AsString(json["Data"]);
-                return ToBoolean(data.data()) ? websocket : NULL;
+                if (!ToBoolean(data.data())) {
+                    return NULL;
+                }
+
+                binary_.store(JsonAuxiliary::AsBoolean(json["Binary"]));
+                return websocket;
             }
 
             VirtualEthernetManagedServer::IWebScoketPtr VirtualEthernetManagedServer::NewWebSocketConnectToManagedServer(const ppp::string& url, YieldContext& y) noexcept {
@@ -30,11 +30,18 @@ namespace ppp {
                 typedef std::lock_guard<SynchronizedObject>                         SynchronizedObjectScope;
 
             private:
+                typedef ppp::list<AuthenticationToManagedServerAsyncCallback>       AuthenticationCallbackList;
                 typedef struct {
                     uint64_t                                                        timeout;
-                    AuthenticationToManagedServerAsyncCallback                      ac;
+                    AuthenticationCallbackList                                      acs;
                 }                                                                   AuthenticationWaitable;
                 typedef ppp::unordered_map<Int128, AuthenticationWaitable>          AuthenticationWaitableTable;
+                typedef struct {
+                    uint64_t                                                        timeout;
+                    VirtualEthernetInformation                                      information;
+                }                                                                   Authorization;
+                typedef ppp::unordered_map<Int128, Authorization>                   AuthorizationTable;
+                typedef ppp::unordered_map<Int128, uint64_t>                        RevocationTable;
                 typedef ppp::unordered_map<void*, TimerPtr>                         TimerTable;
                 struct UploadTrafficTask {
                     int64_t                                                         rx = 0;
@@ -82,14 +89,19 @@ namespace ppp {
             public:
                 virtual bool                                                        AuthenticationToManagedServer(const ppp::Int128& session_id, const AuthenticationToManagedServerAsyncCallback& ac) noexcept;
                 virtual void                                                        UploadTrafficToManagedServer(const ppp::Int128& session_id, int64_t rx, int64_t tx) noexcept;
+                /* True while the backend recently revoked a session, its registration must be refused until the backend admits it again. */
+                bool                                                                IsRevoked(const ppp::Int128& session_id) noexcept;
 
             protected:
                 bool                                                                SendToManagedServer(const ppp::Int128& session_id, int cmd, int id) noexcept;
                 virtual bool                                                        SendToManagedServer(const ppp::Int128& session_id, int cmd, int id, const ppp::string& data) noexcept;
                 virtual bool                                                        SendToManagedServer(const ppp::Int128& session_id, int cmd, int id, const Json::Value& data) noexcept;
+                virtual bool                                                        SendBinaryToManagedServer(int cmd, int id, const ppp::string& body) noexcept;
 
             private:
-                AuthenticationToManagedServerAsyncCallback                          DeleteAuthenticationToManagedServer(const ppp::Int128& session_id) noexcept;
+                AuthenticationCallbackList                                          DeleteAuthenticationToManagedServer(const ppp::Int128& session_id) noexcept;
+                VirtualEthernetInformationPtr                                       FindAuthorization(const ppp::Int128& session_id) noexcept;
+                bool                                                                UpdateAuthorization(const ppp::Int128& session_id, const VirtualEthernetInformationPtr& i) noexcept;
                 void                                                                TickAllAuthenticationToManagedServer(UInt64 now) noexcept;
                 void                                                                TickEchoToManagedServer(UInt64 now) noexcept;
                 void                                                                RunInner(const ppp::string& url, YieldContext& y) noexcept;
@@ -99,7 +111,9 @@ namespace ppp {
             private:
                 void                                                                Run(IWebScoketPtr& websocket, YieldContext& y) noexcept;
                 bool                                                                AckAuthenticationToManagedServer(Json::Value& json, YieldContext& y) noexcept;
+                bool                                                                AckAuthenticationToManagedServer(const ppp::Int128& session_id, VirtualEthernetInformationPtr& i, YieldContext& y) noexcept;
                 bool                                                                AckAllUploadTrafficToManagedServer(Json::Value& json, YieldContext& y) noexcept;
+                bool                                                                AckBinaryToManagedServer(const Byte* packet, int packet_length, YieldContext& y) noexcept;
                 IWebScoketPtr                                                       NewWebSocketConnectToManagedServer2(const ppp::string& url, YieldContext& y) noexcept;
                 IWebScoketPtr                                                       NewWebSocketConnectToManagedServer(const ppp::string& url, YieldContext& y) noexcept;
 
@@ -109,6 +123,7 @@ namespace ppp {
                     bool                                                            disposed_      : 1;
                     bool                                                            reconnecting_  : 7;
                 };
+                std::atomic<bool>                                                   binary_        = false;
                 std::atomic<int>                                                    aid_           = 0;
                 UInt64                                                              echotest_next_ = 0;
                 UInt64                                                              traffics_next_ = 0;
@@ -120,6 +135,8 @@ namespace ppp {
                 AppConfigurationPtr                                                 configuration_;
                 UploadTrafficTaskTable                                              traffics_;
                 AuthenticationWaitableTable                                         authentications_;
+                AuthorizationTable                                                  authorizations_;
+                RevocationTable                                                     revocations_;
             };
         }
     }
@@ -11,6 +11,8 @@
 #include <ppp/net/packet/UdpFrame.h>
 #include <ppp/net/packet/IcmpFrame.h>
 #include <ppp/collections/Dictionary.h>
+#include <ppp/diagnostics/Metrics.h>
+#include <ppp/cryptography/digest.h>
 #include <ppp/threading/Executors.h>
 #include <ppp/transmissions/ITcpipTransmission.h>
 #include <ppp/transmissions/IWebsocketTransmission.h>
@@ -27,6 +29,45 @@ using ppp::collections::Dictionary;
 namespace ppp {
     namespace app {
         namespace server {
+#if defined(_LINUX)
+            static constexpr int STATIC_ECHO_BATCH_SIZE = 8;
+
+            static bool VirtualEthernetSwitcher_OpenReusePortSocket(boost::asio::ip::udp::socket& socket, const boost::asio::ip::address& address, int port) noexcept {
+                boost::system::error_code ec;
+                if (address.is_v4()) {
+                    socket.open(boost::asio::ip::udp::v4(), ec);
+                }
+                else {
+                    socket.open(boost::asio::ip::udp::v6(), ec);
+                }
+
+                if (ec) {
+                    return false;
+                }
+
+                // SO_REUSEPORT has to be set on every member of the group before it binds.
+                bool ok = Socket::ReuseSocketPort(socket.native_handle(), true) && Socket::OpenSocket(socket, address, port, true);
+                if (ok) {
+                    ok = Socket::LocalPort(socket) == port;
+                }
+
+                if (!ok) {
+                    Socket::Closesocket(socket);
+                }
+
+                return ok;
+            }
+
+            static std::shared_ptr<Byte> VirtualEthernetSwitcher_NewDatagramBuffers(const std::shared_ptr<ppp::configurations::AppConfiguration>& configuration, const std::shared_ptr<Byte>& buffers) noexcept {
+                std::shared_ptr<ppp::threading::BufferswapAllocator> allocator = configuration->GetBufferAllocator();
+                return ppp::threading::BufferswapAllocator::MakeByteArray(allocator, PPP_BUFFER_SIZE * STATIC_ECHO_BATCH_SIZE);
+            }
+#else
+            static std::shared_ptr<Byte> VirtualEthernetSwitcher_NewDatagramBuffers(const std::shared_ptr<ppp::configurations::AppConfiguration>& configuration, const std::shared_ptr<Byte>& buffers) noexcept {
+                return buffers;
+            }
+#endif
+
             VirtualEthernetSwitcher::VirtualEthernetSwitcher(const AppConfigurationPtr& configuration) noexcept
                 : disposed_(false)
                 , configuration_(configuration)
@@ -42,13 +83,7 @@ namespace ppp {
                 uresolver_ = make_shared_object<boost::asio::ip::udp::resolver>(*context_);
                 statistics_ = make_shared_object<ppp::transmissions::ITransmissionStatistics>();
 
-                if (configuration->key.protocol.size() && configuration->key.protocol_key.size() && configuration->key.transport.size() && configuration->key.transport_key.size()) {
-                    if (Ciphertext::Support(configuration->key.protocol) && Ciphertext::Support(configuration->key.transport)) {
-                        static_echo_protocol_ = make_shared_object<Ciphertext>(configuration->key.protocol, configuration->key.protocol_key);
-                        static_echo_transport_ = make_shared_object<Ciphertext>(configuration->key.transport, configuration->key.transport_key);
-                    }
-                }
-
+                NewStaticEchoCiphertexts(static_echo_protocol_, static_echo_transport_);
                 static_echo_buffers_ = ppp::threading::Executors::GetCachedBuffer(context_);
             }
 
@@ -56,6 +91,19 @@ namespace ppp {
                 Finalize();
             }
 
+            bool VirtualEthernetSwitcher::NewStaticEchoCiphertexts(CiphertextPtr& protocol, CiphertextPtr& transport) noexcept {
+                AppConfigurationPtr configuration = configuration_;
+                if (configuration->key.protocol.size() && configuration->key.protocol_key.size() && configuration->key.transport.size() && configuration->key.transport_key.size()) {
+                    if (Ciphertext::Support(configuration->key.protocol) && Ciphertext::Support(configuration->key.transport)) {
+                        protocol = make_shared_object<Ciphertext>(configuration->key.protocol, configuration->key.protocol_key);
+                        transport = make_shared_object<Ciphertext>(configuration->key.transport, configuration->key.transport_key);
+                        return NULL != protocol && NULL != transport;
+                    }
+                }
+
+                return false;
+            }
+
             int VirtualEthernetSwitcher::GetNode() noexcept {
                 return configuration_->server.node;
             }
@@ -123,6 +171,27 @@ namespace ppp {
                         acceptors_[categories] = NULL;
                     }
                 }
+
+                // Conversations of the reliable udp carrier are opened on the executors, the handler only hands them to the coroutine.
+                if (std::shared_ptr<ppp::transmissions::IReliableUdpAcceptor> acceptor = rudp_acceptor_; NULL != acceptor) {
+                    bool bok = acceptor->Run(
+                        [self, this](const std::shared_ptr<ppp::transmissions::IReliableUdpTransmission>& transmission) noexcept {
+                            if (disposed_) {
+                                return false;
+                            }
+
+                            transmission->Statistics = NewStatistics();
+                            return Accept(transmission->GetContext(), transmission);
+                        });
+
+                    if (bok) {
+                        bany = true;
+                    }
+                    else {
+                        acceptor->Dispose();
+                        rudp_acceptor_ = NULL;
+                    }
+                }
                 return bany;
             }
 
@@ -205,18 +274,22 @@ namespace ppp {
                         return false;
                     }
 
-                    auto allocator = transmission->BufferAllocator;
-                    auto self = shared_from_this();
-                    return YieldContext::Spawn(allocator.get(), *context,
-                        [self, this, context, transmission](YieldContext& y) noexcept {
-                            int status = Run(context, transmission, y);
-                            if (status != 0) {
-                                transmission->Dispose();
-                            }
-                        });
+                    return Accept(context, transmission);
                 }
             }
 
+            bool VirtualEthernetSwitcher::Accept(const ContextPtr& context, const ITransmissionPtr& transmission) noexcept {
+                auto allocator = transmission->BufferAllocator;
+                auto self = shared_from_this();
+                return YieldContext::Spawn(allocator.get(), *context,
+                    [self, this, context, transmission](YieldContext& y) noexcept {
+                        int status = Run(context, transmission, y);
+                        if (status != 0) {
+                            transmission->Dispose();
+                        }
+                    });
+            }
+
             VirtualEthernetSwitcher::VirtualEthernetExchangerPtr VirtualEthernetSwitcher::GetExchanger(const Int128& session_id) noexcept {
                 SynchronizedObjectScope scope(syncobj_);
                 if (disposed_) {
@@ -288,6 +361,13 @@ namespace ppp {
                     return false;
                 }
 
+                // Checked after the exchanger is registered, a revocation that comes later finds it through OnInformation instead.
+                VirtualEthernetManagedServerPtr managed_server = managed_server_;
+                if (NULL != managed_server && managed_server->IsRevoked(session_id)) {
+                    DeleteExchanger(channel.get());
+                    return false;
+                }
+
                 bool run = true;
                 if (NULL != i) {
                     run = channel->DoInformation(transmission, *i, y);
@@ -479,6 +559,25 @@ namespace ppp {
                         }
                     }
                 }
+
+                if (int port = configuration_->udp.listen.rudp; port > IPEndPoint::MinPort && port <= IPEndPoint::MaxPort) {
+                    if (NULL != rudp_acceptor_) {
+                        return false;
+                    }
+
+                    std::shared_ptr<ppp::transmissions::IReliableUdpAcceptor> acceptor = make_shared_object<ppp::transmissions::IReliableUdpAcceptor>(context_, configuration_);
+                    if (NULL == acceptor) {
+                        return false;
+                    }
+
+                    for (boost::asio::ip::address& interface_ip : interface_ips) {
+                        if (acceptor->Open(interface_ip, port)) {
+                            bany |= true;
+                            rudp_acceptor_ = std::move(acceptor);
+                            break;
+                        }
+                    }
+                }
                 return bany;
             }
 
@@ -499,11 +598,85 @@ namespace ppp {
                     OpenDatagramSocket();
                 if (ok) {
                     OpenLogger();
+                    OpenMetrics();
                 }
 
                 return ok;
             }
 
+            bool VirtualEthernetSwitcher::OpenMetrics() noexcept {
+                std::weak_ptr<VirtualEthernetSwitcher> self_weak = shared_from_this();
+                return ppp::diagnostics::Metrics::AddCollector(this, 
+                    [self_weak](ppp::string& out) noexcept {
+                        std::shared_ptr<VirtualEthernetSwitcher> self = self_weak.lock();
+                        if (NULL != self) {
+                            self->CollectMetrics(out);
+                        }
+                    });
+            }
+
+            void VirtualEthernetSwitcher::CollectMetrics(ppp::string& out) noexcept {
+                typedef ppp::diagnostics::Metrics Metrics;
+
+                struct SessionTraffic {
+                    Int128                                  guid;
+                    ITransmissionStatisticsPtr              statistics;
+                };
+
+                ppp::vector<SessionTraffic> sessions;
+                std::size_t exchangers = 0;
+                std::size_t connections = 0;
+                std::size_t nats = 0;
+                {
+                    SynchronizedObjectScope scope(syncobj_);
+                    if (disposed_) {
+                        return;
+                    }
+
+                    // One series per session grows with the clients, it is only exported when the configuration asks for it.
+                    if (configuration_->metrics.sessions) {
+                        for (auto&& [session_id, exchanger] : exchangers_) {
+                            sessions.emplace_back(SessionTraffic{ session_id, exchanger->GetStatistics() });
+                        }
+                    }
+
+                    exchangers = exchangers_.size();
+                    connections = connections_.size();
+                    nats = nats_.size();
+                }
+
+                Metrics::WriteHeader(out, "ppp_exchangers", "gauge", "Client sessions attached to the switcher.");
+                Metrics::WriteSample(out, "ppp_exchangers", ppp::string(), (double)exchangers);
+                Metrics::WriteHeader(out, "ppp_connections", "gauge", "Tcp connections relayed by the switcher.");
+                Metrics::WriteSample(out, "ppp_connections", ppp::string(), (double)connections);
+                Metrics::WriteHeader(out, "ppp_nat_entries", "gauge", "Virtual subnet nat entries.");
+                Metrics::WriteSample(out, "ppp_nat_entries", ppp::string(), (double)nats);
+
+                // The session id authenticates the client, the label is a truncated digest of it that names the session and cannot be replayed.
+                static constexpr const char* metrics[] = { "ppp_session_received_bytes_total", "ppp_session_sent_bytes_total" };
+                for (int i = 0; i < arraysizeof(metrics) && !sessions.empty(); i++) {
+                    Metrics::WriteHeader(out, metrics[i], "counter", i ? "Bytes sent to the session." : "Bytes received from the session.");
+                    for (SessionTraffic& session : sessions) {
+                        if (NULL == session.statistics) {
+                            continue;
+                        }
+
+                        ppp::string digest = ppp::cryptography::hash_hmac(&session.guid, sizeof(session.guid), ppp::cryptography::DigestAlgorithmic_sha256, false);
+                        ppp::string labels = "session=\"" + digest.substr(0, 12) + "\"";
+                        uint64_t traffic = i ? session.statistics->OutgoingTraffic.load() : session.statistics->IncomingTraffic.load();
+                        Metrics::WriteSample(out, metrics[i], labels, (double)traffic);
+                    }
+                }
+
+                std::shared_ptr<ppp::threading::BufferswapAllocator> allocator = configuration_->GetBufferAllocator();
+                if (NULL != allocator) {
+                    Metrics::WriteHeader(out, "ppp_allocator_memory_bytes", "gauge", "Size of the buffer swap region.");
+                    Metrics::WriteSample(out, "ppp_allocator_memory_bytes", ppp::string(), (double)allocator->GetMemorySize());
+                    Metrics::WriteHeader(out, "ppp_allocator_available_bytes", "gauge", "Free bytes left in the buffer swap region.");
+                    Metrics::WriteSample(out, "ppp_allocator_available_bytes", ppp::string(), (double)allocator->GetAvailableSize());
+                }
+            }
+
             bool VirtualEthernetSwitcher::OpenLogger() noexcept {
                 VirtualEthernetLoggerPtr logger = NewLogger();
                 if (NULL == logger) {
@@ -527,9 +700,12 @@ namespace ppp {
                 boost::asio::ip::address interface_ip = GetInterfaceIP();
                 boost::asio::ip::udp::endpoint bind_endpoint(interface_ip, bind_port);
 
-                bool ok = VirtualEthernetPacket::OpenDatagramSocket(static_echo_socket_, interface_ip, bind_port, bind_endpoint);
+                bool ok = OpenDatagramSockets(interface_ip, bind_port);
                 if (!ok) {
-                    return false;
+                    ok = VirtualEthernetPacket::OpenDatagramSocket(static_echo_socket_, interface_ip, bind_port, bind_endpoint);
+                    if (!ok) {
+                        return false;
+                    }
                 }
 
                 boost::system::error_code ec;
@@ -538,23 +714,93 @@ namespace ppp {
                     return false;
                 }
 
+                // Every socket of the port group deciphers on its own executor, so each one gets its own cipher pair and never waits on
+                // the lock of another socket's pair, the shared pair stays with the senders.
                 static_echo_bind_port_ = localEP.port();
-                return LoopbackDatagramSocket();
+                for (const DatagramSocketPtr& socket : static_echo_sockets_) {
+                    CiphertextPtr protocol;
+                    CiphertextPtr transport;
+                    NewStaticEchoCiphertexts(protocol, transport);
+                    LoopbackDatagramSocket(*socket, VirtualEthernetSwitcher_NewDatagramBuffers(configuration_, static_echo_buffers_), protocol, transport);
+                }
+
+                CiphertextPtr protocol;
+                CiphertextPtr transport;
+                NewStaticEchoCiphertexts(protocol, transport);
+                return LoopbackDatagramSocket(static_echo_socket_, VirtualEthernetSwitcher_NewDatagramBuffers(configuration_, static_echo_buffers_), protocol, transport);
             }
 
-            bool VirtualEthernetSwitcher::LoopbackDatagramSocket() noexcept {
+            bool VirtualEthernetSwitcher::OpenDatagramSockets(const boost::asio::ip::address& interface_ip, int bind_port) noexcept {
+#if defined(_LINUX)
+                // A port group only pays off when there is more than one executor to spread the sockets over.
+                ppp::vector<ContextPtr> contexts;
+                Executors::GetAllContexts(contexts);
+
+                if (contexts.size() < 2) {
+                    return false;
+                }
+
+                if (!VirtualEthernetSwitcher_OpenReusePortSocket(static_echo_socket_, interface_ip, bind_port)) {
+                    return false;
+                }
+
+                boost::system::error_code ec;
+                boost::asio::ip::udp::endpoint localEP = static_echo_socket_.local_endpoint(ec);
+                if (ec) {
+                    Socket::Closesocket(static_echo_socket_);
+                    return false;
+                }
+
+                // Every other executor gets its own socket on the same port, the kernel spreads the clients over them by address hash.
+                for (const ContextPtr& context : contexts) {
+                    if (NULL == context || context == context_) {
+                        continue;
+                    }
+
+                    DatagramSocketPtr socket = make_shared_object<boost::asio::ip::udp::socket>(*context);
+                    if (NULL == socket) {
+                        continue;
+                    }
+
+                    if (VirtualEthernetSwitcher_OpenReusePortSocket(*socket, localEP.address(), localEP.port())) {
+                        static_echo_sockets_.emplace_back(socket);
+                    }
+                }
+
+                return true;
+#else
+                return false;
+#endif
+            }
+
+            void VirtualEthernetSwitcher::CloseDatagramSockets() noexcept {
+                for (const DatagramSocketPtr& socket : static_echo_sockets_) {
+                    Socket::Closesocket(socket);
+                }
+
+                static_echo_sockets_.clear();
+            }
+
+            bool VirtualEthernetSwitcher::LoopbackDatagramSocket(boost::asio::ip::udp::socket& socket, const std::shared_ptr<Byte>& buffers, const CiphertextPtr& protocol, const CiphertextPtr& transport) noexcept {
                 if (disposed_) {
                     return false;
                 }
 
-                bool opened = static_echo_socket_.is_open();
+                bool opened = socket.is_open();
                 if (!opened) {
                     return false;
                 }
 
+                if (NULL == buffers) {
+                    return false;
+                }
+
                 auto self = shared_from_this();
-                static_echo_socket_.async_receive_from(boost::asio::buffer(static_echo_buffers_.get(), PPP_BUFFER_SIZE), static_echo_source_ep_,
-                    [self, this](const boost::system::error_code& ec, std::size_t sz) noexcept {
+                boost::asio::ip::udp::socket* socket_ptr = &socket;
+
+#if defined(_LINUX)
+                socket.async_wait(boost::asio::ip::udp::socket::wait_read,
+                    [self, this, socket_ptr, buffers, protocol, transport](const boost::system::error_code& ec) noexcept {
                         if (ec == boost::system::errc::operation_canceled) {
                             return false;
                         }
@@ -564,22 +810,66 @@ namespace ppp {
                         }
 
                         if (ec == boost::system::errc::success) {
-                            if (sz > 0) {
-                                std::shared_ptr<ppp::threading::BufferswapAllocator> allocator = configuration_->GetBufferAllocator();
-                                std::shared_ptr<VirtualEthernetPacket> packet = 
-                                    VirtualEthernetPacket::Unpack(configuration_, allocator, static_echo_protocol_, static_echo_transport_, static_echo_buffers_.get(), sz);
-                                if (NULL != packet) {
-                                    StaticEchoPacketInput(allocator, packet, sz, static_echo_source_ep_);
+                            Byte* packets[STATIC_ECHO_BATCH_SIZE];
+                            int packet_lengths[STATIC_ECHO_BATCH_SIZE];
+                            boost::asio::ip::udp::endpoint sourceEPs[STATIC_ECHO_BATCH_SIZE];
+
+                            for (int i = 0; i < STATIC_ECHO_BATCH_SIZE; i++) {
+                                packets[i] = buffers.get() + i * PPP_BUFFER_SIZE;
+                            }
+
+                            // The reactor is edge triggered, so keep draining until recvmmsg comes back short.
+                            for (;;) {
+                                int count = Socket::ReceiveFrom(*socket_ptr, packets, PPP_BUFFER_SIZE, packet_lengths, sourceEPs, STATIC_ECHO_BATCH_SIZE);
+                                for (int i = 0; i < count; i++) {
+                                    if (packet_lengths[i] > 0) {
+                                        StaticEchoPacketInput(protocol, transport, packets[i], packet_lengths[i], sourceEPs[i]);
+                                    }
+                                }
+
+                                if (count < STATIC_ECHO_BATCH_SIZE || disposed_) {
+                                    break;
                                 }
                             }
                         }
+
+                        return LoopbackDatagramSocket(*socket_ptr, buffers, protocol, transport);
+                    });
+#else
+                socket.async_receive_from(boost::asio::buffer(buffers.get(), PPP_BUFFER_SIZE), static_echo_source_ep_,
+                    [self, this, socket_ptr, buffers, protocol, transport](const boost::system::error_code& ec, std::size_t sz) noexcept {
+                        if (ec == boost::system::errc::operation_canceled) {
+                            return false;
+                        }
+
+                        if (disposed_) {
+                            return false;
+                        }
+
+                        if (ec == boost::system::errc::success) {
+                            if (sz > 0) {
+                                StaticEchoPacketInput(protocol, transport, buffers.get(), sz, static_echo_source_ep_);
+                            }
+                        }
                         
-                        return LoopbackDatagramSocket();
+                        return LoopbackDatagramSocket(*socket_ptr, buffers, protocol, transport);
                     });
+#endif
                 return true;
             }
 
-            bool VirtualEthernetSwitcher::StaticEchoPacketInput(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, const std::shared_ptr<ppp::app::protocol::VirtualEthernetPacket>& packet, int packet_length, const boost::asio::ip::udp::endpoint& sourceEP) noexcept {
+            bool VirtualEthernetSwitcher::StaticEchoPacketInput(const CiphertextPtr& protocol, const CiphertextPtr& transport, Byte* packet, int packet_length, const boost::asio::ip::udp::endpoint& sourceEP) noexcept {
+                std::shared_ptr<ppp::threading::BufferswapAllocator> allocator = configuration_->GetBufferAllocator();
+                std::shared_ptr<VirtualEthernetPacket> message = 
+                    VirtualEthernetPacket::Unpack(configuration_, allocator, protocol, transport, packet, packet_length);
+                if (NULL == message) {
+                    return false;
+                }
+
+                return StaticEchoPacketInput(allocator, protocol, transport, message, packet, packet_length, sourceEP);
+            }
+
+            bool VirtualEthernetSwitcher::StaticEchoPacketInput(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, const CiphertextPtr& protocol, const CiphertextPtr& transport, const std::shared_ptr<ppp::app::protocol::VirtualEthernetPacket>& packet, const void* messages, int packet_length, const boost::asio::ip::udp::endpoint& sourceEP) noexcept {
                 VirtualEthernetExchangerPtr exchanger;
                 if (packet->Protocol == ppp::net::native::ip_hdr::IP_PROTO_UDP || packet->Protocol == ppp::net::native::ip_hdr::IP_PROTO_IP) {
                     Int128 guid;
@@ -601,12 +891,35 @@ namespace ppp {
                     statistics->AddIncomingTraffic(packet_length);
                 }
 
-                exchanger->static_echo_source_ep_ = sourceEP;
-                if (packet->Protocol == ppp::net::native::ip_hdr::IP_PROTO_UDP) {
-                    return exchanger->StaticEchoSendToDestination(packet);
+                exchanger->StaticEchoSourceEndPoint(sourceEP);
+
+                std::shared_ptr<VirtualEthernetPacket> message = packet;
+                std::shared_ptr<ppp::app::protocol::VirtualEthernetFec> fec = exchanger->static_echo_fec_;
+                if (packet->IsParity()) {
+                    if (NULL == fec) {
+                        return false;
+                    }
+
+                    int rebuilt_length = 0;
+                    std::shared_ptr<Byte> rebuilt = fec->Decode(allocator, packet->Payload.get(), packet->Length, rebuilt_length);
+                    if (NULL == rebuilt) {
+                        return true;
+                    }
+
+                    message = VirtualEthernetPacket::Unpack(configuration_, allocator, protocol, transport, rebuilt.get(), rebuilt_length);
+                    if (NULL == message || message->Id != packet->Id) {
+                        return false;
+                    }
+                }
+                elif(NULL != fec && !fec->Input(allocator, messages, packet_length)) {
+                    return true;
+                }
+
+                if (message->Protocol == ppp::net::native::ip_hdr::IP_PROTO_UDP) {
+                    return exchanger->StaticEchoSendToDestination(message);
                 }
-                elif(packet->Protocol == ppp::net::native::ip_hdr::IP_PROTO_IP) {
-                    return exchanger->StaticEchoEchoToDestination(packet, sourceEP);
+                elif(message->Protocol == ppp::net::native::ip_hdr::IP_PROTO_IP) {
+                    return exchanger->StaticEchoEchoToDestination(message, sourceEP);
                 }
                 else {
                     return true;
@@ -841,7 +1154,10 @@ namespace ppp {
                 }
 
                 disposed_ = true;
+                ppp::diagnostics::Metrics::DeleteCollector(this);
+
                 CloseAlwaysTimeout();
+                CloseDatagramSockets();
 
                 CancelAllResolver(tresolver);
                 CancelAllResolver(uresolver);
@@ -866,6 +1182,11 @@ namespace ppp {
                         acceptors_[i] = NULL;
                     }
                 }
+
+                if (std::shared_ptr<ppp::transmissions::IReliableUdpAcceptor> acceptor = std::move(rudp_acceptor_); NULL != acceptor) {
+                    rudp_acceptor_.reset();
+                    acceptor->Dispose();
+                }
             }
 
             bool VirtualEthernetSwitcher::CloseAlwaysTimeout() noexcept {
@@ -1029,6 +1350,14 @@ namespace ppp {
                         }
                     }
                 }
+                elif(categories == NetworkAcceptorCategories_ReliableUdp) {
+                    if (std::shared_ptr<ppp::transmissions::IReliableUdpAcceptor> acceptor = rudp_acceptor_; NULL != acceptor) {
+                        boost::asio::ip::udp::endpoint localEP = acceptor->GetLocalEndPoint();
+                        if (localEP.port() > IPEndPoint::MinPort) {
+                            return boost::asio::ip::tcp::endpoint(localEP.address(), localEP.port());
+                        }
+                    }
+                }
                 elif(categories >= NetworkAcceptorCategories_Min && categories < NetworkAcceptorCategories_Max) {
                     std::shared_ptr<boost::asio::ip::tcp::acceptor> acceptor = acceptors_[categories];
                     if (NULL != acceptor) {
@@ -2,12 +2,14 @@
 
 #include <ppp/stdafx.h>
 #include <ppp/Int128.h>
+#include <ppp/collections/FlowTable.h>
 #include <ppp/net/Firewall.h>
 #include <ppp/net/native/rib.h>
 #include <ppp/threading/Timer.h>
 #include <ppp/cryptography/Ciphertext.h>
 #include <ppp/coroutines/YieldContext.h>
 #include <ppp/transmissions/ITransmission.h>
+#include <ppp/transmissions/IReliableUdpAcceptor.h>
 #include <ppp/configurations/AppConfiguration.h>
 #include <ppp/app/protocol/VirtualEthernetPacket.h>
 #include <ppp/app/protocol/VirtualEthernetLogger.h>
@@ -42,7 +44,7 @@ namespace ppp {
                 typedef ppp::app::protocol::VirtualEthernetInformation  VirtualEthernetInformation;
                 typedef std::shared_ptr<VirtualEthernetInformation>     VirtualEthernetInformationPtr;
                 typedef std::shared_ptr<VirtualEthernetExchanger>       VirtualEthernetExchangerPtr;
-                typedef ppp::unordered_map<Int128,
+                typedef ppp::collections::FlowTable<Int128,
                     VirtualEthernetExchangerPtr>                        VirtualEthernetExchangerTable;
                 typedef std::shared_ptr<VirtualEthernetManagedServer>   VirtualEthernetManagedServerPtr;
                 typedef ppp::app::protocol::VirtualEthernetLogger       VirtualEthernetLogger;
@@ -66,6 +68,9 @@ namespace ppp {
                 typedef ppp::unordered_map<void*,
                     VirtualEthernetNetworkTcpipConnectionPtr>           VirtualEthernetNetworkTcpipConnectionTable;
                 typedef ppp::unordered_map<int, Int128>                 VirtualEthernetStaticEchoAllocatedTable;
+                typedef std::shared_ptr<
+                    boost::asio::ip::udp::socket>                       DatagramSocketPtr;
+                typedef ppp::vector<DatagramSocketPtr>                  DatagramSocketList;
 
             public:
                 VirtualEthernetSwitcher(const AppConfigurationPtr& configuration) noexcept;
@@ -105,6 +110,7 @@ namespace ppp {
                     NetworkAcceptorCategories_CDN2,
                     NetworkAcceptorCategories_Max,
                     NetworkAcceptorCategories_Udpip = NetworkAcceptorCategories_Max,
+                    NetworkAcceptorCategories_ReliableUdp,
                 }                                                       NetworkAcceptorCategories;
                 boost::asio::ip::tcp::endpoint                          GetLocalEndPoint(NetworkAcceptorCategories categories) noexcept;
 
@@ -126,6 +132,7 @@ namespace ppp {
             private:
                 void                                                    Finalize() noexcept;
                 bool                                                    Accept(const ContextPtr& context, const std::shared_ptr<boost::asio::ip::tcp::socket>& socket, int categories) noexcept;
+                bool                                                    Accept(const ContextPtr& context, const ITransmissionPtr& transmission) noexcept;
                 int                                                     Run(const ContextPtr& context, const ITransmissionPtr& transmission, YieldContext& y) noexcept;
                 VirtualEthernetExchangerPtr                             DeleteExchanger(VirtualEthernetExchanger* exchanger) noexcept;
                 VirtualEthernetExchangerPtr                             GetExchanger(const Int128& session_id) noexcept;
@@ -143,7 +150,9 @@ namespace ppp {
                 Int128                                                  StaticEchoUnallocated(int allocated_id) noexcept;
                 bool                                                    StaticEchoQuery(int allocated_id, Int128& session_id) noexcept;
                 bool                                                    StaticEchoAllocated(Int128 session_id, int& allocated_id, int& remote_port) noexcept;
-                bool                                                    StaticEchoPacketInput(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, const std::shared_ptr<ppp::app::protocol::VirtualEthernetPacket>& packet, int packet_length, const boost::asio::ip::udp::endpoint& sourceEP) noexcept;
+                bool                                                    StaticEchoPacketInput(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, const CiphertextPtr& protocol, const CiphertextPtr& transport, const std::shared_ptr<ppp::app::protocol::VirtualEthernetPacket>& packet, const void* messages, int packet_length, const boost::asio::ip::udp::endpoint& sourceEP) noexcept;
+                bool                                                    StaticEchoPacketInput(const CiphertextPtr& protocol, const CiphertextPtr& transport, Byte* packet, int packet_length, const boost::asio::ip::udp::endpoint& sourceEP) noexcept;
+                bool                                                    NewStaticEchoCiphertexts(CiphertextPtr& protocol, CiphertextPtr& transport) noexcept;
 
             private:
                 bool                                                    CreateFirewall(const ppp::string& path) noexcept;
@@ -152,8 +161,12 @@ namespace ppp {
                 bool                                                    CloseAlwaysTimeout() noexcept;
                 bool                                                    CreateAlwaysTimeout() noexcept;
                 bool                                                    OpenDatagramSocket() noexcept;
-                bool                                                    LoopbackDatagramSocket() noexcept;
+                bool                                                    OpenDatagramSockets(const boost::asio::ip::address& interface_ip, int bind_port) noexcept;
+                bool                                                    LoopbackDatagramSocket(boost::asio::ip::udp::socket& socket, const std::shared_ptr<Byte>& buffers, const CiphertextPtr& protocol, const CiphertextPtr& transport) noexcept;
+                void                                                    CloseDatagramSockets() noexcept;
                 bool                                                    OpenLogger() noexcept;
+                bool                                                    OpenMetrics() noexcept;
+                void                                                    CollectMetrics(ppp::string& out) noexcept;
                 bool                                                    DeleteNatInformation(VirtualEthernetExchanger* key, uint32_t ip) noexcept;
                 NatInformationPtr                                       FindNatInformation(uint32_t ip) noexcept;
                 NatInformationPtr                                       AddNatInformation(const std::shared_ptr<VirtualEthernetExchanger>& exchanger, uint32_t ip, uint32_t mask) noexcept;
@@ -201,10 +214,12 @@ namespace ppp {
                 boost::asio::ip::udp::socket                            static_echo_socket_;
                 int                                                     static_echo_bind_port_ = 0;
                 std::shared_ptr<Byte>                                   static_echo_buffers_;
+                DatagramSocketList                                      static_echo_sockets_;
                 boost::asio::ip::udp::endpoint                          static_echo_source_ep_;
                 VirtualEthernetStaticEchoAllocatedTable                 static_echo_allocateds_;
 
                 std::shared_ptr<boost::asio::ip::tcp::acceptor>         acceptors_[NetworkAcceptorCategories_Max];
+                std::shared_ptr<ppp::transmissions::IReliableUdpAcceptor> rudp_acceptor_;
             };
         }
     }
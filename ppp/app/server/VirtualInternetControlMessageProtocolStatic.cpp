@@ -54,7 +54,7 @@ namespace ppp {
 
                 boost::system::error_code ec;
                 socket.send_to(boost::asio::buffer(packet_output.get(), packet_length),
-                    exchanger_->static_echo_source_ep_, boost::asio::socket_base::message_end_of_record, ec);
+                    exchanger_->StaticEchoSourceEndPoint(), boost::asio::socket_base::message_end_of_record, ec);
 
                 if (ec) {
                     return false;
@@ -65,6 +65,7 @@ namespace ppp {
                     statistics->AddOutgoingTraffic(packet_length);
                 }
                 
+                exchanger_->StaticEchoParityToClient(packet_output.get(), packet_length);
                 return true;
             }
         }
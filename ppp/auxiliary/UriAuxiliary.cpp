@@ -140,6 +140,9 @@ namespace ppp {
             elif(proto_string == BOOST_BEAST_VERSION_STRING) {
                 protocol_type = ProtocolType_PPP;
             }
+            elif(proto_string == "rudp") {
+                protocol_type = ProtocolType_ReliableUdp;
+            }
             elif(proto_string == "wss") {
                 protocol_type = ProtocolType_WebSocketSSL;
             }
@@ -19,6 +19,7 @@ namespace ppp {
                 ProtocolType_HttpSSL,
                 ProtocolType_WebSocket,
                 ProtocolType_WebSocketSSL,
+                ProtocolType_ReliableUdp,
             }                                           ProtocolType;
             static ppp::string                          Parse(
                 const ppp::string&                      url,
@@ -0,0 +1,406 @@
+#pragma once
+
+#include <ppp/stdafx.h>
+#include <ppp/Int128.h>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#elif (defined(__SSE4_2__) || defined(__AVX__)) && (defined(__i386__) || defined(_M_IX86))
+#include <nmmintrin.h>
+#define PPP_FLOWHASH_CRC32C 1
+#endif
+
+namespace ppp {
+    namespace collections {
+        /* Hashes two 64-bit words with a folded multiply (as in aHash) where the target has a 64x64->128 bit multiply. 32-bit x86
+         * with SSE4.2 falls back to CRC32C, which measured slower than the multiply where both are available. */
+        inline uint64_t                                             FlowHashWords(uint64_t a, uint64_t b) noexcept {
+            a ^= 0x243f6a8885a308d3ULL;
+            b ^= 0x13198a2e03707344ULL;
+#if defined(__SIZEOF_INT128__)
+            unsigned __int128 r = (unsigned __int128)a * b;
+            return (uint64_t)r ^ (uint64_t)(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+            uint64_t hi;
+            uint64_t lo = _umul128(a, b, &hi);
+            return lo ^ hi;
+#elif defined(PPP_FLOWHASH_CRC32C)
+            uint32_t lo = _mm_crc32_u32(_mm_crc32_u32(0x85a308d3u, (uint32_t)a), (uint32_t)(a >> 32));
+            uint32_t hi = _mm_crc32_u32(_mm_crc32_u32(0x03707344u, (uint32_t)b), (uint32_t)(b >> 32));
+            lo = _mm_crc32_u32(_mm_crc32_u32(lo, (uint32_t)b), (uint32_t)(b >> 32));
+            hi = _mm_crc32_u32(_mm_crc32_u32(hi, (uint32_t)a), (uint32_t)(a >> 32));
+            return lo | ((uint64_t)hi << 32);
+#else
+            uint64_t h = a ^ (b * 0x9e3779b97f4a7c15ULL);
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            return h ^ (h >> 33);
+#endif
+        }
+
+        template <typename TKey>
+        struct FlowHash {
+            uint64_t                                                operator()(const TKey& key) const noexcept {
+                if constexpr (std::is_integral<TKey>::value || std::is_enum<TKey>::value) {
+                    return FlowHashWords((uint64_t)key, 0);
+                }
+                else {
+                    return FlowHashWords((uint64_t)std::hash<TKey>()(key), 0);
+                }
+            }
+        };
+
+        template <>
+        struct FlowHash<Int128> {
+            uint64_t                                                operator()(const Int128& key) const noexcept {
+#if defined(_PPP_INT128)
+                return FlowHashWords(key.lo, (uint64_t)key.hi);
+#else
+                return FlowHashWords((uint64_t)key, (uint64_t)(key >> 64));
+#endif
+            }
+        };
+
+        template <typename TProtocol>
+        struct FlowHash<boost::asio::ip::basic_endpoint<TProtocol> > {
+            uint64_t                                                operator()(const boost::asio::ip::basic_endpoint<TProtocol>& key) const noexcept {
+                boost::asio::ip::address address = key.address();
+                if (address.is_v4()) {
+                    return FlowHashWords(address.to_v4().to_uint(), key.port());
+                }
+
+                uint64_t words[2];
+                boost::asio::ip::address_v6::bytes_type bytes = address.to_v6().to_bytes();
+                memcpy(words, bytes.data(), sizeof(words));
+                return FlowHashWords(FlowHashWords(words[0], words[1]), key.port());
+            }
+        };
+
+        /* Open addressing hash table for flow lookups on the packet path.
+         *
+         * Entries live inline in one slot array next to a dense array of 32-bit tags, a probe touches the tags and only compares
+         * keys when a tag matches. Collisions are resolved by linear probing and erase shifts the rest of the cluster back instead
+         * of leaving tombstones, so lookups never slow down as flows come and go.
+         *
+         * The interface mirrors the parts of std::unordered_map the Dictionary helpers use. Unlike unordered_map, an insert or an
+         * erase may move other entries, so references and iterators are invalidated by both. Erasing while iterating is allowed
+         * through the iterator returned by erase and still visits every other entry once: iteration starts behind an empty slot,
+         * so no cluster wraps past its end and erase only ever pulls entries back onto slots the iteration has not reached yet. */
+        template <typename TKey, typename TValue, typename THash = FlowHash<TKey>, typename TKeyEqual = std::equal_to<TKey> >
+        class FlowTable final {
+        public:
+            typedef TKey                                            key_type;
+            typedef TValue                                          mapped_type;
+            typedef std::pair<TKey, TValue>                         value_type;
+            typedef std::size_t                                     size_type;
+
+        private:
+            template <bool Const>
+            class Iterator final {
+                friend class FlowTable;
+                friend class Iterator<!Const>;
+
+                typedef typename std::conditional<Const, const FlowTable, FlowTable>::type table_type;
+
+            public:
+                typedef std::forward_iterator_tag                   iterator_category;
+                typedef typename FlowTable::value_type              value_type;
+                typedef std::ptrdiff_t                              difference_type;
+                typedef typename std::conditional<Const, const value_type*, value_type*>::type pointer;
+                typedef typename std::conditional<Const, const value_type&, value_type&>::type reference;
+
+            public:
+                Iterator() noexcept = default;
+                Iterator(const Iterator& other) noexcept = default;
+                template <bool OtherConst, typename = typename std::enable_if<Const && !OtherConst>::type>
+                Iterator(const Iterator<OtherConst>& other) noexcept : table_(other.table_), index_(other.index_) {}
+
+            public:
+                Iterator&                                           operator=(const Iterator& other) noexcept = default;
+
+            public:
+                reference                                           operator*() const noexcept { return table_->slots_[index_]; }
+                pointer                                             operator->() const noexcept { return table_->slots_ + index_; }
+                Iterator&                                           operator++() noexcept { index_ = table_->Next((index_ + 1) & (table_->capacity_ - 1)); return *this; }
+                Iterator                                            operator++(int) noexcept { Iterator it = *this; ++(*this); return it; }
+                bool                                                operator==(const Iterator& other) const noexcept { return index_ == other.index_; }
+                bool                                                operator!=(const Iterator& other) const noexcept { return index_ != other.index_; }
+
+            private:
+                Iterator(table_type* table, size_type index) noexcept : table_(table), index_(index) {}
+
+            private:
+                table_type*                                         table_ = NULL;
+                size_type                                           index_ = 0;
+            };
+
+        public:
+            typedef Iterator<false>                                 iterator;
+            typedef Iterator<true>                                  const_iterator;
+
+        public:
+            FlowTable() noexcept = default;
+            FlowTable(const FlowTable& other) noexcept { *this = other; }
+            FlowTable(FlowTable&& other) noexcept { Swap(other); }
+            ~FlowTable() noexcept { Release(); }
+
+        public:
+            FlowTable&                                              operator=(const FlowTable& other) noexcept {
+                if (this != &other) {
+                    clear();
+                    reserve(other.size_);
+                    for (const value_type& kv : other) {
+                        try_emplace(kv.first, kv.second);
+                    }
+                }
+                return *this;
+            }
+            FlowTable&                                              operator=(FlowTable&& other) noexcept {
+                if (this != &other) {
+                    Release();
+                    Swap(other);
+                }
+                return *this;
+            }
+            TValue&                                                 operator[](const TKey& key) noexcept { return try_emplace(key).first->second; }
+
+        public:
+            iterator                                                begin() noexcept { return iterator(this, First()); }
+            iterator                                                end() noexcept { return iterator(this, capacity_); }
+            const_iterator                                          begin() const noexcept { return const_iterator(this, First()); }
+            const_iterator                                          end() const noexcept { return const_iterator(this, capacity_); }
+            size_type                                               size() const noexcept { return size_; }
+            bool                                                    empty() const noexcept { return size_ == 0; }
+            size_type                                               count(const TKey& key) const noexcept { return Find(key) != capacity_ ? 1 : 0; }
+            iterator                                                find(const TKey& key) noexcept { return iterator(this, Find(key)); }
+            const_iterator                                          find(const TKey& key) const noexcept { return const_iterator(this, Find(key)); }
+
+        public:
+            template <typename TArgKey, typename... Args>
+            std::pair<iterator, bool>                               try_emplace(TArgKey&& key, Args&&... args) noexcept {
+                uint64_t h = hasher_(key);
+                uint32_t tag = Tag(h);
+                size_type index = capacity_;
+                if (capacity_ > 0) {
+                    for (size_type i = h & (capacity_ - 1);; i = (i + 1) & (capacity_ - 1)) {
+                        uint32_t t = tags_[i];
+                        if (t == 0) {
+                            index = i;
+                            break;
+                        }
+                        elif(t == tag && equal_(slots_[i].first, key)) {
+                            return std::make_pair(iterator(this, i), false);
+                        }
+                    }
+                }
+
+                if ((size_ + 1) * 4 > capacity_ * 3) {
+                    if (!Rehash(capacity_ > 0 ? capacity_ << 1 : MIN_CAPACITY)) {
+                        return std::make_pair(end(), false);
+                    }
+
+                    index = Hole(h);
+                }
+
+                new (slots_ + index) value_type(std::piecewise_construct, std::forward_as_tuple(std::forward<TArgKey>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+                tags_[index] = tag;
+                size_++;
+
+                if (index == origin_) {
+                    origin_ = Hole(index);
+                }
+                return std::make_pair(iterator(this, index), true);
+            }
+
+            template <typename... Args>
+            std::pair<iterator, bool>                               emplace(Args&&... args) noexcept {
+                value_type kv(std::forward<Args>(args)...);
+                return try_emplace(std::move(kv.first), std::move(kv.second));
+            }
+
+            iterator                                                erase(const_iterator position) noexcept {
+                size_type index = position.index_;
+                Erase(index);
+                return iterator(this, Next(index));
+            }
+
+            iterator                                                erase(iterator position) noexcept { return erase(const_iterator(position)); }
+
+            size_type                                               erase(const TKey& key) noexcept {
+                size_type index = Find(key);
+                if (index == capacity_) {
+                    return 0;
+                }
+
+                Erase(index);
+                return 1;
+            }
+
+            void                                                    clear() noexcept {
+                if (size_ > 0) {
+                    for (size_type i = 0; i < capacity_; i++) {
+                        if (tags_[i] != 0) {
+                            slots_[i].~value_type();
+                            tags_[i] = 0;
+                        }
+                    }
+                    size_ = 0;
+                }
+            }
+
+            void                                                    reserve(size_type count) noexcept {
+                size_type capacity = MIN_CAPACITY;
+                while (count * 4 > capacity * 3) {
+                    capacity <<= 1;
+                }
+
+                if (capacity > capacity_) {
+                    Rehash(capacity);
+                }
+            }
+
+        private:
+            /* The low bits of the hash pick the home slot and the tag keeps the low 32 bits with the top bit set, so zero marks an
+             * empty slot and the home slot of an entry can be read back from its tag while shifting a cluster. */
+            static uint32_t                                         Tag(uint64_t h) noexcept { return (uint32_t)h | 0x80000000u; }
+
+            /* Iteration runs once around the array from the slot after origin_, which is kept empty. Erase never fills a slot that
+             * was empty before, so origin_ only has to move when an insert lands on it. */
+            size_type                                               First() const noexcept {
+                return size_ > 0 ? Next((origin_ + 1) & (capacity_ - 1)) : capacity_;
+            }
+
+            size_type                                               Next(size_type index) const noexcept {
+                for (size_type mask = capacity_ - 1; index != origin_; index = (index + 1) & mask) {
+                    if (tags_[index] != 0) {
+                        return index;
+                    }
+                }
+                return capacity_;
+            }
+
+            size_type                                               Find(const TKey& key) const noexcept {
+                if (size_ == 0) {
+                    return capacity_;
+                }
+
+                uint64_t h = hasher_(key);
+                uint32_t tag = Tag(h);
+                for (size_type i = h & (capacity_ - 1);; i = (i + 1) & (capacity_ - 1)) {
+                    uint32_t t = tags_[i];
+                    if (t == 0) {
+                        return capacity_;
+                    }
+                    elif(t == tag && equal_(slots_[i].first, key)) {
+                        return i;
+                    }
+                }
+            }
+
+            size_type                                               Hole(uint64_t h) const noexcept {
+                size_type i = h & (capacity_ - 1);
+                while (tags_[i] != 0) {
+                    i = (i + 1) & (capacity_ - 1);
+                }
+                return i;
+            }
+
+            void                                                    Erase(size_type index) noexcept {
+                size_type mask = capacity_ - 1;
+                slots_[index].~value_type();
+                tags_[index] = 0;
+                size_--;
+
+                // Pull back every later entry of the cluster whose home slot does not lie between the hole and itself.
+                size_type hole = index;
+                for (size_type i = (index + 1) & mask; tags_[i] != 0; i = (i + 1) & mask) {
+                    size_type home = tags_[i] & mask;
+                    if (((i - home) & mask) >= ((i - hole) & mask)) {
+                        new (slots_ + hole) value_type(std::move(slots_[i]));
+                        slots_[i].~value_type();
+
+                        tags_[hole] = tags_[i];
+                        tags_[i] = 0;
+                        hole = i;
+                    }
+                }
+            }
+
+            bool                                                    Rehash(size_type capacity) noexcept {
+                if (capacity > MAX_CAPACITY) {
+                    return false;
+                }
+
+                uint32_t* tags = (uint32_t*)ppp::Malloc(capacity * sizeof(uint32_t));
+                if (NULL == tags) {
+                    return false;
+                }
+
+                value_type* slots = (value_type*)ppp::Malloc(capacity * sizeof(value_type));
+                if (NULL == slots) {
+                    ppp::Mfree(tags);
+                    return false;
+                }
+
+                memset(tags, 0, capacity * sizeof(uint32_t));
+                for (size_type i = 0; i < capacity_; i++) {
+                    uint32_t tag = tags_[i];
+                    if (tag != 0) {
+                        size_type index = tag & (capacity - 1);
+                        while (tags[index] != 0) {
+                            index = (index + 1) & (capacity - 1);
+                        }
+
+                        new (slots + index) value_type(std::move(slots_[i]));
+                        slots_[i].~value_type();
+                        tags[index] = tag;
+                    }
+                }
+
+                ppp::Mfree(tags_);
+                ppp::Mfree(slots_);
+
+                tags_ = tags;
+                slots_ = slots;
+                capacity_ = capacity;
+                origin_ = Hole(0);
+                return true;
+            }
+
+            void                                                    Release() noexcept {
+                clear();
+                if (NULL != tags_) {
+                    ppp::Mfree(tags_);
+                    ppp::Mfree(slots_);
+                }
+
+                tags_ = NULL;
+                slots_ = NULL;
+                capacity_ = 0;
+                origin_ = 0;
+            }
+
+            void                                                    Swap(FlowTable& other) noexcept {
+                std::swap(tags_, other.tags_);
+                std::swap(slots_, other.slots_);
+                std::swap(capacity_, other.capacity_);
+                std::swap(size_, other.size_);
+                std::swap(origin_, other.origin_);
+            }
+
+        private:
+            static constexpr size_type                              MIN_CAPACITY = 16;
+            static constexpr size_type                              MAX_CAPACITY = 0x80000000u;
+
+            uint32_t*                                               tags_     = NULL;
+            value_type*                                             slots_    = NULL;
+            size_type                                               capacity_ = 0;
+            size_type                                               size_     = 0;
+            size_type                                               origin_   = 0;
+            THash                                                   hasher_;
+            TKeyEqual                                               equal_;
+        };
+    }
+}
@@ -1,4 +1,5 @@
 #include <ppp/configurations/AppConfiguration.h>
+#include <ppp/cryptography/AEAD.h>
 #include <ppp/cryptography/Ciphertext.h>
 #include <ppp/threading/Thread.h>
 #include <ppp/threading/Executors.h>
@@ -6,17 +7,20 @@
 #include <ppp/ssl/SSL.h>
 #include <ppp/net/Ipep.h>
 #include <ppp/net/IPEndPoint.h>
+#include <ppp/net/packet/IPFragment.h>
 #include <ppp/auxiliary/JsonAuxiliary.h>
 #include <ppp/auxiliary/StringAuxiliary.h>
 
 using ppp::auxiliary::StringAuxiliary;
 using ppp::auxiliary::JsonAuxiliary;
+using ppp::cryptography::AEAD;
 using ppp::cryptography::Ciphertext;
 using ppp::io::File;
 using ppp::io::FileAccess;
 using ppp::net::Ipep;
 using ppp::net::AddressFamily;
 using ppp::net::IPEndPoint;
+using ppp::net::packet::IPFragment;
 using ppp::threading::Thread;
 using ppp::threading::Executors;
 
@@ -39,16 +43,21 @@ namespace ppp {
 
             config.ip.public_ = "";
             config.ip.interface_ = "";
+            config.metrics.port = IPEndPoint::MinPort;
+            config.metrics.bind = "";
+            config.metrics.sessions = false;
             config.udp.dns.timeout = PPP_DEFAULT_DNS_TIMEOUT;
             config.udp.dns.redirect = "";
             config.udp.inactive.timeout = PPP_UDP_INACTIVE_TIMEOUT;
             config.udp.listen.port = IPEndPoint::MinPort;
+            config.udp.listen.rudp = IPEndPoint::MinPort;
             config.udp.static_.dns = true;
             config.udp.static_.quic = true;
             config.udp.static_.icmp = true;
             config.udp.static_.servers.clear();
             config.udp.static_.keep_alived[0] = 0;
             config.udp.static_.keep_alived[1] = 0;
+            config.udp.static_.fec = 0;
 
             config.tcp.turbo = false;
             config.tcp.backlog = PPP_LISTEN_BACKLOG;
@@ -83,6 +92,7 @@ namespace ppp {
             config.key.plaintext = true;
             config.key.delta_encode = true;
             config.key.shuffle_data = true;
+            config.key.aead = false;
 
             config.server.log = "";
             config.server.node = 0;
@@ -98,6 +108,11 @@ namespace ppp {
             config.client.reconnections.timeout = PPP_TCP_CONNECT_TIMEOUT;
             config.client.http_proxy.bind = "";
             config.client.http_proxy.port = PPP_DEFAULT_HTTP_PROXY_PORT;
+            config.client.socks_proxy.bind = "";
+            config.client.socks_proxy.port = IPEndPoint::MinPort;
+            config.client.fragment.slots = IPFragment::MAX_SUBPACKAGES;
+            config.client.fragment.memory = IPFragment::MAX_MEMORY;
+            config.client.fragment.timeout = IPFragment::MAX_FINALIZE_TIME / 1000;
 #if defined(_WIN32)
             config.client.paper_airplane.tcp = true;
 #endif
@@ -273,7 +288,20 @@ namespace ppp {
                 config.client.reconnections.timeout = PPP_TCP_CONNECT_TIMEOUT;
             }
 
-            int* pts[] = { &config.tcp.listen.port, &config.websocket.listen.ws, &config.websocket.listen.wss, &config.client.http_proxy.port, &config.udp.listen.port };
+            if (config.client.fragment.slots < 1) {
+                config.client.fragment.slots = IPFragment::MAX_SUBPACKAGES;
+            }
+
+            // One slot holds a whole datagram, a smaller cap could not reassemble the largest one.
+            if (config.client.fragment.memory < IPFragment::MAX_PAYLOAD) {
+                config.client.fragment.memory = IPFragment::MAX_MEMORY;
+            }
+
+            if (config.client.fragment.timeout < 1) {
+                config.client.fragment.timeout = IPFragment::MAX_FINALIZE_TIME / 1000;
+            }
+
+            int* pts[] = { &config.tcp.listen.port, &config.websocket.listen.ws, &config.websocket.listen.wss, &config.client.http_proxy.port, &config.client.socks_proxy.port, &config.udp.listen.port, &config.udp.listen.rudp, &config.metrics.port };
             for (int i = 0; i < arraysizeof(pts); i++) {
                 int& port = *pts[i];
                 if (port < IPEndPoint::MinPort || port > IPEndPoint::MaxPort) {
@@ -293,7 +321,9 @@ namespace ppp {
                 keep_alived = std::max<int>(0, keep_alived);
             }
 
-            ppp::string* ips[] = { &config.ip.public_, &config.ip.interface_, &config.client.http_proxy.bind };
+            config.udp.static_.fec = std::max<int>(0, std::min<int>(UINT8_MAX, config.udp.static_.fec));
+
+            ppp::string* ips[] = { &config.ip.public_, &config.ip.interface_, &config.client.http_proxy.bind, &config.client.socks_proxy.bind, &config.metrics.bind };
             for (int i = 0; i < arraysizeof(ips); i++) {
                 ppp::string& ip = *ips[i];
                 if (ip.empty()) {
@@ -321,6 +351,11 @@ namespace ppp {
                 config.key.transport = PPP_DEFAULT_KEY_TRANSPORT;
             }
 
+            // AEAD framing is opt-in and needs an AEAD transport cipher, both ends must agree on it like on the cipher names.
+            if (!AEAD::Support(config.key.transport)) {
+                config.key.aead = false;
+            }
+
             if (config.key.protocol_key.empty()) {
                 config.key.protocol_key = BOOST_BEAST_VERSION_STRING;
             }
@@ -561,16 +596,21 @@ namespace ppp {
 
             config.vmem.size = JsonAuxiliary::AsValue<int64_t>(json["vmem"]["size"]);
             config.vmem.path = JsonAuxiliary::AsValue<ppp::string>(json["vmem"]["path"]);
+            config.metrics.port = JsonAuxiliary::AsValue<int>(json["metrics"]["port"]);
+            config.metrics.bind = JsonAuxiliary::AsValue<ppp::string>(json["metrics"]["bind"]);
+            config.metrics.sessions = JsonAuxiliary::AsValue<bool>(json["metrics"]["sessions"]);
 
             config.udp.inactive.timeout = JsonAuxiliary::AsValue<int>(json["udp"]["inactive"]["timeout"]);
             config.udp.dns.timeout = JsonAuxiliary::AsValue<int>(json["udp"]["dns"]["timeout"]);
             config.udp.dns.redirect = JsonAuxiliary::AsValue<ppp::string>(json["udp"]["dns"]["redirect"]);
             config.udp.listen.port = JsonAuxiliary::AsValue<int>(json["udp"]["listen"]["port"]);
+            config.udp.listen.rudp = JsonAuxiliary::AsValue<int>(json["udp"]["listen"]["rudp"]);
             config.udp.static_.dns = JsonAuxiliary::AsValue<bool>(json["udp"]["static"]["dns"]);
             config.udp.static_.quic = JsonAuxiliary::AsValue<bool>(json["udp"]["static"]["quic"]);
             config.udp.static_.icmp = JsonAuxiliary::AsValue<bool>(json["udp"]["static"]["icmp"]);
             config.udp.static_.keep_alived[0] = JsonAuxiliary::AsValue<int>(json["udp"]["static"]["keep-alived"][0]);
             config.udp.static_.keep_alived[1] = JsonAuxiliary::AsValue<int>(json["udp"]["static"]["keep-alived"][1]);
+            config.udp.static_.fec = JsonAuxiliary::AsValue<int>(json["udp"]["static"]["fec"]);
             ReadJsonAllAddressStringToSet(json["udp"]["static"]["servers"], config.udp.static_.servers);
 
             config.tcp.inactive.timeout = JsonAuxiliary::AsValue<int>(json["tcp"]["inactive"]["timeout"]);
@@ -606,6 +646,7 @@ namespace ppp {
             config.key.plaintext = JsonAuxiliary::AsValue<bool>(json["key"]["plaintext"]);
             config.key.delta_encode = JsonAuxiliary::AsValue<bool>(json["key"]["delta-encode"]);
             config.key.shuffle_data = JsonAuxiliary::AsValue<bool>(json["key"]["shuffle-data"]);
+            config.key.aead = JsonAuxiliary::AsValue<bool>(json["key"]["aead"]);
 
             config.server.log = JsonAuxiliary::AsValue<ppp::string>(json["server"]["log"]);
             config.server.node = JsonAuxiliary::AsValue<int>(json["server"]["node"]);
@@ -621,6 +662,11 @@ namespace ppp {
             config.client.bandwidth = JsonAuxiliary::AsValue<int64_t>(json["client"]["bandwidth"]);
             config.client.http_proxy.port = JsonAuxiliary::AsValue<int>(json["client"]["http-proxy"]["port"]);
             config.client.http_proxy.bind = JsonAuxiliary::AsValue<ppp::string>(json["client"]["http-proxy"]["bind"]);
+            config.client.socks_proxy.port = JsonAuxiliary::AsValue<int>(json["client"]["socks-proxy"]["port"]);
+            config.client.socks_proxy.bind = JsonAuxiliary::AsValue<ppp::string>(json["client"]["socks-proxy"]["bind"]);
+            config.client.fragment.slots = JsonAuxiliary::AsValue<int>(json["client"]["fragment"]["slots"]);
+            config.client.fragment.memory = JsonAuxiliary::AsValue<int>(json["client"]["fragment"]["memory"]);
+            config.client.fragment.timeout = JsonAuxiliary::AsValue<int>(json["client"]["fragment"]["timeout"]);
 #if defined(_WIN32)
             config.client.paper_airplane.tcp = JsonAuxiliary::AsValue<bool>(json["client"]["paper-airplane"]["tcp"]);
 #endif
@@ -660,12 +706,20 @@ namespace ppp {
             vmem["path"] = config.vmem.path;
             root["vmem"] = vmem;
 
+            // Set metrics structure
+            Json::Value metrics;
+            metrics["port"] = config.metrics.port;
+            metrics["bind"] = config.metrics.bind;
+            metrics["sessions"] = config.metrics.sessions;
+            root["metrics"] = metrics;
+
             // Set udp structure
             Json::Value udp;
             udp["inactive"]["timeout"] = config.udp.inactive.timeout;
             udp["dns"]["timeout"] = config.udp.dns.timeout;
             udp["dns"]["redirect"] = config.udp.dns.redirect;
             udp["listen"]["port"] = config.udp.listen.port;
+            udp["listen"]["rudp"] = config.udp.listen.rudp;
 
             // Set keep-alived structure
             Json::Value keep_alived(Json::arrayValue);
@@ -685,6 +739,7 @@ namespace ppp {
             udp["static"]["dns"] = config.udp.static_.dns;
             udp["static"]["quic"] = config.udp.static_.quic;
             udp["static"]["icmp"] = config.udp.static_.icmp;
+            udp["static"]["fec"] = config.udp.static_.fec;
             root["udp"] = udp;
 
             // Set tcp structure
@@ -739,6 +794,7 @@ namespace ppp {
             key["plaintext"] = config.key.plaintext;
             key["delta-encode"] = config.key.delta_encode;
             key["shuffle-data"] = config.key.shuffle_data;
+            key["aead"] = config.key.aead;
             root["key"] = key;
 
             // Set server structure
@@ -766,6 +822,11 @@ namespace ppp {
 
             client["http-proxy"]["bind"] = config.client.http_proxy.bind;
             client["http-proxy"]["port"] = config.client.http_proxy.port;
+            client["socks-proxy"]["bind"] = config.client.socks_proxy.bind;
+            client["socks-proxy"]["port"] = config.client.socks_proxy.port;
+            client["fragment"]["slots"] = config.client.fragment.slots;
+            client["fragment"]["memory"] = config.client.fragment.memory;
+            client["fragment"]["timeout"] = config.client.fragment.timeout;
             client["reconnections"]["timeout"] = config.client.reconnections.timeout;
             client["guid"] = config.client.guid;
             client["server"] = config.client.server;
@@ -34,9 +34,11 @@ namespace ppp {
                 }                                                           dns;
                 struct {
                     int                                                     port;
+                    int                                                     rudp;
                 }                                                           listen;
                 struct {
                     int                                                     keep_alived[2];
+                    int                                                     fec;
                     bool                                                    dns;
                     bool                                                    quic;
                     bool                                                    icmp;
@@ -91,11 +93,17 @@ namespace ppp {
                 bool                                                        plaintext;
                 bool                                                        delta_encode;
                 bool                                                        shuffle_data;
+                bool                                                        aead;
             }                                                               key;
             struct {
                 int64_t                                                     size;
                 ppp::string                                                 path;
             }                                                               vmem;
+            struct {
+                int                                                         port;
+                ppp::string                                                 bind;
+                bool                                                        sessions;
+            }                                                               metrics;
             struct {
                 int                                                         node;
                 ppp::string                                                 log;
@@ -121,6 +129,15 @@ namespace ppp {
                     int                                                     port;
                     ppp::string                                             bind;
                 }                                                           http_proxy;
+                struct {
+                    int                                                     port;
+                    ppp::string                                             bind;
+                }                                                           socks_proxy;
+                struct {
+                    int                                                     slots;
+                    int                                                     memory;
+                    int                                                     timeout;
+                }                                                           fragment;
             }                                                               client;
 
         public:
@@ -1,9 +1,177 @@
 #include <ppp/coroutines/YieldContext.h>
+#include <ppp/diagnostics/Metrics.h>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#endif
 
 namespace ppp
 {
     namespace coroutines
     {
+        // Stacks are cached per thread in power of two size classes, once a thread is warm spawning a coroutine neither maps nor
+        // frees memory. Every stack has an inaccessible guard page below it, so an overflow faults instead of corrupting memory.
+        class YieldContext_StackPool final
+        {
+        public:
+            static constexpr int                                                MIN_CLASS_BITS      = 12;
+            static constexpr int                                                MAX_CLASS_BITS      = 20;
+            static constexpr int                                                MAX_CACHED_BYTES    = 1 << 20;
+            static constexpr int                                                HIGH_WATER_SAMPLE   = 256;
+
+        public:
+            // Rounds size up to its class, the caller may use all of it.
+            static Byte*                                                        Alloc(int& size) noexcept
+            {
+                int bits = MIN_CLASS_BITS;
+                while ((1 << bits) < size || (1 << bits) < GetMemoryPageSize())
+                {
+                    if (++bits > MAX_CLASS_BITS)
+                    {
+                        return NULL;
+                    }
+                }
+
+                size = 1 << bits;
+                ppp::diagnostics::Metrics::Gauge(ppp::diagnostics::Metrics::MetricsGauge_CoroutineStacks, 1);
+
+                Cache* cache = GetCache();
+                if (NULL != cache)
+                {
+                    ppp::vector<Byte*>& stacks = cache->stacks[bits - MIN_CLASS_BITS];
+                    if (!stacks.empty())
+                    {
+                        Byte* stack = stacks.back();
+                        stacks.pop_back();
+                        return stack;
+                    }
+                }
+
+                Byte* stack = Map(size);
+                if (NULL == stack)
+                {
+                    ppp::diagnostics::Metrics::Gauge(ppp::diagnostics::Metrics::MetricsGauge_CoroutineStacks, -1);
+                }
+
+                return stack;
+            }
+
+            static void                                                         Free(Byte* stack, int size) noexcept
+            {
+                ppp::diagnostics::Metrics::Gauge(ppp::diagnostics::Metrics::MetricsGauge_CoroutineStacks, -1);
+
+                Cache* cache = GetCache();
+                if (NULL == cache)
+                {
+                    Unmap(stack, size);
+                    return;
+                }
+
+                // Stacks start out zeroed and only get dirtier, the lowest written word bounds the deepest use of the stack so far.
+                if (++cache->releases % HIGH_WATER_SAMPLE == 0)
+                {
+                    const uint64_t* words = (uint64_t*)stack;
+                    int count = size / sizeof(uint64_t);
+                    int index = 0;
+                    while (index < count && words[index] == 0)
+                    {
+                        index++;
+                    }
+
+                    ppp::diagnostics::Metrics::Maximum(ppp::diagnostics::Metrics::MetricsGauge_CoroutineStackHighWater, size - index * (int)sizeof(uint64_t));
+                }
+
+                int bits = MIN_CLASS_BITS;
+                while ((1 << bits) < size)
+                {
+                    bits++;
+                }
+
+                ppp::vector<Byte*>& stacks = cache->stacks[bits - MIN_CLASS_BITS];
+                if (stacks.size() < (std::size_t)std::max<int>(1, MAX_CACHED_BYTES >> bits))
+                {
+                    stacks.emplace_back(stack);
+                }
+                else
+                {
+                    Unmap(stack, size);
+                }
+            }
+
+        private:
+            struct Cache
+            {
+                ppp::vector<Byte*>                                              stacks[MAX_CLASS_BITS - MIN_CLASS_BITS + 1];
+                uint64_t                                                        releases = 0;
+
+                ~Cache() noexcept
+                {
+                    exited_ = true;
+                    for (int i = 0; i < (int)arraysizeof(stacks); i++)
+                    {
+                        for (Byte* stack : stacks[i])
+                        {
+                            Unmap(stack, 1 << (i + MIN_CLASS_BITS));
+                        }
+                    }
+                }
+            };
+
+            // Coroutines may still finish while thread locals are torn down, their stacks are then unmapped directly.
+            static Cache*                                                       GetCache() noexcept
+            {
+                static thread_local Cache cache;
+                return exited_ ? NULL : &cache;
+            }
+
+            static Byte*                                                        Map(int size) noexcept
+            {
+                int pagesize = GetMemoryPageSize();
+#if defined(_WIN32)
+                Byte* memory = (Byte*)VirtualAlloc(NULL, size + pagesize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+                if (NULL == memory)
+                {
+                    return NULL;
+                }
+
+                DWORD protect;
+                if (!VirtualProtect(memory, pagesize, PAGE_NOACCESS, &protect))
+                {
+                    VirtualFree(memory, 0, MEM_RELEASE);
+                    return NULL;
+                }
+#else
+                Byte* memory = (Byte*)mmap(NULL, size + pagesize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (MAP_FAILED == (void*)memory)
+                {
+                    return NULL;
+                }
+
+                if (mprotect(memory, pagesize, PROT_NONE) < 0)
+                {
+                    munmap(memory, size + pagesize);
+                    return NULL;
+                }
+#endif
+                return memory + pagesize;
+            }
+
+            static void                                                         Unmap(Byte* stack, int size) noexcept
+            {
+                int pagesize = GetMemoryPageSize();
+#if defined(_WIN32)
+                VirtualFree(stack - pagesize, 0, MEM_RELEASE);
+#else
+                munmap(stack - pagesize, size + pagesize);
+#endif
+            }
+
+        private:
+            static thread_local bool                                            exited_;
+        };
+
+        thread_local bool YieldContext_StackPool::exited_ = false;
+
         YieldContext::YieldContext(ppp::threading::BufferswapAllocator* allocator, boost::asio::io_context& context, boost::asio::strand<boost::asio::io_context::executor_type>* strand, SpawnHander&& spawn, int stack_size) noexcept
             : callee_(NULL)
             , caller_(NULL)
@@ -23,6 +191,21 @@ namespace ppp
                 }
             }
 
+            if (!stack_)
+            {
+                int size = stack_size;
+                Byte* stack = YieldContext_StackPool::Alloc(size);
+                if (stack)
+                {
+                    stack_size_ = size;
+                    stack_ = std::shared_ptr<Byte>(stack,
+                        [size](Byte* p) noexcept
+                        {
+                            YieldContext_StackPool::Free(p, size);
+                        });
+                }
+            }
+
             /* boost::context::stack_traits::minimum_size(); */
             if (!stack_)
             {
@@ -0,0 +1,186 @@
+#include <openssl/rand.h>
+
+#include "AEAD.h"
+
+namespace ppp {
+    namespace cryptography {
+        // The top bit of the sequence carries the sealing side, so client and server never share a nonce under the same key.
+        static constexpr uint64_t AEAD_SEQUENCE_SERVER  = 0x8000000000000000ULL;
+        static constexpr uint64_t AEAD_SEQUENCE_MASK    = 0x7fffffffffffffffULL;
+
+        AEAD::AEAD(const ppp::string& method, const ppp::string& password, bool server) noexcept
+            : _cipher(NULL)
+            , _server(server)
+            , _sequence(0)
+            , _opened(false)
+            , _expected(0) {
+            if (initKey(method, password)) {
+                initCipher(_sealCTX, 1);
+                initCipher(_openCTX, 0);
+            }
+        }
+
+        bool AEAD::Support(const ppp::string& method) noexcept {
+            if (method.empty()) {
+                return false;
+            }
+
+            const EVP_CIPHER* cipher = EVP_get_cipherbyname(method.data());
+            if (NULL == cipher) {
+                return false;
+            }
+
+            if (EVP_CIPHER_iv_length(cipher) != NONCE_SIZE) {
+                return false;
+            }
+
+            return EVP_CIPHER_mode(cipher) == EVP_CIPH_GCM_MODE || EVP_CIPHER_nid(cipher) == NID_chacha20_poly1305;
+        }
+
+        bool AEAD::initKey(const ppp::string& method, const ppp::string& password) noexcept {
+            if (!Support(method)) {
+                return false;
+            }
+
+            _cipher = EVP_get_cipherbyname(method.data());
+            if (EVP_BytesToKey(_cipher, EVP_md5(), NULL, (Byte*)password.data(), (int)password.length(), 1, _key, _iv) < 1) {
+                _cipher = NULL;
+                return false;
+            }
+
+            // The sequence starts at a random point so the clear sequence field does not read as a packet counter.
+            uint64_t sequence = 0;
+            if (RAND_bytes((Byte*)&sequence, sizeof(sequence)) < 1) {
+                sequence = (uint64_t)RandomNext() << 32 | (uint32_t)RandomNext();
+            }
+
+            _sequence = sequence & AEAD_SEQUENCE_MASK;
+            return true;
+        }
+
+        bool AEAD::initCipher(std::shared_ptr<EVP_CIPHER_CTX>& context, int enc) noexcept {
+            if (NULL == _cipher) {
+                return false;
+            }
+
+            EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+            if (NULL == ctx) {
+                return false;
+            }
+
+            context = std::shared_ptr<EVP_CIPHER_CTX>(ctx,
+                [](EVP_CIPHER_CTX* context) noexcept {
+                    EVP_CIPHER_CTX_free(context);
+                });
+
+            if (EVP_CipherInit_ex(ctx, _cipher, NULL, _key, NULL, enc) < 1) {
+                context = NULL;
+                return false;
+            }
+
+            return true;
+        }
+
+        void AEAD::computeNonce(uint64_t sequence, Byte* nonce) noexcept {
+            memcpy(nonce, _iv, NONCE_SIZE);
+            for (int i = 0; i < SEQUENCE_SIZE; i++) {
+                nonce[NONCE_SIZE - 1 - i] ^= (Byte)(sequence >> (i << 3));
+            }
+        }
+
+        bool AEAD::Seal(const Byte* aad, int aadlen, const Byte* data, int datalen, Byte* output) noexcept {
+            if (NULL == output || datalen < 0 || (NULL == data && datalen != 0) || aadlen < 0) {
+                return false;
+            }
+
+            EVP_CIPHER_CTX* ctx = _sealCTX.get();
+            if (NULL == ctx) {
+                return false;
+            }
+
+            uint64_t sequence = (_sequence++ & AEAD_SEQUENCE_MASK) | (_server ? AEAD_SEQUENCE_SERVER : 0);
+            for (int i = 0; i < SEQUENCE_SIZE; i++) {
+                output[i] = (Byte)(sequence >> ((SEQUENCE_SIZE - 1 - i) << 3));
+            }
+
+            Byte nonce[NONCE_SIZE];
+            computeNonce(sequence, nonce);
+
+            int len = 0;
+            if (EVP_EncryptInit_ex(ctx, NULL, NULL, NULL, nonce) < 1) {
+                return false;
+            }
+
+            if (aadlen > 0 && EVP_EncryptUpdate(ctx, NULL, &len, aad, aadlen) < 1) {
+                return false;
+            }
+
+            Byte* ciphertext = output + SEQUENCE_SIZE;
+            if (datalen > 0 && EVP_EncryptUpdate(ctx, ciphertext, &len, data, datalen) < 1) {
+                return false;
+            }
+
+            if (EVP_EncryptFinal_ex(ctx, ciphertext + datalen, &len) < 1) {
+                return false;
+            }
+
+            return EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, TAG_SIZE, ciphertext + datalen) > 0;
+        }
+
+        bool AEAD::Open(const Byte* aad, int aadlen, const Byte* data, int datalen, Byte* output) noexcept {
+            if (NULL == data || datalen < OVERHEAD_SIZE || aadlen < 0) {
+                return false;
+            }
+
+            EVP_CIPHER_CTX* ctx = _openCTX.get();
+            if (NULL == ctx) {
+                return false;
+            }
+
+            uint64_t sequence = 0;
+            for (int i = 0; i < SEQUENCE_SIZE; i++) {
+                sequence = sequence << 8 | data[i];
+            }
+
+            // Only the peer's half of the sequence space is accepted, and once a frame has been opened only its successor, 
+            // so replayed, duplicated, dropped or reordered frames fail even though their tags are valid.
+            bool server = (sequence & AEAD_SEQUENCE_SERVER) != 0;
+            if (server == _server) {
+                return false;
+            }
+            elif(_opened && sequence != _expected) {
+                return false;
+            }
+
+            Byte nonce[NONCE_SIZE];
+            computeNonce(sequence, nonce);
+
+            int len = 0;
+            if (EVP_DecryptInit_ex(ctx, NULL, NULL, NULL, nonce) < 1) {
+                return false;
+            }
+
+            if (aadlen > 0 && EVP_DecryptUpdate(ctx, NULL, &len, aad, aadlen) < 1) {
+                return false;
+            }
+
+            int ciphertext_size = datalen - OVERHEAD_SIZE;
+            const Byte* ciphertext = data + SEQUENCE_SIZE;
+            if (ciphertext_size > 0 && EVP_DecryptUpdate(ctx, output, &len, ciphertext, ciphertext_size) < 1) {
+                return false;
+            }
+
+            if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG, TAG_SIZE, (void*)(ciphertext + ciphertext_size)) < 1) {
+                return false;
+            }
+
+            if (EVP_DecryptFinal_ex(ctx, output + ciphertext_size, &len) < 1) {
+                return false;
+            }
+
+            _opened = true;
+            _expected = ((sequence + 1) & AEAD_SEQUENCE_MASK) | (sequence & AEAD_SEQUENCE_SERVER);
+            return true;
+        }
+    }
+}
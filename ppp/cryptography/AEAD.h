@@ -0,0 +1,46 @@
+#pragma once
+
+#include <ppp/stdafx.h>
+
+namespace ppp {
+    namespace cryptography {
+        /* Authenticated transport cipher (AES-GCM, ChaCha20-Poly1305), the key schedule is set up once and each message only loads a new nonce. */
+        class AEAD : public std::enable_shared_from_this<AEAD> {
+        public:
+            static constexpr int                                SEQUENCE_SIZE = 8;
+            static constexpr int                                TAG_SIZE      = 16;
+            static constexpr int                                NONCE_SIZE    = 12;
+            static constexpr int                                OVERHEAD_SIZE = SEQUENCE_SIZE + TAG_SIZE;
+
+        public:
+            AEAD(const ppp::string& method, const ppp::string& password, bool server) noexcept;
+
+        public:
+            /* output = SEQ(8) CIPHERTEXT(datalen) TAG(16), output must hold datalen + OVERHEAD_SIZE bytes, only called from the write queue.
+             * The queue packs frames under its own lock in the order they go out, so it is the single writer of the context and the sequence. */
+            bool                                                Seal(const Byte* aad, int aadlen, const Byte* data, int datalen, Byte* output) noexcept;
+            /* data = SEQ(8) CIPHERTEXT TAG(16), output must hold datalen - OVERHEAD_SIZE bytes, only called from the read loop. 
+             * The stream is in order, so after the first frame only the sequence following the last opened one is accepted. */
+            bool                                                Open(const Byte* aad, int aadlen, const Byte* data, int datalen, Byte* output) noexcept;
+            bool                                                IsVaild() noexcept { return NULL != _sealCTX && NULL != _openCTX; }
+            std::shared_ptr<AEAD>                               GetReference() noexcept { return this->shared_from_this(); }
+            static bool                                         Support(const ppp::string& method) noexcept;
+
+        private:
+            bool                                                initKey(const ppp::string& method, const ppp::string& password) noexcept;
+            bool                                                initCipher(std::shared_ptr<EVP_CIPHER_CTX>& context, int enc) noexcept;
+            void                                                computeNonce(uint64_t sequence, Byte* nonce) noexcept;
+
+        private:
+            const EVP_CIPHER*                                   _cipher = NULL;
+            bool                                                _server = false;
+            uint64_t                                            _sequence = 0;
+            bool                                                _opened   = false;
+            uint64_t                                            _expected = 0;
+            Byte                                                _key[EVP_MAX_KEY_LENGTH];
+            Byte                                                _iv[EVP_MAX_IV_LENGTH];
+            std::shared_ptr<EVP_CIPHER_CTX>                     _sealCTX;
+            std::shared_ptr<EVP_CIPHER_CTX>                     _openCTX;
+        };
+    }
+}
@@ -39,6 +39,24 @@ namespace ppp {
             return NULL;
         }
 
+        bool Ciphertext::Encrypt(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, BatchMessage* messages, int count) noexcept {
+            if (NULL != evp_) {
+                return evp_->Encrypt(allocator, messages, count);
+            }
+
+            if (NULL != rc4_ && NULL != messages && count > 0) {
+                for (int i = 0; i < count; i++) {
+                    BatchMessage& message = messages[i];
+                    message.output = rc4_->Encrypt(allocator, message.data, message.datalen, message.outlen);
+                    if (NULL == message.output) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            return false;
+        }
+
         bool Ciphertext::Support(const ppp::string& method) noexcept {
             if (method.empty()) {
                 return false;
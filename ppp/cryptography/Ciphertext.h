@@ -7,12 +7,18 @@
 namespace ppp {
     namespace cryptography {
         class Ciphertext : public std::enable_shared_from_this<Ciphertext> {
+        public:
+            typedef EVP::BatchMessage                           BatchMessage;
+
         public:
             Ciphertext(const ppp::string& method, const ppp::string& password) noexcept;
 
         public:
             std::shared_ptr<Byte>                               Encrypt(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, Byte* data, int datalen, int& outlen) noexcept;
             std::shared_ptr<Byte>                               Decrypt(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, Byte* data, int datalen, int& outlen) noexcept;
+            /* Encrypts every message on its own as Encrypt does, with one lock and one key setup for the batch. The messages are still 
+             * ciphered one after another, a CFB message rewinds the IV, it is not OpenSSL pipelining or multi-buffer AES. */
+            bool                                                Encrypt(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, BatchMessage* messages, int count) noexcept;
             std::shared_ptr<Ciphertext>                         GetReference() noexcept { return this->shared_from_this(); }
             static bool                                         Support(const ppp::string& method) noexcept;
 
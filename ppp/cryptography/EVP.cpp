@@ -120,6 +120,55 @@ namespace ppp {
             return cipherText;
         }
 
+        bool EVP::Encrypt(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, BatchMessage* messages, int count) noexcept {
+            if (NULL == messages || count < 1) {
+                return false;
+            }
+
+            EVP_CIPHER_CTX* context = _encryptCTX.get();
+            if (NULL == _cipher || NULL == context) {
+                return false;
+            }
+
+            // INIT-CTX, the key schedule is expanded once and the lock is held for the whole batch, the messages are still ciphered one by one.
+            SynchronizedObjectScope scope(_syncobj);
+            if (EVP_CipherInit_ex(context, _cipher, NULL, _key.get(), _iv.get(), 1) < 1) {
+                return false;
+            }
+
+            int blocksize = EVP_CIPHER_block_size(_cipher);
+            for (int i = 0; i < count; i++) {
+                BatchMessage& message = messages[i];
+                message.output = NULL;
+                message.outlen = 0;
+
+                if (NULL == message.data || message.datalen < 1) {
+                    return false;
+                }
+
+                // Every further message only rewinds the IV, which resets the stream state the same way a full init does.
+                if (i > 0 && EVP_CipherInit_ex(context, NULL, NULL, NULL, _iv.get(), 1) < 1) {
+                    return false;
+                }
+
+                int feedbacklen = message.datalen + blocksize;
+                std::shared_ptr<Byte> cipherText = ppp::threading::BufferswapAllocator::MakeByteArray(allocator, feedbacklen);
+                if (NULL == cipherText) {
+                    return false;
+                }
+
+                if (EVP_CipherUpdate(context,
+                    cipherText.get(), &feedbacklen, message.data, message.datalen) < 1) {
+                    return false;
+                }
+
+                message.output = std::move(cipherText);
+                message.outlen = feedbacklen;
+            }
+
+            return true;
+        }
+
         bool EVP::initCipher(std::shared_ptr<EVP_CIPHER_CTX>& context, int enc) noexcept {
             bool exception = false;
             while (!context) {
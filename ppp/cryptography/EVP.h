@@ -10,12 +10,22 @@ namespace ppp {
             typedef std::mutex                                  SynchronizedObject;
             typedef std::lock_guard<SynchronizedObject>         SynchronizedObjectScope;
 
+        public:
+            /* One message of a batch, output and outlen are filled in by the cipher. */
+            struct BatchMessage {
+                Byte*                                           data    = NULL;
+                int                                             datalen = 0;
+                std::shared_ptr<Byte>                           output;
+                int                                             outlen  = 0;
+            };
+
         public:
             EVP(const ppp::string& method, const ppp::string& password) noexcept;
 
         public:
             std::shared_ptr<Byte>                               Encrypt(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, Byte* data, int datalen, int& outlen) noexcept;
             std::shared_ptr<Byte>                               Decrypt(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, Byte* data, int datalen, int& outlen) noexcept;
+            bool                                                Encrypt(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, BatchMessage* messages, int count) noexcept;
             std::shared_ptr<EVP>                                GetReference() noexcept { return this->shared_from_this(); }
             SynchronizedObject&                                 GetSynchronizedObject() noexcept { return _syncobj; }
             static bool                                         Support(const ppp::string& method) noexcept;
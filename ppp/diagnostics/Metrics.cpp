@@ -0,0 +1,383 @@
+#include <ppp/diagnostics/Metrics.h>
+#include <ppp/net/Socket.h>
+#include <ppp/net/IPEndPoint.h>
+
+using ppp::net::Socket;
+using ppp::net::IPEndPoint;
+
+namespace ppp
+{
+    namespace diagnostics
+    {
+        typedef std::mutex                                                  SynchronizedObject;
+        typedef std::lock_guard<SynchronizedObject>                         SynchronizedObjectScope;
+        typedef ppp::unordered_map<const void*, Metrics::CollectEventHandler> CollectEventHandlerTable;
+
+        Metrics::Shard                                                      Metrics::shards_[Metrics::SHARD_COUNT];
+        std::atomic<int64_t>                                                Metrics::gauges_[Metrics::MetricsGauge_Max];
+        Metrics::Histogram                                                  Metrics::histograms_[Metrics::MetricsHistogram_Max];
+
+        static SynchronizedObject                                           Metrics_syncobj;
+        static CollectEventHandlerTable                                     Metrics_collectors;
+        static std::shared_ptr<boost::asio::ip::tcp::acceptor>              Metrics_acceptor;
+
+        static constexpr int                                                METRICS_MAX_REQUEST_SIZE = 8192;
+
+        static const struct
+        {
+            Metrics::MetricsCounter                                         counter;
+            const char*                                                     name;
+            const char*                                                     help;
+        } Metrics_counters[] =
+        {
+            { Metrics::MetricsCounter_TransmissionPacketsIn,   "ppp_transmission_packets_received_total", "Frames read from carrier transmissions." },
+            { Metrics::MetricsCounter_TransmissionPacketsOut,  "ppp_transmission_packets_sent_total",     "Frames written to carrier transmissions." },
+            { Metrics::MetricsCounter_TransmissionBytesIn,     "ppp_transmission_bytes_received_total",   "Payload bytes read from carrier transmissions." },
+            { Metrics::MetricsCounter_TransmissionBytesOut,    "ppp_transmission_bytes_sent_total",       "Payload bytes written to carrier transmissions." },
+            { Metrics::MetricsCounter_HandshakeFailures,       "ppp_handshake_failures_total",            "Carrier handshakes that did not complete." },
+            { Metrics::MetricsCounter_DnsQueries,              "ppp_dns_queries_total",                   "DNS queries relayed for sessions." },
+            { Metrics::MetricsCounter_FirewallDrops,           "ppp_firewall_drops_total",                "Destinations refused by the firewall rules." },
+            { Metrics::MetricsCounter_AllocatorFallbacks,      "ppp_allocator_fallbacks_total",           "Buffers taken from the heap because the swap allocator was full." },
+            { Metrics::MetricsCounter_LoggerDrops,             "ppp_logger_dropped_records_total",        "Log events dropped because the ring of the thread was full." },
+            { Metrics::MetricsCounter_FragmentDrops,           "ppp_fragment_drops_total",                "IPv4 datagrams abandoned during reassembly (malformed, evicted or over the memory cap)." },
+            { Metrics::MetricsCounter_FragmentTimeouts,        "ppp_fragment_timeouts_total",             "IPv4 datagrams whose fragments did not all arrive in time." },
+        };
+
+        static const struct
+        {
+            Metrics::MetricsGauge                                           gauge;
+            const char*                                                     name;
+            const char*                                                     help;
+        } Metrics_gauges[] =
+        {
+            { Metrics::MetricsGauge_DatagramPorts,             "ppp_datagram_ports",                      "Open UDP relay ports." },
+            { Metrics::MetricsGauge_CoroutineStacks,           "ppp_coroutine_stacks",                    "Coroutine stacks in use from the stack pool." },
+            { Metrics::MetricsGauge_CoroutineStackHighWater,   "ppp_coroutine_stack_high_water_bytes",    "Deepest coroutine stack use seen in sampled pool stacks." },
+        };
+
+        static const struct
+        {
+            Metrics::MetricsHistogram                                       histogram;
+            const char*                                                     name;
+            const char*                                                     help;
+        } Metrics_histograms[] =
+        {
+            { Metrics::MetricsHistogram_HandshakeLatency,      "ppp_handshake_duration_seconds",          "Time taken by completed carrier handshakes." },
+            { Metrics::MetricsHistogram_ExecutorLag,           "ppp_executor_lag_seconds",                "Delay of the default executor tick behind its deadline." },
+        };
+
+        static int Metrics_HighestBit(uint64_t value) noexcept
+        {
+#if defined(_MSC_VER)
+            unsigned long index = 0;
+            _BitScanReverse64(&index, value);
+            return (int)index;
+#else
+            return 63 - __builtin_clzll(value);
+#endif
+        }
+
+        static int Metrics_BucketIndex(uint64_t value) noexcept
+        {
+            static constexpr int SUB_COUNT = 1 << Metrics::HISTOGRAM_SUB_BITS;
+            if (value < SUB_COUNT)
+            {
+                return (int)value;
+            }
+
+            int msb = Metrics_HighestBit(value);
+            if (msb >= Metrics::HISTOGRAM_MAX_BITS)
+            {
+                return Metrics::HISTOGRAM_BUCKETS - 1;
+            }
+
+            int shift = msb - Metrics::HISTOGRAM_SUB_BITS;
+            return ((msb - 2) << Metrics::HISTOGRAM_SUB_BITS) + (int)((value >> shift) & (SUB_COUNT - 1));
+        }
+
+        int Metrics::NextShard() noexcept
+        {
+            static std::atomic<int> next = 0;
+            return next++ % SHARD_COUNT;
+        }
+
+        void Metrics::Record(MetricsHistogram histogram, uint64_t value) noexcept
+        {
+            Histogram& h = histograms_[histogram];
+            h.buckets[Metrics_BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+            h.count.fetch_add(1, std::memory_order_relaxed);
+            h.sum.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        bool Metrics::AddCollector(const void* key, const CollectEventHandler& handler) noexcept
+        {
+            if (NULL == key || NULL == handler)
+            {
+                return false;
+            }
+
+            SynchronizedObjectScope scope(Metrics_syncobj);
+            Metrics_collectors[key] = handler;
+            return true;
+        }
+
+        void Metrics::DeleteCollector(const void* key) noexcept
+        {
+            SynchronizedObjectScope scope(Metrics_syncobj);
+            Metrics_collectors.erase(key);
+        }
+
+        void Metrics::WriteHeader(ppp::string& out, const char* name, const char* type, const char* help) noexcept
+        {
+            out += "# HELP ";
+            out += name;
+            out += " ";
+            out += help;
+            out += "\n# TYPE ";
+            out += name;
+            out += " ";
+            out += type;
+            out += "\n";
+        }
+
+        void Metrics::WriteSample(ppp::string& out, const char* name, const ppp::string& labels, double value) noexcept
+        {
+            char sz[64];
+            snprintf(sz, sizeof(sz), "%.15g", value);
+
+            out += name;
+            if (!labels.empty())
+            {
+                out += "{";
+                out += labels;
+                out += "}";
+            }
+
+            out += " ";
+            out += sz;
+            out += "\n";
+        }
+
+        ppp::string Metrics::ToString() noexcept
+        {
+            ppp::string out;
+            for (auto& i : Metrics_counters)
+            {
+                uint64_t value = 0;
+                for (Shard& shard : shards_)
+                {
+                    value += shard.counters[i.counter].load(std::memory_order_relaxed);
+                }
+
+                WriteHeader(out, i.name, "counter", i.help);
+                WriteSample(out, i.name, ppp::string(), (double)value);
+            }
+
+            for (auto& i : Metrics_gauges)
+            {
+                WriteHeader(out, i.name, "gauge", i.help);
+                WriteSample(out, i.name, ppp::string(), (double)gauges_[i.gauge].load(std::memory_order_relaxed));
+            }
+
+            // Buckets are folded into one cumulative bucket per power of two microseconds.
+            for (auto& i : Metrics_histograms)
+            {
+                Histogram& h = histograms_[i.histogram];
+                ppp::string bucket_name = ppp::string(i.name) + "_bucket";
+                WriteHeader(out, i.name, "histogram", i.help);
+
+                uint64_t cumulative = 0;
+                int index = 0;
+                for (int bit = 0; bit < HISTOGRAM_MAX_BITS; bit++)
+                {
+                    int next = Metrics_BucketIndex(1ULL << bit);
+                    for (; index < next; index++)
+                    {
+                        cumulative += h.buckets[index].load(std::memory_order_relaxed);
+                    }
+
+                    char le[64];
+                    snprintf(le, sizeof(le), "le=\"%.6f\"", (double)((1ULL << bit) - 1) / 1000000.0);
+                    WriteSample(out, bucket_name.data(), le, (double)cumulative);
+                }
+
+                uint64_t count = h.count.load(std::memory_order_relaxed);
+                WriteSample(out, bucket_name.data(), "le=\"+Inf\"", (double)count);
+                WriteSample(out, (ppp::string(i.name) + "_sum").data(), ppp::string(), (double)h.sum.load(std::memory_order_relaxed) / 1000000.0);
+                WriteSample(out, (ppp::string(i.name) + "_count").data(), ppp::string(), (double)count);
+            }
+
+            ppp::vector<CollectEventHandler> collectors;
+            {
+                SynchronizedObjectScope scope(Metrics_syncobj);
+                for (auto&& kv : Metrics_collectors)
+                {
+                    collectors.emplace_back(kv.second);
+                }
+            }
+
+            for (CollectEventHandler& collector : collectors)
+            {
+                collector(out);
+            }
+
+            return out;
+        }
+
+        static void Metrics_Reply(const std::shared_ptr<boost::asio::ip::tcp::socket>& socket, const ppp::string& request) noexcept
+        {
+            ppp::string status = "200 OK";
+            ppp::string body;
+            if (request.find("GET /metrics ") == 0 || request.find("GET / ") == 0)
+            {
+                body = Metrics::ToString();
+            }
+            else
+            {
+                status = "404 Not Found";
+            }
+
+            std::shared_ptr<ppp::string> response = make_shared_object<ppp::string>();
+            if (NULL == response)
+            {
+                Socket::Closesocket(socket);
+                return;
+            }
+
+            *response = "HTTP/1.1 " + status + "\r\n"
+                "Content-Type: text/plain; version=0.0.4\r\n"
+                "Content-Length: " + stl::to_string<ppp::string>(body.size()) + "\r\n"
+                "Connection: close\r\n\r\n" + body;
+
+            boost::asio::async_write(*socket, boost::asio::buffer(response->data(), response->size()),
+                [socket, response](const boost::system::error_code& ec, std::size_t sz) noexcept
+                {
+                    Socket::Closesocket(socket);
+                });
+        }
+
+        static bool Metrics_Read(const std::shared_ptr<boost::asio::ip::tcp::socket>& socket, const std::shared_ptr<ppp::string>& request, const std::shared_ptr<Byte>& buffer) noexcept
+        {
+            if (!socket->is_open())
+            {
+                return false;
+            }
+
+            socket->async_read_some(boost::asio::buffer(buffer.get(), PPP_BUFFER_SIZE),
+                [socket, request, buffer](const boost::system::error_code& ec, std::size_t sz) noexcept
+                {
+                    if (ec || sz < 1)
+                    {
+                        Socket::Closesocket(socket);
+                        return;
+                    }
+
+                    request->append((char*)buffer.get(), sz);
+                    if (request->find("\r\n\r\n") != ppp::string::npos)
+                    {
+                        Metrics_Reply(socket, *request);
+                    }
+                    elif(request->size() > METRICS_MAX_REQUEST_SIZE || !Metrics_Read(socket, request, buffer))
+                    {
+                        Socket::Closesocket(socket);
+                    }
+                });
+            return true;
+        }
+
+        bool Metrics::Open(const std::shared_ptr<boost::asio::io_context>& context, const ppp::string& bind, int port) noexcept
+        {
+            if (NULL == context || port <= IPEndPoint::MinPort || port > IPEndPoint::MaxPort)
+            {
+                return false;
+            }
+
+            boost::system::error_code ec;
+            boost::asio::ip::address ip = bind.empty() ? boost::asio::ip::address(boost::asio::ip::address_v4::loopback()) : StringToAddress(bind.data(), ec);
+            if (ec)
+            {
+                return false;
+            }
+
+            std::shared_ptr<boost::asio::ip::tcp::acceptor> acceptor = make_shared_object<boost::asio::ip::tcp::acceptor>(*context);
+            if (NULL == acceptor)
+            {
+                return false;
+            }
+
+            if (!Socket::OpenAcceptor(*acceptor, ip, port, PPP_LISTEN_BACKLOG, false, false))
+            {
+                Socket::Closesocket(acceptor);
+                return false;
+            }
+
+            bool ok = Socket::AcceptLoopbackAsync(acceptor,
+                [](const Socket::AsioContext& context, const Socket::AsioTcpSocket& socket) noexcept
+                {
+                    std::shared_ptr<ppp::string> request = make_shared_object<ppp::string>();
+                    std::shared_ptr<Byte> buffer = make_shared_alloc<Byte>(PPP_BUFFER_SIZE);
+                    if (NULL == request || NULL == buffer)
+                    {
+                        return false;
+                    }
+
+                    return Metrics_Read(socket, request, buffer);
+                });
+            if (!ok)
+            {
+                Socket::Closesocket(acceptor);
+                return false;
+            }
+
+            std::shared_ptr<boost::asio::ip::tcp::acceptor> previous;
+            {
+                SynchronizedObjectScope scope(Metrics_syncobj);
+                previous = std::move(Metrics_acceptor);
+                Metrics_acceptor = acceptor;
+            }
+
+            if (NULL != previous)
+            {
+                Socket::Closesocket(previous);
+            }
+
+            return true;
+        }
+
+        void Metrics::Close() noexcept
+        {
+            std::shared_ptr<boost::asio::ip::tcp::acceptor> acceptor;
+            {
+                SynchronizedObjectScope scope(Metrics_syncobj);
+                acceptor = std::move(Metrics_acceptor);
+                Metrics_acceptor.reset();
+            }
+
+            if (NULL != acceptor)
+            {
+                Socket::Closesocket(acceptor);
+            }
+        }
+
+        boost::asio::ip::tcp::endpoint Metrics::GetLocalEndPoint() noexcept
+        {
+            std::shared_ptr<boost::asio::ip::tcp::acceptor> acceptor;
+            {
+                SynchronizedObjectScope scope(Metrics_syncobj);
+                acceptor = Metrics_acceptor;
+            }
+
+            boost::system::error_code ec;
+            if (NULL != acceptor && acceptor->is_open())
+            {
+                boost::asio::ip::tcp::endpoint localEP = acceptor->local_endpoint(ec);
+                if (!ec)
+                {
+                    return localEP;
+                }
+            }
+
+            return boost::asio::ip::tcp::endpoint();
+        }
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <ppp/stdafx.h>
+
+namespace ppp
+{
+    namespace diagnostics
+    {
+        // Process wide counters, gauges and latency histograms, scraped in the Prometheus text format from a local http endpoint.
+        // Counters are sharded per thread, recording one is a relaxed add on the cache line of the thread's shard. Threads take the
+        // shards round robin, past SHARD_COUNT threads a shard is shared and its line is written by more than one thread.
+        class Metrics final
+        {
+        public:
+            typedef enum
+            {
+                MetricsCounter_TransmissionPacketsIn,
+                MetricsCounter_TransmissionPacketsOut,
+                MetricsCounter_TransmissionBytesIn,
+                MetricsCounter_TransmissionBytesOut,
+                MetricsCounter_HandshakeFailures,
+                MetricsCounter_DnsQueries,
+                MetricsCounter_FirewallDrops,
+                MetricsCounter_AllocatorFallbacks,
+                MetricsCounter_LoggerDrops,
+                MetricsCounter_FragmentDrops,
+                MetricsCounter_FragmentTimeouts,
+                MetricsCounter_Max,
+            }                                       MetricsCounter;
+            typedef enum
+            {
+                MetricsGauge_DatagramPorts,
+                MetricsGauge_CoroutineStacks,
+                MetricsGauge_CoroutineStackHighWater,
+                MetricsGauge_Max,
+            }                                       MetricsGauge;
+            typedef enum
+            {
+                MetricsHistogram_HandshakeLatency,
+                MetricsHistogram_ExecutorLag,
+                MetricsHistogram_Max,
+            }                                       MetricsHistogram;
+            typedef ppp::function<void(ppp::string&)> CollectEventHandler;
+
+        public:
+            static constexpr int                    SHARD_COUNT             = 16;
+            static constexpr int                    HISTOGRAM_SUB_BITS      = 3;
+            static constexpr int                    HISTOGRAM_MAX_BITS      = 40;
+            static constexpr int                    HISTOGRAM_BUCKETS       = (HISTOGRAM_MAX_BITS - 2) << HISTOGRAM_SUB_BITS;
+
+        public:
+            static void                             Add(MetricsCounter counter, uint64_t value) noexcept
+            {
+                shards_[GetShard()].counters[counter].fetch_add(value, std::memory_order_relaxed);
+            }
+            static void                             Increment(MetricsCounter counter) noexcept { Add(counter, 1); }
+            static void                             Gauge(MetricsGauge gauge, int64_t delta) noexcept
+            {
+                gauges_[gauge].fetch_add(delta, std::memory_order_relaxed);
+            }
+            static void                             Maximum(MetricsGauge gauge, int64_t value) noexcept
+            {
+                int64_t current = gauges_[gauge].load(std::memory_order_relaxed);
+                while (current < value && !gauges_[gauge].compare_exchange_weak(current, value, std::memory_order_relaxed))
+                {
+                }
+            }
+            // Values are microseconds, buckets are log-linear with eight steps per power of two (at most 12.5% error).
+            static void                             Record(MetricsHistogram histogram, uint64_t value) noexcept;
+
+        public:
+            static bool                             AddCollector(const void* key, const CollectEventHandler& handler) noexcept;
+            static void                             DeleteCollector(const void* key) noexcept;
+            static ppp::string                      ToString() noexcept;
+            static void                             WriteHeader(ppp::string& out, const char* name, const char* type, const char* help) noexcept;
+            static void                             WriteSample(ppp::string& out, const char* name, const ppp::string& labels, double value) noexcept;
+
+        public:
+            static bool                             Open(const std::shared_ptr<boost::asio::io_context>& context, const ppp::string& bind, int port) noexcept;
+            static void                             Close() noexcept;
+            static boost::asio::ip::tcp::endpoint   GetLocalEndPoint() noexcept;
+
+        private:
+            struct alignas(64) Shard
+            {
+                std::atomic<uint64_t>               counters[MetricsCounter_Max];
+            };
+            struct Histogram
+            {
+                std::atomic<uint64_t>               buckets[HISTOGRAM_BUCKETS];
+                std::atomic<uint64_t>               count;
+                std::atomic<uint64_t>               sum;
+            };
+
+        private:
+            static int                              GetShard() noexcept
+            {
+                static thread_local int shard = NextShard();
+                return shard;
+            }
+            static int                              NextShard() noexcept;
+
+        private:
+            static Shard                            shards_[SHARD_COUNT];
+            static std::atomic<int64_t>             gauges_[MetricsGauge_Max];
+            static Histogram                        histograms_[MetricsHistogram_Max];
+        };
+    }
+}
@@ -18,6 +18,7 @@ using ppp::net::native::ip_hdr;
 using ppp::net::native::tcp_hdr;
 using ppp::net::packet::IPFlags;
 using ppp::net::packet::IPFrame;
+using ppp::net::packet::PacketView;
 using ppp::net::packet::BufferSegment;
 
 namespace ppp
@@ -91,6 +92,7 @@ namespace ppp
             }
 
             lwip::netstack::output = NULL;
+            lwip::netstack::Allocator = NULL;
             if (NULL != tap)
             {
                 tap->PacketInput.reset();
@@ -379,6 +381,7 @@ namespace ppp
             lwip::netstack::IP = tap->IPAddress;
             lwip::netstack::MASK = tap->SubmaskAddress;
             lwip::netstack::Localhost = IPEndPoint::MinPort;
+            lwip::netstack::Allocator = GetBufferAllocator();
 
             // An attempt has been made to open the local loop of the virtual network card.  
             // If the virtual network card is opened or has been opened before, the operation succeeds. 
@@ -600,6 +603,14 @@ namespace ppp
                 std::shared_ptr<IPFragment> fragment = fragment_;
                 if (NULL != fragment)
                 {
+                    // Whole datagrams are first offered as a view over the input buffer, 
+                    // Only fragments and what the view handler declines are parsed into frame objects.
+                    PacketView view;
+                    if (view.Parse(iphdr, packet_length) && !view.IsFragment() && OnPacketInput(view))
+                    {
+                        return 0;
+                    }
+
                     std::shared_ptr<ppp::threading::BufferswapAllocator> allocator = GetBufferAllocator();
                     std::shared_ptr<IPFrame> packet = IPFrame::Parse(allocator, iphdr, packet_length);
                     if (NULL != packet && !fragment->Input(packet))
@@ -771,6 +782,11 @@ namespace ppp
             return false;
         }
 
+        bool VEthernet::OnPacketInput(PacketView& packet) noexcept
+        {
+            return false;
+        }
+
         bool VEthernet::Output(IPFrame* packet) noexcept
         {
             if (NULL == packet)
@@ -10,6 +10,7 @@
 #include <ppp/net/packet/IPFrame.h>
 #include <ppp/net/packet/UdpFrame.h>
 #include <ppp/net/packet/IcmpFrame.h>
+#include <ppp/net/packet/PacketView.h>
 
 struct pbuf;
 
@@ -63,6 +64,7 @@ namespace ppp
             virtual bool                                                    OnUpdate(uint64_t now) noexcept;
             virtual bool                                                    OnPacketInput(const std::shared_ptr<IPFrame>& packet) noexcept;
             virtual bool                                                    OnPacketInput(ppp::net::native::ip_hdr* packet, int packet_length, int header_length, int proto, bool vnet) noexcept;
+            virtual bool                                                    OnPacketInput(ppp::net::packet::PacketView& packet) noexcept;
 
         private:
             void                                                            Finalize() noexcept;
@@ -20,7 +20,7 @@ typedef ppp::collections::Dictionary                            Dictionary;
 
 namespace ppp {
     namespace ethernet {
-        static Int128 LAN2WAN_KEY(uint32_t src_ip, uint16_t src_port, uint16_t dst_ip, uint16_t dst_port) noexcept {
+        static Int128 LAN2WAN_KEY(uint32_t src_ip, uint16_t src_port, uint32_t dst_ip, uint16_t dst_port) noexcept {
             uint64_t src_ep = MAKE_QWORD(src_ip, src_port);
             uint64_t dst_ep = MAKE_QWORD(dst_ip, dst_port);
 
@@ -107,20 +107,31 @@ namespace ppp {
             int newPort = 0;
             SynchronizedObjectScope scope(syncobj_);
 
+            // Another queue may have allocated the same flow since the lookup above.
+            if (auto tail = this->lan2wan_.find(key); tail != this->lan2wan_.end()) {
+                link = tail->second;
+                if (NULL != link) {
+                    link->Update();
+                }
+                return link;
+            }
+
             for (int traversePort = IPEndPoint::MinPort; traversePort < IPEndPoint::MaxPort; traversePort++) {
                 newPort = IPEndPoint::MinPort;
                 for (int c = IPEndPoint::MinPort; c <= IPEndPoint::MaxPort; c++) {
                     int localPort = ++this->ap_;
                     if (localPort <= IPEndPoint::MinPort || localPort > IPEndPoint::MaxPort) {
                         this->ap_ = IPEndPoint::MinPort;
+                        continue;
                     }
 
                     if (localPort == this->listenEP_.Port) {
                         continue;
                     }
 
-                    auto tail = this->lan2wan_.find(key);
-                    auto endl = this->lan2wan_.end();
+                    // The NAT port must not be in use by another flow, or its segments would be delivered to the new one.
+                    auto tail = this->wan2lan_.find(localPort);
+                    auto endl = this->wan2lan_.end();
                     if (tail == endl) {
                         newPort = localPort;
                         break;
@@ -268,9 +279,16 @@ namespace ppp {
             std::shared_ptr<TapTcpLink> link;
             std::shared_ptr<TapTcpClient> c;
 
+            // Segments of established flows that carry no SYN, FIN or RST cannot change the link state, so they only need the
+            // addresses and ports rewritten and both checksums patched, the state machine below only sees the other segments.
+            bool established = (flags & (TcpFlags::TCP_SYN | TcpFlags::TCP_FIN | TcpFlags::TCP_RST)) == 0;
             if (ip->dest == tap->GatewayServer) { // V->Local 
                 if ((link = this->FindTcpLink(tcp->dest))) {
                     link->Update();
+                    if (established && link->state == TcpState::TCP_STATE_ESTABLISHED) {
+                        return this->Forward(tap, ip, tcp, tcp_len, link->dstAddr, link->dstPort, link->srcAddr, link->srcPort);
+                    }
+
                     lan2wan = false;
                     rst = false;
                     ip->src = link->dstAddr;
@@ -282,6 +300,10 @@ namespace ppp {
             elif(flags != TcpFlags::TCP_SYN) { // Local->V
                 if ((link = this->FindTcpLink(LAN2WAN_KEY(ip->src, tcp->src, ip->dest, tcp->dest)))) {
                     link->Update();
+                    if (established && link->state == TcpState::TCP_STATE_ESTABLISHED) {
+                        return this->Forward(tap, ip, tcp, tcp_len, tap->GatewayServer, link->natPort, tap->IPAddress, ntohs(this->listenEP_.Port));
+                    }
+
                     rst = false;
                     ip->src = tap->GatewayServer;
                     tcp->src = link->natPort;
@@ -505,6 +527,25 @@ namespace ppp {
             return true;
         }
 
+        bool VNetstack::Forward(const std::shared_ptr<ITap>& tap, ip_hdr* ip, tcp_hdr* tcp, int tcp_len, UInt32 srcAddr, UInt16 srcPort, UInt32 dstAddr, UInt16 dstPort) noexcept {
+            // The addresses are covered by the IP header checksum and by the pseudo header of the TCP checksum, the ports only by the latter.
+            unsigned int addresses = ppp::net::native::inet_chksum_delta32(0, ip->src, srcAddr);
+            addresses = ppp::net::native::inet_chksum_delta32(addresses, ip->dest, dstAddr);
+
+            unsigned int ports = ppp::net::native::inet_chksum_delta(addresses, tcp->src, srcPort);
+            ports = ppp::net::native::inet_chksum_delta(ports, tcp->dest, dstPort);
+
+            ip->src = srcAddr;
+            tcp->src = srcPort;
+            ip->dest = dstAddr;
+            tcp->dest = dstPort;
+            ip->chksum = ppp::net::native::inet_chksum_adjust_delta(ip->chksum, addresses);
+            tcp->chksum = ppp::net::native::inet_chksum_adjust_delta(tcp->chksum, ports);
+
+            int ippkg_len = ((char*)tcp + tcp_len) - (char*)ip;
+            return tap->Output(ip, ippkg_len);
+        }
+
         bool VNetstack::CloseTcpLink(const std::shared_ptr<TapTcpLink>& link, bool fin) noexcept {
             if (NULL == link) {
                 return false;
@@ -2,6 +2,7 @@
 
 #include <ppp/stdafx.h>
 #include <ppp/Int128.h>
+#include <ppp/collections/FlowTable.h>
 #include <ppp/threading/Executors.h>
 #include <ppp/threading/BufferswapAllocator.h>
 #include <ppp/coroutines/YieldContext.h>
@@ -47,8 +48,8 @@ namespace ppp {
             public:
                 typedef std::shared_ptr<TapTcpLink>                         Ptr;
             };
-            typedef ppp::unordered_map<int, TapTcpLink::Ptr>                WAN2LANTABLE;
-            typedef ppp::unordered_map<Int128, TapTcpLink::Ptr>             LAN2WANTABLE;
+            typedef ppp::collections::FlowTable<int, TapTcpLink::Ptr>       WAN2LANTABLE;
+            typedef ppp::collections::FlowTable<Int128, TapTcpLink::Ptr>    LAN2WANTABLE;
 
         public:
             typedef ppp::tap::ITap                                          ITap;
@@ -137,6 +138,7 @@ namespace ppp {
         private:
             bool                                                            RST(ip_hdr* ip, tcp_hdr* tcp, int tcp_len) noexcept;
             bool                                                            Output(bool lan2wan, ip_hdr* ip, tcp_hdr* tcp, int tcp_len, TapTcpClient* c) noexcept;
+            bool                                                            Forward(const std::shared_ptr<ITap>& tap, ip_hdr* ip, tcp_hdr* tcp, int tcp_len, UInt32 srcAddr, UInt16 srcPort, UInt32 dstAddr, UInt16 dstPort) noexcept;
             bool                                                            ProcessAcceptSocket(int sockfd) noexcept;
             void                                                            ReleaseAllResources() noexcept;
 
@@ -31,6 +31,20 @@ namespace ppp {
             return length;
         }
 
+        int64_t File::GetLastWriteTime(const char* path) noexcept {
+            if (NULL == path) {
+                return -1;
+            }
+
+            boost::system::error_code ec;
+            std::time_t last_write_time = boost::filesystem::last_write_time(path, ec);
+            if (ec) {
+                return -1;
+            }
+
+            return static_cast<int64_t>(last_write_time);
+        }
+
         bool File::Exists(const char* path) noexcept {
             if (NULL == path) {
                 return false;
@@ -19,6 +19,7 @@ namespace ppp {
             static ppp::string                  RewritePath(const char* path) noexcept;
             static bool                         CanAccess(const char* path, FileAccess access_) noexcept;
             static int                          GetLength(const char* path) noexcept;
+            static int64_t                      GetLastWriteTime(const char* path) noexcept;
             static bool                         Exists(const char* path) noexcept;
             static bool                         Delete(const char* path) noexcept;
             static bool                         Create(const char* path, size_t size) noexcept;
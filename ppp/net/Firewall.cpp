@@ -3,8 +3,10 @@
 #include <ppp/net/Ipep.h>
 #include <ppp/net/IPEndPoint.h>
 #include <ppp/collections/Dictionary.h>
+#include <ppp/diagnostics/Metrics.h>
 
 using ppp::collections::Dictionary;
+using ppp::diagnostics::Metrics;
 using ppp::io::File;
 using ppp::net::Ipep;
 using ppp::net::IPEndPoint;
@@ -149,6 +151,7 @@ namespace ppp
                 auto endl = list->end();
                 if (tail != endl)
                 {
+                    Metrics::Increment(Metrics::MetricsCounter_FirewallDrops);
                     return true;
                 }
             }
@@ -178,6 +181,7 @@ namespace ppp
 
                 if (prefix >= tail->second)
                 {
+                    Metrics::Increment(Metrics::MetricsCounter_FirewallDrops);
                     return true;
                 }
             }
@@ -238,7 +242,13 @@ namespace ppp
                     auto endl = network_domains_.end();
                     return tail != endl;
                 };
-            return IsSameNetworkDomains(host_lower, contains);
+
+            bool drop = IsSameNetworkDomains(host_lower, contains);
+            if (drop)
+            {
+                Metrics::Increment(Metrics::MetricsCounter_FirewallDrops);
+            }
+            return drop;
         }
 
         bool Firewall::IsSameNetworkDomains(const ppp::string& host, const ppp::function<bool(const ppp::string& s)>& contains) noexcept
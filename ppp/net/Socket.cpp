@@ -458,6 +458,78 @@ namespace ppp {
             return ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (char*)&flag, sizeof(flag)) == 0;
         }
 
+        bool Socket::ReuseSocketPort(int fd, bool reuse) noexcept {
+            if (fd == -1) {
+                return false;
+            }
+
+#if defined(SO_REUSEPORT)
+            int flag = reuse ? 1 : 0;
+            return ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, (char*)&flag, sizeof(flag)) == 0;
+#else
+            return false;
+#endif
+        }
+
+#if defined(_LINUX)
+        int Socket::ReceiveFrom(
+            const boost::asio::ip::udp::socket&                     socket,
+            Byte**                                                  buffers,
+            int                                                     buffer_size,
+            int*                                                    lengths,
+            boost::asio::ip::udp::endpoint*                         sources,
+            int                                                     count) noexcept {
+            static constexpr int RECVMMSG_MAX = 64;
+
+            if (NULL == buffers || NULL == lengths || NULL == sources || buffer_size < 1 || count < 1) {
+                return -1;
+            }
+
+            boost::asio::ip::udp::socket& socket_ = constantof(socket);
+            if (!socket_.is_open()) {
+                return -1;
+            }
+
+            struct mmsghdr msgs[RECVMMSG_MAX];
+            struct iovec iovecs[RECVMMSG_MAX];
+            struct sockaddr_storage addresses[RECVMMSG_MAX];
+
+            count = std::min<int>(count, RECVMMSG_MAX);
+            memset(msgs, 0, sizeof(*msgs) * count);
+
+            for (int i = 0; i < count; i++) {
+                iovecs[i].iov_base = buffers[i];
+                iovecs[i].iov_len = buffer_size;
+
+                struct msghdr& hdr = msgs[i].msg_hdr;
+                hdr.msg_name = &addresses[i];
+                hdr.msg_namelen = sizeof(addresses[i]);
+                hdr.msg_iov = &iovecs[i];
+                hdr.msg_iovlen = 1;
+            }
+
+            int handle = socket_.native_handle();
+            int received = ::recvmmsg(handle, msgs, count, MSG_DONTWAIT, NULL);
+            if (received < 0) {
+                int err = errno;
+                return err == EAGAIN || err == EWOULDBLOCK || err == EINTR ? 0 : -1;
+            }
+
+            for (int i = 0; i < received; i++) {
+                struct msghdr& hdr = msgs[i].msg_hdr;
+                boost::asio::ip::udp::endpoint& sourceEP = sources[i];
+
+                int address_length = std::min<int>(hdr.msg_namelen, sourceEP.capacity());
+                memcpy(sourceEP.data(), &addresses[i], address_length);
+                sourceEP.resize(address_length);
+
+                lengths[i] = msgs[i].msg_len;
+            }
+
+            return received;
+        }
+#endif
+
         /* TCP MSS values – what’s changed?
          * https://blog.apnic.net/2019/07/31/tcp-mss-values-whats-changed/ 
          */
@@ -111,6 +111,19 @@ namespace ppp {
             static bool                                                                                 SetTypeOfService(int fd, int tos = ~0) noexcept;
             static bool                                                                                 SetSignalPipeline(int fd, bool sigpipe) noexcept;
             static bool                                                                                 ReuseSocketAddress(int fd, bool reuse) noexcept;
+            static bool                                                                                 ReuseSocketPort(int fd, bool reuse) noexcept;
+
+#if defined(_LINUX)
+        public:
+            /* Drains up to count datagrams with one recvmmsg call without blocking, returns the number received, 0 when the queue is empty or -1 on error. */
+            static int                                                                                  ReceiveFrom(
+                const boost::asio::ip::udp::socket&                                                     socket,
+                Byte**                                                                                  buffers,
+                int                                                                                     buffer_size,
+                int*                                                                                    lengths,
+                boost::asio::ip::udp::endpoint*                                                         sources,
+                int                                                                                     count) noexcept;
+#endif
 
         public:
             static int                                                                                  GetHandle(const boost::asio::ip::tcp::acceptor& acceptor) noexcept;
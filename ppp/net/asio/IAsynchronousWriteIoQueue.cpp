@@ -8,7 +8,8 @@ namespace ppp {
             }
 
             IAsynchronousWriteIoQueue::AsynchronousWriteIoContext::AsynchronousWriteIoContext() noexcept
-                : packet_length(0) {
+                : packet_length(0)
+                , deferred(false) {
 
             }
 
@@ -137,38 +138,149 @@ namespace ppp {
                 return ok;
             }
 
+            bool IAsynchronousWriteIoQueue::PackBytes(const void* packet, int packet_length, const AsynchronousWriteBytesCallback& cb) noexcept {
+                IAsynchronousWriteIoQueue* const q = this;
+                if (q->disposed_) {
+                    return false;
+                }
+
+                if (NULL == packet || packet_length < 1) {
+                    return false;
+                }
+
+                if (NULL == cb) {
+                    return false;
+                }
+
+                std::shared_ptr<AsynchronousWriteIoContext> context = make_shared_object<AsynchronousWriteIoContext>();
+                if (NULL == context) {
+                    return false;
+                }
+
+                context->cb = cb;
+                context->deferred = true;
+
+                SynchronizedObjectScope scope(q->syncobj_);
+                if (q->sending_) {
+                    context->packet = Copy(BufferAllocator, packet, packet_length);
+                    if (NULL == context->packet) {
+                        return false;
+                    }
+
+                    context->packet_length = packet_length;
+                    q->queues_.emplace_back(context);
+                    return true;
+                }
+
+                // The queue is idle, pack the caller's buffer directly instead of copying it first.
+                Byte* packets[] = { (Byte*)packet };
+                int packet_lengths[] = { packet_length };
+
+                context->packet = DoPackBytes(packets, packet_lengths, 1, context->packet_length);
+                if (NULL == context->packet) {
+                    return false;
+                }
+
+                context->deferred = false;
+                return q->DoWriteBytes(context);
+            }
+
+            std::shared_ptr<Byte> IAsynchronousWriteIoQueue::DoPackBytes(Byte** packets, int* packet_lengths, int count, int& outlen) noexcept {
+                outlen = 0;
+                for (int i = 0; i < count; i++) {
+                    outlen += packet_lengths[i];
+                }
+
+                std::shared_ptr<Byte> packet = BufferswapAllocator::MakeByteArray(BufferAllocator, outlen);
+                if (NULL == packet) {
+                    outlen = 0;
+                    return NULL;
+                }
+
+                Byte* memory = packet.get();
+                for (int i = 0; i < count; i++) {
+                    memcpy(memory, packets[i], packet_lengths[i]);
+                    memory += packet_lengths[i];
+                }
+
+                return packet;
+            }
+
             bool IAsynchronousWriteIoQueue::DoWriteBytes(AsynchronousWriteIoContextPtr message) noexcept {
+                AsynchronousWriteIoContextQueue messages;
+                messages.emplace_back(message);
+
+                return DoWriteBytes(messages, message->packet, message->packet_length);
+            }
+
+            bool IAsynchronousWriteIoQueue::DoWriteBytes(AsynchronousWriteIoContextQueue& messages) noexcept {
+                auto tail = queues_.begin();
+                auto endl = queues_.end();
+                if (tail == endl) {
+                    return true;
+                }
+
+                AsynchronousWriteIoContextPtr context = *tail;
+                if (!context->deferred) {
+                    messages.emplace_back(context);
+                    queues_.erase(tail);
+
+                    return DoWriteBytes(messages, context->packet, context->packet_length);
+                }
+
+                // Take the run of deferred messages at the head of the queue, up to one buffer's worth, and pack them in one pass.
+                ppp::vector<Byte*> packets;
+                ppp::vector<int> packet_lengths;
+
+                int packet_size = 0;
+                while (tail != endl && packet_size < PPP_BUFFER_SIZE) {
+                    context = *tail;
+                    if (!context->deferred) {
+                        break;
+                    }
+
+                    packets.emplace_back(context->packet.get());
+                    packet_lengths.emplace_back(context->packet_length);
+                    packet_size += context->packet_length;
+
+                    messages.emplace_back(context);
+                    tail = queues_.erase(tail);
+                }
+
+                int packet_length = 0;
+                std::shared_ptr<Byte> packet = DoPackBytes(packets.data(), packet_lengths.data(), (int)packets.size(), packet_length);
+                if (NULL == packet) {
+                    return false;
+                }
+
+                return DoWriteBytes(messages, packet, packet_length);
+            }
+
+            bool IAsynchronousWriteIoQueue::DoWriteBytes(const AsynchronousWriteIoContextQueue& messages, const std::shared_ptr<Byte>& packet, int packet_length) noexcept {
                 if (disposed_) {
                     return false;
                 }
 
                 auto self = shared_from_this();
-                auto evtf = [self, this, message](bool ok) noexcept {
-                        if (message) {
+                auto evtf = [self, this, messages](bool ok) noexcept {
+                        for (const AsynchronousWriteIoContextPtr& message : messages) {
                             (*message)(ok);
                         }
 
-                        std::shared_ptr<AsynchronousWriteIoContext> context;
+                        AsynchronousWriteIoContextQueue contexts;
                         if (ok) {
                             SynchronizedObjectScope scope(syncobj_);
                             sending_ = false;
 
-                            auto tail = queues_.begin();
-                            auto endl = queues_.end();
-                            if (tail != endl) {
-                                context = std::move(*tail);
-                                queues_.erase(tail);
-
-                                ok = DoWriteBytes(context);
-                            }
+                            ok = DoWriteBytes(contexts);
                         }
 
-                        if (context) {
+                        for (const AsynchronousWriteIoContextPtr& context : contexts) {
                             (*context)(ok);
                         }
                     };
 
-                bool ok = DoWriteBytes(message->packet, 0, message->packet_length, evtf);
+                bool ok = DoWriteBytes(packet, 0, packet_length, evtf);
                 if (ok) {
                     sending_ = true;
                 }
@@ -34,6 +34,7 @@ namespace ppp {
                 public:
                     std::shared_ptr<Byte>                               packet;
                     int                                                 packet_length;
+                    bool                                                deferred;
                     AsynchronousWriteBytesCallback                      cb;
 
                 public:
@@ -80,8 +81,15 @@ namespace ppp {
                 bool                                                    WriteBytes(YieldContext& y, const std::shared_ptr<Byte>& packet, int packet_length) noexcept;
                 virtual bool                                            DoWriteBytes(std::shared_ptr<Byte> packet, int offset, int packet_length, const AsynchronousWriteBytesCallback& cb) noexcept = 0;
 
+            protected:
+                /* Messages that arrive while a write is in flight are kept as written and packed together by DoPackBytes once the queue drains. */
+                bool                                                    PackBytes(const void* packet, int packet_length, const AsynchronousWriteBytesCallback& cb) noexcept;
+                virtual std::shared_ptr<Byte>                           DoPackBytes(Byte** packets, int* packet_lengths, int count, int& outlen) noexcept;
+
             private:
                 bool                                                    DoWriteBytes(AsynchronousWriteIoContextPtr message) noexcept;
+                bool                                                    DoWriteBytes(AsynchronousWriteIoContextQueue& messages) noexcept;
+                bool                                                    DoWriteBytes(const AsynchronousWriteIoContextQueue& messages, const std::shared_ptr<Byte>& packet, int packet_length) noexcept;
                 void                                                    Finalize() noexcept;
 
             private:
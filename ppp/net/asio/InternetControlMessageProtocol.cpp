@@ -1,9 +1,9 @@
 #include <ppp/net/asio/InternetControlMessageProtocol.h>
 #include <ppp/net/Socket.h>
 #include <ppp/net/IPEndPoint.h>
+#include <ppp/net/native/checksum.h>
 #include <ppp/threading/Timer.h>
 #include <ppp/threading/Executors.h>
-#include <ppp/collections/Dictionary.h>
 
 typedef ppp::net::Socket                        Socket;
 typedef ppp::net::native::ip_hdr                ip_hdr;
@@ -16,80 +16,355 @@ typedef ppp::net::IPEndPoint                    IPEndPoint;
 typedef ppp::net::AddressFamily                 AddressFamily;
 typedef ppp::threading::Timer                   Timer;
 typedef ppp::threading::Executors               Executors;
-typedef ppp::collections::Dictionary            Dictionary;
 
 namespace ppp {
     namespace net {
         namespace asio {
-            static void Closesocket(const std::shared_ptr<boost::asio::ip::udp::socket>& socket, uint32_t sockfd) noexcept {
-                if (NULL != socket) {
-                    if (socket->is_open()) {
-                        Socket::Closesocket(socket);
-                        return;
-                    }
-                }
-
-                Socket::Closesocket(sockfd);
+            // Stores value into word and patches the checksum, both are taken as they lie in memory.
+            static void ChecksumAdjust(Byte* checksum, Byte* word, uint16_t value) noexcept {
+                uint16_t hc;
+                uint16_t m;
+                memcpy(&hc, checksum, sizeof(hc));
+                memcpy(&m, word, sizeof(m));
+
+                hc = ppp::net::native::inet_chksum_adjust(hc, m, value);
+                memcpy(checksum, &hc, sizeof(hc));
+                memcpy(word, &value, sizeof(value));
             }
 
-            // RAII
-            typedef class InternetControlMessageProtocol_EchoAsynchronousContext final {
+            // One raw ICMP socket per io_context, shared by every InternetControlMessageProtocol running on it.
+            class InternetControlMessageProtocol_EchoEngine final : public std::enable_shared_from_this<InternetControlMessageProtocol_EchoEngine> {
+            private:
+                typedef std::mutex                                              SynchronizedObject;
+                typedef std::lock_guard<SynchronizedObject>                     SynchronizedObjectScope;
+                typedef std::weak_ptr<InternetControlMessageProtocol_EchoEngine> EchoEngineWeakPtr;
+                typedef ppp::unordered_map<boost::asio::io_context*, EchoEngineWeakPtr> EchoEngineTable;
+
+                struct Translation {
+                    std::weak_ptr<InternetControlMessageProtocol>               owner;
+                    std::shared_ptr<IPFrame>                                    packet;
+                    std::shared_ptr<IcmpFrame>                                  frame;
+                    IPEndPoint                                                  destinationEP;
+                    uint32_t                                                    destination = 0;
+                    uint16_t                                                    id          = 0;
+                    uint64_t                                                    stamp       = 0;
+                };
+                typedef ppp::unordered_map<uint16_t, Translation>               TranslationTable;
+                typedef std::pair<uint64_t, uint16_t>                           TranslationAging;   // stamp, translated identifier.
+
             public:
-                std::shared_ptr<Timer>                                          timeout;
-                std::shared_ptr<IcmpFrame>                                      frame;
-                std::shared_ptr<IPFrame>                                        packet;
-                std::shared_ptr<boost::asio::ip::udp::socket>                   socket;
-                int                                                             sockfd;
-                ppp::function<void(const boost::system::error_code&, size_t)>   callback;
-                std::weak_ptr<InternetControlMessageProtocol>                   reference_weak;
+                static constexpr int                                            AGING_INTERVAL = 1000;
 
             public:
-                InternetControlMessageProtocol_EchoAsynchronousContext() noexcept
-                    : sockfd(-1) {
+                InternetControlMessageProtocol_EchoEngine(const std::shared_ptr<boost::asio::io_context>& context) noexcept
+                    : context_(context)
+                    , socket_(*context) {
 
                 }
-                ~InternetControlMessageProtocol_EchoAsynchronousContext() noexcept {
-                    Release(this);
+                ~InternetControlMessageProtocol_EchoEngine() noexcept {
+                    std::shared_ptr<Timer> timer = std::move(timer_);
+                    if (NULL != timer) {
+                        timer->Dispose();
+                    }
+
+                    Socket::Closesocket(socket_);
+
+                    for (const auto& kv : translations_) {
+                        Release(kv.first);
+                    }
+
+                    SynchronizedObjectScope scope(syncobj_);
+                    auto tail = engines_.find(context_.get());
+                    if (tail != engines_.end() && tail->second.expired()) {
+                        engines_.erase(tail);
+                    }
                 }
 
             public:
-                static void                                                     Release(InternetControlMessageProtocol_EchoAsynchronousContext* context) noexcept {
-                    std::shared_ptr<Timer> timeout = std::move(context->timeout);
-                    if (timeout) {
-                        timeout->Dispose();
-                    }
-
-                    std::shared_ptr<boost::asio::ip::udp::socket> socket = std::move(context->socket);
-                    if (socket) {
-                        Closesocket(socket, context->sockfd);
-                    }
-
-                    std::weak_ptr<InternetControlMessageProtocol> reference_weak = std::move(context->reference_weak);
-                    context->sockfd = -1;
-                    context->frame.reset();
-                    context->packet.reset();
-                    context->socket.reset();
-                    context->timeout.reset();
-                    context->callback = NULL;
-                    context->reference_weak.reset();
-
-                    std::shared_ptr<InternetControlMessageProtocol> reference = reference_weak.lock();
-                    if (reference) {
-                        auto& timeouts = reference->timeouts_;
-                        auto tail = timeouts.find(context);
-                        auto endl = timeouts.end();
-                        if (tail != endl) {
-                            timeouts.erase(tail);
+                static std::shared_ptr<InternetControlMessageProtocol_EchoEngine> GetEngine(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, const std::shared_ptr<boost::asio::io_context>& context) noexcept {
+                    // Declared ahead of the lock so an engine that failed to open is destroyed after it is released.
+                    std::shared_ptr<InternetControlMessageProtocol_EchoEngine> engine;
+                    SynchronizedObjectScope scope(syncobj_);
+
+                    EchoEngineWeakPtr& weak = engines_[context.get()];
+                    engine = weak.lock();
+                    if (NULL != engine) {
+                        return engine;
+                    }
+
+                    engine = make_shared_object<InternetControlMessageProtocol_EchoEngine>(context);
+                    if (NULL == engine) {
+                        return NULL;
+                    }
+
+                    if (!engine->Open(allocator)) {
+                        engines_.erase(context.get());
+                        return NULL;
+                    }
+
+                    weak = engine;
+                    return engine;
+                }
+
+                bool                                                            Echo(
+                    InternetControlMessageProtocol*                             owner,
+                    const std::shared_ptr<IPFrame>&                             packet,
+                    const std::shared_ptr<IcmpFrame>&                           frame,
+                    const IPEndPoint&                                           destinationEP) noexcept {
+
+                    const std::shared_ptr<BufferSegment> messages = packet->Payload;
+                    if (messages->Length < (int)sizeof(struct ppp::net::native::icmp_hdr)) {
+                        return false;
+                    }
+
+                    if (translations_.size() >= UINT16_MAX) {
+                        return false;
+                    }
+
+                    uint16_t translated = Claim();
+                    if (translated == 0) {
+                        return false;
+                    }
+
+                    const int ttl = packet->Ttl;
+                    if (ttl != ttl_) {
+                        if (::setsockopt(socket_.native_handle(), IPPROTO_IP, IP_TTL, (char*)&ttl, sizeof(ttl))) {
+                            Release(translated);
+                            return false;
+                        }
+
+                        ttl_ = ttl;
+                    }
+
+                    // The identifier is rewritten in place, the request is not looked at again after this point.
+                    struct ppp::net::native::icmp_hdr* icmphdr = (struct ppp::net::native::icmp_hdr*)messages->Buffer.get();
+                    uint16_t id = icmphdr->icmp_id;
+                    ChecksumAdjust((Byte*)&icmphdr->icmp_chksum, (Byte*)&icmphdr->icmp_id, htons(translated));
+
+                    boost::system::error_code ec;
+                    boost::asio::ip::udp::endpoint remoteEP = IPEndPoint::WrapAddressV4<boost::asio::ip::udp>(packet->Destination, IPEndPoint::MaxPort);
+                    socket_.send_to(boost::asio::buffer(messages->Buffer.get(), messages->Length), remoteEP, 
+                        boost::asio::socket_base::message_end_of_record, ec);
+                    if (ec) {
+                        Release(translated);
+                        return false;
+                    }
+
+                    uint64_t now = Executors::GetTickCount();
+                    Translation& translation = translations_[translated];
+                    translation.owner = owner->shared_from_this();
+                    translation.packet = packet;
+                    translation.frame = frame;
+                    translation.destinationEP = destinationEP;
+                    translation.destination = packet->Destination;
+                    translation.id = id;
+                    translation.stamp = now;
+
+                    agings_.emplace_back(now, translated);
+                    return true;
+                }
+
+            private:
+                // Every raw ICMP socket sees every reply, so identifiers are claimed process-wide and never in flight on two engines at once.
+                static uint16_t                                                 Claim() noexcept {
+                    for (int i = 0; i < UINT16_MAX; i++) {
+                        uint16_t translated = ++next_id_;
+                        if (translated != 0 && !ids_[translated].exchange(true)) {
+                            return translated;
+                        }
+                    }
+
+                    return 0;
+                }
+
+                static void                                                     Release(uint16_t translated) noexcept {
+                    ids_[translated].store(false);
+                }
+
+                bool                                                            Open(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator) noexcept {
+                    const int sockfd = ::socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
+                    if (sockfd == -1) {
+                        return false; /* ::socket(AF_INET, SOCK_DGRAM, IPPROTO_ICMP); */
+                    }
+
+                    ppp::net::Socket::AdjustDefaultSocketOptional(sockfd, true);
+                    ppp::net::Socket::SetTypeOfService(sockfd);
+                    ppp::net::Socket::SetSignalPipeline(sockfd, false);
+                    ppp::net::Socket::ReuseSocketAddress(sockfd, true);
+
+                    boost::system::error_code ec;
+                    socket_.assign(boost::asio::ip::udp::v4(), sockfd, ec);
+                    if (ec) {
+                        Socket::Closesocket(sockfd);
+                        return false;
+                    }
+
+                    buffer_ = ppp::threading::BufferswapAllocator::MakeByteArray(allocator, PPP_BUFFER_SIZE);
+                    if (NULL == buffer_) {
+                        return false;
+                    }
+
+                    std::weak_ptr<InternetControlMessageProtocol_EchoEngine> weak = shared_from_this();
+                    timer_ = make_shared_object<Timer>(context_);
+                    if (NULL == timer_) {
+                        return false;
+                    }
+
+                    timer_->TickEvent = 
+                        [weak](Timer* sender, Timer::TickEventArgs& e) noexcept {
+                            std::shared_ptr<InternetControlMessageProtocol_EchoEngine> engine = weak.lock();
+                            if (NULL != engine) {
+                                engine->Aging(Executors::GetTickCount());
+                            }
+                        };
+                    timer_->SetInterval(AGING_INTERVAL);
+                    if (!timer_->Start()) {
+                        return false;
+                    }
+
+                    return Loopback();
+                }
+
+                // Table aging replaces the per-request timers, stamps only grow so the queue is in expiry order.
+                void                                                            Aging(uint64_t now) noexcept {
+                    while (!agings_.empty()) {
+                        const TranslationAging& aging = agings_.front();
+                        if ((now - aging.first) < (uint64_t)InternetControlMessageProtocol::MAX_ICMP_TIMEOUT) {
+                            break;
+                        }
+
+                        auto tail = translations_.find(aging.second);
+                        if (tail != translations_.end() && tail->second.stamp == aging.first) {
+                            Release(tail->first);
+                            translations_.erase(tail);
+                        }
+
+                        agings_.pop_front();
+                    }
+                }
+
+                bool                                                            Loopback() noexcept {
+                    if (!socket_.is_open()) {
+                        return false;
+                    }
+
+                    std::shared_ptr<Byte> buffer = buffer_;
+                    std::weak_ptr<InternetControlMessageProtocol_EchoEngine> weak = shared_from_this();
+                    socket_.async_receive_from(boost::asio::buffer(buffer.get(), PPP_BUFFER_SIZE), ep_, 
+                        [weak, buffer](const boost::system::error_code& ec, size_t sz) noexcept {
+                            if (ec == boost::system::errc::operation_canceled) {
+                                return;
+                            }
+
+                            std::shared_ptr<InternetControlMessageProtocol_EchoEngine> engine = weak.lock();
+                            if (NULL == engine) {
+                                return;
+                            }
+
+                            if (!ec) {
+                                engine->Demultiplex(buffer.get(), (int)sz);
+                            }
+
+                            engine->Loopback();
+                        });
+                    return true;
+                }
+
+                // Finds the translation a reply or a time-exceeded error belongs to and restores the original identifier.
+                void                                                            Demultiplex(Byte* buffer, int length) noexcept {
+                    int ihl = (buffer[0] & 0x0f) << 2;
+                    if (length < ihl + (int)sizeof(struct ppp::net::native::icmp_hdr)) {
+                        return;
+                    }
+
+                    struct ppp::net::native::icmp_hdr* icmphdr = (struct ppp::net::native::icmp_hdr*)(buffer + ihl);
+                    struct ppp::net::native::icmp_hdr* echohdr = NULL;
+                    if (icmphdr->icmp_type == IcmpType::ICMP_ER) {
+                        echohdr = icmphdr;
+                    }
+                    elif(icmphdr->icmp_type == IcmpType::ICMP_TE) {
+                        Byte* raw = (Byte*)(icmphdr + 1);
+                        int raw_ihl = (raw[0] & 0x0f) << 2;
+                        if (length < ihl + (int)sizeof(struct ppp::net::native::icmp_hdr) + raw_ihl + (int)sizeof(struct ppp::net::native::icmp_hdr)) {
+                            return;
+                        }
+
+                        echohdr = (struct ppp::net::native::icmp_hdr*)(raw + raw_ihl);
+                        if (echohdr->icmp_type != IcmpType::ICMP_ECHO) {
+                            return;
                         }
                     }
+                    else {
+                        return;
+                    }
+
+                    // Identifiers in flight on another engine are not in this table, their replies are dropped here.
+                    auto tail = translations_.find(ntohs(echohdr->icmp_id));
+                    if (tail == translations_.end()) {
+                        return;
+                    }
+
+                    Translation& translation = tail->second;
+                    if (echohdr == icmphdr) {
+                        uint32_t source;
+                        memcpy(&source, buffer + 12, sizeof(source));
+                        if (source != translation.destination) {
+                            return;
+                        }
+
+                        ChecksumAdjust((Byte*)&icmphdr->icmp_chksum, (Byte*)&icmphdr->icmp_id, translation.id);
+                    }
+                    else {
+                        // The quoted request sits inside the error message, so the outer checksum follows both quoted words.
+                        uint16_t chksum = echohdr->icmp_chksum;
+                        ChecksumAdjust((Byte*)&echohdr->icmp_chksum, (Byte*)&echohdr->icmp_id, translation.id);
+                        ChecksumAdjust((Byte*)&icmphdr->icmp_chksum, (Byte*)&chksum, echohdr->icmp_chksum);
+
+                        uint16_t id = htons(tail->first);
+                        ChecksumAdjust((Byte*)&icmphdr->icmp_chksum, (Byte*)&id, translation.id);
+                    }
+
+                    Translation request = std::move(translation);
+                    Release(tail->first);
+                    translations_.erase(tail);
+
+                    std::shared_ptr<InternetControlMessageProtocol> owner = request.owner.lock();
+                    if (NULL == owner) {
+                        return;
+                    }
+
+                    std::shared_ptr<IPFrame> response = IPFrame::Parse(owner->BufferAllocator, buffer, length);
+                    if (NULL != response) {
+                        owner->Replay(request.packet, request.frame, response, request.destinationEP);
+                    }
                 }
-            }                                                                   EchoAsynchronousContext;
+
+            private:
+                std::shared_ptr<boost::asio::io_context>                        context_;
+                boost::asio::ip::udp::socket                                    socket_;
+                boost::asio::ip::udp::endpoint                                  ep_;
+                std::shared_ptr<Byte>                                           buffer_;
+                std::shared_ptr<Timer>                                          timer_;
+                int                                                             ttl_     = -1;
+                TranslationTable                                                translations_;
+                ppp::list<TranslationAging>                                     agings_;
+
+            private:
+                static SynchronizedObject                                       syncobj_;
+                static EchoEngineTable                                          engines_;
+                static std::atomic<uint16_t>                                    next_id_;
+                static std::atomic<bool>                                        ids_[UINT16_MAX + 1];
+            };
+
+            InternetControlMessageProtocol_EchoEngine::SynchronizedObject       InternetControlMessageProtocol_EchoEngine::syncobj_;
+            InternetControlMessageProtocol_EchoEngine::EchoEngineTable          InternetControlMessageProtocol_EchoEngine::engines_;
+            std::atomic<uint16_t>                                               InternetControlMessageProtocol_EchoEngine::next_id_(0);
+            std::atomic<bool>                                                   InternetControlMessageProtocol_EchoEngine::ids_[UINT16_MAX + 1];
 
             InternetControlMessageProtocol::InternetControlMessageProtocol(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, const std::shared_ptr<boost::asio::io_context>& context) noexcept
                 : BufferAllocator(allocator)
                 , disposed_(false)
-                , executor_(context)
-                , buffer_(Executors::GetCachedBuffer(context)) {
+                , executor_(context) {
 
             }
 
@@ -99,7 +374,7 @@ namespace ppp {
 
             void InternetControlMessageProtocol::Finalize() noexcept {
                 disposed_ = true;
-                Dictionary::ReleaseAllCallbacks(timeouts_);
+                engine_.reset();
             }
 
             std::shared_ptr<InternetControlMessageProtocol> InternetControlMessageProtocol::GetReference() noexcept {
@@ -134,102 +409,17 @@ namespace ppp {
                     return false;
                 }
 
-                const int sockfd = ::socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
-                if (sockfd == -1) {
-                    return false; /* ::socket(AF_INET, SOCK_DGRAM, IPPROTO_ICMP); */
-                }
-                else {
-                    const int TTL = packet->Ttl;
-                    if (::setsockopt(sockfd, IPPROTO_IP, IP_TTL, (char*)&TTL, sizeof(TTL))) { // SOL_SOCKET, SO_SNDTIMEO, SO_RCVTIMEO
-                        Socket::Closesocket(sockfd);
+                std::shared_ptr<InternetControlMessageProtocol_EchoEngine> engine = engine_;
+                if (NULL == engine) {
+                    engine = InternetControlMessageProtocol_EchoEngine::GetEngine(BufferAllocator, executor_);
+                    if (NULL == engine) {
                         return false;
                     }
-                }
-
-                boost::system::error_code ec;
-                const std::shared_ptr<boost::asio::ip::udp::socket> socket = make_shared_object<boost::asio::ip::udp::socket>(*executor_);
-                if (!socket) {
-                    Socket::Closesocket(sockfd);
-                    return false;
-                }
-
-                ppp::net::Socket::AdjustDefaultSocketOptional(sockfd, packet->AddressesFamily == AddressFamily::InterNetwork);
-                ppp::net::Socket::SetTypeOfService(sockfd);
-                ppp::net::Socket::SetSignalPipeline(sockfd, false);
-                ppp::net::Socket::ReuseSocketAddress(sockfd, true);
-
-                socket->assign(boost::asio::ip::udp::v4(), sockfd, ec);
-                if (ec) {
-                    Closesocket(socket, sockfd);
-                    return false;
-                }
-
-                boost::asio::ip::udp::endpoint remoteEP = IPEndPoint::WrapAddressV4<boost::asio::ip::udp>(packet->Destination, IPEndPoint::MaxPort);
-                socket->send_to(boost::asio::buffer(messages->Buffer.get(), messages->Length), remoteEP, 
-                    boost::asio::socket_base::message_end_of_record, ec);
-                if (ec) {
-                    Closesocket(socket, sockfd);
-                    return false;
-                }
-
-                const std::shared_ptr<EchoAsynchronousContext> context = make_shared_object<EchoAsynchronousContext>();
-                if (!context) {
-                    Closesocket(socket, sockfd);
-                    return false;
-                }
 
-                const std::shared_ptr<InternetControlMessageProtocol> self = shared_from_this();
-                const std::weak_ptr<EchoAsynchronousContext> weak_context(context);
-                context->frame = frame;
-                context->packet = packet;
-                context->sockfd = sockfd;
-                context->socket = socket;
-                context->reference_weak = self;
-
-                const std::shared_ptr<TimeoutEventHandler> timeout_cb = make_shared_object<TimeoutEventHandler>(
-                    [self, weak_context] {
-                        const std::shared_ptr<EchoAsynchronousContext> context = weak_context.lock();
-                        if (context) {
-                            EchoAsynchronousContext::Release(context.get());
-                        }
-                    });
-                if (!timeout_cb) {
-                    Closesocket(socket, sockfd);
-                    return false;
+                    engine_ = engine;
                 }
 
-                context->timeout = Timer::Timeout(executor_, MAX_ICMP_TIMEOUT, *timeout_cb);
-                context->callback = [self, this, context, destinationEP](const boost::system::error_code& ec, size_t sz) noexcept {
-                    bool cleanup = true;
-                    do {
-                        if (ec) {
-                            break;
-                        }
-
-                        const std::shared_ptr<ppp::threading::BufferswapAllocator> allocator = this->BufferAllocator;
-                        const std::shared_ptr<IPFrame> response = IPFrame::Parse(allocator, buffer_.get(), (int)sz);
-                        if (response) {
-                            if (Replay(context->packet, context->frame, response, destinationEP)) {
-                                break;
-                            }
-                        }
-
-                        const std::shared_ptr<boost::asio::ip::udp::socket> socket = context->socket;
-                        if (!socket) {
-                            break;
-                        }
-
-                        cleanup = false;
-                        socket->async_receive_from(boost::asio::buffer(buffer_.get(), PPP_BUFFER_SIZE), ep_, context->callback);
-                    } while (false);
-
-                    if (cleanup) {
-                        EchoAsynchronousContext::Release(context.get());
-                    }
-                };
-
-                socket->async_receive_from(boost::asio::buffer(buffer_.get(), PPP_BUFFER_SIZE), ep_, context->callback);
-                return timeouts_.emplace(context.get(), timeout_cb).second;
+                return engine->Echo(this, packet, frame, destinationEP);
             }
 
             bool InternetControlMessageProtocol::Replay(
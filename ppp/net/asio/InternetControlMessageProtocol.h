@@ -9,17 +9,13 @@
 namespace ppp {
     namespace net {
         namespace asio {
-            class InternetControlMessageProtocol_EchoAsynchronousContext;
+            class InternetControlMessageProtocol_EchoEngine;
 
             // ICMP on Internet Control Message Protocol.
+            // Echo requests of every instance bound to the same io_context share one raw socket, the ICMP identifier is rewritten 
+            // On the way out and restored on the way back, outstanding requests are aged out of the translation table.
             class InternetControlMessageProtocol : public std::enable_shared_from_this<InternetControlMessageProtocol> {
-                friend class InternetControlMessageProtocol_EchoAsynchronousContext;
-
-            private:
-                typedef ppp::threading::Timer                                   Timer;
-                typedef Timer::TimeoutEventHandler                              TimeoutEventHandler;
-                typedef std::weak_ptr<TimeoutEventHandler>                      TimeoutEventHandlerWeakPtr;
-                typedef ppp::unordered_map<void*, TimeoutEventHandlerWeakPtr>   TimeoutEventHandlerTable;
+                friend class InternetControlMessageProtocol_EchoEngine;
 
             public:
                 typedef ppp::net::packet::IPFrame                               IPFrame;
@@ -64,10 +60,8 @@ namespace ppp {
 
             private:
                 bool                                                            disposed_ = false;
-                boost::asio::ip::udp::endpoint                                  ep_;
-                std::shared_ptr<Byte>                                           buffer_;
                 std::shared_ptr<boost::asio::io_context>                        executor_;
-                TimeoutEventHandlerTable                                        timeouts_;
+                std::shared_ptr<InternetControlMessageProtocol_EchoEngine>      engine_;
             };
         }
     }
@@ -58,13 +58,13 @@ namespace ppp {
                         }
 
                         if (handshaked_client) {
-                            ssl_context_ = ppp::ssl::SSL::CreateClientSslContext(ppp::ssl::SSL::SSL_METHOD::tlsv13, verify_peer_, ciphersuites_);
+                            ssl_context_ = ppp::ssl::SSL::GetClientSslContext(ppp::ssl::SSL::SSL_METHOD::tlsv13, verify_peer_, ciphersuites_);
                         }
                         elif(certificate_file_.empty() || certificate_key_file_.empty() || certificate_chain_file_.empty()) {
                             return false;
                         }
                         else {
-                            ssl_context_ = ppp::ssl::SSL::CreateServerSslContext(ppp::ssl::SSL::SSL_METHOD::tlsv13, certificate_file_, certificate_key_file_, certificate_chain_file_, certificate_key_password_, ciphersuites_);
+                            ssl_context_ = ppp::ssl::SSL::GetServerSslContext(ppp::ssl::SSL::SSL_METHOD::tlsv13, certificate_file_, certificate_key_file_, certificate_chain_file_, certificate_key_password_, ciphersuites_);
                         }
 
                         boost::system::error_code ec;
@@ -72,6 +72,8 @@ namespace ppp {
                             return false;
                         }
 
+                        // The session cache is keyed by the server port too, the socket is moved into the stream below.
+                        int port = tcpSocket->remote_endpoint(ec).port();
                         ssl_socket_ = make_shared_object<SslSocket>(std::move(*tcpSocket), *ssl_context_);
                         if (!ssl_socket_) {
                             return false;
@@ -82,6 +84,10 @@ namespace ppp {
                             if (!SSL_set_tlsext_host_name(GetSslHandle(), host_.data())) {
                                 return false; /* throw boost::system::system_error{ { static_cast<int>(::ERR_get_error()), boost::asio::error::get_ssl_category() } }; */
                             }
+
+                            if (handshaked_client) {
+                                ppp::ssl::SSL::ResumeClientSslSession(GetSslHandle(), host_, port);
+                            }
                         }
 
                         return PerformSslHandshake(handshaked_client, y);
@@ -35,6 +35,9 @@ namespace ppp {
                         , path_(path)
                         , websocket_(websocket) {
                         websocket_.binary(binary);
+
+                        // Send each tunnel frame as one websocket frame, beast otherwise splits messages at write_buffer_bytes (4 KB).
+                        websocket_.auto_fragment(false);
                     }
                     virtual ~WebSocket() noexcept = default;
 
@@ -2,6 +2,14 @@
 
 #include <ppp/stdafx.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define PPP_CHKSUM_SIMD 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PPP_CHKSUM_SIMD 1
+#endif
+
 #if _WIN32
 #include <winsock2.h>
 #else
@@ -35,39 +43,112 @@ namespace ppp {
                 return SetBitValueAt(b, offset, 1, value);
             }
 
+#if defined(PPP_CHKSUM_SIMD)
+#if defined(__AVX2__)
+            typedef __m256i                                 ip_chksum_vector;
+#define PPP_CHKSUM_LOAD(p)                                  _mm256_loadu_si256((const __m256i*)(p))
+#define PPP_CHKSUM_STORE(p, v)                              _mm256_storeu_si256((__m256i*)(p), v)
+#define PPP_CHKSUM_ADD(a, b)                                _mm256_add_epi32(a, b)
+#define PPP_CHKSUM_LOW(v, mask)                             _mm256_and_si256(v, mask)
+#define PPP_CHKSUM_HIGH(v)                                  _mm256_srli_epi32(v, 16)
+#define PPP_CHKSUM_SET1(x)                                  _mm256_set1_epi32(x)
+#define PPP_CHKSUM_ZERO()                                   _mm256_setzero_si256()
+#else
+            typedef __m128i                                 ip_chksum_vector;
+#define PPP_CHKSUM_LOAD(p)                                  _mm_loadu_si128((const __m128i*)(p))
+#define PPP_CHKSUM_STORE(p, v)                              _mm_storeu_si128((__m128i*)(p), v)
+#define PPP_CHKSUM_ADD(a, b)                                _mm_add_epi32(a, b)
+#define PPP_CHKSUM_LOW(v, mask)                             _mm_and_si128(v, mask)
+#define PPP_CHKSUM_HIGH(v)                                  _mm_srli_epi32(v, 16)
+#define PPP_CHKSUM_SET1(x)                                  _mm_set1_epi32(x)
+#define PPP_CHKSUM_ZERO()                                   _mm_setzero_si128()
+#endif
+
+            // Whole blocks of two vectors are split into the low and high 16-bit halves of every 32-bit lane and added into four independent 
+            // Accumulators, which are drained into the 64-bit sum before a lane can overflow.
+            inline uint64_t ip_standard_chksum_blocks(const unsigned char*& octetptr, int& len) noexcept {
+                static constexpr int VECTOR_SIZE = sizeof(ip_chksum_vector);
+                static constexpr int BLOCK_SIZE  = VECTOR_SIZE << 1;
+                static constexpr int MAX_BLOCKS  = 0xffff;
+
+                uint64_t acc = 0;
+                while (len >= BLOCK_SIZE) {
+                    int blocks = std::min<int>(len / BLOCK_SIZE, MAX_BLOCKS);
+                    len -= blocks * BLOCK_SIZE;
+
+                    ip_chksum_vector mask = PPP_CHKSUM_SET1(0xffff);
+                    ip_chksum_vector sums[4] = { PPP_CHKSUM_ZERO(), PPP_CHKSUM_ZERO(), PPP_CHKSUM_ZERO(), PPP_CHKSUM_ZERO() };
+                    for (int i = 0; i < blocks; i++, octetptr += BLOCK_SIZE) {
+                        ip_chksum_vector v = PPP_CHKSUM_LOAD(octetptr);
+                        ip_chksum_vector w = PPP_CHKSUM_LOAD(octetptr + VECTOR_SIZE);
+                        sums[0] = PPP_CHKSUM_ADD(sums[0], PPP_CHKSUM_LOW(v, mask));
+                        sums[1] = PPP_CHKSUM_ADD(sums[1], PPP_CHKSUM_HIGH(v));
+                        sums[2] = PPP_CHKSUM_ADD(sums[2], PPP_CHKSUM_LOW(w, mask));
+                        sums[3] = PPP_CHKSUM_ADD(sums[3], PPP_CHKSUM_HIGH(w));
+                    }
+
+                    for (ip_chksum_vector& sum : sums) {
+                        uint32_t lanes[VECTOR_SIZE / sizeof(uint32_t)];
+                        PPP_CHKSUM_STORE(lanes, sum);
+
+                        for (uint32_t lane : lanes) {
+                            acc += lane;
+                        }
+                    }
+                }
+                return acc;
+            }
+
+#undef PPP_CHKSUM_LOAD
+#undef PPP_CHKSUM_STORE
+#undef PPP_CHKSUM_ADD
+#undef PPP_CHKSUM_LOW
+#undef PPP_CHKSUM_HIGH
+#undef PPP_CHKSUM_SET1
+#undef PPP_CHKSUM_ZERO
+#endif
+
+            // The ones' complement sum does not depend on byte order (RFC 1071), so words are added as they lie in memory 
+            // And the folded sum is already in network order. Tails shorter than a SIMD block go through a 64-bit accumulator.
             inline unsigned short ip_standard_chksum(void* dataptr, int len) noexcept {
-                unsigned int acc;
-                unsigned short src;
-                unsigned char* octetptr;
-
-                acc = 0;
-                /* dataptr may be at odd or even addresses */
-                octetptr = (unsigned char*)dataptr;
-                while (len > 1) {
-                    /* declare first octet as most significant
-                       thus assume network order, ignoring host order */
-                    src = (unsigned short)((*octetptr) << 8);
-                    octetptr++;
-                    /* declare second octet as least significant */
-                    src |= (*octetptr);
-                    octetptr++;
+                const unsigned char* octetptr = (const unsigned char*)dataptr;
+                uint64_t acc = 0;
+
+#if defined(PPP_CHKSUM_SIMD)
+                // Draining the lanes costs more than it saves on headers and other short buffers.
+                if (len >= 256) {
+                    acc = ip_standard_chksum_blocks(octetptr, len);
+                }
+#endif
+                /* 32-bit words cannot overflow a 64-bit accumulator, the carries are folded back at the end */
+                while (len >= (int)sizeof(uint32_t)) {
+                    uint32_t src;
+                    memcpy(&src, octetptr, sizeof(src));
+                    octetptr += sizeof(src);
+                    len -= sizeof(src);
                     acc += src;
-                    len -= 2;
                 }
-                if (len > 0) {
-                    /* accumulate remaining octet */
-                    src = (unsigned short)((*octetptr) << 8);
+
+                if (len >= (int)sizeof(uint16_t)) {
+                    uint16_t src;
+                    memcpy(&src, octetptr, sizeof(src));
+                    octetptr += sizeof(src);
+                    len -= sizeof(src);
                     acc += src;
                 }
-                /* add deferred carry bits */
-                acc = (unsigned int)((acc >> 16) + (acc & 0x0000ffffUL));
-                if ((acc & 0xffff0000UL) != 0) {
-                    acc = (unsigned int)((acc >> 16) + (acc & 0x0000ffffUL));
+
+                if (len > 0) {
+                    /* the odd octet is the high half of a zero padded word */
+                    uint16_t src = 0;
+                    memcpy(&src, octetptr, 1);
+                    acc += src;
                 }
-                /* This maybe a little confusing: reorder sum using htons()
-                   instead of ntohs() since it has a little less call overhead.
-                   The caller must invert bits for Internet sum ! */
-                return ntohs((unsigned short)acc);
+
+                acc = (acc >> 32) + (acc & 0xffffffffULL);
+                acc = (acc >> 32) + (acc & 0xffffffffULL);
+                acc = (acc >> 16) + (acc & 0xffffULL);
+                acc = (acc >> 16) + (acc & 0xffffULL);
+                return (unsigned short)acc;
             }
 
             inline unsigned short inet_chksum(void* dataptr, int len) noexcept {
@@ -121,6 +202,41 @@ namespace ppp {
 
                 return inet_cksum_pseudo_base(payload, proto, proto_len, acc);
             }
+
+            // RFC 1624: HC' = ~(~HC + ~m + m'), the words only need to share the byte order of the checksum they patch.
+            inline unsigned short inet_chksum_adjust(unsigned short chksum, unsigned short old_word, unsigned short new_word) noexcept {
+                unsigned int acc = (unsigned short)~chksum;
+                acc += (unsigned short)~old_word;
+                acc += new_word;
+
+                acc = FOLD_U32T(acc);
+                acc = FOLD_U32T(acc);
+                return (unsigned short)~acc;
+            }
+
+            inline unsigned short inet_chksum_adjust32(unsigned short chksum, unsigned int old_dword, unsigned int new_dword) noexcept {
+                chksum = inet_chksum_adjust(chksum, (unsigned short)(old_dword & 0xffff), (unsigned short)(new_dword & 0xffff));
+                return inet_chksum_adjust(chksum, (unsigned short)(old_dword >> 16), (unsigned short)(new_dword >> 16));
+            }
+
+            // Accumulate the differences of several rewritten fields, then patch a checksum once with inet_chksum_adjust_delta.
+            inline unsigned int inet_chksum_delta(unsigned int delta, unsigned short old_word, unsigned short new_word) noexcept {
+                return delta + (unsigned short)~old_word + new_word;
+            }
+
+            inline unsigned int inet_chksum_delta32(unsigned int delta, unsigned int old_dword, unsigned int new_dword) noexcept {
+                delta = inet_chksum_delta(delta, (unsigned short)(old_dword & 0xffff), (unsigned short)(new_dword & 0xffff));
+                return inet_chksum_delta(delta, (unsigned short)(old_dword >> 16), (unsigned short)(new_dword >> 16));
+            }
+
+            inline unsigned short inet_chksum_adjust_delta(unsigned short chksum, unsigned int delta) noexcept {
+                unsigned int acc = FOLD_U32T(delta);
+                acc += (unsigned short)~chksum;
+
+                acc = FOLD_U32T(acc);
+                acc = FOLD_U32T(acc);
+                return (unsigned short)~acc;
+            }
         }
     }
 }
\ No newline at end of file
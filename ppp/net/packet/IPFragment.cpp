@@ -1,9 +1,8 @@
 #include <ppp/net/packet/IPFragment.h>
-#include <ppp/io/Stream.h>
-#include <ppp/io/MemoryStream.h>
-#include <ppp/collections/Dictionary.h>
+#include <ppp/diagnostics/Metrics.h>
+
+#include <bitset>
 
-using ppp::io::MemoryStream;
 using ppp::net::packet::IPFlags;
 using ppp::net::packet::IPFrame;
 using ppp::net::packet::BufferSegment;
@@ -15,130 +14,223 @@ namespace ppp {
                 Int128 key = (Int128)packet->Source;
                 key = key | ((Int128)packet->Destination) << 32;
                 key = key | ((Int128)packet->Id) << 64;
-                return true;
+                key = key | ((Int128)packet->ProtocolType) << 80;
+                return key;
             }
 
-            bool IPFragment::Input(const std::shared_ptr<IPFrame>& packet) noexcept {
-                if ((packet->Flags & IPFlags::IP_MF) != 0 || ((packet->Flags & IPFlags::IP_OFFMASK) != 0 && packet->GetFragmentOffset() > 0)) {
-                    std::shared_ptr<BufferSegment> payload = packet->Payload;
-                    if (NULL == payload || payload->Length <= 0) {
+            IPFragment::IPFragment(int max_subpackages, int max_memory, int finalize_time) noexcept
+                : max_memory_(std::max<int>(MAX_PAYLOAD, max_memory))
+                , finalize_time_(std::max<int>(1, finalize_time)) {
+                
+                max_subpackages = std::max<int>(1, max_subpackages);
+                slots_.resize(max_subpackages);
+                frees_.reserve(max_subpackages);
+                subpackages_.reserve(max_subpackages);
+
+                for (int i = max_subpackages - 1; i >= 0; i--) {
+                    frees_.emplace_back(i);
+                }
+            }
+
+            int IPFragment::NewSubpackage(const Int128& key, UInt64 now) noexcept {
+                if (frees_.empty()) {
+                    ppp::diagnostics::Metrics::Increment(ppp::diagnostics::Metrics::MetricsCounter_FragmentDrops);
+                    DeleteSubpackage(oldest_);
+                }
+
+                int slot = frees_.back();
+                frees_.pop_back();
+
+                Subpackage& subpackage = slots_[slot];
+                subpackage.Key = key;
+                subpackage.FinalizeTime = now + finalize_time_;
+                subpackage.Length = -1;
+                subpackage.Extent = 0;
+                subpackage.Received = 0;
+                memset(subpackage.Bitmap, 0, sizeof(subpackage.Bitmap));
+
+                subpackage.Next = -1;
+                subpackage.Prev = newest_;
+                if (newest_ < 0) {
+                    oldest_ = slot;
+                }
+                else {
+                    slots_[newest_].Next = slot;
+                }
+
+                newest_ = slot;
+                subpackages_.emplace(key, slot);
+                return slot;
+            }
+
+            void IPFragment::DeleteSubpackage(int slot) noexcept {
+                Subpackage& subpackage = slots_[slot];
+                if (subpackage.Prev < 0) {
+                    oldest_ = subpackage.Next;
+                }
+                else {
+                    slots_[subpackage.Prev].Next = subpackage.Next;
+                }
+
+                if (subpackage.Next < 0) {
+                    newest_ = subpackage.Prev;
+                }
+                else {
+                    slots_[subpackage.Next].Prev = subpackage.Prev;
+                }
+
+                memory_ -= subpackage.Capacity;
+                subpackage.Capacity = 0;
+                subpackage.Buffer.reset();
+                subpackage.Header.reset();
+
+                subpackages_.erase(subpackage.Key);
+                frees_.emplace_back(slot);
+            }
+
+            bool IPFragment::Reserve(int slot, int end) noexcept {
+                Subpackage& subpackage = slots_[slot];
+                if (end <= subpackage.Capacity) {
+                    return true;
+                }
+
+                // Until the last fragment tells the total length the buffer grows geometrically.
+                int capacity = subpackage.Length;
+                if (capacity < 0) {
+                    capacity = std::min<int>(MAX_PAYLOAD, std::max<int>(end, subpackage.Capacity << 1));
+                }
+
+                int growth = capacity - subpackage.Capacity;
+                while (memory_ + growth > max_memory_) {
+                    if (oldest_ == slot) {
                         return false;
                     }
 
-                    IPFramePtr originNew;
-                    Int128 key = FragmentKey(packet);
-                    do {
-                        std::shared_ptr<Subpackage> subpackage; {
-                            SynchronizedObjectScope scope(syncobj_);
-                            
-                            SubpackageTable::iterator tail = IPV4_SUBPACKAGES_.find(key);
-                            SubpackageTable::iterator endl = IPV4_SUBPACKAGES_.end();
-                            if (tail != endl) {
-                                subpackage = tail->second;
-                            }
-                            else {
-                                subpackage = make_shared_object<Subpackage>();
-                                if (NULL == subpackage) {
-                                    return false;
-                                }
-
-                                IPV4_SUBPACKAGES_.emplace(SubpackageTable::value_type(key, subpackage));
-                            }
-                        }
-
-                        ppp::vector<IPFramePtr>& frames = subpackage->Frames;
-                        size_t index = frames.size();
-                        if (index <= 0) {
-                            frames.emplace_back(packet);
-                        }
-                        else {
-                            while (index > 0) {
-                                IPFramePtr left = frames[index - 1];
-                                if (packet->GetFragmentOffset() >= left->GetFragmentOffset()) {
-                                    break;
-                                }
-                                else {
-                                    index--;
-                                }
-                            }
-                            frames.emplace(frames.begin() + index, packet);
-                        }
-
-                        int nextFragementOffset = 0;
-                        bool fullFragementOffset = true; {
-                            size_t count = frames.size();
-                            for (index = 0; index < count; index++) {
-                                IPFramePtr left = frames[index];
-                                if (left->GetFragmentOffset() != nextFragementOffset) {
-                                    fullFragementOffset = false;
-                                    break;
-                                }
-                                else {
-                                    nextFragementOffset = left->GetFragmentOffset() + left->Payload->Length;
-                                }
-                            }
-
-                            if (fullFragementOffset) {
-                                IPFramePtr left = frames[frames.size() - 1];
-                                if ((packet->Flags & IPFlags::IP_MF) == 0 &&
-                                    (packet->Flags & IPFlags::IP_OFFMASK) != 0 && left->GetFragmentOffset() > 0) {
-                                    left = frames[0]; {
-                                        SynchronizedObjectScope scope(syncobj_);
-                                        
-                                        SubpackageTable::iterator tail = IPV4_SUBPACKAGES_.find(key);
-                                        SubpackageTable::iterator endl = IPV4_SUBPACKAGES_.end();
-                                        if (tail != endl) {
-                                            IPV4_SUBPACKAGES_.erase(tail);
-                                        }
-                                    }
-
-                                    std::shared_ptr<ppp::threading::BufferswapAllocator> allocator = this->BufferAllocator;
-                                    std::shared_ptr<Byte> buffer = ppp::threading::BufferswapAllocator::MakeByteArray(allocator, nextFragementOffset);
-                                    if (NULL == buffer) {
-                                        return false;
-                                    }
-
-                                    MemoryStream ms(buffer, nextFragementOffset);
-                                    for (index = 0, count = frames.size(); index < count; index++) {
-                                        std::shared_ptr<BufferSegment> payload = frames[index]->Payload;
-                                        ms.Write(payload->Buffer.get(), 0, payload->Length);
-                                    }
-
-                                    originNew = make_shared_object<IPFrame>();
-                                    if (NULL == originNew) {
-                                        return false;
-                                    }
-
-                                    std::shared_ptr<BufferSegment> packet_payload = make_shared_object<BufferSegment>(buffer, nextFragementOffset);
-                                    if (NULL == packet_payload) {
-                                        return false;
-                                    }
-                                    
-                                    originNew->AddressesFamily = left->AddressesFamily;
-                                    originNew->ProtocolType = left->ProtocolType;
-                                    originNew->Source = left->Source;
-                                    originNew->Destination = left->Destination;
-                                    originNew->Payload = packet_payload;
-                                    originNew->Id = left->Id;
-                                    originNew->Options = left->Options;
-                                    originNew->Tos = left->Tos;
-                                    originNew->Ttl = left->Ttl;
-                                    originNew->Flags = IPFlags::IP_DF;
-                                    originNew->SetFragmentOffset(0);
-                                }
-                            }
-                        }
-                    } while (false);
-
-                    if (NULL != originNew) {
-                        PacketInputEventArgs e{ originNew };
-                        OnInput(e);
-                    }
-                    return true;
+                    ppp::diagnostics::Metrics::Increment(ppp::diagnostics::Metrics::MetricsCounter_FragmentDrops);
+                    DeleteSubpackage(oldest_);
                 }
-                else {
+
+                std::shared_ptr<ppp::threading::BufferswapAllocator> allocator = this->BufferAllocator;
+                std::shared_ptr<Byte> buffer = ppp::threading::BufferswapAllocator::MakeByteArray(allocator, capacity);
+                if (NULL == buffer) {
+                    return false;
+                }
+
+                if (subpackage.Received > 0) {
+                    memcpy(buffer.get(), subpackage.Buffer.get(), subpackage.Capacity);
+                }
+
+                memory_ += growth;
+                subpackage.Buffer = buffer;
+                subpackage.Capacity = capacity;
+                return true;
+            }
+
+            bool IPFragment::Input(const std::shared_ptr<IPFrame>& packet) noexcept {
+                using Metrics = ppp::diagnostics::Metrics;
+
+                bool more = (packet->Flags & IPFlags::IP_MF) != 0;
+                int offset = packet->GetFragmentOffset();
+                if (!more && offset == 0) {
                     return false;
                 }
+
+                std::shared_ptr<BufferSegment> payload = packet->Payload;
+                if (NULL == payload || payload->Length <= 0) {
+                    return false;
+                }
+
+                // Every fragment but the last one carries a multiple of eight octets.
+                int end = offset + payload->Length;
+                if (end > MAX_PAYLOAD || (more && (payload->Length & 7) != 0)) {
+                    Metrics::Increment(Metrics::MetricsCounter_FragmentDrops);
+                    return true;
+                }
+
+                IPFramePtr originNew; {
+                    SynchronizedObjectScope scope(syncobj_);
+
+                    Int128 key = FragmentKey(packet);
+                    int slot = -1;
+
+                    SubpackageTable::iterator tail = subpackages_.find(key);
+                    if (tail != subpackages_.end()) {
+                        slot = tail->second;
+                    }
+                    else {
+                        slot = NewSubpackage(key, ppp::threading::Executors::GetTickCount());
+                    }
+
+                    Subpackage& subpackage = slots_[slot];
+                    // A fragment past the end, or a second end that disagrees, poisons the whole datagram.
+                    bool conflicts = more ? subpackage.Length >= 0 && end > subpackage.Length : 
+                        (subpackage.Length >= 0 ? subpackage.Length != end : subpackage.Extent > end);
+                    if (conflicts) {
+                        Metrics::Increment(Metrics::MetricsCounter_FragmentDrops);
+                        DeleteSubpackage(slot);
+                        return true;
+                    }
+
+                    if (!more) {
+                        subpackage.Length = end;
+                    }
+
+                    if (!Reserve(slot, end)) {
+                        Metrics::Increment(Metrics::MetricsCounter_FragmentDrops);
+                        DeleteSubpackage(slot);
+                        return true;
+                    }
+
+                    memcpy(subpackage.Buffer.get() + offset, payload->Buffer.get(), payload->Length);
+                    subpackage.Extent = std::max<int>(subpackage.Extent, end);
+                    if (offset == 0) {
+                        subpackage.Header = packet;
+                    }
+
+                    // Mark the 8-octet units [first, last) and count the ones not seen before, overlaps are rewritten but not counted twice.
+                    int first = offset >> 3;
+                    int last = (end + 7) >> 3;
+                    while (first < last) {
+                        int bit = first & 63;
+                        int bits = std::min<int>(64 - bit, last - first);
+                        uint64_t mask = (bits == 64 ? UINT64_MAX : ((1ULL << bits) - 1)) << bit;
+
+                        uint64_t& word = subpackage.Bitmap[first >> 6];
+                        subpackage.Received += (int)std::bitset<64>(mask & ~word).count();
+                        word |= mask;
+                        first += bits;
+                    }
+
+                    if (NULL == subpackage.Header || subpackage.Length < 0 || subpackage.Received != (subpackage.Length + 7) >> 3) {
+                        return true;
+                    }
+
+                    std::shared_ptr<BufferSegment> packet_payload = make_shared_object<BufferSegment>(subpackage.Buffer, subpackage.Length);
+                    originNew = make_shared_object<IPFrame>();
+
+                    IPFramePtr left = subpackage.Header;
+                    DeleteSubpackage(slot);
+
+                    if (NULL == packet_payload || NULL == originNew) {
+                        return true;
+                    }
+
+                    originNew->AddressesFamily = left->AddressesFamily;
+                    originNew->ProtocolType = left->ProtocolType;
+                    originNew->Source = left->Source;
+                    originNew->Destination = left->Destination;
+                    originNew->Payload = packet_payload;
+                    originNew->Id = left->Id;
+                    originNew->Options = left->Options;
+                    originNew->Tos = left->Tos;
+                    originNew->Ttl = left->Ttl;
+                    originNew->Flags = IPFlags::IP_DF;
+                    originNew->SetFragmentOffset(0);
+                }
+
+                PacketInputEventArgs e{ originNew };
+                OnInput(e);
+                return true;
             }
 
             bool IPFragment::Output(const IPFrame* packet) noexcept {
@@ -182,16 +274,26 @@ namespace ppp {
                 PacketOutput.reset();
 
                 SynchronizedObjectScope scope(syncobj_);
-                IPV4_SUBPACKAGES_.clear();
+                while (oldest_ >= 0) {
+                    DeleteSubpackage(oldest_);
+                }
             }
 
             int IPFragment::Update(uint64_t now) noexcept {
+                // Slots are linked in arrival order with the same lifetime, so only the expired head needs to be looked at.
+                int events = 0;
                 SynchronizedObjectScope scope(syncobj_);
-                return ppp::collections::Dictionary::PredicateAllObjects(
-                    [now](const Subpackage::Ptr& subpackage) noexcept {
-                        return now >= subpackage->FinalizeTime || 
-                            (subpackage->FinalizeTime > Subpackage::MAX_FINALIZE_TIME && now <= Subpackage::MAX_FINALIZE_TIME);
-                    }, IPV4_SUBPACKAGES_);
+
+                while (oldest_ >= 0 && now >= slots_[oldest_].FinalizeTime) {
+                    DeleteSubpackage(oldest_);
+                    events++;
+                }
+
+                if (events > 0) {
+                    ppp::diagnostics::Metrics::Add(ppp::diagnostics::Metrics::MetricsCounter_FragmentTimeouts, events);
+                }
+
+                return events;
             }
 
             void IPFragment::OnInput(PacketInputEventArgs& e) noexcept {
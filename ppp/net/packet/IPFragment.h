@@ -2,6 +2,7 @@
 
 #include <ppp/stdafx.h>
 #include <ppp/Int128.h>
+#include <ppp/collections/FlowTable.h>
 #include <ppp/net/packet/IPFrame.h>
 #include <ppp/threading/Executors.h>
 #include <ppp/threading/BufferswapAllocator.h>
@@ -9,24 +10,38 @@
 namespace ppp {
     namespace net {
         namespace packet {
+            // Reassembles IPv4 fragments into a bounded table of preallocated slots, payloads are written straight into one buffer per datagram 
+            // And holes are tracked in a bitmap of 8-octet units. When the slots or the memory cap run out the oldest datagram is evicted.
             class IPFragment {
             private:
                 typedef std::shared_ptr<IPFrame>                                    IPFramePtr;
-                struct Subpackage {
-                public:
-                    typedef std::shared_ptr<Subpackage>                             Ptr;
 
-                public:
-                    Subpackage() noexcept : FinalizeTime(ppp::threading::Executors::GetTickCount() + Subpackage::MAX_FINALIZE_TIME) {}
+            public:
+                static constexpr int                                                MAX_FINALIZE_TIME   = 1000;
+                static constexpr int                                                MAX_SUBPACKAGES     = 128;
+                static constexpr int                                                MAX_MEMORY          = 4 * 1024 * 1024;
+                static constexpr int                                                MAX_PAYLOAD         = UINT16_MAX - 20; /* ip_hdr::IP_HLEN */
 
+            private:
+                struct Subpackage {
                 public:
+                    Int128                                                          Key;
                     UInt64                                                          FinalizeTime = 0;
-                    ppp::vector<IPFramePtr>                                         Frames;
-
-                public:
-                    static const int                                                MAX_FINALIZE_TIME = 1;
+                    IPFramePtr                                                      Header;             // The fragment at offset zero.
+                    std::shared_ptr<Byte>                                           Buffer;
+                    int                                                             Capacity     = 0;
+                    int                                                             Length       = -1;  // Known once the last fragment arrived.
+                    int                                                             Extent       = 0;   // Furthest octet written so far.
+                    int                                                             Received     = 0;   // 8-octet units present.
+                    int                                                             Prev         = -1;
+                    int                                                             Next         = -1;
+                    uint64_t                                                        Bitmap[(MAX_PAYLOAD / 8 + 63) / 64];
                 };
-                typedef ppp::unordered_map<Int128, Subpackage::Ptr>                 SubpackageTable;
+                typedef ppp::collections::FlowTable<Int128, int>                    SubpackageTable;
+
+            public:
+                IPFragment(int max_subpackages = MAX_SUBPACKAGES, int max_memory = MAX_MEMORY, int finalize_time = MAX_FINALIZE_TIME) noexcept;
+                virtual ~IPFragment() noexcept = default;
 
             public:
                 typedef std::mutex                                                  SynchronizedObject;
@@ -56,9 +71,21 @@ namespace ppp {
                 virtual void                                                        OnInput(PacketInputEventArgs& e) noexcept;
                 virtual void                                                        OnOutput(PacketOutputEventArgs& e) noexcept;
 
+            private:
+                int                                                                 NewSubpackage(const Int128& key, UInt64 now) noexcept;
+                void                                                                DeleteSubpackage(int slot) noexcept;
+                bool                                                                Reserve(int slot, int end) noexcept;
+
             private:
                 SynchronizedObject                                                  syncobj_;
-                SubpackageTable                                                     IPV4_SUBPACKAGES_;
+                const int                                                           max_memory_;
+                const int                                                           finalize_time_;
+                int                                                                 memory_ = 0;
+                int                                                                 oldest_ = -1;       // Slots in arrival order, the head expires first.
+                int                                                                 newest_ = -1;
+                ppp::vector<Subpackage>                                             slots_;
+                ppp::vector<int>                                                    frees_;
+                SubpackageTable                                                     subpackages_;
             };
         }
     }
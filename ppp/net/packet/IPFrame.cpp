@@ -93,7 +93,7 @@ namespace ppp {
                 frame->Ttl = iphdr->ttl;
                 frame->AddressesFamily = AddressFamily::InterNetwork;
                 frame->ProtocolType = iphdr->proto;
-                frame->Id = ntohl(iphdr->id);
+                frame->Id = ntohs(iphdr->id);
                 frame->Flags = (IPFlags)ntohs(iphdr->flags);
 
                 int iphdr_hlen = ip_hdr::IPH_HL(iphdr) << 2;
@@ -0,0 +1,150 @@
+#include <ppp/net/packet/PacketView.h>
+#include <ppp/net/native/checksum.h>
+
+using namespace ppp::net::native;
+
+namespace ppp {
+    namespace net {
+        namespace packet {
+            static unsigned short ReadWord(const void* p) noexcept {
+                unsigned short w;
+                memcpy(&w, p, sizeof(w));
+                return w;
+            }
+
+            static void AdjustChecksum(Byte* chksum, unsigned short old_word, unsigned short new_word, bool udp) noexcept {
+                unsigned short hc = ReadWord(chksum);
+                if (udp && hc == 0) {
+                    return; /* The sender did not compute one. */
+                }
+
+                hc = inet_chksum_adjust(hc, old_word, new_word);
+                if (udp && hc == 0) {
+                    hc = 0xffff;
+                }
+
+                memcpy(chksum, &hc, sizeof(hc));
+            }
+
+            bool PacketView::Parse(void* packet, int length) noexcept {
+                ip_ = NULL;
+                udp_ = NULL;
+                icmp_ = NULL;
+                length_ = 0;
+                hlen_ = 0;
+
+                ip_hdr* iphdr = ip_hdr::Parse(packet, length);
+                if (NULL == iphdr) {
+                    return false;
+                }
+
+                int hlen = ip_hdr::IPH_HL(iphdr) << 2;
+                Byte* payload = (Byte*)iphdr + hlen;
+                int payload_length = length - hlen;
+
+                // Only the first fragment carries the transport header.
+                if ((ntohs(iphdr->flags) & ip_hdr::IP_OFFMASK) == 0) {
+                    int proto = ip_hdr::IPH_PROTO(iphdr);
+                    if (proto == ip_hdr::IP_PROTO_UDP) {
+                        if ((ntohs(iphdr->flags) & ip_hdr::IP_MF) == 0) {
+                            udp_ = udp_hdr::Parse(iphdr, payload, payload_length);
+                            if (NULL == udp_) {
+                                return false;
+                            }
+                        }
+                    }
+                    elif(proto == ip_hdr::IP_PROTO_ICMP) {
+                        if ((ntohs(iphdr->flags) & ip_hdr::IP_MF) == 0) {
+                            icmp_ = icmp_hdr::Parse(iphdr, payload, payload_length);
+                            if (NULL == icmp_) {
+                                return false;
+                            }
+                        }
+                    }
+                }
+
+                ip_ = iphdr;
+                length_ = length;
+                hlen_ = hlen;
+                return true;
+            }
+
+            Byte* PacketView::GetTransportChecksum() const noexcept {
+                if (IsFragment()) {
+                    return NULL;
+                }
+
+                int proto = ip_->proto;
+                if (proto == ip_hdr::IP_PROTO_UDP) {
+                    return NULL != udp_ ? (Byte*)udp_ + offsetof(udp_hdr, chksum) : NULL;
+                }
+                elif(proto == ip_hdr::IP_PROTO_TCP) {
+                    static constexpr int TCP_CHKSUM_OFFSET = 16;
+
+                    return GetPayloadLength() >= TCP_CHKSUM_OFFSET + 2 ? GetPayload() + TCP_CHKSUM_OFFSET : NULL;
+                }
+                else {
+                    return NULL;
+                }
+            }
+
+            void PacketView::SetTtl(int ttl) noexcept {
+                // TTL and protocol share one 16-bit word of the header.
+                Byte* word = (Byte*)&ip_->ttl;
+                unsigned short old_word = ReadWord(word);
+
+                ip_->ttl = (unsigned char)ttl;
+                AdjustChecksum((Byte*)&ip_->chksum, old_word, ReadWord(word), false);
+            }
+
+            void PacketView::SetAddress(void* field, uint32_t address) noexcept {
+                uint32_t old_address;
+                memcpy(&old_address, field, sizeof(old_address));
+                memcpy(field, &address, sizeof(address));
+
+                // The address is in the IP header and in the pseudo header of the TCP and UDP checksums.
+                const Byte* old_words = (Byte*)&old_address;
+                const Byte* new_words = (Byte*)&address;
+
+                Byte* l4 = GetTransportChecksum();
+                bool udp = ip_->proto == ip_hdr::IP_PROTO_UDP;
+                for (int i = 0; i < 4; i += 2) {
+                    unsigned short old_word = ReadWord(old_words + i);
+                    unsigned short new_word = ReadWord(new_words + i);
+
+                    AdjustChecksum((Byte*)&ip_->chksum, old_word, new_word, false);
+                    if (NULL != l4) {
+                        AdjustChecksum(l4, old_word, new_word, udp);
+                    }
+                }
+            }
+
+            void PacketView::SetSource(uint32_t address) noexcept {
+                SetAddress(&ip_->src, address);
+            }
+
+            void PacketView::SetDestination(uint32_t address) noexcept {
+                SetAddress(&ip_->dest, address);
+            }
+
+            void PacketView::SetPort(void* field, int port) noexcept {
+                unsigned short old_port = ReadWord(field);
+                unsigned short new_port = htons((unsigned short)port);
+                memcpy(field, &new_port, sizeof(new_port));
+
+                Byte* l4 = GetTransportChecksum();
+                if (NULL != l4) {
+                    AdjustChecksum(l4, old_port, new_port, true);
+                }
+            }
+
+            void PacketView::SetSourcePort(int port) noexcept {
+                SetPort((Byte*)udp_ + offsetof(udp_hdr, src), port);
+            }
+
+            void PacketView::SetDestinationPort(int port) noexcept {
+                SetPort((Byte*)udp_ + offsetof(udp_hdr, dest), port);
+            }
+        }
+    }
+}
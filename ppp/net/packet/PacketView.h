@@ -0,0 +1,69 @@
+#pragma once
+
+#include <ppp/stdafx.h>
+#include <ppp/net/native/ip.h>
+#include <ppp/net/native/udp.h>
+#include <ppp/net/native/icmp.h>
+
+namespace ppp {
+    namespace net {
+        namespace packet {
+            // Non-owning view over an IPv4 datagram in a caller owned buffer, parsing it allocates and copies nothing.
+            // Fields are rewritten in place and the checksums covering them are adjusted incrementally (RFC 1624).
+            class PacketView final {
+            public:
+                typedef ppp::net::native::ip_hdr                        ip_hdr;
+                typedef ppp::net::native::udp_hdr                       udp_hdr;
+                typedef ppp::net::native::icmp_hdr                      icmp_hdr;
+
+            public:
+                PacketView() noexcept = default;
+                PacketView(void* packet, int length) noexcept { Parse(packet, length); }
+
+            public:
+                bool                                                    Parse(void* packet, int length) noexcept;
+                bool                                                    IsValid() const noexcept          { return NULL != ip_; }
+                bool                                                    IsFragment() const noexcept       { return (ntohs(ip_->flags) & (ip_hdr::IP_MF | ip_hdr::IP_OFFMASK)) != 0; }
+
+            public:
+                ip_hdr*                                                 GetIPHeader() const noexcept      { return ip_; }
+                Byte*                                                   GetBuffer() const noexcept        { return (Byte*)ip_; }
+                int                                                     GetLength() const noexcept        { return length_; }
+                int                                                     GetProtocol() const noexcept      { return ip_->proto; }
+                int                                                     GetTtl() const noexcept           { return ip_->ttl; }
+                uint32_t                                                GetSource() const noexcept        { return ip_->src; }
+                uint32_t                                                GetDestination() const noexcept   { return ip_->dest; }
+                Byte*                                                   GetPayload() const noexcept       { return (Byte*)ip_ + hlen_; }
+                int                                                     GetPayloadLength() const noexcept { return length_ - hlen_; }
+
+            public:
+                // Only set on the first (or only) fragment of a UDP or ICMP datagram.
+                udp_hdr*                                                GetUdpHeader() const noexcept     { return udp_; }
+                icmp_hdr*                                               GetIcmpHeader() const noexcept    { return icmp_; }
+                int                                                     GetSourcePort() const noexcept    { return ntohs(udp_->src); }
+                int                                                     GetDestinationPort() const noexcept { return ntohs(udp_->dest); }
+                Byte*                                                   GetUdpPayload() const noexcept    { return (Byte*)(udp_ + 1); }
+                int                                                     GetUdpPayloadLength() const noexcept { return GetPayloadLength() - (int)sizeof(udp_hdr); }
+
+            public:
+                void                                                    SetTtl(int ttl) noexcept;
+                void                                                    SetSource(uint32_t address) noexcept;
+                void                                                    SetDestination(uint32_t address) noexcept;
+                void                                                    SetSourcePort(int port) noexcept;
+                void                                                    SetDestinationPort(int port) noexcept;
+
+            private:
+                void                                                    SetAddress(void* field, uint32_t address) noexcept;
+                void                                                    SetPort(void* field, int port) noexcept;
+                Byte*                                                   GetTransportChecksum() const noexcept;
+
+            private:
+                ip_hdr*                                                 ip_     = NULL;
+                udp_hdr*                                                udp_    = NULL;
+                icmp_hdr*                                               icmp_   = NULL;
+                int                                                     length_ = 0;
+                int                                                     hlen_   = 0;
+            };
+        }
+    }
+}
@@ -41,246 +41,439 @@ namespace ppp {
                     strncasecmp(data, "PATCH ", 6) == 0;
             }
 
-            bool sniproxy::be_host(ppp::string host, ppp::string domain) noexcept {
-                if (host.empty() || domain.empty()) {
+            bool sniproxy::be_host(const ppp::string& host, const char* domain, int domain_length) noexcept {
+                int host_length = (int)host.size();
+                if (host_length < 1 || !domain || domain_length < 1) {
                     return false;
                 }
 
-                domain = ToLower(domain);
-                host = ToLower(host);
-
                 // Direct hit
-                if (strcmp(domain.data(), host.data()) == 0) {
+                if (host_length == domain_length && strncasecmp(host.data(), domain, domain_length) == 0) {
                     return true;
                 }
 
-                // Segment hit
-                ppp::vector<ppp::string> lables;
-                if (Tokenize<ppp::string>(domain, lables, ".") < 3) {
-                    return false;
-                }
+                // Segment hit, the domain must have at least three non-empty labels.
+                int lables_count = 1;
+                for (int i = 0; i < domain_length; i++) {
+                    if (domain[i] != '.') {
+                        continue;
+                    }
 
-                size_t lables_count = lables.size();
-                for (size_t i = 0; i < lables_count; i++) {
-                    const ppp::string& label = lables[i];
-                    if (label.empty()) {
+                    if (i == 0 || i == domain_length - 1 || domain[i - 1] == '.') {
                         return false;
                     }
+
+                    lables_count++;
                 }
 
-                for (size_t i = 1, l = lables_count - 1; i < l; i++) {
-                    ppp::string next;
-                    for (size_t j = i; j < lables_count; j++) {
-                        if (next.empty()) {
-                            next += lables[j];
-                        }
-                        else {
-                            next += "." + lables[j];
-                        }
+                if (lables_count < 3) {
+                    return false;
+                }
+
+                // Compare the host against every suffix that starts after the first label and keeps at least two labels.
+                for (int i = 0, lable_index = 0; i < domain_length; i++) {
+                    if (domain[i] != '.') {
+                        continue;
+                    }
+
+                    if (++lable_index > lables_count - 2) {
+                        break;
                     }
 
-                    if (strcmp(next.data(), host.data()) == 0) {
+                    int next_length = domain_length - (i + 1);
+                    if (next_length == host_length && strncasecmp(host.data(), domain + i + 1, next_length) == 0) {
                         return true;
                     }
                 }
                 return false;
             }
 
-            bool sniproxy::do_tlsvd_handshake(const boost::asio::yield_context& y, MemoryStream& messages_) noexcept {
-                struct tls_hdr* hdr = (struct tls_hdr*)local_socket_buf_;
-                if (hdr->Content_Type != 0x16) { // Handshake
+            int sniproxy::tls_reassemble_client_hello(const Byte* packet, int packet_length, int& packet_offset, Byte* handshake, int handshake_size, int& handshake_length) noexcept {
+                if (!packet || !handshake || packet_offset < 0 || handshake_length < 0 || handshake_size < 4) {
+                    return -1;
+                }
+
+                // Each call only walks the records that have not been consumed yet, so the total cost stays linear in the first flight.
+                while ((packet_length - packet_offset) >= TLS_RECORD_HEADER_SIZE) {
+                    const Byte* record = packet + packet_offset;
+                    if (record[0] != 0x16 || record[1] != 0x03) { // Handshake, TLS 1.x
+                        return -1;
+                    }
+
+                    int record_length = record[3] << 8 | record[4];
+                    if (record_length < 1 || record_length > TLS_RECORD_MAX_SIZE) {
+                        return -1;
+                    }
+
+                    if ((packet_length - packet_offset) < (TLS_RECORD_HEADER_SIZE + record_length)) {
+                        break;
+                    }
+
+                    if ((handshake_length + record_length) > handshake_size) {
+                        return -1;
+                    }
+
+                    memcpy(handshake + handshake_length, record + TLS_RECORD_HEADER_SIZE, record_length);
+                    handshake_length += record_length;
+                    packet_offset += TLS_RECORD_HEADER_SIZE + record_length;
+
+                    if (handshake[0] != 0x01) { // Handshake Type: Client Hello (1)
+                        return -1;
+                    }
+
+                    if (handshake_length < 4) {
+                        continue;
+                    }
+
+                    int message_length = 4 + (handshake[1] << 16 | handshake[2] << 8 | handshake[3]);
+                    if (message_length > handshake_size) {
+                        return -1;
+                    }
+
+                    if (handshake_length >= message_length) {
+                        return message_length;
+                    }
+                }
+                return 0;
+            }
+
+            bool sniproxy::tls_fetch_client_hello(const Byte* handshake, int handshake_length, tls_client_hello& hello) noexcept {
+                hello = tls_client_hello();
+                if (!handshake || handshake_length < 4 || handshake[0] != 0x01) {
                     return false;
                 }
 
-                size_t tls_payload = ntohs(hdr->Length);
-                if (!tls_payload) {
+                const Byte* data = handshake + 4;
+                const Byte* data_end = data + (handshake[1] << 16 | handshake[2] << 8 | handshake[3]);
+                if (data_end > handshake + handshake_length) {
                     return false;
                 }
 
-                if (!ppp::net::asio::async_read(*local_socket_, boost::asio::buffer(local_socket_buf_, tls_payload), y)) {
+                // Skip Version, Random.
+                if ((data_end - data) < 34) {
                     return false;
                 }
                 else {
-                    messages_.Write(local_socket_buf_, 0, (int)tls_payload);
+                    data += 34;
                 }
 
-                ppp::string hostname_ = fetch_sniaddr(tls_payload);
-                return do_connect_and_forward_to_host(y, hostname_, configuration_->websocket.listen.wss, 443, messages_);
-            }
+                // Skip Session ID.
+                if ((data_end - data) < 1 || (data_end - data - 1) < data[0]) {
+                    return false;
+                }
+                else {
+                    data += 1 + data[0];
+                }
 
-            bool sniproxy::do_httpd_handshake(const boost::asio::yield_context& y, MemoryStream& messages_) noexcept {
-                if (!do_read_http_request_headers(y, messages_)) {
+                // Skip Cipher Suites.
+                if ((data_end - data) < 2) {
                     return false;
                 }
+                else {
+                    int Cipher_Suites_Length = data[0] << 8 | data[1];
+                    if ((data_end - data - 2) < Cipher_Suites_Length) {
+                        return false;
+                    }
 
-                int port_;
-                ppp::string hostname_;
-                if (!do_httpd_handshake_host_trim(messages_, hostname_, port_)) {
+                    data += 2 + Cipher_Suites_Length;
+                }
+
+                // Skip Compression Methods.
+                if ((data_end - data) < 1 || (data_end - data - 1) < data[0]) {
                     return false;
                 }
-                return do_connect_and_forward_to_host(y, hostname_, do_forward_websocket_port(), port_, messages_);
-            }
+                else {
+                    data += 1 + data[0];
+                }
 
-            bool sniproxy::do_httpd_handshake_host_trim(MemoryStream& messages_, ppp::string& host, int& port) noexcept {
-                port = 80;
-                host = do_httpd_handshake_host(messages_);
-                if (host.empty()) {
+                // Extensions are optional in a ClientHello, without them there is no SNI either.
+                if ((data_end - data) < 2) {
                     return false;
                 }
 
-                host = RTrim(LTrim(host));
-                if (host.empty()) {
+                int Extensions_Length = data[0] << 8 | data[1];
+                data += 2;
+
+                if ((data_end - data) < Extensions_Length) {
                     return false;
                 }
 
-                std::size_t index = host.find(":");
-                if (index == ppp::string::npos) {
-                    return true;
+                const Byte* Extensions_End = data + Extensions_Length;
+                while ((Extensions_End - data) >= 4) {
+                    int Extension_Type = data[0] << 8 | data[1];
+                    int Extension_Length = data[2] << 8 | data[3];
+                    data += 4;
+
+                    if ((Extensions_End - data) < Extension_Length) {
+                        return false;
+                    }
+
+                    const Byte* Extension_Data = data;
+                    const Byte* Extension_End = data + Extension_Length;
+                    data = Extension_End;
+
+                    if (Extension_Type == 0x0000) { // RFC4366/6066(Server Name Indication extension)
+                        if ((Extension_End - Extension_Data) < 2) {
+                            return false;
+                        }
+
+                        const Byte* Server_Name_List_End = Extension_Data + 2 + (Extension_Data[0] << 8 | Extension_Data[1]);
+                        if (Server_Name_List_End > Extension_End) {
+                            return false;
+                        }
+
+                        Extension_Data += 2;
+                        while ((Server_Name_List_End - Extension_Data) >= 3) {
+                            int Server_Name_Type = Extension_Data[0];
+                            int Server_Name_Length = Extension_Data[1] << 8 | Extension_Data[2];
+                            Extension_Data += 3;
+
+                            if ((Server_Name_List_End - Extension_Data) < Server_Name_Length) {
+                                return false;
+                            }
+
+                            if (Server_Name_Type == 0x00 && Server_Name_Length > 0) { // RFC6066 NameType::host_name(0)
+                                hello.sni = (char*)Extension_Data;
+                                hello.sni_length = Server_Name_Length;
+                                break;
+                            }
+
+                            Extension_Data += Server_Name_Length;
+                        }
+                    }
+                    elif(Extension_Type == 0x0010) { // RFC7301(Application-Layer Protocol Negotiation extension), the first protocol offered.
+                        if ((Extension_End - Extension_Data) < 3) {
+                            return false;
+                        }
+
+                        const Byte* Protocol_Name_List_End = Extension_Data + 2 + (Extension_Data[0] << 8 | Extension_Data[1]);
+                        if (Protocol_Name_List_End > Extension_End) {
+                            return false;
+                        }
+
+                        int Protocol_Name_Length = Extension_Data[2];
+                        if ((Protocol_Name_List_End - Extension_Data - 3) < Protocol_Name_Length) {
+                            return false;
+                        }
+
+                        hello.alpn = (char*)Extension_Data + 3;
+                        hello.alpn_length = Protocol_Name_Length;
+                    }
+                }
+                return hello.sni_length > 0;
+            }
+
+            int sniproxy::http_fetch_headers_end(const char* data, int length, int offset) noexcept {
+                if (!data) {
+                    return -1;
+                }
+
+                // Resume three bytes back so that a "\r\n\r\n" split across two reads is still found.
+                for (int i = std::max<int>(0, offset - 3); (i + 4) <= length; i++) {
+                    if (data[i] == '\r' && data[i + 1] == '\n' && data[i + 2] == '\r' && data[i + 3] == '\n') {
+                        return i + 4;
+                    }
                 }
+                return -1;
+            }
+
+            bool sniproxy::http_fetch_host(const char* headers, int length, const char*& host, int& host_length, int& port) noexcept {
+                host = NULL;
+                host_length = 0;
+                port = 80;
 
-                ppp::string hoststr = host.substr(0, index);
-                if (hoststr.empty()) {
+                if (!headers || length < 4) {
                     return false;
                 }
 
-                ppp::string portstr = host.substr(index + 1);
-                if (portstr.empty()) {
+                const char* p = headers;
+                const char* p_end = headers + length;
+
+                // GET / HTTP/1.1
+                const char* line_end = p;
+                while (line_end < p_end && *line_end != '\r') {
+                    line_end++;
+                }
+
+                const char* method_end = (char*)memchr(p, ' ', line_end - p);
+                if (!method_end) {
                     return false;
                 }
 
-                portstr = RTrim(LTrim(portstr));
-                if (portstr.empty()) {
+                const char* url = method_end + 1;
+                const char* url_end = (char*)memchr(url, ' ', line_end - url);
+                if (!url_end || url == url_end) {
                     return false;
                 }
 
-                port = atoi(portstr.data());
-                if (port <= IPEndPoint::MinPort || port > IPEndPoint::MaxPort) {
+                const char* protocol = url_end + 1;
+                if ((line_end - protocol) != 8 ||
+                    (strncasecmp(protocol, "HTTP/1.0", 8) != 0 &&
+                        strncasecmp(protocol, "HTTP/1.1", 8) != 0 &&
+                        strncasecmp(protocol, "HTTP/2.0", 8) != 0)) {
                     return false;
                 }
 
-                host = std::move(hoststr);
-                return true;
-            }
+                if (*url != '/') {
+                    if ((url_end - url) > 7 && strncasecmp(url, "http://", 7) == 0) {
+                        const char* authority = url + 7;
+                        const char* authority_end = (char*)memchr(authority, '/', url_end - authority);
+                        if (!authority_end || authority == authority_end) {
+                            return false;
+                        }
 
-            ppp::string sniproxy::do_httpd_handshake_host(MemoryStream& messages_) noexcept {
-                int headers_size = messages_.GetPosition();
-                if (headers_size < 4) {
-                    return "";
+                        host = authority;
+                        host_length = (int)(authority_end - authority);
+                    }
                 }
 
-                ppp::vector<ppp::string> headers;
-                if (Tokenize<ppp::string>(ppp::string((char*)messages_.GetBuffer().get(), headers_size), headers, "\r\n") < 1) {
-                    return "";
-                }
+                for (p = line_end + 2; !host && p < p_end; p = line_end + 2) {
+                    line_end = p;
+                    while (line_end < p_end && *line_end != '\r') {
+                        line_end++;
+                    }
 
-                // GET / HTTP/1.1
-                ppp::vector<ppp::string> protocols;
-                if (Tokenize<ppp::string>(headers[0], protocols, " ") < 3) {
-                    return "";
-                }
-                else {
-                    ppp::string protocol = ToUpper(protocols[2]);
-                    if (protocol != "HTTP/1.0" &&
-                        protocol != "HTTP/1.1" &&
-                        protocol != "HTTP/2.0") {
-                        return "";
+                    if (line_end == p) {
+                        break;
                     }
 
-                    const ppp::string& url_or_path = protocols[1];
-                    if (url_or_path.empty()) {
-                        return "";
+                    const char* colon = (char*)memchr(p, ':', line_end - p);
+                    if (!colon || colon == p) {
+                        return false;
                     }
 
-                    if (url_or_path[0] != '/') {
-                        ppp::string url = ToLower(url_or_path);
-                        do {
-                            std::size_t leftIndex = url.find("://");
-                            if (leftIndex == ppp::string::npos) {
-                                break;
-                            }
+                    if ((colon - p) == 4 && strncasecmp(p, "HOST", 4) == 0) {
+                        host = colon + 1;
+                        host_length = (int)(line_end - host);
+                    }
+                }
 
-                            ppp::string schema = url.substr(0, leftIndex);
-                            if (schema != "http") {
-                                break;
-                            }
-                            else {
-                                leftIndex += 3;
-                            }
+                // Trim the value and split off an optional port.
+                while (host_length > 0 && (*host == ' ' || *host == '\t')) {
+                    host++;
+                    host_length--;
+                }
 
-                            std::size_t nextIndex = url.find("/", leftIndex);
-                            if (nextIndex == ppp::string::npos) {
-                                return "";
-                            }
+                while (host_length > 0 && (host[host_length - 1] == ' ' || host[host_length - 1] == '\t')) {
+                    host_length--;
+                }
 
-                            std::size_t hostCount = nextIndex - leftIndex;
-                            if (!hostCount) {
-                                return "";
-                            }
+                if (host_length < 1) {
+                    return false;
+                }
 
-                            return protocols[1].substr(leftIndex, hostCount);
-                        } while (false);
-                    }
+                const char* colon = (char*)memchr(host, ':', host_length);
+                if (!colon) {
+                    return true;
                 }
 
-                for (size_t i = 1, header_count = headers.size(); i < header_count; i++) {
-                    const ppp::string& header = headers[i];
-                    if (header.empty()) {
-                        return "";
-                    }
+                const char* port_end = host + host_length;
+                if (colon == host || (colon + 1) == port_end || (port_end - colon) > 6) {
+                    return false;
+                }
 
-                    std::size_t leftIndex = header.find(": ");
-                    if (!leftIndex || leftIndex == ppp::string::npos) {
-                        return "";
+                int port_ = 0;
+                for (const char* i = colon + 1; i < port_end; i++) {
+                    if (*i < '0' || *i > '9') {
+                        return false;
                     }
 
-                    std::size_t rightIndex = leftIndex + 2;
-                    if (rightIndex > header.size()) {
-                        return "";
-                    }
+                    port_ = port_ * 10 + (*i - '0');
+                }
 
-                    ppp::string key = ToUpper(header.substr(0, leftIndex));
-                    if (key == "HOST") {
-                        return header.substr(rightIndex);
-                    }
+                if (port_ <= IPEndPoint::MinPort || port_ > IPEndPoint::MaxPort) {
+                    return false;
                 }
-                return "";
+
+                port = port_;
+                host_length = (int)(colon - host);
+                return true;
             }
 
-            bool sniproxy::do_read_http_request_headers(const boost::asio::yield_context& y, MemoryStream& messages_) noexcept {
+            bool sniproxy::do_read_some(const boost::asio::yield_context& y, int& length) noexcept {
+                if (length < 0 || length >= FORWARD_MSS) {
+                    return false;
+                }
+
                 boost::system::error_code ec_;
-                boost::asio::streambuf response_;
-                size_t length_;
                 try {
-                    length_ = boost::asio::async_read_until(*local_socket_, response_, "\r\n\r\n", y[ec_]);
-                    if (ec_) {
+                    std::size_t bytes_transferred = local_socket_->async_read_some(boost::asio::buffer(remote_socket_buf_ + length, FORWARD_MSS - length), y[ec_]);
+                    if (ec_ || !bytes_transferred) {
                         return false;
                     }
 
-                    if (!length_) {
+                    length += (int)bytes_transferred;
+                    return true;
+                }
+                catch (const std::exception&) {
+                    return false;
+                }
+            }
+
+            bool sniproxy::do_tlsvd_handshake(const boost::asio::yield_context& y, int length) noexcept {
+                // The raw first flight is kept in remote_socket_buf_ for forwarding, the ClientHello is reassembled in local_socket_buf_.
+                int packet_offset_ = 0;
+                int handshake_length_ = 0;
+                int handshake_size_ = 0;
+                for (;;) {
+                    handshake_size_ = tls_reassemble_client_hello((Byte*)remote_socket_buf_, length, packet_offset_, (Byte*)local_socket_buf_, FORWARD_MSS, handshake_length_);
+                    if (handshake_size_ < 0) {
+                        return false;
+                    }
+                    elif(handshake_size_ > 0) {
+                        break;
+                    }
+                    elif(!do_read_some(y, length)) {
                         return false;
                     }
                 }
-                catch (const std::exception&) {
+
+                tls_client_hello hello_;
+                if (!tls_fetch_client_hello((Byte*)local_socket_buf_, handshake_size_, hello_)) {
                     return false;
                 }
 
-                boost::asio::const_buffers_1 buff_ = response_.data();
-                messages_.Write(buff_.data(), 0, (int)length_);
-                return true;
+                return do_connect_and_forward_to_host(y, hello_.sni, hello_.sni_length, configuration_->websocket.listen.wss, 443, length);
+            }
+
+            bool sniproxy::do_httpd_handshake(const boost::asio::yield_context& y, int length) noexcept {
+                int headers_size_ = http_fetch_headers_end(remote_socket_buf_, length, 0);
+                while (headers_size_ < 0) {
+                    int offset_ = length;
+                    if (!do_read_some(y, length)) {
+                        return false;
+                    }
+
+                    headers_size_ = http_fetch_headers_end(remote_socket_buf_, length, offset_);
+                }
+
+                int port_;
+                int hostname_length_;
+                const char* hostname_;
+                if (!http_fetch_host(remote_socket_buf_, headers_size_, hostname_, hostname_length_, port_)) {
+                    return false;
+                }
+
+                return do_connect_and_forward_to_host(y, hostname_, hostname_length_, do_forward_websocket_port(), port_, length);
             }
 
-            bool sniproxy::do_connect_and_forward_to_host(const boost::asio::yield_context& y, const ppp::string hostname_, int self_websocket_port, int forward_connect_port, MemoryStream& messages_) noexcept {
-                if (hostname_.empty() ||
+            bool sniproxy::do_connect_and_forward_to_host(const boost::asio::yield_context& y, const char* hostname, int hostname_length, int self_websocket_port, int forward_connect_port, int messages_size) noexcept {
+                if (!hostname || hostname_length < 1 || hostname_length > TLS_HOSTNAME_MAX_SIZE ||
                     forward_connect_port <= IPEndPoint::MinPort ||
                     forward_connect_port > IPEndPoint::MaxPort) {
                     return false;
                 }
 
+                // The hostname points into one of the forwarding buffers, copy it out before they are reused.
+                char hostname_[TLS_HOSTNAME_MAX_SIZE + 1];
+                memcpy(hostname_, hostname, hostname_length);
+                hostname_[hostname_length] = '\x0';
+
                 boost::system::error_code ec_;
                 boost::asio::ip::address address_;
                 boost::asio::ip::tcp::endpoint remoteEP_;
 
-                if (be_host(configuration_->websocket.host, hostname_)) {
+                if (be_host(configuration_->websocket.host, hostname_, hostname_length)) {
                     if (self_websocket_port <= IPEndPoint::MinPort ||
                         self_websocket_port > IPEndPoint::MaxPort) {
                         return false;
@@ -290,9 +483,9 @@ namespace ppp {
                     remoteEP_ = boost::asio::ip::tcp::endpoint(address_, self_websocket_port);
                 }
                 else {
-                    address_ = StringToAddress(hostname_.data(), ec_);
+                    address_ = StringToAddress(hostname_, ec_);
                     if (ec_) {
-                        address_ = ppp::net::asio::GetAddressByHostName(*resolver_, hostname_.data(), IPEndPoint::MinPort, y).address();
+                        address_ = ppp::net::asio::GetAddressByHostName(*resolver_, hostname_, IPEndPoint::MinPort, y).address();
                     }
 
                     if (IPEndPoint::IsInvalid(address_) || address_.is_loopback()) {
@@ -336,12 +529,11 @@ namespace ppp {
                 ppp::net::Socket::ReuseSocketAddress(handle_, true);
 
                 // [CONNECT]SSL VPN
-                if (ppp::net::asio::async_connect(remote_socket_, remoteEP_, y)) {
+                if (!ppp::net::asio::async_connect(remote_socket_, remoteEP_, y)) {
                     return false;
                 }
 
-                std::shared_ptr<Byte> buff_ = messages_.GetBuffer();
-                if (!ppp::net::asio::async_write(remote_socket_, boost::asio::buffer(buff_.get(), messages_.GetPosition()), y)) {
+                if (!ppp::net::asio::async_write(remote_socket_, boost::asio::buffer(remote_socket_buf_, messages_size), y)) {
                     return false;
                 }
 
@@ -360,101 +552,22 @@ namespace ppp {
                 }
             }
 
-            UInt16 sniproxy::fetch_uint16(Byte*& data) noexcept {
-                int r_ = data[0] << 8 | data[1];
-                data += 2;
-                return r_;
-            }
-
-            int sniproxy::fetch_length(Byte*& data) noexcept {
-                int r_ = data[0] << 16 | data[1] << 8 | data[2];
-                data += 3;
-                return r_;
-            }
-
-            ppp::string sniproxy::fetch_sniaddr(size_t tls_payload) noexcept {
-                Byte* data = (Byte*)local_socket_buf_;
-                if (*data++ != 0x01) { // Handshake Type: Client Hello (1)
-                    return "";
-                }
-
-                int Length = std::max<int>(0, fetch_length(data));
-                if ((Length + 4) != tls_payload) {
-                    return "";
-                }
-
-                // Skip Version
-                data += 2;
-
-                // Skip Random
-                data += 32;
-
-                // Skip Session ID
-                Byte Session_ID_Length = std::max<int>((Byte)0, *data++);
-                data += Session_ID_Length;
-
-                // Skip Cipher Suites
-                int Cipher_Suites_Length = std::max<int>(0, fetch_uint16(data));
-                data += Cipher_Suites_Length;
-
-                // Skip Compression Methods Length
-                int Compression_Methods_Length = *data++;
-                data += Compression_Methods_Length;
-
-                // Extensions Length
-                int Extensions_Length = std::max<int>(0, fetch_uint16(data));
-                Byte* Extensions_End = data + Extensions_Length;
-                while (data < Extensions_End) {
-                    int Extension_Type = fetch_uint16(data);
-                    int Extension_Length = std::max<int>(0, fetch_uint16(data));
-                    if (Extension_Type == 0x0000) { // RFC4366/6066(Server Name Indication extension)
-                        int Server_Name_list_length = std::max<int>(0, fetch_uint16(data));
-                        if ((data + Server_Name_list_length) >= Extensions_End) {
-                            break;
-                        }
-
-                        int Server_Name_Type = *data++;
-                        if (Server_Name_Type != 0x00) { // RFC6066 NameType::host_name(0)
-                            data += 2;
-                            continue;
-                        }
-
-                        int Server_Name_length = std::max<int>(0, fetch_uint16(data));
-                        if ((data + Server_Name_length) > Extensions_End) {
-                            break;
-                        }
-                        return ppp::string((char*)data, 0, Server_Name_length);
-                    }
-                    else {
-                        data += Extension_Length;
-                    }
-                }
-                return "";
-            }
-
             bool sniproxy::do_handshake(const boost::asio::yield_context& y) noexcept {
-                const int header_size_ = sizeof(struct tls_hdr);
-                if (!ppp::net::asio::async_read(*local_socket_, boost::asio::buffer(local_socket_buf_, header_size_), y)) {
+                // Eight bytes are enough to tell a TLS record header from the longest HTTP method prefix.
+                const int header_size_ = 8;
+                if (!ppp::net::asio::async_read(*local_socket_, boost::asio::buffer(remote_socket_buf_, header_size_), y)) {
                     return false;
                 }
 
-                MemoryStream messages_;
-                messages_.Write(local_socket_buf_, 0, header_size_);
-
-                if (do_tlsvd_handshake(y, messages_)) {
-                    return true;
+                if (remote_socket_buf_[0] == 0x16) { // Handshake
+                    return do_tlsvd_handshake(y, header_size_);
                 }
-
-                if (!ppp::net::asio::async_read(*local_socket_, boost::asio::buffer(local_socket_buf_ + header_size_, 3), y)) {
-                    return false;
+                elif(be_http(remote_socket_buf_)) {
+                    return do_httpd_handshake(y, header_size_);
                 }
-
-                messages_.Write(local_socket_buf_, header_size_, 3);
-                if (!be_http(local_socket_buf_)) {
+                else {
                     return false;
                 }
-
-                return do_httpd_handshake(y, messages_);
             }
 
             bool sniproxy::socket_is_open() noexcept {
@@ -1,7 +1,6 @@
 #pragma once
 
 #include <ppp/stdafx.h>
-#include <ppp/io/MemoryStream.h>
 #include <ppp/net/IPEndPoint.h>
 #include <ppp/threading/Timer.h>
 #include <ppp/configurations/AppConfiguration.h>
@@ -10,16 +9,19 @@ namespace ppp {
     namespace net {
         namespace proxies {
             class sniproxy final : public std::enable_shared_from_this<sniproxy> {
-                typedef ppp::io::MemoryStream                                       MemoryStream;
                 typedef ppp::threading::Timer                                       Timer;
-#pragma pack(push, 1)       
-                struct tls_hdr {        
-                    Byte                                                            Content_Type = 0;
-                    UInt16                                                          Version      = 0;
-                    UInt16                                                          Length       = 0;
-                };      
-#pragma pack(pop)       
-                static const int                                                    FORWARD_MSS = 65536;
+                static const int                                                    FORWARD_MSS            = 65536;
+                static const int                                                    TLS_RECORD_HEADER_SIZE = 5;
+                static const int                                                    TLS_RECORD_MAX_SIZE    = 16384;
+                static const int                                                    TLS_HOSTNAME_MAX_SIZE  = 255;
+
+            public:
+                struct tls_client_hello {
+                    const char*                                                     sni         = NULL;
+                    int                                                             sni_length  = 0;
+                    const char*                                                     alpn        = NULL;
+                    int                                                             alpn_length = 0;
+                };
 
             public:
                 sniproxy(int                                                        cdn, 
@@ -32,26 +34,30 @@ namespace ppp {
             public:
                 void                                                                close() noexcept;
                 bool                                                                handshake() noexcept;
-        
+
+            public:
+                /* Consumes the complete TLS records in packet[packet_offset, packet_length) and appends their handshake fragments to the handshake buffer.
+                 * Returns the ClientHello message size once it has been fully reassembled, 0 if more records are required, or -1 if the input is malformed.
+                 */
+                static int                                                          tls_reassemble_client_hello(const Byte* packet, int packet_length, int& packet_offset, Byte* handshake, int handshake_size, int& handshake_length) noexcept;
+                static bool                                                         tls_fetch_client_hello(const Byte* handshake, int handshake_length, tls_client_hello& hello) noexcept;
+                static int                                                          http_fetch_headers_end(const char* data, int length, int offset) noexcept;
+                static bool                                                         http_fetch_host(const char* headers, int length, const char*& host, int& host_length, int& port) noexcept;
+                static bool                                                         be_http(const void* p) noexcept;
+                static bool                                                         be_host(const ppp::string& host, const char* domain, int domain_length) noexcept;
+
             private:        
                 void                                                                clear_timeout() noexcept;
-                UInt16                                                              fetch_uint16(Byte*& data) noexcept;
-                int                                                                 fetch_length(Byte*& data) noexcept;
-                ppp::string                                                         fetch_sniaddr(size_t tls_payload) noexcept;
                 bool                                                                do_handshake(const boost::asio::yield_context& y) noexcept;
+                bool                                                                do_read_some(const boost::asio::yield_context& y, int& length) noexcept;
                 bool                                                                socket_is_open() noexcept;
                 bool                                                                local_to_remote() noexcept;
                 bool                                                                remote_to_local() noexcept;
         
             private:        
-                static bool                                                         be_http(const void* p) noexcept;
-                static bool                                                         be_host(ppp::string host, ppp::string domain) noexcept;
-                bool                                                                do_tlsvd_handshake(const boost::asio::yield_context& y, MemoryStream& messages_) noexcept;
-                bool                                                                do_httpd_handshake(const boost::asio::yield_context& y, MemoryStream& messages_) noexcept;
-                bool                                                                do_httpd_handshake_host_trim(MemoryStream& messages_, ppp::string& host, int& port) noexcept;
-                ppp::string                                                         do_httpd_handshake_host(MemoryStream& messages_) noexcept;
-                bool                                                                do_read_http_request_headers(const boost::asio::yield_context& y, MemoryStream& messages_) noexcept;
-                bool                                                                do_connect_and_forward_to_host(const boost::asio::yield_context& y, const ppp::string hostname_, int self_websocket_port, int forward_connect_port, MemoryStream& messages_) noexcept;
+                bool                                                                do_tlsvd_handshake(const boost::asio::yield_context& y, int length) noexcept;
+                bool                                                                do_httpd_handshake(const boost::asio::yield_context& y, int length) noexcept;
+                bool                                                                do_connect_and_forward_to_host(const boost::asio::yield_context& y, const char* hostname, int hostname_length, int self_websocket_port, int forward_connect_port, int messages_size) noexcept;
                 int                                                                 do_forward_websocket_port() noexcept;
         
             private:        
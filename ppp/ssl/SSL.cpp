@@ -4,6 +4,21 @@
 
 namespace ppp {
     namespace ssl {
+        static constexpr int                                                        SSL_CONTEXT_CHECK_INTERVAL  = 1000;
+        static constexpr int                                                        SSL_SESSION_MAX_HOSTS       = 1024;
+        static const int                                                            SSL_SESSION_PORT_INDEX      = SSL_get_ex_new_index(0, NULL, NULL, NULL, NULL);
+
+        typedef struct {
+            std::shared_ptr<boost::asio::ssl::context>                              context;
+            int64_t                                                                 last_write_times[3];
+            uint64_t                                                                next_check;
+        }                                                                           SSL_ServerContext;
+
+        static std::mutex                                                           SSL_syncobj;
+        static ppp::unordered_map<ppp::string, SSL_ServerContext>                   SSL_server_contexts;
+        static ppp::unordered_map<ppp::string, std::shared_ptr<boost::asio::ssl::context>/**/> SSL_client_contexts;
+        static ppp::unordered_map<ppp::string, std::shared_ptr<SSL_SESSION>/**/>    SSL_client_sessions;
+
         boost::asio::ssl::context::method SSL::SSL_S_METHOD(int method) noexcept {
             switch (method) {
             case SSL_METHOD::tlsv13:
@@ -183,6 +198,149 @@ namespace ppp {
             return ssl_context;
         }
 
+        static void SSL_GetLastWriteTimes(const std::string& certificate_file, const std::string& certificate_key_file, const std::string& certificate_chain_file, int64_t last_write_times[3]) noexcept {
+            last_write_times[0] = ppp::io::File::GetLastWriteTime(certificate_file.data());
+            last_write_times[1] = ppp::io::File::GetLastWriteTime(certificate_key_file.data());
+            last_write_times[2] = ppp::io::File::GetLastWriteTime(certificate_chain_file.data());
+        }
+
+        std::shared_ptr<boost::asio::ssl::context> SSL::GetServerSslContext(
+            int                                         method,
+            const std::string&                          certificate_file,
+            const std::string&                          certificate_key_file,
+            const std::string&                          certificate_chain_file,
+            const std::string&                          certificate_key_password,
+            const std::string&                          ciphersuites) noexcept {
+
+            ppp::string key = stl::to_string<ppp::string>(method) + "|" + certificate_file.data() + "|" + certificate_key_file.data() + "|" + 
+                certificate_chain_file.data() + "|" + certificate_key_password.data() + "|" + ciphersuites.data();
+
+            uint64_t now = ppp::GetTickCount();
+            std::lock_guard<std::mutex> scope(SSL_syncobj);
+
+            SSL_ServerContext* entry = NULL;
+            if (auto tail = SSL_server_contexts.find(key); tail != SSL_server_contexts.end()) {
+                entry = &tail->second;
+                if (now < entry->next_check) {
+                    return entry->context;
+                }
+            }
+
+            // The files are looked at no more than once a second, the handshake path does not touch the disk otherwise.
+            int64_t last_write_times[3];
+            SSL_GetLastWriteTimes(certificate_file, certificate_key_file, certificate_chain_file, last_write_times);
+            if (NULL != entry) {
+                entry->next_check = now + SSL_CONTEXT_CHECK_INTERVAL;
+                if (memcmp(entry->last_write_times, last_write_times, sizeof(last_write_times)) == 0) {
+                    return entry->context;
+                }
+            }
+
+            std::shared_ptr<boost::asio::ssl::context> ssl_context = CreateServerSslContext(method, certificate_file, certificate_key_file, certificate_chain_file, certificate_key_password, ciphersuites);
+            if (NULL == ssl_context) {
+                return NULL != entry ? entry->context : NULL;
+            }
+
+            SSL_CTX* ssl_ctx = ssl_context->native_handle();
+            SSL_CTX_set_session_id_context(ssl_ctx, (const unsigned char*)PPP_APPLICATION_NAME, (unsigned int)strlen(PPP_APPLICATION_NAME));
+            SSL_CTX_set_session_cache_mode(ssl_ctx, SSL_SESS_CACHE_SERVER);
+
+            if (NULL == entry) {
+                entry = &SSL_server_contexts[key];
+                entry->next_check = now + SSL_CONTEXT_CHECK_INTERVAL;
+            }
+            else {
+                // Carry the ticket keys over so tickets issued under the old certificate still resume.
+                unsigned char ticket_keys[80];
+                if (SSL_CTX_get_tlsext_ticket_keys(entry->context->native_handle(), ticket_keys, sizeof(ticket_keys)) > 0) {
+                    SSL_CTX_set_tlsext_ticket_keys(ssl_ctx, ticket_keys, sizeof(ticket_keys));
+                }
+
+                OPENSSL_cleanse(ticket_keys, sizeof(ticket_keys));
+            }
+
+            memcpy(entry->last_write_times, last_write_times, sizeof(last_write_times));
+            entry->context = ssl_context;
+            return ssl_context;
+        }
+
+        // A session only resumes on the client context that made it and against the same host and port, a context with other verify
+        // or cipher settings, or another server behind the same name, never gets it offered.
+        static ppp::string SSL_ClientSessionKey(::SSL* ssl, const char* host, int port) noexcept {
+            return stl::to_string<ppp::string>((uint64_t)(uintptr_t)SSL_get_SSL_CTX(ssl)) + "|" + host + ":" + stl::to_string<ppp::string>(port);
+        }
+
+        static int SSL_NewClientSession(::SSL* ssl, SSL_SESSION* session) noexcept {
+            const char* host = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+            if (NULL == host || *host == '\x0') {
+                return 0;
+            }
+
+            int port = (int)(intptr_t)SSL_get_ex_data(ssl, SSL_SESSION_PORT_INDEX);
+            if (port < 1) {
+                return 0;
+            }
+
+            ppp::string key = SSL_ClientSessionKey(ssl, host, port);
+            std::shared_ptr<SSL_SESSION> ssl_session = std::shared_ptr<SSL_SESSION>(session, SSL_SESSION_free);
+            std::lock_guard<std::mutex> scope(SSL_syncobj);
+            if (SSL_client_sessions.size() >= SSL_SESSION_MAX_HOSTS) {
+                SSL_client_sessions.clear();
+            }
+
+            SSL_client_sessions[key] = std::move(ssl_session);
+            return 1; /* The callback keeps the reference. */
+        }
+
+        std::shared_ptr<boost::asio::ssl::context> SSL::GetClientSslContext(
+            int                                         method,
+            bool                                        verify_peer,
+            const std::string&                          ciphersuites) noexcept {
+
+            ppp::string key = stl::to_string<ppp::string>(method) + "|" + (verify_peer ? "1" : "0") + "|" + ciphersuites.data();
+            std::lock_guard<std::mutex> scope(SSL_syncobj);
+
+            std::shared_ptr<boost::asio::ssl::context>& ssl_context = SSL_client_contexts[key];
+            if (NULL == ssl_context) {
+                ssl_context = CreateClientSslContext(method, verify_peer, ciphersuites);
+                if (NULL != ssl_context) {
+                    SSL_CTX* ssl_ctx = ssl_context->native_handle();
+                    SSL_CTX_set_session_cache_mode(ssl_ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+                    SSL_CTX_sess_set_new_cb(ssl_ctx, SSL_NewClientSession);
+                }
+            }
+
+            return ssl_context;
+        }
+
+        bool SSL::ResumeClientSslSession(::SSL* ssl, const ppp::string& host, int port) noexcept {
+            if (NULL == ssl || host.empty() || port < 1 || SSL_SESSION_PORT_INDEX < 0) {
+                return false;
+            }
+
+            // The new session callback has the server name but not the port, the connection carries it there.
+            if (SSL_set_ex_data(ssl, SSL_SESSION_PORT_INDEX, (void*)(intptr_t)port) != 1) {
+                return false;
+            }
+
+            ppp::string key = SSL_ClientSessionKey(ssl, host.data(), port);
+            std::shared_ptr<SSL_SESSION> ssl_session; {
+                std::lock_guard<std::mutex> scope(SSL_syncobj);
+                auto tail = SSL_client_sessions.find(key);
+                if (tail == SSL_client_sessions.end()) {
+                    return false;
+                }
+
+                ssl_session = tail->second;
+            }
+
+            if (!SSL_SESSION_is_resumable(ssl_session.get())) {
+                return false;
+            }
+
+            return SSL_set_session(ssl, ssl_session.get()) == 1;
+        }
+
         const char* SSL::GetSslCiphersuites() noexcept {
 #if !(defined(__aarch64__) || defined(_M_ARM64))
             if (strstr(GetPlatformCode(), "ARM")) {
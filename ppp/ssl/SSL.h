@@ -38,6 +38,24 @@ namespace ppp {
                 int                                                         method,
                 bool                                                        verify_peer,
                 const std::string&                                          ciphersuites) noexcept;
+
+        public:
+            /* Process wide contexts shared by every connection with the same settings, so session tickets issued by one connection resume on the next. 
+             * The server context is rebuilt when the certificate files change, connections already running keep the context they were opened with.
+             */
+            static std::shared_ptr<boost::asio::ssl::context>               GetServerSslContext(
+                int                                                         method,
+                const std::string&                                          certificate_file,
+                const std::string&                                          certificate_key_file,
+                const std::string&                                          certificate_chain_file,
+                const std::string&                                          certificate_key_password,
+                const std::string&                                          ciphersuites) noexcept;
+            static std::shared_ptr<boost::asio::ssl::context>               GetClientSslContext(
+                int                                                         method,
+                bool                                                        verify_peer,
+                const std::string&                                          ciphersuites) noexcept;
+            /* Offers the last session ticket the same client context received from host:port to a client connection before its handshake. */
+            static bool                                                     ResumeClientSslSession(::SSL* ssl, const ppp::string& host, int port) noexcept;
         };
     }
 }
\ No newline at end of file
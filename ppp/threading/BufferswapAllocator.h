@@ -2,6 +2,7 @@
 
 #include <ppp/stdafx.h>
 #include <ppp/threading/BufferblockAllocator.h>
+#include <ppp/diagnostics/Metrics.h>
 
 namespace ppp
 {
@@ -42,6 +43,7 @@ namespace ppp
 
                 T* memory = (T*)Alloc(length * sizeof(T));
                 if (NULL == memory) {
+                    ppp::diagnostics::Metrics::Increment(ppp::diagnostics::Metrics::MetricsCounter_AllocatorFallbacks);
                     return make_shared_alloc<T>(length);
                 }
 
@@ -57,6 +59,7 @@ namespace ppp
 
                 void* memory = Alloc(sizeof(T));
                 if (NULL == memory) {
+                    ppp::diagnostics::Metrics::Increment(ppp::diagnostics::Metrics::MetricsCounter_AllocatorFallbacks);
                     return make_shared_object<T>(std::forward<A&&>(args)...);
                 }
 
@@ -1,6 +1,7 @@
 #include <ppp/threading/Executors.h>
 #include <ppp/threading/Timer.h>
 #include <ppp/threading/Thread.h>
+#include <ppp/diagnostics/Metrics.h>
 #include <common/libtcpip/netstack.h>
 
 #if defined(_WIN32)
@@ -85,14 +86,20 @@ namespace ppp
 
             boost::asio::deadline_timer::duration_type durationTime = ppp::threading::Timer::DurationTime(10);
             t->expires_from_now(durationTime);
+
+            // The tick runs every 10ms on the default context, how late it fires is the loop lag.
+            uint64_t deadline = ppp::GetTickCount(true) + 10000;
             t->async_wait(
-                [context, t](const boost::system::error_code& ec) noexcept {
+                [context, t, deadline](const boost::system::error_code& ec) noexcept {
                     if (ec) {
                         if (ec != boost::system::errc::operation_canceled) {
                             return;
                         }
                     }
 
+                    uint64_t now = ppp::GetTickCount(true);
+                    ppp::diagnostics::Metrics::Record(ppp::diagnostics::Metrics::MetricsHistogram_ExecutorLag, now > deadline ? now - deadline : 0);
+
                     Internal->Now = DateTime::Now();
                     Internal->TickCount
                         = ppp::GetTickCount();
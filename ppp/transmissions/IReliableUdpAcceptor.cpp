@@ -0,0 +1,196 @@
+#include <ppp/transmissions/IReliableUdpAcceptor.h>
+#include <ppp/net/Socket.h>
+#include <ppp/net/Ipep.h>
+#include <ppp/net/IPEndPoint.h>
+#include <ppp/threading/Executors.h>
+
+using ppp::net::Socket;
+using ppp::threading::Executors;
+
+namespace ppp {
+    namespace transmissions {
+        IReliableUdpAcceptor::IReliableUdpAcceptor(const ContextPtr& context, const AppConfigurationPtr& configuration) noexcept
+            : disposed_(false)
+            , context_(context)
+            , configuration_(configuration) {
+            socket_ = make_shared_object<boost::asio::ip::udp::socket>(*context);
+            buffer_ = Executors::GetCachedBuffer(context);
+        }
+
+        IReliableUdpAcceptor::~IReliableUdpAcceptor() noexcept {
+            Finalize();
+        }
+
+        bool IReliableUdpAcceptor::Open(const boost::asio::ip::address& ip, int port) noexcept {
+            std::shared_ptr<boost::asio::ip::udp::socket> socket = socket_;
+            if (NULL == socket || NULL == buffer_ || disposed_) {
+                return false;
+            }
+
+            if (port <= ppp::net::IPEndPoint::MinPort || port > ppp::net::IPEndPoint::MaxPort) {
+                return false;
+            }
+
+            // OpenSocket falls back to any free port, a listener that did not get its own port is of no use to clients.
+            if (!Socket::OpenSocket(*socket, ip, port)) {
+                return false;
+            }
+
+            boost::system::error_code ec;
+            boost::asio::ip::udp::endpoint localEP = socket->local_endpoint(ec);
+            if (ec || localEP.port() != port) {
+                Socket::Closesocket(*socket);
+                return false;
+            }
+
+            return true;
+        }
+
+        bool IReliableUdpAcceptor::Run(const AcceptEventHandler& handler) noexcept {
+            if (NULL == handler) {
+                return false;
+            }
+
+            handler_ = handler;
+            return Loopback();
+        }
+
+        boost::asio::ip::udp::endpoint IReliableUdpAcceptor::GetLocalEndPoint() noexcept {
+            std::shared_ptr<boost::asio::ip::udp::socket> socket = socket_;
+            if (NULL == socket) {
+                return boost::asio::ip::udp::endpoint();
+            }
+
+            boost::system::error_code ec;
+            return socket->local_endpoint(ec);
+        }
+
+        void IReliableUdpAcceptor::Dispose() noexcept {
+            auto self = shared_from_this();
+            Executors::Post(context_,
+                [self, this]() noexcept {
+                    Finalize();
+                });
+        }
+
+        void IReliableUdpAcceptor::Finalize() noexcept {
+            TransmissionTable transmissions;
+            {
+                SynchronizedObjectScope scope(syncobj_);
+                disposed_ = true;
+                transmissions = std::move(transmissions_);
+                transmissions_.clear();
+            }
+
+            if (std::shared_ptr<boost::asio::ip::udp::socket> socket = std::move(socket_); socket) {
+                socket_.reset();
+                Socket::Closesocket(socket);
+            }
+
+            handler_ = NULL;
+            for (auto&& kv : transmissions) {
+                kv.second->Dispose();
+            }
+        }
+
+        void IReliableUdpAcceptor::Release(uint32_t conversation, IReliableUdpTransmission* transmission) noexcept {
+            SynchronizedObjectScope scope(syncobj_);
+            auto tail = transmissions_.find(conversation);
+            if (tail != transmissions_.end() && tail->second.get() == transmission) {
+                transmissions_.erase(tail);
+            }
+        }
+
+        bool IReliableUdpAcceptor::Loopback() noexcept {
+            std::shared_ptr<boost::asio::ip::udp::socket> socket = socket_;
+            if (NULL == socket || !socket->is_open()) {
+                return false;
+            }
+
+            if (disposed_) {
+                return false;
+            }
+
+            auto self = shared_from_this();
+            socket->async_receive_from(boost::asio::buffer(buffer_.get(), PPP_BUFFER_SIZE), sourceEP_,
+                [self, this, socket](const boost::system::error_code& ec, std::size_t sz) noexcept {
+                    if (ec == boost::system::errc::operation_canceled) {
+                        return;
+                    }
+
+                    if (ec == boost::system::errc::success && sz > 0) {
+                        PacketInput(buffer_.get(), (int)sz, sourceEP_);
+                    }
+
+                    Loopback();
+                });
+            return true;
+        }
+
+        void IReliableUdpAcceptor::PacketInput(const Byte* packet, int packet_length, const boost::asio::ip::udp::endpoint& sourceEP) noexcept {
+            bool opening = false;
+            uint32_t conversation = IReliableUdpTransmission::GetConversation(packet, packet_length, opening);
+            if (conversation == 0) {
+                return;
+            }
+
+            std::shared_ptr<IReliableUdpTransmission> transmission;
+            {
+                SynchronizedObjectScope scope(syncobj_);
+                if (disposed_) {
+                    return;
+                }
+
+                auto tail = transmissions_.find(conversation);
+                if (tail != transmissions_.end()) {
+                    transmission = tail->second;
+                }
+            }
+
+            // Only the first segment of a stream opens a conversation, stray segments of a closed one are dropped.
+            if (NULL == transmission) {
+                if (!opening) {
+                    return;
+                }
+
+                ContextPtr context = Executors::GetExecutor();
+                if (NULL == context) {
+                    context = context_;
+                }
+
+                transmission = make_shared_object<IReliableUdpTransmission>(context, StrandPtr(), socket_, sourceEP, conversation, configuration_);
+                if (NULL == transmission) {
+                    return;
+                }
+
+                transmission->acceptor_ = shared_from_this();
+                {
+                    SynchronizedObjectScope scope(syncobj_);
+                    if (disposed_) {
+                        return;
+                    }
+
+                    transmissions_[conversation] = transmission;
+                }
+
+                bool ok = transmission->Open() && handler_(transmission);
+                if (!ok) {
+                    transmission->Dispose();
+                    return;
+                }
+            }
+
+            // The receive buffer is reused by the next datagram, the transmission gets its own copy on its own context.
+            std::shared_ptr<Byte> messages = BufferswapAllocator::MakeByteArray(configuration_->GetBufferAllocator(), packet_length);
+            if (NULL == messages) {
+                return;
+            }
+
+            memcpy(messages.get(), packet, packet_length);
+            Executors::Post(transmission->GetContext(), transmission->GetStrand(),
+                [transmission, messages, packet_length, sourceEP]() noexcept {
+                    transmission->Input(messages.get(), packet_length, sourceEP);
+                });
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <ppp/transmissions/IReliableUdpTransmission.h>
+
+namespace ppp {
+    namespace transmissions {
+        /* One listening UDP socket for all reliable udp conversations, datagrams are routed by conversation id and not by address. */
+        class IReliableUdpAcceptor : public std::enable_shared_from_this<IReliableUdpAcceptor> {
+            friend class IReliableUdpTransmission;
+
+        public:
+            typedef std::shared_ptr<boost::asio::io_context>                                    ContextPtr;
+            typedef ppp::transmissions::ITransmission::StrandPtr                                StrandPtr;
+            typedef ppp::threading::BufferswapAllocator                                         BufferswapAllocator;
+            typedef ppp::configurations::AppConfiguration                                       AppConfiguration;
+            typedef std::shared_ptr<AppConfiguration>                                           AppConfigurationPtr;
+            typedef ppp::function<bool(const std::shared_ptr<IReliableUdpTransmission>&)>       AcceptEventHandler;
+            typedef std::mutex                                                                  SynchronizedObject;
+            typedef std::lock_guard<SynchronizedObject>                                         SynchronizedObjectScope;
+
+        public:
+            IReliableUdpAcceptor(const ContextPtr& context, const AppConfigurationPtr& configuration) noexcept;
+            virtual ~IReliableUdpAcceptor() noexcept;
+
+        public:
+            bool                                                                                Open(const boost::asio::ip::address& ip, int port) noexcept;
+            bool                                                                                Run(const AcceptEventHandler& handler) noexcept;
+            virtual void                                                                        Dispose() noexcept;
+            boost::asio::ip::udp::endpoint                                                      GetLocalEndPoint() noexcept;
+
+        private:
+            void                                                                                Finalize() noexcept;
+            bool                                                                                Loopback() noexcept;
+            void                                                                                PacketInput(const Byte* packet, int packet_length, const boost::asio::ip::udp::endpoint& sourceEP) noexcept;
+            void                                                                                Release(uint32_t conversation, IReliableUdpTransmission* transmission) noexcept;
+
+        private:
+            typedef ppp::unordered_map<uint32_t, std::shared_ptr<IReliableUdpTransmission>>    TransmissionTable;
+
+        private:
+            SynchronizedObject                                                                  syncobj_;
+            bool                                                                                disposed_ = false;
+            ContextPtr                                                                          context_;
+            AppConfigurationPtr                                                                 configuration_;
+            std::shared_ptr<boost::asio::ip::udp::socket>                                       socket_;
+            std::shared_ptr<Byte>                                                               buffer_;
+            boost::asio::ip::udp::endpoint                                                      sourceEP_;
+            AcceptEventHandler                                                                  handler_;
+            TransmissionTable                                                                   transmissions_;
+        };
+    }
+}
@@ -0,0 +1,875 @@
+#include <ppp/transmissions/IReliableUdpTransmission.h>
+#include <ppp/transmissions/IReliableUdpAcceptor.h>
+#include <ppp/net/Socket.h>
+#include <ppp/net/Ipep.h>
+#include <ppp/threading/Timer.h>
+#include <ppp/threading/Executors.h>
+#include <ppp/coroutines/YieldContext.h>
+
+using ppp::net::Socket;
+using ppp::threading::Timer;
+using ppp::threading::Executors;
+
+namespace ppp {
+    namespace transmissions {
+#pragma pack(push, 1)
+        typedef struct {
+            uint32_t                                                                            conv;
+            uint8_t                                                                             cmd;
+            uint8_t                                                                             reserved;
+            uint16_t                                                                            wnd;
+            uint32_t                                                                            ts;
+            uint32_t                                                                            sn;
+            uint32_t                                                                            una;
+            uint16_t                                                                            len;
+        } RELIABLE_UDP_HEADER;
+#pragma pack(pop)
+
+        static_assert(sizeof(RELIABLE_UDP_HEADER) == IReliableUdpTransmission::HEADER_SIZE, "The reliable udp header is 22 bytes.");
+
+        static constexpr int RELIABLE_UDP_CMD_PUSH          = 1;
+        static constexpr int RELIABLE_UDP_CMD_ACK           = 2;
+        static constexpr int RELIABLE_UDP_CMD_FIN           = 3;
+        static constexpr int RELIABLE_UDP_CMD_PING          = 4;
+        static constexpr int RELIABLE_UDP_CMD_PROBE         = 5;        // sn carries the nonce the peer echoes back
+        static constexpr int RELIABLE_UDP_CMD_PROBE_ACK     = 6;
+
+        static constexpr int RELIABLE_UDP_WND               = 1024;     // segments
+        static constexpr int RELIABLE_UDP_INTERVAL          = 10;       // ms
+        static constexpr int RELIABLE_UDP_KEEPALIVE         = 5000;     // ms
+        static constexpr int RELIABLE_UDP_RTO_MIN           = 50;
+        static constexpr int RELIABLE_UDP_RTO_DEF           = 200;
+        static constexpr int RELIABLE_UDP_RTO_MAX           = 10000;
+        static constexpr int RELIABLE_UDP_FAST_RESEND       = 2;
+        static constexpr int RELIABLE_UDP_DEAD_LINK         = 20;
+        static constexpr int RELIABLE_UDP_SEND_BUFFER       = 512 * 1024;
+        static constexpr int RELIABLE_UDP_INITIAL_CWND      = 10;
+        static constexpr int RELIABLE_UDP_MIN_CWND          = 4;
+        static constexpr int RELIABLE_UDP_BW_ROUNDS         = 10;
+        static constexpr int RELIABLE_UDP_MIN_RTT_WINDOW    = 10000;    // ms
+
+        // Startup doubles the delivery rate each round (2/ln2), probe bandwidth cycles one round up, one round down and six rounds cruising.
+        static constexpr double RELIABLE_UDP_STARTUP_GAIN   = 2.885;
+        static constexpr double RELIABLE_UDP_CWND_GAIN      = 2.0;
+        static constexpr double RELIABLE_UDP_PROBE_GAINS[]  = { 1.25, 0.75, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0 };
+
+        static bool ReliableUdp_Before(uint32_t x, uint32_t y) noexcept {
+            return (int32_t)(x - y) < 0;
+        }
+
+        IReliableUdpTransmission::IReliableUdpTransmission(
+            const ContextPtr&                                       context,
+            const StrandPtr&                                        strand,
+            const std::shared_ptr<boost::asio::ip::udp::socket>&    socket,
+            const boost::asio::ip::udp::endpoint&                   remoteEP,
+            uint32_t                                                conversation,
+            const AppConfigurationPtr&                              configuration) noexcept
+            : ITransmission(context, strand, configuration)
+            , disposed_(false)
+            , conversation_(conversation)
+            , socket_(socket)
+            , remoteEP_(remoteEP)
+            , rmt_wnd_(RELIABLE_UDP_WND)
+            , rto_(RELIABLE_UDP_RTO_DEF) {
+            for (double& bandwidth : bandwidth_) {
+                bandwidth = 0;
+            }
+        }
+
+        IReliableUdpTransmission::~IReliableUdpTransmission() noexcept {
+            Finalize();
+        }
+
+        uint32_t IReliableUdpTransmission::NewConversation() noexcept {
+            uint32_t conversation = 0;
+            while (conversation == 0) {
+                conversation = (uint32_t)RandomNext() << 16 ^ (uint32_t)RandomNext();
+            }
+
+            return conversation;
+        }
+
+        uint32_t IReliableUdpTransmission::GetConversation(const void* packet, int packet_length, bool& opening) noexcept {
+            opening = false;
+            if (NULL == packet || packet_length < HEADER_SIZE) {
+                return 0;
+            }
+
+            RELIABLE_UDP_HEADER h;
+            memcpy(&h, packet, sizeof(h));
+
+            opening = h.cmd == RELIABLE_UDP_CMD_PUSH && h.sn == 0;
+            return ntohl(h.conv);
+        }
+
+        void IReliableUdpTransmission::Finalize() noexcept {
+            std::shared_ptr<boost::asio::ip::udp::socket> socket = std::move(socket_);
+            if (socket && !disposed_) {
+                RELIABLE_UDP_HEADER h = { htonl(conversation_), RELIABLE_UDP_CMD_FIN, 0, 0, 0, htonl(snd_nxt_), htonl(rcv_nxt_), 0 };
+                boost::system::error_code ec;
+                socket->send_to(boost::asio::buffer(&h, sizeof(h)), remoteEP_, 0, ec);
+            }
+
+            disposed_ = true;
+            socket_.reset();
+
+            if (std::shared_ptr<boost::asio::deadline_timer> timeout = std::move(timeout_); timeout) {
+                timeout_.reset();
+                Socket::Cancel(*timeout);
+            }
+
+            // Sockets of an acceptor are shared by all of its conversations, only the client side owns and closes its socket.
+            if (std::shared_ptr<IReliableUdpAcceptor> acceptor = std::move(acceptor_); acceptor) {
+                acceptor_.reset();
+                acceptor->Release(conversation_, this);
+            }
+            elif(socket) {
+                Socket::Closesocket(socket);
+            }
+
+            snd_queue_.clear();
+            snd_buf_.clear();
+            rcv_buf_.clear();
+            rcv_stream_.clear();
+            acks_.clear();
+
+            snd_queue_bytes_ = 0;
+            rcv_stream_size_ = 0;
+            inflight_ = 0;
+
+            if (AsynchronousWriteBytesCallback cb = std::move(write_cb_); cb) {
+                write_cb_ = NULL;
+                cb(false);
+            }
+
+            Wake();
+        }
+
+        void IReliableUdpTransmission::Dispose() noexcept {
+            auto self = shared_from_this();
+            Executors::Post(GetContext(), GetStrand(),
+                [self, this]() noexcept {
+                    Finalize();
+                });
+            ITransmission::Dispose();
+        }
+
+        boost::asio::ip::tcp::endpoint IReliableUdpTransmission::GetRemoteEndPoint() noexcept {
+            boost::asio::ip::udp::endpoint remoteEP = ppp::net::Ipep::V6ToV4(remoteEP_);
+            return boost::asio::ip::tcp::endpoint(remoteEP.address(), remoteEP.port());
+        }
+
+        bool IReliableUdpTransmission::ShiftToScheduler() noexcept {
+            // Datagrams of a conversation are handed to the context it was opened on.
+            return false;
+        }
+
+        bool IReliableUdpTransmission::Open() noexcept {
+            std::shared_ptr<boost::asio::ip::udp::socket> socket = socket_;
+            if (!socket || !socket->is_open()) {
+                return false;
+            }
+
+            if (disposed_ || NULL != timeout_) {
+                return false;
+            }
+
+            const ContextPtr& context = GetContext();
+            const StrandPtr& strand = GetStrand();
+
+            std::shared_ptr<boost::asio::deadline_timer> timeout = strand ?
+                make_shared_object<boost::asio::deadline_timer>(*strand) : make_shared_object<boost::asio::deadline_timer>(*context);
+            if (NULL == timeout) {
+                return false;
+            }
+
+            uint64_t now = ppp::GetTickCount();
+            timeout_ = timeout;
+            last_input_ = now;
+            last_output_ = now;
+            pacing_time_ = now;
+            pacing_budget_ = MTU * 2;
+            delivered_time_ = now;
+            min_rtt_stamp_ = now;
+            cycle_stamp_ = now;
+
+            if (NULL == acceptor_) {
+                buffer_ = BufferswapAllocator::MakeByteArray(this->BufferAllocator, PPP_BUFFER_SIZE);
+                if (NULL == buffer_ || !Loopback()) {
+                    return false;
+                }
+            }
+
+            return NextTick();
+        }
+
+        bool IReliableUdpTransmission::Loopback() noexcept {
+            std::shared_ptr<boost::asio::ip::udp::socket> socket = socket_;
+            if (!socket || !socket->is_open()) {
+                return false;
+            }
+
+            if (disposed_) {
+                return false;
+            }
+
+            auto self = shared_from_this();
+            socket->async_receive_from(boost::asio::buffer(buffer_.get(), PPP_BUFFER_SIZE), sourceEP_,
+                [self, this, socket](const boost::system::error_code& ec, std::size_t sz) noexcept {
+                    if (ec == boost::system::errc::operation_canceled) {
+                        return;
+                    }
+
+                    // Unreachable replies to earlier datagrams surface as receive errors on some platforms, they do not end the stream.
+                    if (ec == boost::system::errc::success && sz > 0) {
+                        if (ppp::net::Ipep::V6ToV4(sourceEP_) == ppp::net::Ipep::V6ToV4(remoteEP_)) {
+                            Input(buffer_.get(), (int)sz, sourceEP_);
+                        }
+                    }
+
+                    Loopback();
+                });
+            return true;
+        }
+
+        bool IReliableUdpTransmission::NextTick() noexcept {
+            std::shared_ptr<boost::asio::deadline_timer> timeout = timeout_;
+            if (NULL == timeout || disposed_) {
+                return false;
+            }
+
+            auto self = shared_from_this();
+            timeout->expires_from_now(Timer::DurationTime(RELIABLE_UDP_INTERVAL));
+            timeout->async_wait(
+                [self, this](const boost::system::error_code& ec) noexcept {
+                    if (ec == boost::system::errc::operation_canceled) {
+                        return;
+                    }
+
+                    if (!Update() || !NextTick()) {
+                        Dispose();
+                    }
+                });
+            return true;
+        }
+
+        bool IReliableUdpTransmission::Update() noexcept {
+            if (disposed_) {
+                return false;
+            }
+
+            uint64_t now = ppp::GetTickCount();
+            AppConfigurationPtr configuration = GetConfiguration();
+
+            uint64_t inactive = (uint64_t)std::max<int>(1, configuration->tcp.inactive.timeout) * 1000;
+            if (now - last_input_ >= inactive) {
+                return false;
+            }
+
+            if (now - last_output_ >= RELIABLE_UDP_KEEPALIVE) {
+                RELIABLE_UDP_HEADER h = { htonl(conversation_), RELIABLE_UDP_CMD_PING, 0, htons((uint16_t)ReceiveWindow()), htonl((uint32_t)now), 0, htonl(rcv_nxt_), 0 };
+                Output((Byte*)&h, sizeof(h));
+            }
+
+            return Flush(now);
+        }
+
+        int IReliableUdpTransmission::ReceiveWindow() noexcept {
+            // Bytes the reader has not taken yet close the window as well, a slow reader slows the sender instead of growing memory.
+            int64_t used = (int64_t)rcv_buf_.size() + rcv_stream_size_ / MSS;
+            return (int)std::max<int64_t>(0, RELIABLE_UDP_WND - used);
+        }
+
+        double IReliableUdpTransmission::PacingRate() noexcept {
+            double gain = RELIABLE_UDP_STARTUP_GAIN;
+            if (mode_ == CongestionMode_Drain) {
+                gain = 1 / RELIABLE_UDP_STARTUP_GAIN;
+            }
+            elif(mode_ == CongestionMode_ProbeBandwidth) {
+                gain = RELIABLE_UDP_PROBE_GAINS[cycle_index_];
+            }
+
+            // Bytes per millisecond, before the first sample the initial window is paced over the handshake rtt.
+            if (btl_bw_ > 0) {
+                return gain * btl_bw_;
+            }
+
+            int rtt = srtt_ > 0 ? srtt_ : RELIABLE_UDP_RTO_DEF;
+            return gain * (double)(RELIABLE_UDP_INITIAL_CWND * MSS) / (double)rtt;
+        }
+
+        int64_t IReliableUdpTransmission::CongestionWindow() noexcept {
+            if (btl_bw_ <= 0 || min_rtt_ <= 0) {
+                return RELIABLE_UDP_INITIAL_CWND * MSS;
+            }
+
+            double gain = mode_ == CongestionMode_Startup ? RELIABLE_UDP_STARTUP_GAIN : RELIABLE_UDP_CWND_GAIN;
+            int64_t cwnd = (int64_t)(gain * btl_bw_ * (double)min_rtt_);
+            return std::max<int64_t>(cwnd, RELIABLE_UDP_MIN_CWND * MSS);
+        }
+
+        void IReliableUdpTransmission::OnRoundTrip(int rtt, uint64_t now) noexcept {
+            rtt = std::max<int>(1, rtt);
+            if (srtt_ == 0) {
+                srtt_ = rtt;
+                rttvar_ = rtt >> 1;
+            }
+            else {
+                rttvar_ = (3 * rttvar_ + std::abs(srtt_ - rtt)) >> 2;
+                srtt_ = (7 * srtt_ + rtt) >> 3;
+            }
+
+            rto_ = std::max<int>(RELIABLE_UDP_RTO_MIN, std::min<int>(RELIABLE_UDP_RTO_MAX, srtt_ + std::max<int>(RELIABLE_UDP_INTERVAL, rttvar_ << 2)));
+            if (min_rtt_ == 0 || rtt <= min_rtt_ || now - min_rtt_stamp_ >= RELIABLE_UDP_MIN_RTT_WINDOW) {
+                min_rtt_ = rtt;
+                min_rtt_stamp_ = now;
+            }
+        }
+
+        void IReliableUdpTransmission::OnBandwidth(double rate, bool round_start, uint64_t now) noexcept {
+            double& slot = bandwidth_[round_ % RELIABLE_UDP_BW_ROUNDS];
+            slot = round_start ? rate : std::max<double>(slot, rate);
+
+            btl_bw_ = 0;
+            for (double bandwidth : bandwidth_) {
+                btl_bw_ = std::max<double>(btl_bw_, bandwidth);
+            }
+
+            // Startup ends once three rounds in a row failed to grow the bottleneck estimate by a quarter.
+            if (round_start && mode_ == CongestionMode_Startup) {
+                if (btl_bw_ >= full_bw_ * 1.25) {
+                    full_bw_ = btl_bw_;
+                    full_bw_count_ = 0;
+                }
+                elif(++full_bw_count_ >= 3) {
+                    mode_ = CongestionMode_Drain;
+                }
+            }
+
+            if (mode_ == CongestionMode_Drain) {
+                double bdp = btl_bw_ * (double)std::max<int>(1, min_rtt_);
+                if ((double)inflight_ <= bdp) {
+                    mode_ = CongestionMode_ProbeBandwidth;
+                    cycle_index_ = 0;
+                    cycle_stamp_ = now;
+                }
+            }
+            elif(mode_ == CongestionMode_ProbeBandwidth) {
+                if (now - cycle_stamp_ >= (uint64_t)std::max<int>(1, min_rtt_)) {
+                    cycle_index_ = (cycle_index_ + 1) % arraysizeof(RELIABLE_UDP_PROBE_GAINS);
+                    cycle_stamp_ = now;
+                }
+            }
+        }
+
+        void IReliableUdpTransmission::OnDelivered(const Segment& segment, uint64_t now) noexcept {
+            inflight_ -= segment.length;
+            if (segment.xmit < 1) {
+                return;
+            }
+
+            unacked_--;
+            delivered_ += segment.length;
+            delivered_time_ = now;
+
+            // The delivery rate over the interval this segment was in flight, a round ends when a segment sent after the last round start is acked.
+            bool round_start = false;
+            if (segment.delivered >= next_round_delivered_) {
+                next_round_delivered_ = delivered_;
+                round_++;
+                round_start = true;
+            }
+
+            uint64_t interval = std::max<uint64_t>(1, now - segment.delivered_time);
+            OnBandwidth((double)(delivered_ - segment.delivered) / (double)interval, round_start, now);
+        }
+
+        bool IReliableUdpTransmission::AcknowledgeUna(uint32_t una, uint64_t now) noexcept {
+            // Nothing past snd_nxt was ever sent, such an una is forged and acks nothing.
+            bool acked = false;
+            if (ReliableUdp_Before(snd_nxt_, una)) {
+                return acked;
+            }
+
+            while (!snd_buf_.empty()) {
+                Segment& segment = snd_buf_.front();
+                if (!ReliableUdp_Before(segment.sn, una)) {
+                    break;
+                }
+
+                OnDelivered(segment, now);
+                snd_buf_.pop_front();
+                acked = true;
+            }
+
+            return acked;
+        }
+
+        bool IReliableUdpTransmission::AcknowledgeSegment(uint32_t sn, uint64_t now) noexcept {
+            for (auto tail = snd_buf_.begin(); tail != snd_buf_.end(); tail++) {
+                Segment& segment = *tail;
+                if (segment.sn == sn) {
+                    OnDelivered(segment, now);
+                    snd_buf_.erase(tail);
+                    return true;
+                }
+                elif(ReliableUdp_Before(sn, segment.sn)) {
+                    break;
+                }
+            }
+
+            return false;
+        }
+
+        bool IReliableUdpTransmission::Input(const Byte* packet, int packet_length, const boost::asio::ip::udp::endpoint& sourceEP) noexcept {
+            if (disposed_ || NULL == packet) {
+                return false;
+            }
+
+            uint64_t now = ppp::GetTickCount();
+            uint32_t maxack = 0;
+            uint32_t maxack_ts = 0;
+            bool acked = false;
+            bool pushed = false;
+            bool valid = false;
+            bool progress = false;
+            bool validated = false;
+
+            // The header is not authenticated, only the address the stream runs on may ack, move the peer window or end the stream.
+            // Another address that knows the conversation can at most deliver segments and ask for a probe, its acks are only looked
+            // at to tell whether it moves the stream forward, they are applied once it answered the probe and the stream followed it.
+            bool trusted = ppp::net::Ipep::V6ToV4(sourceEP) == ppp::net::Ipep::V6ToV4(remoteEP_);
+            while (packet_length >= HEADER_SIZE) {
+                RELIABLE_UDP_HEADER h;
+                memcpy(&h, packet, sizeof(h));
+
+                int len = ntohs(h.len);
+                if (ntohl(h.conv) != conversation_ || packet_length - HEADER_SIZE < len) {
+                    break;
+                }
+
+                const Byte* payload = packet + HEADER_SIZE;
+                packet += HEADER_SIZE + len;
+                packet_length -= HEADER_SIZE + len;
+
+                valid = true;
+                uint32_t sn = ntohl(h.sn);
+                uint32_t una = ntohl(h.una);
+                if (!trusted) {
+                    if (!snd_buf_.empty()) {
+                        uint32_t first = snd_buf_.front().sn;
+                        progress |= ReliableUdp_Before(first, una) && !ReliableUdp_Before(snd_nxt_, una);
+                        progress |= h.cmd == RELIABLE_UDP_CMD_ACK && !ReliableUdp_Before(sn, first) && ReliableUdp_Before(sn, snd_nxt_);
+                    }
+                }
+                else {
+                    rmt_wnd_ = ntohs(h.wnd);
+                    progress |= AcknowledgeUna(una, now);
+                }
+
+                if (h.cmd == RELIABLE_UDP_CMD_ACK) {
+                    if (!trusted) {
+                        continue;
+                    }
+
+                    int rtt = (int32_t)((uint32_t)now - ntohl(h.ts));
+                    if (rtt >= 0) {
+                        OnRoundTrip(rtt, now);
+                    }
+
+                    if (AcknowledgeSegment(sn, now)) {
+                        progress = true;
+                        if (!acked || ReliableUdp_Before(maxack, sn)) {
+                            maxack = sn;
+                            maxack_ts = ntohl(h.ts);
+                            acked = true;
+                        }
+                    }
+                }
+                elif(h.cmd == RELIABLE_UDP_CMD_PUSH) {
+                    if (len < 1 || !ReliableUdp_Before(sn, rcv_nxt_ + RELIABLE_UDP_WND)) {
+                        continue;
+                    }
+
+                    // Segments below rcv_nxt were delivered already, they are acked again because the earlier ack was lost.
+                    acks_.emplace_back(Acknowledge{ sn, ntohl(h.ts) });
+                    if (ReliableUdp_Before(sn, rcv_nxt_) || rcv_buf_.find(sn) != rcv_buf_.end()) {
+                        continue;
+                    }
+
+                    std::shared_ptr<Byte> data = BufferswapAllocator::MakeByteArray(this->BufferAllocator, len);
+                    if (NULL == data) {
+                        return false;
+                    }
+
+                    memcpy(data.get(), payload, len);
+
+                    Segment& segment = rcv_buf_[sn];
+                    segment.sn = sn;
+                    segment.data = data;
+                    segment.length = len;
+                    pushed = true;
+                    progress = true;
+                }
+                elif(h.cmd == RELIABLE_UDP_CMD_FIN) {
+                    fin_ |= trusted;
+                }
+                elif(h.cmd == RELIABLE_UDP_CMD_PROBE) {
+                    Probe(RELIABLE_UDP_CMD_PROBE_ACK, sn, sourceEP, now);
+                }
+                elif(h.cmd == RELIABLE_UDP_CMD_PROBE_ACK) {
+                    validated |= probe_nonce_ != 0 && sn == probe_nonce_;
+                }
+            }
+
+            if (!valid) {
+                return false;
+            }
+
+            if (trusted) {
+                last_input_ = now;
+            }
+            elif(NULL != acceptor_) {
+                Migrate(sourceEP, progress, validated, now);
+            }
+
+            if (acked) {
+                for (Segment& segment : snd_buf_) {
+                    if (!ReliableUdp_Before(segment.sn, maxack)) {
+                        break;
+                    }
+
+                    // Only an ack for a segment sent no earlier than this one was last sent says it is missing, the acks still on their
+                    // way for segments sent before a resend would otherwise fire fast resends one after another until the link counts as dead.
+                    if (segment.xmit > 0 && !ReliableUdp_Before(maxack_ts, segment.ts)) {
+                        segment.fastack++;
+                    }
+                }
+            }
+
+            if (pushed) {
+                Deliver();
+            }
+
+            if (!Flush(now)) {
+                Dispose();
+                return false;
+            }
+
+            Wake();
+            return true;
+        }
+
+        void IReliableUdpTransmission::Migrate(const boost::asio::ip::udp::endpoint& sourceEP, bool progress, bool validated, uint64_t now) noexcept {
+            // The server follows the client to a new address only once that address moved the stream forward and echoed a fresh probe,
+            // a spoofed or replayed datagram carrying the conversation alone cannot redirect the stream.
+            if (validated && sourceEP == probeEP_) {
+                remoteEP_ = sourceEP;
+                probeEP_ = boost::asio::ip::udp::endpoint();
+                probe_nonce_ = 0;
+                return;
+            }
+
+            if (!progress) {
+                return;
+            }
+
+            if (probe_nonce_ != 0 && sourceEP == probeEP_ && now - probe_time_ < (uint64_t)rto_) {
+                return;
+            }
+
+            uint32_t nonce = 0;
+            while (nonce == 0) {
+                nonce = (uint32_t)RandomNext() << 16 ^ (uint32_t)RandomNext();
+            }
+
+            probeEP_ = sourceEP;
+            probe_nonce_ = nonce;
+            probe_time_ = now;
+            Probe(RELIABLE_UDP_CMD_PROBE, nonce, sourceEP, now);
+        }
+
+        bool IReliableUdpTransmission::Probe(uint8_t cmd, uint32_t nonce, const boost::asio::ip::udp::endpoint& destinationEP, uint64_t now) noexcept {
+            std::shared_ptr<boost::asio::ip::udp::socket> socket = socket_;
+            if (!socket || !socket->is_open()) {
+                return false;
+            }
+
+            // Probes and their answers go to the address they concern, not to the address the stream currently uses.
+            RELIABLE_UDP_HEADER h = { htonl(conversation_), cmd, 0, htons((uint16_t)ReceiveWindow()), htonl((uint32_t)now), htonl(nonce), htonl(rcv_nxt_), 0 };
+            boost::system::error_code ec;
+            socket->send_to(boost::asio::buffer(&h, sizeof(h)), destinationEP, 0, ec);
+            return !ec;
+        }
+
+        void IReliableUdpTransmission::Deliver() noexcept {
+            while (!rcv_buf_.empty()) {
+                auto tail = rcv_buf_.find(rcv_nxt_);
+                if (tail == rcv_buf_.end()) {
+                    break;
+                }
+
+                Segment& segment = tail->second;
+                rcv_stream_size_ += segment.length;
+                rcv_stream_.emplace_back(std::move(segment));
+                rcv_buf_.erase(tail);
+                rcv_nxt_++;
+            }
+        }
+
+        void IReliableUdpTransmission::Wake() noexcept {
+            YieldContext* y = read_y_;
+            if (NULL == y) {
+                return;
+            }
+
+            if (disposed_ || fin_ || rcv_stream_size_ >= read_length_) {
+                read_y_ = NULL;
+                y->R();
+            }
+        }
+
+        bool IReliableUdpTransmission::Output(const Byte* packet, int packet_length) noexcept {
+            std::shared_ptr<boost::asio::ip::udp::socket> socket = socket_;
+            if (!socket || !socket->is_open()) {
+                return false;
+            }
+
+            // A full socket buffer drops the datagram like the path would, retransmission covers it.
+            boost::system::error_code ec;
+            socket->send_to(boost::asio::buffer(packet, packet_length), remoteEP_, 0, ec);
+
+            last_output_ = ppp::GetTickCount();
+            return true;
+        }
+
+        bool IReliableUdpTransmission::Flush(uint64_t now) noexcept {
+            if (disposed_) {
+                return false;
+            }
+
+            // Tokens for at most two ticks, an idle link does not build up a burst.
+            double rate = PacingRate();
+            double burst = std::max<double>(MTU * 2, rate * RELIABLE_UDP_INTERVAL * 2);
+
+            pacing_budget_ = std::min<double>(burst, pacing_budget_ + rate * (double)(now - pacing_time_));
+            pacing_time_ = now;
+
+            Byte buffer[MTU];
+            int position = 0;
+
+            uint16_t wnd = htons((uint16_t)ReceiveWindow());
+            uint32_t una = htonl(rcv_nxt_);
+            uint32_t ts = (uint32_t)now;
+
+            auto output = [this, &buffer, &position](uint8_t cmd, uint16_t wnd, uint32_t ts, uint32_t sn, uint32_t una, const Byte* payload, int len) noexcept {
+                if (position + HEADER_SIZE + len > MTU) {
+                    Output(buffer, position);
+                    position = 0;
+                }
+
+                RELIABLE_UDP_HEADER h = { htonl(conversation_), cmd, 0, wnd, htonl(ts), htonl(sn), una, htons((uint16_t)len) };
+                memcpy(buffer + position, &h, sizeof(h));
+                if (len > 0) {
+                    memcpy(buffer + position + HEADER_SIZE, payload, len);
+                }
+
+                position += HEADER_SIZE + len;
+            };
+
+            for (const Acknowledge& ack : acks_) {
+                output(RELIABLE_UDP_CMD_ACK, wnd, ack.ts, ack.sn, una, NULL, 0);
+            }
+
+            acks_.clear();
+
+            // A closed peer window still lets one segment through so the window update is not lost forever.
+            int64_t cwnd = CongestionWindow();
+            std::size_t limit = rmt_wnd_ > 0 ? (std::size_t)rmt_wnd_ : (snd_buf_.empty() ? 1 : 0);
+            while (!snd_queue_.empty() && snd_buf_.size() < limit && inflight_ < cwnd) {
+                Segment& segment = snd_queue_.front();
+                segment.sn = snd_nxt_++;
+                inflight_ += segment.length;
+                snd_queue_bytes_ -= segment.length;
+
+                snd_buf_.emplace_back(std::move(segment));
+                snd_queue_.pop_front();
+            }
+
+            for (Segment& segment : snd_buf_) {
+                bool first = segment.xmit == 0;
+                bool lost = !first && now >= segment.resend;
+                bool fast = !first && segment.fastack >= RELIABLE_UDP_FAST_RESEND;
+                if (!first && !lost && !fast) {
+                    continue;
+                }
+
+                if (pacing_budget_ <= 0) {
+                    break;
+                }
+
+                if (first) {
+                    if (unacked_++ == 0) {
+                        delivered_time_ = now;
+                    }
+
+                    segment.rto = rto_;
+                    segment.delivered = delivered_;
+                    segment.delivered_time = delivered_time_;
+                }
+                elif(lost) {
+                    segment.rto = std::min<int>(RELIABLE_UDP_RTO_MAX, segment.rto + (segment.rto >> 1));
+                }
+
+                if (++segment.xmit > RELIABLE_UDP_DEAD_LINK) {
+                    return false;
+                }
+
+                segment.ts = ts;
+                segment.fastack = 0;
+                segment.resend = now + segment.rto;
+
+                pacing_budget_ -= segment.length + HEADER_SIZE;
+                output(RELIABLE_UDP_CMD_PUSH, wnd, ts, segment.sn, una, segment.data.get(), segment.length);
+            }
+
+            if (position > 0) {
+                Output(buffer, position);
+            }
+
+            if (snd_queue_bytes_ < RELIABLE_UDP_SEND_BUFFER) {
+                if (AsynchronousWriteBytesCallback cb = std::move(write_cb_); cb) {
+                    write_cb_ = NULL;
+                    cb(true);
+                }
+            }
+
+            return true;
+        }
+
+        bool IReliableUdpTransmission::Send(const Byte* packet, int packet_length) noexcept {
+            std::shared_ptr<BufferswapAllocator> allocator = this->BufferAllocator;
+            while (packet_length > 0) {
+                int length = std::min<int>(packet_length, MSS);
+                std::shared_ptr<Byte> data = BufferswapAllocator::MakeByteArray(allocator, length);
+                if (NULL == data) {
+                    return false;
+                }
+
+                memcpy(data.get(), packet, length);
+                packet += length;
+                packet_length -= length;
+
+                Segment segment;
+                segment.data = data;
+                segment.length = length;
+
+                snd_queue_bytes_ += length;
+                snd_queue_.emplace_back(std::move(segment));
+            }
+
+            return true;
+        }
+
+        std::shared_ptr<Byte> IReliableUdpTransmission::DoReadBytes(YieldContext& y, int length) noexcept {
+            if (disposed_) {
+                return NULL;
+            }
+
+            auto self = shared_from_this();
+            return ITransmissionQoS::DoReadBytes(y, length, self, *this, this->QoS);
+        }
+
+        std::shared_ptr<Byte> IReliableUdpTransmission::ReadBytes(YieldContext& y, int length) noexcept {
+            if (disposed_ || length < 1 || NULL != read_y_) {
+                return NULL;
+            }
+
+            // The coroutine runs on the context of the transmission, datagrams land there too and wake it once enough bytes are ordered.
+            auto self = shared_from_this();
+            while (rcv_stream_size_ < length) {
+                if (disposed_ || fin_) {
+                    return NULL;
+                }
+
+                read_y_ = &y;
+                read_length_ = length;
+                y.Suspend();
+            }
+
+            std::shared_ptr<Byte> packet = BufferswapAllocator::MakeByteArray(this->BufferAllocator, length);
+            if (NULL == packet) {
+                return NULL;
+            }
+
+            int offset = 0;
+            while (offset < length) {
+                Segment& segment = rcv_stream_.front();
+                int n = std::min<int>(segment.length - rcv_offset_, length - offset);
+                memcpy(packet.get() + offset, segment.data.get() + rcv_offset_, n);
+
+                offset += n;
+                rcv_offset_ += n;
+                if (rcv_offset_ >= segment.length) {
+                    rcv_stream_.pop_front();
+                    rcv_offset_ = 0;
+                }
+            }
+
+            rcv_stream_size_ -= length;
+
+            std::shared_ptr<ITransmissionStatistics> statistics = this->Statistics;
+            if (statistics) {
+                statistics->AddIncomingTraffic(length);
+            }
+
+            return packet;
+        }
+
+        bool IReliableUdpTransmission::DoWriteBytes(std::shared_ptr<Byte> packet, int offset, int packet_length, const AsynchronousWriteBytesCallback& cb) noexcept {
+            if (disposed_) {
+                return false;
+            }
+
+            std::shared_ptr<IAsynchronousWriteIoQueue> self = shared_from_this();
+            auto complete_do_write_bytes_async_callback = [self, this, packet, offset, packet_length, cb]() noexcept {
+                bool ok = !disposed_ && Send((Byte*)packet.get() + offset, packet_length);
+                if (!ok) {
+                    Dispose();
+                    if (cb) {
+                        cb(false);
+                    }
+
+                    return;
+                }
+
+                std::shared_ptr<ITransmissionStatistics> statistics = this->Statistics;
+                if (statistics) {
+                    statistics->AddOutgoingTraffic(packet_length);
+                }
+
+                // The write queue hands out the next frame only after cb, holding it while the send queue is full is the backpressure.
+                bool full = snd_queue_bytes_ >= RELIABLE_UDP_SEND_BUFFER;
+                if (full) {
+                    write_cb_ = cb;
+                }
+
+                // A full queue parked cb in write_cb_, Finalize answers it, otherwise it is answered here either way.
+                if (!Flush(ppp::GetTickCount())) {
+                    Dispose();
+                    if (!full && cb) {
+                        cb(false);
+                    }
+                }
+                elif(!full && cb) {
+                    Executors::Post(GetContext(), GetStrand(),
+                        [self, cb]() noexcept {
+                            cb(true);
+                        });
+                }
+            };
+
+            return Executors::Dispatch(GetContext(), GetStrand(), complete_do_write_bytes_async_callback);
+        }
+    }
+}
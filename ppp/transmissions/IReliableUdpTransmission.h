@@ -0,0 +1,152 @@
+#pragma once
+
+#include <ppp/transmissions/ITransmission.h>
+
+namespace ppp {
+    namespace transmissions {
+        class IReliableUdpAcceptor;
+
+        /* Ordered byte stream over UDP datagrams (selective ack, paced by a bottleneck bandwidth and rtt model), carries the same frames as the tcp carriers. */
+        class IReliableUdpTransmission : public ITransmission {
+            friend class ITransmissionQoS;
+            friend class IReliableUdpAcceptor;
+
+        public:
+            static constexpr int                                                                MTU         = 1400;
+            static constexpr int                                                                HEADER_SIZE = 22;
+            static constexpr int                                                                MSS         = MTU - HEADER_SIZE;
+
+        public:
+            IReliableUdpTransmission(
+                const ContextPtr&                                                               context,
+                const StrandPtr&                                                                strand,
+                const std::shared_ptr<boost::asio::ip::udp::socket>&                            socket,
+                const boost::asio::ip::udp::endpoint&                                           remoteEP,
+                uint32_t                                                                        conversation,
+                const AppConfigurationPtr&                                                      configuration) noexcept;
+            virtual ~IReliableUdpTransmission() noexcept;
+
+        public:
+            /* Starts the clock, a transmission that is not owned by an acceptor also starts receiving on its own socket. */
+            bool                                                                                Open() noexcept;
+            uint32_t                                                                            GetConversation() noexcept { return conversation_; }
+            virtual void                                                                        Dispose() noexcept override;
+            virtual boost::asio::ip::tcp::endpoint                                              GetRemoteEndPoint() noexcept override;
+            virtual std::shared_ptr<Byte>                                                       ReadBytes(YieldContext& y, int length) noexcept;
+
+        public:
+            static uint32_t                                                                     NewConversation() noexcept;
+            /* Reads the conversation of a datagram, opening is set when it carries the first segment of a stream. */
+            static uint32_t                                                                     GetConversation(const void* packet, int packet_length, bool& opening) noexcept;
+
+        protected:
+            virtual std::shared_ptr<Byte>                                                       DoReadBytes(YieldContext& y, int length) noexcept;
+            virtual bool                                                                        DoWriteBytes(std::shared_ptr<Byte> packet, int offset, int packet_length, const AsynchronousWriteBytesCallback& cb) noexcept;
+
+        private:
+            struct Segment {
+                uint32_t                                                                        sn             = 0;
+                uint32_t                                                                        ts             = 0;
+                std::shared_ptr<Byte>                                                           data;
+                int                                                                             length         = 0;
+                int                                                                             rto            = 0;
+                int                                                                             xmit           = 0;
+                int                                                                             fastack        = 0;
+                uint64_t                                                                        resend         = 0;
+                uint64_t                                                                        delivered      = 0;
+                uint64_t                                                                        delivered_time = 0;
+            };
+            typedef ppp::list<Segment>                                                          SegmentList;
+            typedef ppp::map<uint32_t, Segment>                                                 SegmentTable;
+
+            struct Acknowledge {
+                uint32_t                                                                        sn = 0;
+                uint32_t                                                                        ts = 0;
+            };
+            typedef ppp::vector<Acknowledge>                                                    AcknowledgeList;
+
+            typedef enum {
+                CongestionMode_Startup,
+                CongestionMode_Drain,
+                CongestionMode_ProbeBandwidth,
+            }                                                                                   CongestionMode;
+
+        private:
+            void                                                                                Finalize() noexcept;
+            virtual bool                                                                        ShiftToScheduler() noexcept override;
+            bool                                                                                Loopback() noexcept;
+            bool                                                                                NextTick() noexcept;
+            bool                                                                                Update() noexcept;
+            bool                                                                                Input(const Byte* packet, int packet_length, const boost::asio::ip::udp::endpoint& sourceEP) noexcept;
+            bool                                                                                Output(const Byte* packet, int packet_length) noexcept;
+            bool                                                                                Send(const Byte* packet, int packet_length) noexcept;
+            bool                                                                                Probe(uint8_t cmd, uint32_t nonce, const boost::asio::ip::udp::endpoint& destinationEP, uint64_t now) noexcept;
+            void                                                                                Migrate(const boost::asio::ip::udp::endpoint& sourceEP, bool progress, bool validated, uint64_t now) noexcept;
+            bool                                                                                Flush(uint64_t now) noexcept;
+            void                                                                                Wake() noexcept;
+            void                                                                                Deliver() noexcept;
+            int                                                                                 ReceiveWindow() noexcept;
+            bool                                                                                AcknowledgeUna(uint32_t una, uint64_t now) noexcept;
+            bool                                                                                AcknowledgeSegment(uint32_t sn, uint64_t now) noexcept;
+            void                                                                                OnDelivered(const Segment& segment, uint64_t now) noexcept;
+            void                                                                                OnRoundTrip(int rtt, uint64_t now) noexcept;
+            void                                                                                OnBandwidth(double rate, bool round_start, uint64_t now) noexcept;
+            double                                                                              PacingRate() noexcept;
+            int64_t                                                                             CongestionWindow() noexcept;
+
+        private:
+            bool                                                                                disposed_     = false;
+            bool                                                                                fin_          = false;
+            uint32_t                                                                            conversation_ = 0;
+            std::shared_ptr<boost::asio::ip::udp::socket>                                       socket_;
+            std::shared_ptr<IReliableUdpAcceptor>                                               acceptor_;
+            std::shared_ptr<boost::asio::deadline_timer>                                        timeout_;
+            boost::asio::ip::udp::endpoint                                                      remoteEP_;
+            boost::asio::ip::udp::endpoint                                                      sourceEP_;
+            boost::asio::ip::udp::endpoint                                                      probeEP_;
+            uint32_t                                                                            probe_nonce_  = 0;
+            uint64_t                                                                            probe_time_   = 0;
+            std::shared_ptr<Byte>                                                               buffer_;
+            uint64_t                                                                            last_input_   = 0;
+            uint64_t                                                                            last_output_  = 0;
+
+            uint32_t                                                                            snd_nxt_      = 0;
+            int                                                                                 rmt_wnd_      = 0;
+            int                                                                                 unacked_      = 0;
+            int64_t                                                                             inflight_     = 0;
+            int64_t                                                                             snd_queue_bytes_ = 0;
+            SegmentList                                                                         snd_queue_;
+            SegmentList                                                                         snd_buf_;
+            AsynchronousWriteBytesCallback                                                      write_cb_;
+
+            uint32_t                                                                            rcv_nxt_      = 0;
+            int                                                                                 rcv_offset_   = 0;
+            int64_t                                                                             rcv_stream_size_ = 0;
+            SegmentTable                                                                        rcv_buf_;
+            SegmentList                                                                         rcv_stream_;
+            AcknowledgeList                                                                     acks_;
+            YieldContext*                                                                       read_y_       = NULL;
+            int                                                                                 read_length_  = 0;
+
+            int                                                                                 srtt_         = 0;
+            int                                                                                 rttvar_       = 0;
+            int                                                                                 rto_          = 0;
+            int                                                                                 min_rtt_      = 0;
+            uint64_t                                                                            min_rtt_stamp_ = 0;
+
+            CongestionMode                                                                      mode_         = CongestionMode_Startup;
+            uint64_t                                                                            delivered_    = 0;
+            uint64_t                                                                            delivered_time_ = 0;
+            uint64_t                                                                            round_        = 0;
+            uint64_t                                                                            next_round_delivered_ = 0;
+            double                                                                              bandwidth_[10];
+            double                                                                              btl_bw_       = 0;
+            double                                                                              full_bw_      = 0;
+            int                                                                                 full_bw_count_ = 0;
+            int                                                                                 cycle_index_  = 0;
+            uint64_t                                                                            cycle_stamp_  = 0;
+            double                                                                              pacing_budget_ = 0;
+            uint64_t                                                                            pacing_time_  = 0;
+        };
+    }
+}
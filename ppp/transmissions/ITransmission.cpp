@@ -4,6 +4,7 @@
 #include <ppp/io/MemoryStream.h>
 #include <ppp/net/IPEndPoint.h>
 #include <ppp/auxiliary/StringAuxiliary.h>
+#include <ppp/diagnostics/Metrics.h>
 #include <ppp/threading/Thread.h>
 #include <ppp/threading/Executors.h>
 #include <ppp/threading/BufferswapAllocator.h>
@@ -12,10 +13,13 @@ namespace ppp {
     namespace transmissions {
         typedef ITransmission::AppConfigurationPtr      AppConfigurationPtr;
         typedef ITransmission::CiphertextPtr            CiphertextPtr;
+        typedef ITransmission::AEAD                     AEAD;
+        typedef ITransmission::AEADPtr                  AEADPtr;
         typedef ppp::threading::Thread                  Thread;
         typedef ppp::cryptography::ssea                 ssea;
         typedef ppp::io::Stream                         Stream;
         typedef ppp::io::MemoryStream                   MemoryStream;
+        typedef ppp::diagnostics::Metrics               Metrics;
         typedef ITransmission::YieldContext             YieldContext;
         typedef ppp::threading::BufferswapAllocator     BufferswapAllocator;
 
@@ -33,6 +37,24 @@ namespace ppp {
             YieldContext&                               y,
             bool                                        safest) noexcept;
 
+        static std::shared_ptr<Byte>                    Transmission_Packet_Encrypt(
+            const AppConfigurationPtr&                  APP,
+            const std::shared_ptr<BufferswapAllocator>& allocator,
+            const CiphertextPtr&                        EVP_protocol,
+            const CiphertextPtr&                        EVP_transport,
+            Byte**                                      packets,
+            int*                                        packet_lengths,
+            int                                         count,
+            int&                                        outlen) noexcept;
+
+        static std::shared_ptr<Byte>                    Transmission_Packet_Read(
+            const AppConfigurationPtr&                  APP,
+            const std::shared_ptr<BufferswapAllocator>& allocator,
+            const AEADPtr&                              EVP_aead,
+            int&                                        outlen,
+            ITransmission*                              transmission,
+            YieldContext&                               y) noexcept;
+
         class ITransmissionBridge final {
         public:
             static std::shared_ptr<Byte>                ReadBytes(ITransmission* transmission, YieldContext& y, int length) noexcept {
@@ -44,7 +66,10 @@ namespace ppp {
                 CiphertextPtr EVP_transport = transmission->transport_;
 
                 std::shared_ptr<BufferswapAllocator> allocator = transmission->BufferAllocator;
-                if (EVP_protocol && EVP_transport) {
+                if (AEADPtr EVP_aead = transmission->aead_; NULL != EVP_aead && !safest) {
+                    return Transmission_Packet_Read(transmission->configuration_, allocator, EVP_aead, outlen, transmission, y);
+                }
+                elif(EVP_protocol && EVP_transport) {
                     return Transmission_Packet_Read(transmission->configuration_, allocator, EVP_protocol, EVP_transport, outlen, transmission, y, safest);
                 }
                 else {
@@ -71,6 +96,48 @@ namespace ppp {
                 }
                 return packet;
             }
+            static std::shared_ptr<Byte>                Encrypt(ITransmission* transmission, Byte** packets, int* packet_lengths, int count, int& outlen) noexcept {
+                outlen = 0;
+                if (count == 1) {
+                    return Encrypt(transmission, packets[0], packet_lengths[0], outlen);
+                }
+
+                // Frames sealed with the stream ciphers share one key setup per batch, the other framings have no per-call setup to save.
+                bool safest = !transmission->handshaked_;
+                if (!safest && !transmission->configuration_->key.plaintext && NULL == transmission->aead_) {
+                    CiphertextPtr EVP_protocol = transmission->protocol_;
+                    CiphertextPtr EVP_transport = transmission->transport_;
+                    if (EVP_protocol && EVP_transport) {
+                        std::shared_ptr<BufferswapAllocator> allocator = transmission->BufferAllocator;
+                        return Transmission_Packet_Encrypt(transmission->configuration_, allocator, EVP_protocol, EVP_transport, packets, packet_lengths, count, outlen);
+                    }
+                }
+
+                ppp::vector<std::shared_ptr<Byte>> messages(count);
+                ppp::vector<int> messages_sizes(count);
+                for (int i = 0; i < count; i++) {
+                    messages[i] = Encrypt(transmission, packets[i], packet_lengths[i], messages_sizes[i]);
+                    if (NULL == messages[i]) {
+                        return NULL;
+                    }
+
+                    outlen += messages_sizes[i];
+                }
+
+                std::shared_ptr<Byte> packet = BufferswapAllocator::MakeByteArray(transmission->BufferAllocator, outlen);
+                if (NULL == packet) {
+                    outlen = 0;
+                    return NULL;
+                }
+
+                Byte* memory = packet.get();
+                for (int i = 0; i < count; i++) {
+                    memcpy(memory, messages[i].get(), messages_sizes[i]);
+                    memory += messages_sizes[i];
+                }
+
+                return packet;
+            }
             static std::shared_ptr<Byte>                Decrypt(ITransmission* transmission, Byte* data, int datalen, int& outlen) noexcept {
                 std::shared_ptr<Byte> packet;
                 if (!transmission->handshaked_ || transmission->configuration_->key.plaintext) {
@@ -105,6 +172,10 @@ namespace ppp {
                 if (NULL == packet) {
                     outlen = 0;
                 }
+                else {
+                    Metrics::Increment(Metrics::MetricsCounter_TransmissionPacketsIn);
+                    Metrics::Add(Metrics::MetricsCounter_TransmissionBytesIn, outlen);
+                }
                 return packet;
             }
 
@@ -182,13 +253,23 @@ namespace ppp {
                     return false;
                 }
 
-                int messages_size = 0;
-                std::shared_ptr<Byte> messages = Encrypt(transmission, (Byte*)packet, packet_length, messages_size);
-                if (NULL == messages) {
-                    return false;
+                Metrics::Increment(Metrics::MetricsCounter_TransmissionPacketsOut);
+                Metrics::Add(Metrics::MetricsCounter_TransmissionBytesOut, packet_length);
+
+                // Deferred messages are packed when the queue drains, with whatever ciphers the transmission holds by then. 
+                // Until the handshake has installed the session ciphers a frame is therefore sealed right away and queued as written, 
+                // So a frame queued before the key switch can never go out under the session keys.
+                if (!transmission->handshaked_) {
+                    int messages_size = 0;
+                    std::shared_ptr<Byte> messages = Encrypt(transmission, (Byte*)packet, packet_length, messages_size);
+                    if (NULL == messages) {
+                        return false;
+                    }
+
+                    return transmission->WriteBytes(messages, messages_size, cb);
                 }
 
-                return transmission->WriteBytes(messages, messages_size, cb);
+                return transmission->PackBytes(packet, packet_length, cb);
             }
 
         private:
@@ -316,6 +397,27 @@ namespace ppp {
             }
         };
 
+        static std::shared_ptr<Byte>                    Transmission_Header_Encrypt_Partial(
+            const std::shared_ptr<BufferswapAllocator>& allocator,
+            Byte*                                       EVP_payload_length_array,
+            int                                         EVP_header_datalen,
+            int&                                        EVP_header_length,
+            int                                         EVP_header_kf) noexcept {
+
+            // Mask encryption.
+            for (int i = 1; i < EVP_HEADER_MSS; i++) {
+                EVP_payload_length_array[i] ^= EVP_header_kf;
+            }
+
+            // Shuffle datas.
+            EVP_header_length = EVP_HEADER_MSS;
+            ssea::shuffle_data(reinterpret_cast<char*>(EVP_payload_length_array + 1), EVP_HEADER_TSS, EVP_header_kf);
+
+            // Delta encode.
+            std::shared_ptr<Byte> output;
+            return ssea::delta_encode(allocator, EVP_payload_length_array, EVP_header_datalen, output) != EVP_header_length ? NULL : output;
+        }
+
         static std::shared_ptr<Byte>                    Transmission_Header_Encrypt(
             const AppConfigurationPtr&                  APP,
             const std::shared_ptr<BufferswapAllocator>& allocator,
@@ -348,18 +450,7 @@ namespace ppp {
                 memcpy(EVP_payload_length_array + 1, EVP_header_length_buff.get(), EVP_HEADER_TSS);
             }
 
-            // Mask encryption.
-            for (int i = 1; i < EVP_HEADER_MSS; i++) {
-                EVP_payload_length_array[i] ^= EVP_header_kf;
-            }
-
-            // Shuffle datas.
-            EVP_header_length = sizeof(EVP_payload_length_array);
-            ssea::shuffle_data(reinterpret_cast<char*>(EVP_payload_length_array + 1), EVP_HEADER_TSS, EVP_header_kf);
-
-            // Delta encode.
-            std::shared_ptr<Byte> output;
-            return ssea::delta_encode(allocator, EVP_payload_length_array, EVP_header_datalen, output) != EVP_header_length ? NULL : output;
+            return Transmission_Header_Encrypt_Partial(allocator, EVP_payload_length_array, EVP_header_datalen, EVP_header_length, EVP_header_kf);
         }
 
         static int                                      Transmission_Header_Decrypt(
@@ -570,6 +661,109 @@ namespace ppp {
             }
         }
 
+        static std::shared_ptr<Byte>                    Transmission_Packet_Encrypt(
+            const AppConfigurationPtr&                  APP,
+            const std::shared_ptr<BufferswapAllocator>& allocator,
+            const CiphertextPtr&                        EVP_protocol,
+            const CiphertextPtr&                        EVP_transport,
+            Byte**                                      packets,
+            int*                                        packet_lengths,
+            int                                         count,
+            int&                                        outlen) noexcept {
+
+            typedef ITransmission::Ciphertext::BatchMessage BatchMessage;
+
+            outlen = 0;
+            if (count < 1) {
+                return NULL;
+            }
+
+            // Encrypt payload data (A), one key setup for every payload in the batch.
+            ppp::vector<BatchMessage> EVP_payloads(count);
+            for (int i = 0; i < count; i++) {
+                BatchMessage& EVP_payload = EVP_payloads[i];
+                EVP_payload.data = packets[i];
+                EVP_payload.datalen = packet_lengths[i];
+            }
+
+            if (!EVP_transport->Encrypt(allocator, EVP_payloads.data(), count)) {
+                return NULL;
+            }
+
+            // Encrypt header data, the length words of the batch go through the protocol cipher together as well.
+            ppp::vector<Byte> EVP_headers(count * EVP_HEADER_MSS);
+            ppp::vector<int> EVP_header_kfs(count);
+            ppp::vector<BatchMessage> EVP_header_lengths(count);
+
+            int EVP_packet_length = 0;
+            for (int i = 0; i < count; i++) {
+                int EVP_payload_length = EVP_payloads[i].outlen;
+                if (EVP_payload_length != packet_lengths[i]) {
+                    return NULL;
+                }
+
+                // Packet Alignment: 65536 -> 65535
+                int EVP_payload_length_aligned = EVP_payload_length - 1;
+                if (EVP_payload_length_aligned < 0 || EVP_payload_length_aligned > UINT16_MAX) {
+                    return NULL;
+                }
+
+                Byte* EVP_payload_length_array = EVP_headers.data() + i * EVP_HEADER_MSS;
+                EVP_payload_length_array[0] = (Byte)(RandomNext(0x01, 0xff));          // Variable frame word.
+                EVP_payload_length_array[1] = (Byte)(EVP_payload_length_aligned >> 0x08); // High-order
+                EVP_payload_length_array[2] = (Byte)(EVP_payload_length_aligned & 0xff);  // Low-order
+
+                EVP_header_kfs[i] = APP->key.kf ^ *EVP_payload_length_array;
+                EVP_header_lengths[i].data = EVP_payload_length_array + 1;
+                EVP_header_lengths[i].datalen = EVP_HEADER_TSS;
+                EVP_packet_length += EVP_HEADER_MSS + EVP_payload_length;
+            }
+
+            if (!EVP_protocol->Encrypt(allocator, EVP_header_lengths.data(), count)) {
+                return NULL;
+            }
+
+            std::shared_ptr<Byte> packet = BufferswapAllocator::MakeByteArray(allocator, EVP_packet_length);
+            if (NULL == packet) {
+                return NULL;
+            }
+
+            Byte* memory = packet.get();
+            for (int i = 0; i < count; i++) {
+                BatchMessage& EVP_header_length_buff = EVP_header_lengths[i];
+                if (EVP_header_length_buff.outlen != EVP_HEADER_TSS) {
+                    return NULL;
+                }
+
+                int EVP_header_length = 0;
+                Byte* EVP_payload_length_array = EVP_headers.data() + i * EVP_HEADER_MSS;
+                memcpy(EVP_payload_length_array + 1, EVP_header_length_buff.output.get(), EVP_HEADER_TSS);
+
+                std::shared_ptr<Byte> EVP_header = Transmission_Header_Encrypt_Partial(allocator, EVP_payload_length_array, EVP_HEADER_MSS, EVP_header_length, EVP_header_kfs[i]);
+                if (NULL == EVP_header) {
+                    return NULL;
+                }
+
+                // Encrypt payload data (B).
+                int EVP_payload_length = 0;
+                BatchMessage& EVP_payload = EVP_payloads[i];
+
+                std::shared_ptr<Byte> EVP_payload_buff = Transmission_Payload_Encrypt(APP, allocator, EVP_header_kfs[i], EVP_payload.output.get(), EVP_payload.outlen, EVP_payload_length, false);
+                if (NULL == EVP_payload_buff) {
+                    return NULL;
+                }
+
+                memcpy(memory, EVP_header.get(), EVP_header_length);
+                memory += EVP_header_length;
+
+                memcpy(memory, EVP_payload_buff.get(), EVP_payload_length);
+                memory += EVP_payload_length;
+            }
+
+            outlen = EVP_packet_length;
+            return packet;
+        }
+
         static std::shared_ptr<Byte>                    Transmission_Packet_Decrypt(
             const AppConfigurationPtr&                  APP,
             const std::shared_ptr<BufferswapAllocator>& allocator,
@@ -662,6 +856,119 @@ namespace ppp {
             return EVP_payload;
         }
 
+        // AEAD frame: HEADER(3) SEQ(8) CIPHERTEXT(n) TAG(16), the header keeps its mask/shuffle/delta obfuscation and is bound as additional data.
+        static std::shared_ptr<Byte>                    Transmission_Packet_Seal(
+            const AppConfigurationPtr&                  APP,
+            const std::shared_ptr<BufferswapAllocator>& allocator,
+            const AEADPtr&                              EVP_aead,
+            Byte*                                       data,
+            int                                         datalen,
+            int&                                        outlen) noexcept {
+
+            int EVP_header_kf = 0;
+            int EVP_header_length = 0;
+            outlen = 0;
+
+            std::shared_ptr<Byte> EVP_header = Transmission_Header_Encrypt(APP, allocator, NULL, datalen, EVP_header_length, EVP_header_kf);
+            if (NULL == EVP_header) {
+                return NULL;
+            }
+
+            int EVP_packet_length = EVP_header_length + AEAD::OVERHEAD_SIZE + datalen;
+            std::shared_ptr<Byte> packet = BufferswapAllocator::MakeByteArray(allocator, EVP_packet_length);
+            if (NULL == packet) {
+                return NULL;
+            }
+
+            Byte* EVP_packet = packet.get();
+            memcpy(EVP_packet, EVP_header.get(), EVP_header_length);
+
+            if (!EVP_aead->Seal(EVP_packet, EVP_header_length, data, datalen, EVP_packet + EVP_header_length)) {
+                return NULL;
+            }
+
+            outlen = EVP_packet_length;
+            return packet;
+        }
+
+        static std::shared_ptr<Byte>                    Transmission_Packet_Open(
+            const AppConfigurationPtr&                  APP,
+            const std::shared_ptr<BufferswapAllocator>& allocator,
+            const AEADPtr&                              EVP_aead,
+            Byte*                                       data,
+            int                                         datalen,
+            int&                                        outlen) noexcept {
+
+            int EVP_header_kf = 0;
+            outlen = 0;
+
+            if (datalen <= EVP_HEADER_MSS + AEAD::OVERHEAD_SIZE) {
+                return NULL;
+            }
+
+            int EVP_payload_length = Transmission_Header_Decrypt(APP, allocator, NULL, data, EVP_header_kf);
+            if (EVP_payload_length < 1) {
+                return NULL;
+            }
+
+            int EVP_packet_length = EVP_HEADER_MSS + AEAD::OVERHEAD_SIZE + EVP_payload_length;
+            if (EVP_packet_length != datalen) {
+                return NULL;
+            }
+
+            std::shared_ptr<Byte> EVP_payload = BufferswapAllocator::MakeByteArray(allocator, EVP_payload_length);
+            if (NULL == EVP_payload) {
+                return NULL;
+            }
+
+            if (!EVP_aead->Open(data, EVP_HEADER_MSS, data + EVP_HEADER_MSS, datalen - EVP_HEADER_MSS, EVP_payload.get())) {
+                return NULL;
+            }
+
+            outlen = EVP_payload_length;
+            return EVP_payload;
+        }
+
+        static std::shared_ptr<Byte>                    Transmission_Packet_Read(
+            const AppConfigurationPtr&                  APP,
+            const std::shared_ptr<BufferswapAllocator>& allocator,
+            const AEADPtr&                              EVP_aead,
+            int&                                        outlen,
+            ITransmission*                              transmission,
+            YieldContext&                               y) noexcept {
+
+            int EVP_header_kf = 0;
+            outlen = 0;
+
+            std::shared_ptr<Byte> EVP_header = ITransmissionBridge::ReadBytes(transmission, y, EVP_HEADER_MSS);
+            if (NULL == EVP_header) {
+                return NULL;
+            }
+
+            int EVP_payload_length = Transmission_Header_Decrypt(APP, allocator, NULL, EVP_header.get(), EVP_header_kf);
+            if (EVP_payload_length < 1) {
+                return NULL;
+            }
+
+            int EVP_sealed_length = AEAD::OVERHEAD_SIZE + EVP_payload_length;
+            std::shared_ptr<Byte> EVP_sealed = ITransmissionBridge::ReadBytes(transmission, y, EVP_sealed_length);
+            if (NULL == EVP_sealed) {
+                return NULL;
+            }
+
+            std::shared_ptr<Byte> EVP_payload = BufferswapAllocator::MakeByteArray(allocator, EVP_payload_length);
+            if (NULL == EVP_payload) {
+                return NULL;
+            }
+
+            if (!EVP_aead->Open(EVP_header.get(), EVP_HEADER_MSS, EVP_sealed.get(), EVP_sealed_length, EVP_payload.get())) {
+                return NULL;
+            }
+
+            outlen = EVP_payload_length;
+            return EVP_payload;
+        }
+
         static std::shared_ptr<Byte>                    Transmission_Handshake_Pack_SessionId(
             const AppConfigurationPtr&                  APP,
             const std::shared_ptr<BufferswapAllocator>& allocator,
@@ -882,6 +1189,15 @@ namespace ppp {
             return ITransmissionBridge::Write(this, packet, packet_length, cb);
         }
 
+        std::shared_ptr<Byte> ITransmission::DoPackBytes(Byte** packets, int* packet_lengths, int count, int& outlen) noexcept {
+            outlen = 0;
+            if (NULL == packets || NULL == packet_lengths || count < 1) {
+                return NULL;
+            }
+
+            return ITransmissionBridge::Encrypt(this, packets, packet_lengths, count, outlen);
+        }
+
         std::shared_ptr<Byte> ITransmission::Encrypt(Byte* data, int datalen, int& outlen) noexcept {
             outlen = 0;
             if (datalen < 0 || (NULL == data && datalen != 0)) {
@@ -919,11 +1235,35 @@ namespace ppp {
                 });
         }
 
+        // Times one handshake whatever path leaves it, the transmission's handshaked flag tells success from failure.
+        template <typename THandshaked>
+        class ITransmissionHandshakeMetrics final {
+        public:
+            ITransmissionHandshakeMetrics(THandshaked&& handshaked) noexcept
+                : handshaked_(std::move(handshaked))
+                , start_(ppp::GetTickCount(true)) {
+
+            }
+            ~ITransmissionHandshakeMetrics() noexcept {
+                if (handshaked_()) {
+                    Metrics::Record(Metrics::MetricsHistogram_HandshakeLatency, ppp::GetTickCount(true) - start_);
+                }
+                else {
+                    Metrics::Increment(Metrics::MetricsCounter_HandshakeFailures);
+                }
+            }
+
+        private:
+            THandshaked                                 handshaked_;
+            uint64_t                                    start_ = 0;
+        };
+
         Int128 ITransmission::HandshakeClient(YieldContext& y, bool& mux) noexcept {
             if (disposed_) {
                 return 0;
             }
 
+            ITransmissionHandshakeMetrics metrics([this]() noexcept { return (bool)handshaked_; });
             if (!Transmission_Handshake_Nop(configuration_, this, y)) {
                 return 0;
             }
@@ -937,7 +1277,6 @@ namespace ppp {
 
                 Int128 nmux = Transmission_Handshake_SessionId(configuration_, this, y);
                 if (nmux) {
-                    handshaked_ = true;
                     if (nmux & 1) {
                         mux = true;
                     }
@@ -956,8 +1295,18 @@ namespace ppp {
                                 protocol_ = make_shared_object<Ciphertext>(configuration_->key.protocol, configuration_->key.protocol_key + ivv_string);
                                 transport_ = make_shared_object<Ciphertext>(configuration_->key.transport, configuration_->key.transport_key + ivv_string);
                             }
+
+                            if (configuration_->key.aead) {
+                                aead_ = make_shared_object<AEAD>(configuration_->key.transport, configuration_->key.transport_key + ivv_string, false);
+                                if (NULL != aead_ && !aead_->IsVaild()) {
+                                    aead_ = NULL;
+                                }
+                            }
                         }
                     }
+
+                    // Only flagged once the session ciphers are in place, writes packed after this point never see the old ones.
+                    handshaked_ = true;
                     return session_id;
                 }
             }
@@ -973,6 +1322,7 @@ namespace ppp {
                 return false;
             }
 
+            ITransmissionHandshakeMetrics metrics([this]() noexcept { return (bool)handshaked_; });
             if (!Transmission_Handshake_Nop(configuration_, this, y)) {
                 return false;
             }
@@ -1002,7 +1352,6 @@ namespace ppp {
 
             Int128 ivv = Transmission_Handshake_SessionId(configuration_, this, y);
             if (ivv != 0) {
-                handshaked_ = true;
                 if (NULL != protocol_ && NULL != transport_) {
                     ppp::string ivv_string = stl::to_string<ppp::string>(ivv, 32);
                     if (ivv > 0) {
@@ -1014,8 +1363,17 @@ namespace ppp {
                             protocol_ = make_shared_object<Ciphertext>(configuration_->key.protocol, configuration_->key.protocol_key + ivv_string);
                             transport_ = make_shared_object<Ciphertext>(configuration_->key.transport, configuration_->key.transport_key + ivv_string);
                         }
+
+                        if (configuration_->key.aead) {
+                            aead_ = make_shared_object<AEAD>(configuration_->key.transport, configuration_->key.transport_key + ivv_string, true);
+                            if (NULL != aead_ && !aead_->IsVaild()) {
+                                aead_ = NULL;
+                            }
+                        }
                     }
                 }
+
+                handshaked_ = true;
             }
 
             return handshaked_;
@@ -1027,7 +1385,10 @@ namespace ppp {
             CiphertextPtr EVP_transport = transmission->transport_;
 
             std::shared_ptr<BufferswapAllocator> allocator = transmission->BufferAllocator;
-            if (EVP_protocol && EVP_transport) {
+            if (AEADPtr EVP_aead = transmission->aead_; NULL != EVP_aead && !safest) {
+                return Transmission_Packet_Seal(transmission->configuration_, allocator, EVP_aead, data, datalen, outlen);
+            }
+            elif(EVP_protocol && EVP_transport) {
                 return Transmission_Packet_Encrypt(transmission->configuration_, allocator, EVP_protocol, EVP_transport, data, datalen, outlen, safest);
             }
             else {
@@ -1041,7 +1402,10 @@ namespace ppp {
             CiphertextPtr EVP_transport = transmission->transport_;
 
             std::shared_ptr<BufferswapAllocator> allocator = transmission->BufferAllocator;
-            if (EVP_protocol && EVP_transport) {
+            if (AEADPtr EVP_aead = transmission->aead_; NULL != EVP_aead && !safest) {
+                return Transmission_Packet_Open(transmission->configuration_, allocator, EVP_aead, data, datalen, outlen);
+            }
+            elif(EVP_protocol && EVP_transport) {
                 return Transmission_Packet_Decrypt(transmission->configuration_, allocator, EVP_protocol, EVP_transport, data, datalen, outlen, safest);
             }
             else {
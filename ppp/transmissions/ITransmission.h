@@ -2,6 +2,7 @@
 
 #include <ppp/stdafx.h>
 #include <ppp/Int128.h>
+#include <ppp/cryptography/AEAD.h>
 #include <ppp/cryptography/Ciphertext.h>
 #include <ppp/coroutines/YieldContext.h>
 #include <ppp/threading/BufferswapAllocator.h>
@@ -21,6 +22,8 @@ namespace ppp {
             typedef std::shared_ptr<AppConfiguration>                                               AppConfigurationPtr;
             typedef ppp::cryptography::Ciphertext                                                   Ciphertext;
             typedef std::shared_ptr<Ciphertext>                                                     CiphertextPtr;
+            typedef ppp::cryptography::AEAD                                                         AEAD;
+            typedef std::shared_ptr<AEAD>                                                           AEADPtr;
             typedef ppp::coroutines::YieldContext                                                   YieldContext;
             typedef std::shared_ptr<boost::asio::io_context>                                        ContextPtr;
             typedef std::shared_ptr<boost::asio::strand<boost::asio::io_context::executor_type>>    StrandPtr;
@@ -57,6 +60,7 @@ namespace ppp {
 
         protected:
             virtual std::shared_ptr<Byte>                                                           DoReadBytes(YieldContext& y, int length) noexcept = 0;
+            virtual std::shared_ptr<Byte>                                                           DoPackBytes(Byte** packets, int* packet_lengths, int count, int& outlen) noexcept override;
 
         private:
             void                                                                                    Finalize() noexcept;
@@ -70,6 +74,7 @@ namespace ppp {
             StrandPtr                                                                               strand_;
             CiphertextPtr                                                                           protocol_;
             CiphertextPtr                                                                           transport_;
+            AEADPtr                                                                                 aead_;
             AppConfigurationPtr                                                                     configuration_;
         };
     }
@@ -163,7 +163,6 @@ namespace ppp {
                     }
 
                     disposed_ = true;
-                    ITransmission::Dispose();
                 }
                 virtual bool                                                ShiftToScheduler() noexcept override {
                     std::shared_ptr<IWebsocket> socket = socket_;
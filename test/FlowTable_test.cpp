@@ -0,0 +1,148 @@
+// Checks FlowTable against std::unordered_map and checks that erasing while iterating visits every entry once, exits non-zero on a failure.
+//
+// The identity hash puts keys on chosen home slots, so clusters can be made to wrap around the end of the slot array, which is
+// where backward-shift deletion moves entries the iteration may already have passed.
+
+#include <ppp/stdafx.h>
+#include <ppp/collections/FlowTable.h>
+
+#include <unordered_map>
+
+using ppp::collections::FlowTable;
+
+static int failures = 0;
+
+#define FLOW_TABLE_CHECK(condition)                                     \
+    if (!(condition)) {                                                 \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+        failures++;                                                     \
+    }
+
+struct IdentityHash {
+    uint64_t operator()(uint64_t key) const noexcept { return key; }
+};
+
+typedef FlowTable<uint64_t, uint64_t, IdentityHash>                     IdentityTable;
+
+// Small linear congruential generator, the same seed always yields the same operations.
+static uint32_t NextRandom(uint32_t& seed) noexcept {
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+// Erases the entries the predicate picks while iterating, every entry must be visited exactly once and only the picked ones go.
+template <typename TPredicate>
+static void EraseWhileIterating(IdentityTable& table, TPredicate&& predicate) noexcept {
+    std::unordered_map<uint64_t, int> visits;
+    std::unordered_map<uint64_t, uint64_t> expected;
+    for (auto&& kv : table) {
+        if (!predicate(kv.first)) {
+            expected.emplace(kv.first, kv.second);
+        }
+    }
+
+    for (IdentityTable::iterator tail = table.begin(); tail != table.end();) {
+        uint64_t key = tail->first;
+        visits[key]++;
+        if (predicate(key)) {
+            tail = table.erase(tail);
+        }
+        else {
+            tail++;
+        }
+    }
+
+    for (auto&& kv : visits) {
+        FLOW_TABLE_CHECK(kv.second == 1);
+    }
+
+    FLOW_TABLE_CHECK(table.size() == expected.size());
+    for (auto&& kv : expected) {
+        IdentityTable::iterator it = table.find(kv.first);
+        FLOW_TABLE_CHECK(it != table.end() && it->second == kv.second);
+    }
+}
+
+static void TestWrappedClusters() noexcept {
+    // 16 slots: the home slots 13, 14 and 15 take ten keys, the cluster runs past the end onto slots 0 to 6.
+    for (int pick = 0; pick < 4; pick++) {
+        IdentityTable table;
+        for (uint64_t i = 0; i < 10; i++) {
+            table.try_emplace(13 + (i % 3) + 16 * i, i);
+        }
+
+        FLOW_TABLE_CHECK(table.size() == 10);
+        EraseWhileIterating(table,
+            [pick](uint64_t key) noexcept {
+                switch (pick) {
+                case 0:
+                    return true;
+                case 1:
+                    return (key & 16) != 0;
+                case 2:
+                    return key % 3 == 0;
+                default:
+                    return key < 64;
+                }
+            });
+    }
+}
+
+static void TestRandomOperations() noexcept {
+    IdentityTable table;
+    std::unordered_map<uint64_t, uint64_t> reference;
+
+    uint32_t seed = 47;
+    for (int i = 0; i < 200000; i++) {
+        // Keys crowd a few home slots of a small table so clusters are long and often wrap.
+        uint64_t key = (NextRandom(seed) % 512) * ((NextRandom(seed) & 1) ? 1 : 64);
+        switch (NextRandom(seed) % 4) {
+        case 0:
+        case 1: {
+            uint64_t value = NextRandom(seed);
+            bool inserted = table.try_emplace(key, value).second;
+            FLOW_TABLE_CHECK(inserted == reference.emplace(key, value).second);
+            break;
+        }
+        case 2:
+            FLOW_TABLE_CHECK(table.erase(key) == reference.erase(key));
+            break;
+        default: {
+            IdentityTable::iterator it = table.find(key);
+            std::unordered_map<uint64_t, uint64_t>::iterator r = reference.find(key);
+            FLOW_TABLE_CHECK((it == table.end()) == (r == reference.end()));
+            if (it != table.end() && r != reference.end()) {
+                FLOW_TABLE_CHECK(it->second == r->second);
+            }
+            break;
+        }
+        }
+
+        if (i % 5000 == 4999) {
+            uint32_t modulo = 2 + NextRandom(seed) % 5;
+            EraseWhileIterating(table, [modulo](uint64_t key) noexcept { return key % modulo == 0; });
+            for (auto tail = reference.begin(); tail != reference.end();) {
+                tail = tail->first % modulo == 0 ? reference.erase(tail) : std::next(tail);
+            }
+        }
+
+        if (failures > 16) {
+            return;
+        }
+    }
+
+    FLOW_TABLE_CHECK(table.size() == reference.size());
+}
+
+int main(int argc, const char* argv[]) {
+    TestWrappedClusters();
+    TestRandomOperations();
+
+    if (failures > 0) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+
+    printf("FlowTable: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,296 @@
+// Feeds IPFragment shuffled, duplicated and overlapping fragments and checks every datagram it hands back byte for byte, exits non-zero
+// on a failure.
+//
+// The fragments reach the end of the largest datagram IPv4 can carry, arrive past the slot and memory caps and after their timeout,
+// and some are malformed, so the checks cover the paths that write into or drop reassembly buffers. Configure the build with
+// -DCMAKE_CXX_FLAGS="-fsanitize=address -UJEMALLOC" to run it under ASan, any write past a buffer then fails the run as well. Without
+// -UJEMALLOC the buffers come from jemalloc and ASan does not see them.
+
+#include <ppp/stdafx.h>
+#include <ppp/net/packet/IPFrame.h>
+#include <ppp/net/packet/IPFragment.h>
+#include <ppp/threading/Executors.h>
+
+using ppp::Byte;
+using ppp::net::packet::BufferSegment;
+using ppp::net::packet::IPFlags;
+using ppp::net::packet::IPFrame;
+using ppp::net::packet::IPFragment;
+using ppp::net::native::ip_hdr;
+
+typedef std::shared_ptr<IPFrame>                                        IPFramePtr;
+typedef std::vector<Byte>                                               Payload;
+
+static int failures = 0;
+
+#define IP_FRAGMENT_CHECK(condition)                                    \
+    if (!(condition)) {                                                 \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+        failures++;                                                     \
+    }
+
+// Small linear congruential generator, the same seed always yields the same datagrams and the same arrival order.
+static uint32_t NextRandom(uint32_t& seed) noexcept {
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+// Collects what the reassembler hands back, keyed by the datagram id.
+struct Reassembled {
+    std::map<int, Payload>                                              datagrams;
+    int                                                                 duplicates = 0;
+};
+
+static std::shared_ptr<IPFragment> NewFragment(Reassembled& reassembled, int slots, int memory, int timeout) noexcept {
+    std::shared_ptr<IPFragment> fragment = ppp::make_shared_object<IPFragment>(slots, memory, timeout);
+    if (NULL == fragment) {
+        return NULL;
+    }
+
+    fragment->PacketInput =
+        [&reassembled](IPFragment*, IPFragment::PacketInputEventArgs& e) noexcept {
+            IPFramePtr packet = e.Packet;
+            std::shared_ptr<BufferSegment> payload = NULL != packet ? packet->Payload : NULL;
+            if (NULL == payload || NULL == payload->Buffer) {
+                return;
+            }
+
+            Byte* p = payload->Buffer.get();
+            bool inserted = reassembled.datagrams.emplace(packet->Id, Payload(p, p + payload->Length)).second;
+            reassembled.duplicates += inserted ? 0 : 1;
+        };
+    return fragment;
+}
+
+static Payload NewPayload(uint32_t& seed, int length) noexcept {
+    Payload payload(length);
+    for (Byte& b : payload) {
+        b = (Byte)NextRandom(seed);
+    }
+    return payload;
+}
+
+static IPFramePtr NewFragmentFrame(int id, const Payload& payload, int offset, int length, bool more) noexcept {
+    std::shared_ptr<Byte> buffer = ppp::make_shared_alloc<Byte>(std::max<int>(1, length));
+    IPFramePtr frame = ppp::make_shared_object<IPFrame>();
+    if (NULL == buffer || NULL == frame) {
+        return NULL;
+    }
+
+    memcpy(buffer.get(), payload.data() + offset, length);
+    frame->ProtocolType = ip_hdr::IP_PROTO_UDP;
+    frame->Source = htonl(0x0a000001);
+    frame->Destination = htonl(0x0a000002);
+    frame->Id = (ppp::UInt16)id;
+    frame->Flags = more ? IPFlags::IP_MF : (IPFlags)0;
+    frame->SetFragmentOffset(offset);
+    frame->Payload = ppp::make_shared_object<BufferSegment>(buffer, length);
+    return frame;
+}
+
+// Cuts the payload into fragments of random multiples of eight octets, adds duplicates and fragments that overlap their neighbours.
+static std::vector<IPFramePtr> NewFragmentFrames(uint32_t& seed, int id, const Payload& payload) noexcept {
+    std::vector<IPFramePtr> frames;
+    int length = (int)payload.size();
+    for (int offset = 0; offset < length;) {
+        int size = std::min<int>(length - offset, 8 * (1 + (int)(NextRandom(seed) % 185)));
+        if (offset == 0 && size == length) {
+            size = (length - 1) & ~7; /* a whole datagram is not a fragment, Input turns it away */
+        }
+
+        bool more = offset + size < length;
+        frames.emplace_back(NewFragmentFrame(id, payload, offset, size, more));
+
+        switch (NextRandom(seed) % 8) {
+        case 0:
+            frames.emplace_back(NewFragmentFrame(id, payload, offset, size, more));
+            break;
+        case 1:
+            if (offset >= 8 && more) {
+                frames.emplace_back(NewFragmentFrame(id, payload, offset - 8, size, true));
+            }
+            break;
+        default:
+            break;
+        }
+
+        offset += size;
+    }
+
+    for (std::size_t i = frames.size(); i > 1; i--) {
+        std::swap(frames[i - 1], frames[NextRandom(seed) % i]);
+    }
+    return frames;
+}
+
+static void TestShuffledFragments() noexcept {
+    Reassembled reassembled;
+    // A duplicate that arrives after its datagram completed opens a new one that never does, the caps leave room for all of them.
+    std::shared_ptr<IPFragment> fragment = NewFragment(reassembled, 1024, 32 * 1024 * 1024, 60000);
+    if (NULL == fragment) {
+        failures++;
+        return;
+    }
+
+    uint32_t seed = 46;
+    std::map<int, Payload> expected;
+    std::vector<IPFramePtr> frames;
+    for (int id = 1; id <= 64; id++) {
+        // A few datagrams end exactly at the largest payload an IPv4 header allows.
+        int length = id % 16 == 0 ? IPFragment::MAX_PAYLOAD : 9 + (int)(NextRandom(seed) % 30000);
+        Payload payload = NewPayload(seed, length);
+
+        std::vector<IPFramePtr> datagram = NewFragmentFrames(seed, id, payload);
+        frames.insert(frames.end(), datagram.begin(), datagram.end());
+        expected.emplace(id, std::move(payload));
+    }
+
+    // Interleave the datagrams too.
+    for (std::size_t i = frames.size(); i > 1; i--) {
+        std::swap(frames[i - 1], frames[NextRandom(seed) % i]);
+    }
+
+    for (const IPFramePtr& frame : frames) {
+        IP_FRAGMENT_CHECK(NULL != frame && fragment->Input(frame));
+    }
+
+    IP_FRAGMENT_CHECK(reassembled.duplicates == 0);
+    IP_FRAGMENT_CHECK(reassembled.datagrams.size() == expected.size());
+    for (auto&& [id, payload] : expected) {
+        auto tail = reassembled.datagrams.find(id);
+        IP_FRAGMENT_CHECK(tail != reassembled.datagrams.end() && tail->second == payload);
+    }
+
+    fragment->Release();
+}
+
+// Fragments past the largest payload, of a length that is not a multiple of eight, or with a second end are dropped without output.
+static void TestMalformedFragments() noexcept {
+    Reassembled reassembled;
+    std::shared_ptr<IPFragment> fragment = NewFragment(reassembled, 4, IPFragment::MAX_MEMORY, 60000);
+    if (NULL == fragment) {
+        failures++;
+        return;
+    }
+
+    uint32_t seed = 7;
+    Payload payload = NewPayload(seed, IPFragment::MAX_PAYLOAD + 64);
+
+    fragment->Input(NewFragmentFrame(1, payload, (IPFragment::MAX_PAYLOAD & ~7) - 8 * 4, 8 * 8, true));
+    fragment->Input(NewFragmentFrame(2, payload, 0, 13, true));
+    fragment->Input(NewFragmentFrame(3, payload, 64, 64, false));
+    fragment->Input(NewFragmentFrame(3, payload, 64, 32, false));
+    fragment->Input(NewFragmentFrame(3, payload, 0, 64, true));
+    fragment->Input(NewFragmentFrame(4, payload, 512, 64, false));
+    fragment->Input(NewFragmentFrame(4, payload, 1024, 64, true));
+    fragment->Input(NewFragmentFrame(4, payload, 0, 512, true));
+
+    IP_FRAGMENT_CHECK(reassembled.datagrams.empty());
+    fragment->Release();
+}
+
+// Past the slot or the memory cap the oldest datagram goes, the newer ones still complete, and expired ones never do.
+static void TestCapsAndTimeouts() noexcept {
+    uint32_t seed = 11;
+    Payload payload = NewPayload(seed, 40000);
+
+    {
+        Reassembled reassembled;
+        std::shared_ptr<IPFragment> fragment = NewFragment(reassembled, 2, IPFragment::MAX_MEMORY, 60000);
+        for (int id = 1; id <= 3; id++) {
+            fragment->Input(NewFragmentFrame(id, payload, 0, 1024, true));
+        }
+
+        for (int id = 2; id <= 3; id++) {
+            fragment->Input(NewFragmentFrame(id, payload, 1024, 1024, false));
+        }
+
+        fragment->Input(NewFragmentFrame(1, payload, 1024, 1024, false));
+
+        IP_FRAGMENT_CHECK(reassembled.datagrams.size() == 2 && reassembled.datagrams.count(1) == 0);
+        fragment->Release();
+    }
+
+    {
+        Reassembled reassembled;
+        std::shared_ptr<IPFragment> fragment = NewFragment(reassembled, 8, IPFragment::MAX_PAYLOAD, 60000);
+        fragment->Input(NewFragmentFrame(1, payload, 0, 32768, true));
+        fragment->Input(NewFragmentFrame(2, payload, 0, 32768, true));
+        fragment->Input(NewFragmentFrame(2, payload, 32768, 40000 - 32768, false));
+        fragment->Input(NewFragmentFrame(1, payload, 32768, 40000 - 32768, false));
+
+        IP_FRAGMENT_CHECK(reassembled.datagrams.size() == 1 && reassembled.datagrams.count(2) == 1);
+        IP_FRAGMENT_CHECK(reassembled.datagrams.count(2) == 0 || reassembled.datagrams[2] == payload);
+        fragment->Release();
+    }
+
+    {
+        Reassembled reassembled;
+        std::shared_ptr<IPFragment> fragment = NewFragment(reassembled, 8, IPFragment::MAX_MEMORY, 1000);
+        fragment->Input(NewFragmentFrame(1, payload, 0, 1024, true));
+        IP_FRAGMENT_CHECK(fragment->Update(ppp::threading::Executors::GetTickCount() + 60000) == 1);
+
+        fragment->Input(NewFragmentFrame(1, payload, 1024, 1024, false));
+        IP_FRAGMENT_CHECK(reassembled.datagrams.empty());
+        fragment->Release();
+    }
+}
+
+// Whatever Output splits a datagram into must reassemble into the same datagram.
+static void TestOutputRoundTrip() noexcept {
+    Reassembled reassembled;
+    std::shared_ptr<IPFragment> fragment = NewFragment(reassembled, IPFragment::MAX_SUBPACKAGES, IPFragment::MAX_MEMORY, 60000);
+    if (NULL == fragment) {
+        failures++;
+        return;
+    }
+
+    std::vector<IPFramePtr> frames;
+    fragment->PacketOutput =
+        [&frames](IPFragment*, IPFragment::PacketOutputEventArgs& e) noexcept {
+            std::shared_ptr<ppp::threading::BufferswapAllocator> allocator;
+            frames.emplace_back(IPFrame::Parse(allocator, e.Packet.get(), e.PacketLength));
+        };
+
+    uint32_t seed = 3;
+    for (int id = 1; id <= 16; id++) {
+        Payload payload = NewPayload(seed, 1500 + (int)(NextRandom(seed) % 60000));
+        IPFramePtr frame = NewFragmentFrame(id, payload, 0, (int)payload.size(), false);
+        frame->Flags = (IPFlags)0;
+
+        frames.clear();
+        IP_FRAGMENT_CHECK(NULL != frame && fragment->Output(frame.get()));
+        IP_FRAGMENT_CHECK(frames.size() > 1);
+
+        for (std::size_t i = frames.size(); i > 1; i--) {
+            std::swap(frames[i - 1], frames[NextRandom(seed) % i]);
+        }
+
+        for (const IPFramePtr& subpackage : frames) {
+            IP_FRAGMENT_CHECK(NULL != subpackage && fragment->Input(subpackage));
+        }
+
+        auto tail = reassembled.datagrams.find(frame->Id);
+        IP_FRAGMENT_CHECK(tail != reassembled.datagrams.end() && tail->second == payload);
+        reassembled.datagrams.clear();
+    }
+
+    fragment->Release();
+}
+
+int main(int argc, const char* argv[]) {
+    ppp::global::cctor();
+
+    TestShuffledFragments();
+    TestMalformedFragments();
+    TestCapsAndTimeouts();
+    TestOutputRoundTrip();
+
+    if (failures > 0) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+
+    printf("IPFragment: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,256 @@
+// Checks the incremental checksum updates of PacketView against checksums computed over the whole packet, exits non-zero on a failure.
+//
+// Seeded UDP, TCP and ICMP datagrams get their TTL, addresses and ports rewritten in random order, after every rewrite the IP header
+// and the transport checksum must still verify the way the receiving stack checks them. UDP datagrams without a checksum must keep
+// it zero, fragments must not have their payload touched, and inet_chksum_adjust must give the worked example of RFC 1624.
+
+#include <ppp/stdafx.h>
+#include <ppp/net/native/checksum.h>
+#include <ppp/net/packet/PacketView.h>
+
+using ppp::Byte;
+using ppp::net::packet::PacketView;
+using ppp::net::native::ip_hdr;
+using ppp::net::native::udp_hdr;
+
+typedef std::vector<Byte>                                               Datagram;
+
+static int failures = 0;
+
+#define PACKET_VIEW_CHECK(condition)                                    \
+    if (!(condition)) {                                                 \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+        failures++;                                                     \
+    }
+
+static constexpr int IP_HEADER_SIZE     = 20;
+static constexpr int TCP_HEADER_SIZE    = 20;
+static constexpr int TCP_CHKSUM_OFFSET  = 16;
+static constexpr int ICMP_HEADER_SIZE   = 8;
+
+// Small linear congruential generator, the same seed always yields the same packets and the same rewrites.
+static uint32_t NextRandom(uint32_t& seed) noexcept {
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+static uint32_t NextAddress(uint32_t& seed) noexcept {
+    // Neither 0.0.0.0 nor 255.255.255.255, ip_hdr::Parse turns both away.
+    return htonl(0x0a000001u + NextRandom(seed) % 0xe0000000u);
+}
+
+static void WriteWord(Byte* p, unsigned short w) noexcept {
+    memcpy(p, &w, sizeof(w));
+}
+
+static unsigned short TransportChecksum(Datagram& packet, int proto) noexcept {
+    ip_hdr* ip = (ip_hdr*)packet.data();
+    return ppp::net::native::inet_chksum_pseudo(packet.data() + IP_HEADER_SIZE, proto, (unsigned int)packet.size() - IP_HEADER_SIZE, ip->src, ip->dest);
+}
+
+static Datagram NewPacket(uint32_t& seed, int proto, bool fragment, bool udp_checksum) noexcept {
+    int transport_length = 0;
+    if (proto == ip_hdr::IP_PROTO_UDP) {
+        transport_length = sizeof(udp_hdr) + 1 + NextRandom(seed) % 1400;
+    }
+    elif(proto == ip_hdr::IP_PROTO_TCP) {
+        transport_length = TCP_HEADER_SIZE + NextRandom(seed) % 1400;
+    }
+    else {
+        transport_length = ICMP_HEADER_SIZE + NextRandom(seed) % 64;
+    }
+
+    Datagram packet(IP_HEADER_SIZE + transport_length);
+    for (Byte& b : packet) {
+        b = (Byte)NextRandom(seed);
+    }
+
+    ip_hdr* ip = (ip_hdr*)packet.data();
+    ip->v_hl = 0x45;
+    ip->tos = 0;
+    ip->len = htons((unsigned short)packet.size());
+    ip->flags = fragment ? htons(ip_hdr::IP_MF) : 0;
+    ip->ttl = (unsigned char)(2 + NextRandom(seed) % 254);
+    ip->proto = (unsigned char)proto;
+    ip->src = NextAddress(seed);
+    ip->dest = NextAddress(seed);
+    ip->chksum = 0;
+    ip->chksum = ppp::net::native::inet_chksum(ip, IP_HEADER_SIZE);
+
+    Byte* transport = packet.data() + IP_HEADER_SIZE;
+    if (proto == ip_hdr::IP_PROTO_UDP) {
+        udp_hdr* udp = (udp_hdr*)transport;
+        udp->len = htons((unsigned short)transport_length);
+        udp->chksum = 0;
+        if (udp_checksum) {
+            unsigned short chksum = TransportChecksum(packet, proto);
+            udp->chksum = chksum == 0 ? 0xffff : chksum;
+        }
+    }
+    elif(proto == ip_hdr::IP_PROTO_TCP) {
+        transport[12] = (Byte)((TCP_HEADER_SIZE >> 2) << 4);
+        WriteWord(transport + TCP_CHKSUM_OFFSET, 0);
+        WriteWord(transport + TCP_CHKSUM_OFFSET, TransportChecksum(packet, proto));
+    }
+    else {
+        transport[0] = 8; /* echo request */
+        transport[1] = 0;
+        WriteWord(transport + 2, 0);
+        WriteWord(transport + 2, ppp::net::native::inet_chksum(transport, transport_length));
+    }
+
+    return packet;
+}
+
+// 0x0000 and 0xffff are the two one's complement zeros, either one verifies the same way.
+static bool SameChecksum(unsigned short x, unsigned short y) noexcept {
+    return x == y || ((x == 0 || x == 0xffff) && (y == 0 || y == 0xffff));
+}
+
+static bool IpChecksumValid(Datagram& packet) noexcept {
+    return ppp::net::native::inet_chksum(packet.data(), IP_HEADER_SIZE) == 0;
+}
+
+// The receiving stack sums the pseudo header and the segment with its checksum in place, the result has to be zero.
+static bool TransportChecksumValid(Datagram& packet, int proto) noexcept {
+    return TransportChecksum(packet, proto) == 0;
+}
+
+// One random rewrite, the same fields the client rewrites on datagrams from the virtual adapter.
+static void Rewrite(uint32_t& seed, PacketView& view, bool ports) noexcept {
+    switch (NextRandom(seed) % (ports ? 5 : 3)) {
+    case 0:
+        view.SetTtl(1 + NextRandom(seed) % 255);
+        break;
+    case 1:
+        view.SetSource(NextAddress(seed));
+        break;
+    case 2:
+        view.SetDestination(NextAddress(seed));
+        break;
+    case 3:
+        view.SetSourcePort(1 + NextRandom(seed) % 65535);
+        break;
+    default:
+        view.SetDestinationPort(1 + NextRandom(seed) % 65535);
+        break;
+    }
+}
+
+// RFC 1624 section 4: m = 0x5555 becomes m' = 0x3285 under HC = 0xDD2F, equation 3 gives HC' = 0x0000 and not the 0xFFFF of RFC 1141.
+static void TestRfc1624Example() noexcept {
+    PACKET_VIEW_CHECK(ppp::net::native::inet_chksum_adjust(htons(0xDD2F), htons(0x5555), htons(0x3285)) == htons(0x0000));
+
+    // The delta form must agree with adjusting the words one after another.
+    uint32_t seed = 1624;
+    for (int i = 0; i < 10000; i++) {
+        unsigned short chksum = (unsigned short)NextRandom(seed);
+        uint32_t old_dword = NextRandom(seed) ^ (NextRandom(seed) << 16);
+        uint32_t new_dword = NextRandom(seed) ^ (NextRandom(seed) << 16);
+
+        unsigned int delta = ppp::net::native::inet_chksum_delta32(0, old_dword, new_dword);
+        PACKET_VIEW_CHECK(SameChecksum(ppp::net::native::inet_chksum_adjust_delta(chksum, delta), ppp::net::native::inet_chksum_adjust32(chksum, old_dword, new_dword)));
+    }
+}
+
+static void TestUdpRewrites() noexcept {
+    uint32_t seed = 17;
+    for (int i = 0; i < 5000; i++) {
+        Datagram packet = NewPacket(seed, ip_hdr::IP_PROTO_UDP, false, true);
+        PacketView view(packet.data(), (int)packet.size());
+        PACKET_VIEW_CHECK(view.IsValid() && NULL != view.GetUdpHeader());
+        if (!view.IsValid() || NULL == view.GetUdpHeader()) {
+            continue;
+        }
+
+        for (int j = 0; j < 8; j++) {
+            Rewrite(seed, view, true);
+            PACKET_VIEW_CHECK(IpChecksumValid(packet));
+            PACKET_VIEW_CHECK(TransportChecksumValid(packet, ip_hdr::IP_PROTO_UDP));
+            PACKET_VIEW_CHECK(((udp_hdr*)view.GetPayload())->chksum != 0);
+        }
+
+        // A rewritten datagram parses like one that was built with those fields.
+        PacketView reparsed(packet.data(), (int)packet.size());
+        PACKET_VIEW_CHECK(reparsed.IsValid() && reparsed.GetSourcePort() == view.GetSourcePort() && reparsed.GetDestination() == view.GetDestination());
+    }
+}
+
+static void TestUdpWithoutChecksum() noexcept {
+    uint32_t seed = 0;
+    for (int i = 0; i < 1000; i++) {
+        Datagram packet = NewPacket(seed, ip_hdr::IP_PROTO_UDP, false, false);
+        PacketView view(packet.data(), (int)packet.size());
+        PACKET_VIEW_CHECK(view.IsValid() && NULL != view.GetUdpHeader());
+        if (!view.IsValid() || NULL == view.GetUdpHeader()) {
+            continue;
+        }
+
+        for (int j = 0; j < 8; j++) {
+            Rewrite(seed, view, true);
+            PACKET_VIEW_CHECK(IpChecksumValid(packet));
+            PACKET_VIEW_CHECK(view.GetUdpHeader()->chksum == 0);
+        }
+    }
+}
+
+static void TestTcpRewrites() noexcept {
+    uint32_t seed = 6;
+    for (int i = 0; i < 2000; i++) {
+        Datagram packet = NewPacket(seed, ip_hdr::IP_PROTO_TCP, false, true);
+        PacketView view(packet.data(), (int)packet.size());
+        PACKET_VIEW_CHECK(view.IsValid());
+        if (!view.IsValid()) {
+            continue;
+        }
+
+        for (int j = 0; j < 8; j++) {
+            Rewrite(seed, view, false);
+            PACKET_VIEW_CHECK(IpChecksumValid(packet));
+            PACKET_VIEW_CHECK(TransportChecksumValid(packet, ip_hdr::IP_PROTO_TCP));
+        }
+    }
+}
+
+// Only the first fragment holds the transport header, and a fragment with MF set is not checksummed as a whole, nothing past the IP header may change.
+static void TestFragmentsAndIcmp() noexcept {
+    uint32_t seed = 1;
+    for (int i = 0; i < 2000; i++) {
+        bool fragment = (i & 1) == 0;
+        int proto = fragment ? ip_hdr::IP_PROTO_UDP : ip_hdr::IP_PROTO_ICMP;
+        Datagram packet = NewPacket(seed, proto, fragment, true);
+        Datagram payload(packet.begin() + IP_HEADER_SIZE, packet.end());
+
+        PacketView view(packet.data(), (int)packet.size());
+        PACKET_VIEW_CHECK(view.IsValid() && view.IsFragment() == fragment && NULL == view.GetUdpHeader());
+        if (!view.IsValid()) {
+            continue;
+        }
+
+        for (int j = 0; j < 8; j++) {
+            Rewrite(seed, view, false);
+            PACKET_VIEW_CHECK(IpChecksumValid(packet));
+        }
+
+        PACKET_VIEW_CHECK(memcmp(packet.data() + IP_HEADER_SIZE, payload.data(), payload.size()) == 0);
+        if (!fragment) {
+            PACKET_VIEW_CHECK(ppp::net::native::inet_chksum(packet.data() + IP_HEADER_SIZE, (int)payload.size()) == 0);
+        }
+    }
+}
+
+int main(int argc, const char* argv[]) {
+    TestRfc1624Example();
+    TestUdpRewrites();
+    TestUdpWithoutChecksum();
+    TestTcpRewrites();
+    TestFragmentsAndIcmp();
+
+    if (failures > 0) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+
+    printf("PacketView: all checks passed\n");
+    return 0;
+}
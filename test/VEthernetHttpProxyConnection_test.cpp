@@ -0,0 +1,193 @@
+// Request and response framing of the local HTTP proxy, exits with a non-zero code on the first failed check.
+//
+// Covers what the keep-alive loop relies on: the request head rewrite and its Connection header, the keep-alive decision of both
+// sides, where a request or response body ends for every framing, and where a pipelined request starts behind a body.
+
+#include <ppp/stdafx.h>
+#include <ppp/app/client/http/VEthernetHttpProxyConnection.h>
+
+using ppp::Byte;
+using ppp::app::client::http::VEthernetHttpProxyConnection;
+
+typedef VEthernetHttpProxyConnection::ProtocolRoot                      ProtocolRoot;
+typedef VEthernetHttpProxyConnection::ProtocolResponse                  ProtocolResponse;
+typedef VEthernetHttpProxyConnection::ProtocolBody                      ProtocolBody;
+
+static int failures = 0;
+
+#define VETHERNET_HTTP_PROXY_CHECK(condition)                           \
+    if (!(condition)) {                                                 \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+        failures++;                                                     \
+    }
+
+static bool ParseRequest(const std::string& head, ProtocolRoot& protocolRoot) noexcept {
+    return protocolRoot.Parse(head.data(), (int)head.size());
+}
+
+static bool ParseResponse(const std::string& head, const ProtocolRoot& protocolRoot, ProtocolResponse& response) noexcept {
+    return response.Parse(head.data(), (int)head.size(), protocolRoot);
+}
+
+// Rewrites head in place in a buffer that only has the reserved tail behind it, as ProcessRequest does.
+static std::string Rewrite(const std::string& head, const ProtocolRoot& protocolRoot) noexcept {
+    std::vector<char> buffer(head.begin(), head.end());
+    buffer.resize(head.size() + VEthernetHttpProxyConnection::PROTOCOL_HEADERS_RESERVED);
+
+    int length = protocolRoot.ToArray(buffer.data());
+    if (length < 1 || length > (int)buffer.size()) {
+        return std::string();
+    }
+
+    return std::string(buffer.data(), length);
+}
+
+static void TestRequestKeepAlive() noexcept {
+    ProtocolRoot protocolRoot;
+    VETHERNET_HTTP_PROXY_CHECK(ParseRequest("GET http://example.com/a HTTP/1.1\r\nHost: example.com\r\n\r\n", protocolRoot));
+    VETHERNET_HTTP_PROXY_CHECK(protocolRoot.KeepAlive && !protocolRoot.TunnelMode && protocolRoot.Host == "example.com:80");
+
+    VETHERNET_HTTP_PROXY_CHECK(ParseRequest("GET /a HTTP/1.1\r\nHost: example.com:8080\r\nConnection: close\r\n\r\n", protocolRoot));
+    VETHERNET_HTTP_PROXY_CHECK(!protocolRoot.KeepAlive && protocolRoot.Host == "example.com:8080");
+
+    VETHERNET_HTTP_PROXY_CHECK(ParseRequest("GET /a HTTP/1.1\r\nHost: example.com\r\nProxy-Connection: Keep-Alive, close\r\n\r\n", protocolRoot));
+    VETHERNET_HTTP_PROXY_CHECK(!protocolRoot.KeepAlive);
+
+    VETHERNET_HTTP_PROXY_CHECK(ParseRequest("GET /a HTTP/1.0\r\nHost: example.com\r\n\r\n", protocolRoot));
+    VETHERNET_HTTP_PROXY_CHECK(!protocolRoot.KeepAlive);
+
+    VETHERNET_HTTP_PROXY_CHECK(ParseRequest("GET /a HTTP/1.0\r\nHost: example.com\r\nProxy-Connection: keep-alive\r\n\r\n", protocolRoot));
+    VETHERNET_HTTP_PROXY_CHECK(protocolRoot.KeepAlive);
+
+    VETHERNET_HTTP_PROXY_CHECK(ParseRequest("HEAD /a HTTP/1.1\r\nHost: example.com\r\n\r\n", protocolRoot));
+    VETHERNET_HTTP_PROXY_CHECK(protocolRoot.HeadMethod);
+
+    // Ambiguous framing fails the request.
+    VETHERNET_HTTP_PROXY_CHECK(!ParseRequest("POST /a HTTP/1.1\r\nHost: a\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\n", protocolRoot));
+    VETHERNET_HTTP_PROXY_CHECK(!ParseRequest("POST /a HTTP/1.1\r\nHost: a\r\nContent-Length: 1\r\nTransfer-Encoding: chunked\r\n\r\n", protocolRoot));
+    VETHERNET_HTTP_PROXY_CHECK(!ParseRequest("GET /a HTTP/1.1\r\nHost: a\r\nHost: b\r\n\r\n", protocolRoot));
+}
+
+static void TestRequestRewrite() noexcept {
+    ProtocolRoot protocolRoot;
+    std::string head = "GET http://example.com/index.html HTTP/1.1\r\nHost: example.com\r\nProxy-Connection: keep-alive\r\n"
+        "Proxy-Authorization: Basic eDp5\r\nKeep-Alive: 300\r\nAccept: */*\r\n\r\n";
+    VETHERNET_HTTP_PROXY_CHECK(ParseRequest(head, protocolRoot));
+    VETHERNET_HTTP_PROXY_CHECK(Rewrite(head, protocolRoot) ==
+        "GET /index.html HTTP/1.1\r\nHost: example.com\r\nAccept: */*\r\nConnection: keep-alive\r\n\r\n");
+
+    // The longest Connection header still fits a head without any header to drop.
+    head = "GET http://e/ HTTP/1.0\r\nHost: e\r\n\r\n";
+    VETHERNET_HTTP_PROXY_CHECK(ParseRequest(head, protocolRoot));
+    VETHERNET_HTTP_PROXY_CHECK(Rewrite(head, protocolRoot) == "GET / HTTP/1.0\r\nHost: e\r\nConnection: close\r\n\r\n");
+
+    head = "GET /x HTTP/1.1\r\nHost: e\r\n\r\n";
+    VETHERNET_HTTP_PROXY_CHECK(ParseRequest(head, protocolRoot));
+    VETHERNET_HTTP_PROXY_CHECK(Rewrite(head, protocolRoot) == "GET /x HTTP/1.1\r\nHost: e\r\nConnection: keep-alive\r\n\r\n");
+}
+
+static void TestResponseFraming() noexcept {
+    ProtocolRoot get;
+    ProtocolRoot head;
+    VETHERNET_HTTP_PROXY_CHECK(ParseRequest("GET /a HTTP/1.1\r\nHost: a\r\n\r\n", get));
+    VETHERNET_HTTP_PROXY_CHECK(ParseRequest("HEAD /a HTTP/1.1\r\nHost: a\r\n\r\n", head));
+
+    ProtocolResponse response;
+    VETHERNET_HTTP_PROXY_CHECK(ParseResponse("HTTP/1.1 200 OK\r\nContent-Length: 12\r\n\r\n", get, response));
+    VETHERNET_HTTP_PROXY_CHECK(response.StatusCode == 200 && response.ContentLength == 12 && !response.Chunked && response.KeepAlive);
+
+    VETHERNET_HTTP_PROXY_CHECK(ParseResponse("HTTP/1.1 200 OK\r\nTransfer-Encoding: gzip, chunked\r\nContent-Length: 12\r\n\r\n", get, response));
+    VETHERNET_HTTP_PROXY_CHECK(response.Chunked && response.ContentLength == -1 && response.KeepAlive);
+
+    // Without a length the response runs until the upstream closes, neither side can be kept.
+    VETHERNET_HTTP_PROXY_CHECK(ParseResponse("HTTP/1.1 200 OK\r\nTransfer-Encoding: gzip\r\n\r\n", get, response));
+    VETHERNET_HTTP_PROXY_CHECK(!response.IsDelimited() && !response.KeepAlive);
+
+    VETHERNET_HTTP_PROXY_CHECK(ParseResponse("HTTP/1.1 200 OK\r\nServer: x\r\n\r\n", get, response));
+    VETHERNET_HTTP_PROXY_CHECK(!response.IsDelimited() && !response.KeepAlive);
+
+    VETHERNET_HTTP_PROXY_CHECK(ParseResponse("HTTP/1.1 200 OK\r\nContent-Length: 3\r\nConnection: close\r\n\r\n", get, response));
+    VETHERNET_HTTP_PROXY_CHECK(response.IsDelimited() && !response.KeepAlive);
+
+    VETHERNET_HTTP_PROXY_CHECK(ParseResponse("HTTP/1.0 200 OK\r\nContent-Length: 3\r\n\r\n", get, response));
+    VETHERNET_HTTP_PROXY_CHECK(!response.KeepAlive);
+
+    VETHERNET_HTTP_PROXY_CHECK(ParseResponse("HTTP/1.0 200 OK\r\nContent-Length: 3\r\nConnection: keep-alive\r\n\r\n", get, response));
+    VETHERNET_HTTP_PROXY_CHECK(response.KeepAlive);
+
+    // Responses that never carry a body, whatever their headers say.
+    VETHERNET_HTTP_PROXY_CHECK(ParseResponse("HTTP/1.1 200 OK\r\nContent-Length: 1234\r\n\r\n", head, response));
+    VETHERNET_HTTP_PROXY_CHECK(response.ContentLength == 0 && response.KeepAlive);
+
+    VETHERNET_HTTP_PROXY_CHECK(ParseResponse("HTTP/1.1 304 Not Modified\r\nTransfer-Encoding: chunked\r\n\r\n", get, response));
+    VETHERNET_HTTP_PROXY_CHECK(response.ContentLength == 0 && !response.Chunked && response.KeepAlive);
+
+    VETHERNET_HTTP_PROXY_CHECK(ParseResponse("HTTP/1.1 204 No Content\r\n\r\n", get, response));
+    VETHERNET_HTTP_PROXY_CHECK(response.ContentLength == 0 && response.KeepAlive);
+
+    VETHERNET_HTTP_PROXY_CHECK(ParseResponse("HTTP/1.1 100 Continue\r\n\r\n", get, response));
+    VETHERNET_HTTP_PROXY_CHECK(response.StatusCode == 100 && response.ContentLength == 0);
+
+    VETHERNET_HTTP_PROXY_CHECK(!ParseResponse("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n\r\n", get, response));
+    VETHERNET_HTTP_PROXY_CHECK(!ParseResponse("HTTP/1.1 200 OK\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\n", get, response));
+    VETHERNET_HTTP_PROXY_CHECK(!ParseResponse("HTTP/1.1 2x0 OK\r\n\r\n", get, response));
+    VETHERNET_HTTP_PROXY_CHECK(!ParseResponse("ICY 200 OK\r\n\r\n\r\n\r\n", get, response));
+}
+
+// Feeds message in pieces of every size and returns how many bytes the body took, or -1 if it failed or never completed.
+static int ConsumeInPieces(ProtocolBody body, const std::string& message, int piece) noexcept {
+    int consumed = 0;
+    for (int offset = 0; offset < (int)message.size() && !body.IsCompleted(); offset += piece) {
+        int length = std::min<int>(piece, (int)message.size() - offset);
+        int n = body.Consume(message.data() + offset, length);
+        if (n < 0 || (n < length && !body.IsCompleted())) {
+            return -1;
+        }
+
+        consumed += n;
+    }
+    return body.IsCompleted() ? consumed : -1;
+}
+
+static void TestBodyFraming() noexcept {
+    static const std::string pipelined = "GET /next HTTP/1.1\r\nHost: a\r\n\r\n";
+    const std::string chunked = "4;ext=1\r\nWiki\r\n5\r\npedia\r\nE\r\n in\r\n\r\nchunks.\r\n0\r\nExpires: never\r\n\r\n";
+    const std::string fixed = "0123456789";
+
+    for (int piece = 1; piece <= (int)(chunked.size() + pipelined.size()); piece++) {
+        VETHERNET_HTTP_PROXY_CHECK(ConsumeInPieces(ProtocolBody(true, -1), chunked + pipelined, piece) == (int)chunked.size());
+        VETHERNET_HTTP_PROXY_CHECK(ConsumeInPieces(ProtocolBody(false, (ppp::Int64)fixed.size()), fixed + pipelined, piece) == (int)fixed.size());
+    }
+
+    // A request whose body ends in the middle of a read leaves the pipelined request behind it.
+    std::string messages = "POST /a HTTP/1.1\r\nHost: a\r\nContent-Length: 10\r\n\r\n" + fixed + pipelined;
+    int headers_size = (int)messages.find("\r\n\r\n") + 4;
+
+    ProtocolRoot protocolRoot;
+    VETHERNET_HTTP_PROXY_CHECK(protocolRoot.Parse(messages.data(), headers_size));
+
+    ProtocolBody body(protocolRoot);
+    int body_size = body.Consume(messages.data() + headers_size, (int)messages.size() - headers_size);
+    VETHERNET_HTTP_PROXY_CHECK(body.IsCompleted() && body_size == (int)fixed.size());
+    VETHERNET_HTTP_PROXY_CHECK(messages.compare(headers_size + body_size, std::string::npos, pipelined) == 0);
+
+    VETHERNET_HTTP_PROXY_CHECK(ProtocolBody(true, -1).Consume("x\r\n", 3) < 0);
+    VETHERNET_HTTP_PROXY_CHECK(ProtocolBody(true, -1).Consume("1\r\nab", 5) < 0);
+    VETHERNET_HTTP_PROXY_CHECK(ProtocolBody(true, -1).Consume("1234567890abcdef0\r\n", 19) < 0);
+}
+
+int main(int argc, const char* argv[]) {
+    ppp::global::cctor();
+
+    TestRequestKeepAlive();
+    TestRequestRewrite();
+    TestResponseFraming();
+    TestBodyFraming();
+
+    if (failures != 0) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,189 @@
+// Deterministic loss simulation for the static datagram XOR parity, exits with a non-zero code on the first failed check.
+//
+// A seeded generator drops datagrams and parity messages of many groups, every group that lost exactly one datagram and kept
+// its parity has to be rebuilt byte for byte, every other group must not produce anything. Malformed and truncated parity
+// messages are copied into buffers of their exact size so an address sanitizer build catches any read past their end.
+
+#include <ppp/stdafx.h>
+#include <ppp/app/protocol/VirtualEthernetFec.h>
+
+using ppp::Byte;
+using ppp::app::protocol::VirtualEthernetFec;
+
+typedef std::vector<Byte>                                               Datagram;
+
+static int failures = 0;
+
+#define VIRTUAL_ETHERNET_FEC_CHECK(condition)                           \
+    if (!(condition)) {                                                 \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+        failures++;                                                     \
+    }
+
+// Small linear congruential generator, the same seed always yields the same datagrams and the same losses.
+static uint32_t NextRandom(uint32_t& seed) noexcept {
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+static Datagram NewDatagram(uint32_t& seed) noexcept {
+    Datagram datagram(40 + NextRandom(seed) % 1360);
+    for (Byte& b : datagram) {
+        b = (Byte)NextRandom(seed);
+    }
+    return datagram;
+}
+
+static Datagram EncodeGroup(VirtualEthernetFec& encoder, const std::vector<Datagram>& datagrams) noexcept {
+    Datagram parity;
+    for (const Datagram& datagram : datagrams) {
+        int parity_length = 0;
+        std::shared_ptr<Byte> messages = encoder.Encode(NULL, datagram.data(), (int)datagram.size(), parity_length);
+        if (NULL != messages) {
+            parity.assign(messages.get(), messages.get() + parity_length);
+        }
+    }
+    return parity;
+}
+
+static std::shared_ptr<Byte> Decode(VirtualEthernetFec& decoder, const Datagram& parity, int& packet_length) noexcept {
+    // An exact sized heap copy, so reads past the parity message are visible to the sanitizer.
+    Datagram copy(parity);
+    return decoder.Decode(NULL, copy.data(), (int)copy.size(), packet_length);
+}
+
+static void TestLossSimulation() noexcept {
+    static constexpr int GROUP_SIZE = 8;
+    static constexpr int GROUPS     = 2000;
+
+    VirtualEthernetFec encoder(GROUP_SIZE);
+    VirtualEthernetFec decoder(GROUP_SIZE);
+
+    uint32_t seed = 0x5eed1234u;
+    int recovered = 0;
+    int unrecoverable = 0;
+    for (int group = 0; group < GROUPS; group++) {
+        std::vector<Datagram> datagrams;
+        for (int i = 0; i < GROUP_SIZE; i++) {
+            datagrams.emplace_back(NewDatagram(seed));
+        }
+
+        Datagram parity = EncodeGroup(encoder, datagrams);
+        VIRTUAL_ETHERNET_FEC_CHECK(!parity.empty());
+
+        // About one datagram in twelve is lost, the parity message itself is lost just as often.
+        int lost = -1;
+        int lost_count = 0;
+        for (int i = 0; i < GROUP_SIZE; i++) {
+            if (NextRandom(seed) % 12 == 0) {
+                lost = i;
+                lost_count++;
+            }
+            else {
+                VIRTUAL_ETHERNET_FEC_CHECK(decoder.Input(NULL, datagrams[i].data(), (int)datagrams[i].size()));
+            }
+        }
+
+        if (NextRandom(seed) % 12 == 0) {
+            continue;
+        }
+
+        int packet_length = 0;
+        std::shared_ptr<Byte> packet = Decode(decoder, parity, packet_length);
+        if (lost_count != 1) {
+            VIRTUAL_ETHERNET_FEC_CHECK(NULL == packet);
+            unrecoverable += lost_count > 1;
+            continue;
+        }
+
+        const Datagram& original = datagrams[lost];
+        VIRTUAL_ETHERNET_FEC_CHECK(NULL != packet);
+        VIRTUAL_ETHERNET_FEC_CHECK(packet_length == (int)original.size());
+        if (NULL != packet && packet_length == (int)original.size()) {
+            VIRTUAL_ETHERNET_FEC_CHECK(memcmp(packet.get(), original.data(), packet_length) == 0);
+            recovered++;
+        }
+
+        // The original arriving late after it was rebuilt must not be delivered a second time.
+        VIRTUAL_ETHERNET_FEC_CHECK(!decoder.Input(NULL, original.data(), (int)original.size()));
+    }
+
+    VIRTUAL_ETHERNET_FEC_CHECK(recovered > 0);
+    VIRTUAL_ETHERNET_FEC_CHECK(unrecoverable > 0);
+    VIRTUAL_ETHERNET_FEC_CHECK(decoder.GetLoss() > 0);
+    printf("groups=%d recovered=%d unrecoverable=%d loss=%d\n", GROUPS, recovered, unrecoverable, decoder.GetLoss());
+}
+
+static void TestDecodeBounds() noexcept {
+    static constexpr int GROUP_SIZE = 4;
+    static constexpr int HEADER_SIZE = 4;
+
+    VirtualEthernetFec encoder(GROUP_SIZE);
+    VirtualEthernetFec decoder(GROUP_SIZE);
+
+    // The lost datagram is the longest one, so the parity body is exactly as long as the datagram it rebuilds.
+    uint32_t seed = 0xb0d5u;
+    std::vector<Datagram> datagrams;
+    for (int i = 0; i < GROUP_SIZE; i++) {
+        datagrams.emplace_back(NewDatagram(seed));
+        datagrams.back().resize(100 + i * 100);
+    }
+
+    Datagram parity = EncodeGroup(encoder, datagrams);
+    VIRTUAL_ETHERNET_FEC_CHECK(parity.size() == HEADER_SIZE + GROUP_SIZE * sizeof(uint32_t) + datagrams.back().size());
+
+    for (int i = 0; i < GROUP_SIZE - 1; i++) {
+        decoder.Input(NULL, datagrams[i].data(), (int)datagrams[i].size());
+    }
+
+    int packet_length = -1;
+    VIRTUAL_ETHERNET_FEC_CHECK(NULL == decoder.Decode(NULL, NULL, 0, packet_length));
+    VIRTUAL_ETHERNET_FEC_CHECK(packet_length == 0);
+
+    // Every prefix shorter than the whole message is rejected, from a bare header to a body missing its last byte.
+    for (std::size_t length = 0; length < parity.size(); length++) {
+        Datagram truncated(parity.begin(), parity.begin() + length);
+        VIRTUAL_ETHERNET_FEC_CHECK(NULL == Decode(decoder, truncated, packet_length));
+    }
+
+    // Group counts outside of the accepted range.
+    Datagram malformed(parity);
+    malformed[0] = 0;
+    VIRTUAL_ETHERNET_FEC_CHECK(NULL == Decode(decoder, malformed, packet_length));
+
+    malformed[0] = VirtualEthernetFec::MAX_GROUP_SIZE + 1;
+    VIRTUAL_ETHERNET_FEC_CHECK(NULL == Decode(decoder, malformed, packet_length));
+
+    // A count that places the hash table past the end of the message.
+    malformed[0] = VirtualEthernetFec::MAX_GROUP_SIZE;
+    malformed.resize(HEADER_SIZE + GROUP_SIZE * sizeof(uint32_t));
+    VIRTUAL_ETHERNET_FEC_CHECK(NULL == Decode(decoder, malformed, packet_length));
+
+    // A length that does not match the group and a damaged body both fail the hash of the missing datagram.
+    malformed = parity;
+    malformed[2] ^= 0x01;
+    VIRTUAL_ETHERNET_FEC_CHECK(NULL == Decode(decoder, malformed, packet_length));
+
+    malformed = parity;
+    malformed[HEADER_SIZE + GROUP_SIZE * sizeof(uint32_t)] ^= 0x01;
+    VIRTUAL_ETHERNET_FEC_CHECK(NULL == Decode(decoder, malformed, packet_length));
+
+    std::shared_ptr<Byte> packet = Decode(decoder, parity, packet_length);
+    VIRTUAL_ETHERNET_FEC_CHECK(NULL != packet && packet_length == (int)datagrams.back().size());
+    VIRTUAL_ETHERNET_FEC_CHECK(NULL != packet && memcmp(packet.get(), datagrams.back().data(), datagrams.back().size()) == 0);
+
+    // Nothing is missing any more, the same parity message must not rebuild anything again.
+    VIRTUAL_ETHERNET_FEC_CHECK(NULL == Decode(decoder, parity, packet_length));
+}
+
+int main(int argc, const char* argv[]) {
+    TestLossSimulation();
+    TestDecodeBounds();
+
+    if (failures != 0) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+
+    return 0;
+}
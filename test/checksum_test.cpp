@@ -0,0 +1,122 @@
+// Compares ip_standard_chksum against the scalar loop it replaced, exits non-zero if they differ at any length or offset.
+//
+// The random buffers cover every length up to a jumbo frame at every alignment, the all-ones buffers keep every 16-bit word at its
+// maximum so the lane accumulators get as close to overflowing as they can, up to past the point where they are drained.
+
+#include <ppp/stdafx.h>
+#include <ppp/net/native/checksum.h>
+
+using ppp::Byte;
+
+static int failures = 0;
+
+#define CHECKSUM_CHECK(condition, length, offset)                       \
+    if (!(condition)) {                                                 \
+        fprintf(stderr, "%s:%d: check failed: %s (length=%d offset=%d)\n", __FILE__, __LINE__, #condition, length, offset); \
+        failures++;                                                     \
+    }
+
+// Small linear congruential generator, the same seed always yields the same buffers.
+static uint32_t NextRandom(uint32_t& seed) noexcept {
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+// The byte-at-a-time loop ip_standard_chksum used before it was vectorized, kept here as the reference. Its accumulator is widened
+// to 64 bits and folded until no carry is left, the 32-bit one of the original wraps past 128 KB of all-ones words.
+static unsigned short ReferenceChecksum(const void* dataptr, int len) noexcept {
+    uint64_t acc = 0;
+    unsigned short src;
+    const unsigned char* octetptr = (const unsigned char*)dataptr;
+    while (len > 1) {
+        src = (unsigned short)((*octetptr) << 8);
+        octetptr++;
+        src |= (*octetptr);
+        octetptr++;
+        acc += src;
+        len -= 2;
+    }
+
+    if (len > 0) {
+        src = (unsigned short)((*octetptr) << 8);
+        acc += src;
+    }
+
+    while ((acc >> 16) != 0) {
+        acc = (acc >> 16) + (acc & 0xffffULL);
+    }
+
+    return ntohs((unsigned short)acc);
+}
+
+static void TestRandomBuffers() noexcept {
+    static constexpr int MAX_LENGTH = 9000;
+    static constexpr int MAX_OFFSET = 64;
+
+    std::vector<Byte> buffer(MAX_LENGTH + MAX_OFFSET);
+    uint32_t seed = 1071;
+    for (int length = 0; length <= MAX_LENGTH; length++) {
+        for (Byte& b : buffer) {
+            b = (Byte)NextRandom(seed);
+        }
+
+        // Every alignment for the short lengths, where the tails matter, a few random ones past them.
+        int offsets = length <= 256 ? MAX_OFFSET : 4;
+        for (int i = 0; i < offsets; i++) {
+            int offset = length <= 256 ? i : (int)(NextRandom(seed) % MAX_OFFSET);
+            Byte* p = buffer.data() + offset;
+            CHECKSUM_CHECK(ppp::net::native::ip_standard_chksum(p, length) == ReferenceChecksum(p, length), length, offset);
+        }
+    }
+}
+
+static void TestAllOnesBuffers() noexcept {
+    // Large enough to run more than 0xffff blocks of the widest vectors through the lanes before they are drained.
+    static constexpr int MAX_LENGTH = 0xffff * 64 + 4099;
+
+    std::vector<Byte> buffer(MAX_LENGTH + 1, 0xff);
+    for (int length = 0; length <= MAX_LENGTH; length += length < 4096 ? 1 : (length < 65536 ? 251 : 65521)) {
+        for (int offset = 0; offset < 2; offset++) {
+            Byte* p = buffer.data() + offset;
+            CHECKSUM_CHECK(ppp::net::native::ip_standard_chksum(p, length) == ReferenceChecksum(p, length), length, offset);
+            if (failures > 16) {
+                return;
+            }
+        }
+    }
+
+    CHECKSUM_CHECK(ppp::net::native::ip_standard_chksum(buffer.data(), MAX_LENGTH) == ReferenceChecksum(buffer.data(), MAX_LENGTH), MAX_LENGTH, 0);
+}
+
+// A buffer with its own checksum written into it must sum to zero, which is how a receiver verifies a header.
+static void TestVerification() noexcept {
+    uint32_t seed = 791;
+    for (int i = 0; i < 10000; i++) {
+        int length = 2 + (int)(NextRandom(seed) % 1500) * 2;
+        std::vector<Byte> buffer(length);
+        for (Byte& b : buffer) {
+            b = (Byte)NextRandom(seed);
+        }
+
+        buffer[0] = 0;
+        buffer[1] = 0;
+
+        unsigned short chksum = ppp::net::native::inet_chksum(buffer.data(), length);
+        memcpy(buffer.data(), &chksum, sizeof(chksum));
+        CHECKSUM_CHECK(ppp::net::native::inet_chksum(buffer.data(), length) == 0, length, 0);
+    }
+}
+
+int main(int argc, const char* argv[]) {
+    TestRandomBuffers();
+    TestAllOnesBuffers();
+    TestVerification();
+
+    if (failures > 0) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+
+    printf("checksum: all checks passed\n");
+    return 0;
+}